@@ -43,6 +43,33 @@ public:
   /// Finish the aggregation into a single materialized value.
   [[nodiscard]] virtual caf::expected<data> finish() && = 0;
 
+  /// Return the type of the partial state of the function, which allows for
+  /// splitting the aggregation into independently computed parts that get
+  /// merged later on.
+  /// @note Partial states are merged by an instance of the same aggregation
+  /// function that was created with the partial type as its input type, and
+  /// that must have the same output type.
+  /// @note The default implementation returns the null type, which signals
+  /// that the function does not support partial aggregation.
+  [[nodiscard]] virtual type partial_type() const;
+
+  /// Finish the aggregation into a partial state.
+  /// @pre *partial_type()* must not be the null type.
+  /// @note The default implementation for this calls *finish*.
+  [[nodiscard]] virtual caf::expected<data> save() &&;
+
+  /// Merge a partial state into the aggregation function.
+  /// @param partial The partial state to merge.
+  /// @pre *partial* is either *nil* or matches the input type.
+  /// @note The default implementation for this returns an error.
+  [[nodiscard]] virtual caf::error merge(const data_view& partial);
+
+  /// Return an estimate of the memory that the function allocated for its
+  /// state, in bytes. This excludes the size of the function object itself.
+  /// @note The default implementation returns zero, which is correct for all
+  /// functions whose state has a fixed size.
+  [[nodiscard]] virtual size_t memusage() const;
+
 protected:
   /// Constructs the aggregation function. Must be called from implementing base
   /// classes.
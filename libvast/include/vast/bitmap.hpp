@@ -8,12 +8,14 @@
 
 #pragma once
 
+#include "vast/bitmap_algorithms.hpp"
 #include "vast/bitmap_base.hpp"
 #include "vast/concept/printable/print.hpp"
 #include "vast/detail/operators.hpp"
 #include "vast/detail/type_traits.hpp"
 #include "vast/ewah_bitmap.hpp"
 #include "vast/null_bitmap.hpp"
+#include "vast/roaring_bitmap.hpp"
 #include "vast/wah_bitmap.hpp"
 
 #include <caf/detail/type_list.hpp>
@@ -30,7 +32,8 @@ class bitmap : public bitmap_base<bitmap>, detail::equality_comparable<bitmap> {
   friend bitmap_bit_range;
 
 public:
-  using types = caf::detail::type_list<ewah_bitmap, null_bitmap, wah_bitmap>;
+  using types = caf::detail::type_list<ewah_bitmap, null_bitmap, wah_bitmap,
+                                       roaring_bitmap>;
 
   using variant = caf::detail::tl_apply_t<types, caf::variant>;
 
@@ -70,6 +73,19 @@ public:
 
   void flip();
 
+  // -- bitwise operations ---------------------------------------------------
+
+  // Two bitmaps of the same concrete type use its specialized algorithms;
+  // all other combinations fall back to the generic block-wise algorithms.
+
+  friend bitmap operator&(const bitmap& x, const bitmap& y);
+
+  friend bitmap operator|(const bitmap& x, const bitmap& y);
+
+  friend bitmap operator^(const bitmap& x, const bitmap& y);
+
+  friend bitmap operator-(const bitmap& x, const bitmap& y);
+
   // -- concepts -------------------------------------------------------------
 
   variant& get_data();
@@ -104,13 +120,39 @@ public:
 
 private:
   using range_variant
-    = caf::variant<ewah_bitmap_range, null_bitmap_range, wah_bitmap_range>;
+    = caf::variant<ewah_bitmap_range, null_bitmap_range, wah_bitmap_range,
+                   roaring_bitmap_range>;
 
   range_variant range_;
 };
 
 bitmap_bit_range bit_range(const bitmap& bm);
 
+/// Computes the *rank* of the concrete bitmap, which allows for using the
+/// specialized algorithms of bitmaps that have them.
+/// @relates bitmap
+template <bool Bit = true>
+bitmap::size_type rank(const bitmap& bm, bitmap::size_type i) {
+  return caf::visit(
+    [&](const auto& x) {
+      return rank<Bit>(x, i);
+    },
+    bm.get_data());
+}
+
+/// Computes the position of the i-th occurrence of a bit in the concrete
+/// bitmap, which allows for using the specialized algorithms of bitmaps that
+/// have them.
+/// @relates bitmap
+template <bool Bit = true>
+bitmap::size_type select(const bitmap& bm, bitmap::size_type i) {
+  return caf::visit(
+    [&](const auto& x) {
+      return select<Bit>(x, i);
+    },
+    bm.get_data());
+}
+
 } // namespace vast
 
 namespace caf {
@@ -18,6 +18,7 @@
 #include <caf/serializer.hpp>
 
 #include <optional>
+#include <vector>
 
 namespace vast {
 
@@ -59,14 +60,23 @@ public:
         return bloom_filter_.lookup(caf::get<view<T>>(rhs));
       case relational_operator::in: {
         if (auto xs = caf::get_if<view<list>>(&rhs)) {
+          // Collect the candidates first so that the Bloom filter can probe
+          // them in batches. This matters for long lists of indicators.
+          std::vector<view<T>> candidates;
+          candidates.reserve((*xs)->size());
+          auto has_nil = false;
           for (auto x : **xs) {
             if (caf::holds_alternative<view<caf::none_t>>(x))
-              return {};
-            if (!caf::holds_alternative<view<T>>(x))
-              continue;
-            if (bloom_filter_.lookup(caf::get<view<T>>(x)))
-              return true;
+              has_nil = true;
+            else if (auto y = caf::get_if<view<T>>(&x))
+              candidates.push_back(*y);
           }
+          // A hit is definite, but without one a nil in the list may still
+          // match. See the TODO for the equality lookup above.
+          if (bloom_filter_.lookup_any(candidates.begin(), candidates.end()))
+            return true;
+          if (has_nil)
+            return {};
           return false;
         }
         return {};
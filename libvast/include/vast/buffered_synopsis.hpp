@@ -11,6 +11,7 @@
 #include "vast/bloom_filter_parameters.hpp"
 #include "vast/bloom_filter_synopsis.hpp"
 #include "vast/detail/legacy_deserialize.hpp"
+#include "vast/digest_index.hpp"
 #include "vast/error.hpp"
 #include "vast/synopsis.hpp"
 
@@ -74,6 +75,18 @@ public:
     return shrunk_synopsis;
   }
 
+  bool append_digests(uint64_t scope,
+                      std::vector<uint64_t>& result) const override {
+    result.reserve(result.size() + data_.size());
+    for (const auto& x : data_) {
+      auto d = digest(make_view(x), scope);
+      if (!d)
+        return false;
+      result.push_back(*d);
+    }
+    return true;
+  }
+
   // Implementation of the remainder of the `synopsis` API.
   void add(data_view x) override {
     auto v = caf::get_if<view_type>(&x);
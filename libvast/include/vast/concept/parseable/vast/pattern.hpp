@@ -29,7 +29,11 @@ struct access::parser_base<pattern>
 
   template <class Iterator>
   bool parse(Iterator& f, const Iterator& l, pattern& a) const {
-    return pattern_parser{}(f, l, a.str_);
+    auto str = std::string{};
+    if (!pattern_parser{}(f, l, str))
+      return false;
+    a = pattern{std::move(str)};
+    return true;
   }
 };
 
@@ -10,6 +10,7 @@
 
 #include "vast/fwd.hpp"
 
+#include "vast/table_slice_compression.hpp"
 #include "vast/table_slice_encoding.hpp"
 
 #include <caf/fwd.hpp>
@@ -36,6 +37,10 @@ inline constexpr size_t table_slice_size = 65'536; // 64 Ki
 /// The default table slice type when arrow is available.
 inline constexpr auto table_slice_type = table_slice_encoding::arrow;
 
+/// The default compression of the Arrow IPC backing of table slices.
+inline constexpr auto table_slice_compression
+  = vast::table_slice_compression::zstd;
+
 /// Maximum number of results.
 inline constexpr size_t max_events = 0;
 
@@ -44,6 +49,11 @@ inline constexpr size_t max_events = 0;
 inline constexpr std::chrono::milliseconds batch_timeout
   = std::chrono::seconds{10};
 
+/// End-to-end latency target for adaptive batching in sources. A value of zero
+/// disables adaptive batching in favor of the static batch size and timeout.
+inline constexpr std::chrono::milliseconds batch_latency_target
+  = std::chrono::milliseconds::zero();
+
 /// Timeout for how long readers should block while waiting for their input.
 inline constexpr std::chrono::milliseconds read_timeout
   = std::chrono::milliseconds{20};
@@ -61,6 +71,23 @@ struct csv {
   static constexpr std::string_view kvp_separator = "=";
 };
 
+/// Contains settings for the batched UDP receiver.
+struct udp {
+  /// The number of sockets sharing the listening port via SO_REUSEPORT, each
+  /// served by its own receiver thread. A value of 0 disables the batched
+  /// receiver in favor of the datagram source broker.
+  static constexpr size_t receivers = 0;
+
+  /// The maximum number of datagrams to receive with a single system call.
+  static constexpr size_t batch_size = 64;
+
+  /// The requested kernel receive buffer size per socket in bytes.
+  static constexpr size_t receive_buffer_size = 8 * 1'024 * 1'024; // 8 Mi
+
+  /// The maximum number of bytes to buffer before dropping datagrams.
+  static constexpr size_t max_buffered_bytes = 64 * 1'024 * 1'024; // 64 Mi
+};
+
 /// Contains settings for the test subcommand.
 struct test {
   /// @returns a user-defined seed if available, a randomly generated seed
@@ -221,6 +248,19 @@ inline constexpr size_t max_partition_size = 4'194'304; // 4 Mi
 inline constexpr caf::timespan active_partition_timeout
   = std::chrono::minutes{5};
 
+/// Number of active INDEX partitions per schema.
+inline constexpr size_t active_partitions_per_schema = 1;
+
+/// Maximum number of threads that apply import pipelines on the server.
+inline constexpr size_t pipeline_workers = 1;
+
+/// Number of most frequent values per field that the catalog reports in its
+/// detailed status.
+inline constexpr size_t catalog_status_top_k = 10;
+
+/// Maximum number of value digests in the digest index of the catalog.
+inline constexpr size_t max_digest_index_size = 4'194'304; // 4 Mi
+
 /// Maximum number of in-memory INDEX partitions.
 inline constexpr size_t max_in_mem_partitions = 10;
 
@@ -279,6 +319,9 @@ inline constexpr double fp_rate = 0.01;
 /// Flag that enables creation of partition indexes in the database.
 inline constexpr bool create_partition_index = true;
 
+/// Flag that enables cardinality and frequency sketches in partition synopses.
+inline constexpr bool create_sketches = false;
+
 /// Whether to spawn central components in separate threads.
 inline constexpr bool detach_components = true;
 
@@ -27,9 +27,10 @@ public:
   void next_impl();
   void next();
 
-  // This is only supported if input_ uses a detail::fdinbuf as its streambuf,
-  // otherwise the timeout is ignored. The returned bool only indicates if a
-  // timeout occurred, other errors still need to be checked by `done()`.
+  // This is only supported if input_ uses a detail::fdinbuf or a
+  // detail::udp_inbuf as its streambuf, otherwise the timeout is ignored. The
+  // returned bool only indicates if a timeout occurred, other errors still need
+  // to be checked by `done()`.
   [[nodiscard]] bool next_timeout(std::chrono::milliseconds timeout);
 
   template <class Rep, class Period = std::ratio<1>>
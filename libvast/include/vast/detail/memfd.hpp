@@ -0,0 +1,38 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include <caf/fwd.hpp>
+
+#include <cstddef>
+#include <span>
+
+namespace vast::detail {
+
+/// Creates an anonymous in-memory file that contains a copy of *bytes*, and
+/// seals it against further modification. The resulting file descriptor can
+/// be passed to another process on the same host, which may then map the
+/// contents without copying.
+/// @param name The name of the file, used for debugging purposes only.
+/// @param bytes The contents of the file.
+/// @returns The file descriptor of the sealed file, or an error if the
+/// platform does not support sealed in-memory files.
+caf::expected<int>
+make_sealed_memfd(const char* name, std::span<const std::byte> bytes);
+
+/// Memory-maps a sealed in-memory file read-only into a chunk.
+/// @param fd The file descriptor of the in-memory file. The function takes
+/// ownership of *fd* and closes it in any case.
+/// @returns A chunk that unmaps the file on destruction, or an error if the
+/// file is not sealed against modification or cannot be mapped.
+caf::expected<chunk_ptr> map_sealed_memfd(int fd);
+
+} // namespace vast::detail
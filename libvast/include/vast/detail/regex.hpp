@@ -0,0 +1,145 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include <caf/fwd.hpp>
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vast::detail {
+
+/// A regular expression compiled into a finite automaton that matches in time
+/// linear in the length of the input.
+///
+/// The engine understands the subset of the ECMAScript grammar of `std::regex`
+/// that does not require backtracking: literals, escapes, character classes,
+/// the wildcard `.`, groups, alternation, greedy and lazy quantifiers, and the
+/// anchors `^` and `$`. Back references, lookahead, word boundaries, and POSIX
+/// character classes yield `ec::unimplemented`, so that callers can fall back
+/// to `std::regex` with identical semantics.
+///
+/// The automaton is a DFA over byte equivalence classes that is constructed
+/// upfront, so that a compiled expression is immutable and can be shared
+/// between threads. Expressions whose DFA exceeds a size limit run as an NFA
+/// simulation instead. Expressions that consist of literals, `.`, and `.*`
+/// only, e.g., the ones created from glob expressions, bypass the automaton.
+class regex {
+public:
+  /// Compiles a regular expression.
+  /// @param str The regular expression in ECMAScript syntax.
+  /// @returns The compiled expression, `ec::parse_error` if *str* is not a
+  /// valid expression, or `ec::unimplemented` if *str* uses a feature that the
+  /// engine does not support.
+  static caf::expected<regex> make(std::string_view str);
+
+  /// Matches a string against the expression.
+  /// @param str The string to match.
+  /// @returns `true` if the expression matches exactly *str*.
+  [[nodiscard]] bool match(std::string_view str) const;
+
+  /// Searches the expression in a string.
+  /// @param str The string to search.
+  /// @returns `true` if the expression matches a substring of *str*.
+  [[nodiscard]] bool search(std::string_view str) const;
+
+  /// @returns The literal that all matches start with.
+  [[nodiscard]] const std::string& prefix() const noexcept;
+
+  /// @returns Literals that every match contains as a substring.
+  [[nodiscard]] std::vector<std::string> literals() const;
+
+  /// @returns Whether the expression takes the fast path for globs.
+  [[nodiscard]] bool is_glob() const noexcept;
+
+  /// @returns Whether the expression runs as a DFA.
+  [[nodiscard]] bool is_dfa() const noexcept;
+
+  // -- implementation details -------------------------------------------------
+
+  /// A single instruction of the NFA program.
+  struct instruction {
+    enum class opcode : uint8_t {
+      byte,  ///< Consumes a byte contained in the set `x`.
+      split, ///< Continues at both `x` and `y`.
+      jump,  ///< Continues at `x`.
+      begin, ///< Continues if at the beginning of the input.
+      end,   ///< Continues if at the end of the input.
+      match, ///< Accepts.
+    };
+
+    opcode op = opcode::match;
+    uint32_t x = 0;
+    uint32_t y = 0;
+  };
+
+  /// A DFA over the byte equivalence classes of the program.
+  struct automaton {
+    /// The state flags.
+    enum flag : uint8_t {
+      accepting = 1, ///< The state contains a match.
+      final = 2,     ///< The state accepts at the end of the input.
+      dead = 4,      ///< The state cannot reach a match.
+    };
+
+    /// The transition table, indexed by `state * num_classes + class`.
+    std::vector<uint32_t> transitions = {};
+
+    /// The flags of each state.
+    std::vector<uint8_t> flags = {};
+
+    /// The state at the beginning of the input.
+    uint32_t start = 0;
+
+    /// The state for starting a search in the middle of the input.
+    uint32_t restart = 0;
+
+    /// Whether the expression matches the empty input.
+    bool start_final = false;
+  };
+
+  /// A sequence of literals and wildcards between two `.*` of a glob.
+  struct glob_segment {
+    /// The literal bytes; a wildcard position holds an arbitrary byte.
+    std::string bytes = {};
+
+    /// Marks the wildcard positions.
+    std::vector<bool> wildcards = {};
+  };
+
+private:
+  regex() = default;
+
+  [[nodiscard]] bool match_glob(std::string_view str, bool anchored) const;
+
+  [[nodiscard]] std::optional<automaton> make_automaton(bool search) const;
+
+  [[nodiscard]] bool
+  run(const automaton& dfa, std::string_view str, size_t from) const;
+
+  [[nodiscard]] bool
+  simulate(std::string_view str, size_t from, bool search) const;
+
+  std::string prefix_ = {};
+  bool anchored_ = false;
+  std::optional<std::vector<glob_segment>> glob_ = {};
+  std::vector<instruction> program_ = {};
+  std::vector<std::bitset<256>> sets_ = {};
+  std::array<uint8_t, 256> classes_ = {};
+  size_t num_classes_ = 0;
+  std::optional<automaton> match_dfa_ = {};
+  std::optional<automaton> search_dfa_ = {};
+};
+
+} // namespace vast::detail
@@ -0,0 +1,44 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/data.hpp"
+
+#include <caf/expected.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace vast::detail {
+
+/// Parses the `memory-budget` option of a pipeline operator that moves its
+/// state to disk, which is either a non-negative number of bytes or a string
+/// with an optional unit, e.g., `512 MiB`.
+/// @param value The configured value.
+/// @returns The number of bytes, or an error if the value is invalid.
+caf::expected<uint64_t> parse_memory_budget(const data& value);
+
+/// Parses the `spill-directory` option of a pipeline operator that moves its
+/// state to disk.
+/// @param value The configured value.
+/// @returns The directory, or an error if the value is not a string.
+caf::expected<std::filesystem::path> parse_spill_directory(const data& value);
+
+/// Creates a uniquely named directory for state that a pipeline operator
+/// moves to disk.
+/// @param parent The configured spill directory, or an empty path for the
+/// directory for temporary files.
+/// @param name The name of the pipeline operator.
+/// @returns The path to the created directory.
+caf::expected<std::filesystem::path>
+make_spill_directory(const std::filesystem::path& parent,
+                     std::string_view name);
+
+} // namespace vast::detail
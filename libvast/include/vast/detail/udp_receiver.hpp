@@ -0,0 +1,160 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include <caf/fwd.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vast::detail {
+
+/// Receives UDP datagrams on one or more sockets bound to the same endpoint,
+/// each served by a dedicated receiver thread. On Linux, receiver threads
+/// drain their socket in batches via `recvmmsg(2)`, and multiple sockets share
+/// the port via `SO_REUSEPORT` so that the kernel balances flows across them.
+/// Received datagrams are buffered as newline-delimited text for consumption
+/// by line-based readers.
+class udp_receiver {
+public:
+  /// Configures a UDP receiver.
+  struct options {
+    /// The host to bind to; binds to all interfaces if empty.
+    std::string host = {};
+
+    /// The port to bind to; 0 chooses an ephemeral port.
+    uint16_t port = 0;
+
+    /// The number of sockets and receiver threads.
+    size_t receivers = 1;
+
+    /// The maximum number of datagrams to receive with a single system call.
+    size_t batch_size = 64;
+
+    /// The requested size of the kernel receive buffer per socket in bytes.
+    size_t receive_buffer_size = 8 * 1'024 * 1'024;
+
+    /// The maximum number of bytes to buffer before dropping datagrams.
+    size_t max_buffered_bytes = 64 * 1'024 * 1'024;
+  };
+
+  /// Counters for the received and dropped datagrams.
+  struct statistics {
+    /// The number of received datagrams.
+    uint64_t datagrams = 0;
+
+    /// The number of received bytes.
+    uint64_t bytes = 0;
+
+    /// The number of system calls that returned at least one datagram.
+    uint64_t batches = 0;
+
+    /// The number of datagrams dropped because the buffer was full.
+    uint64_t dropped = 0;
+
+    /// The number of datagrams dropped by the kernel because the socket
+    /// receive buffer was full. Only available on Linux.
+    uint64_t kernel_dropped = 0;
+  };
+
+  /// Opens the sockets and starts the receiver threads.
+  /// @param opts The receiver configuration.
+  /// @returns The running receiver or an error if any socket failed to open.
+  static caf::expected<std::shared_ptr<udp_receiver>> make(options opts);
+
+  udp_receiver(const udp_receiver&) = delete;
+  udp_receiver& operator=(const udp_receiver&) = delete;
+  udp_receiver(udp_receiver&&) = delete;
+  udp_receiver& operator=(udp_receiver&&) = delete;
+
+  /// The destructor stops all receiver threads and closes the sockets.
+  ~udp_receiver() noexcept;
+
+  /// Moves all buffered datagrams into *out*, each terminated by a newline.
+  /// Blocks until data is available, the timeout expires, or the receiver
+  /// stops.
+  /// @param out The buffer to swap the received data into; gets cleared.
+  /// @param timeout The maximum time to wait, or indefinitely if unset.
+  /// @returns `true` if *out* contains data.
+  bool receive(std::string& out,
+               std::optional<std::chrono::milliseconds> timeout);
+
+  /// Stops all receiver threads; pending data can still be received.
+  void stop();
+
+  /// @returns `true` if the receiver was stopped.
+  [[nodiscard]] bool stopped() const;
+
+  /// @returns The port that the sockets are bound to.
+  [[nodiscard]] uint16_t port() const;
+
+  /// @returns A snapshot of the receive and drop counters.
+  [[nodiscard]] statistics stats() const;
+
+private:
+  explicit udp_receiver(options opts);
+
+  /// The loop executed by each receiver thread.
+  void run(int fd);
+
+  /// Appends a single datagram to the shared buffer.
+  /// @pre `mutex_` is locked.
+  void append(const char* data, size_t size);
+
+  options options_;
+  std::vector<int> fds_ = {};
+  std::vector<std::thread> threads_ = {};
+  std::atomic<bool> stopped_ = false;
+  mutable std::mutex mutex_ = {};
+  std::condition_variable cv_ = {};
+  std::string buffer_ = {};
+  std::atomic<uint64_t> datagrams_ = 0;
+  std::atomic<uint64_t> bytes_ = 0;
+  std::atomic<uint64_t> batches_ = 0;
+  std::atomic<uint64_t> dropped_ = 0;
+  std::atomic<uint64_t> kernel_dropped_ = 0;
+};
+
+/// An input stream buffer that reads newline-delimited datagrams from a UDP
+/// receiver. Mirrors the read timeout interface of `fdinbuf`.
+class udp_inbuf : public std::streambuf {
+public:
+  explicit udp_inbuf(std::shared_ptr<udp_receiver> receiver);
+
+  std::optional<std::chrono::milliseconds>& read_timeout();
+  [[nodiscard]] bool timed_out() const;
+
+  [[nodiscard]] const std::shared_ptr<udp_receiver>& receiver() const;
+
+protected:
+  int_type underflow() override;
+
+private:
+  std::shared_ptr<udp_receiver> receiver_;
+  std::string buffer_ = {};
+  std::optional<std::chrono::milliseconds> read_timeout_ = {};
+  bool timed_out_ = false;
+};
+
+/// Creates an input stream that owns a `udp_inbuf` for the given receiver.
+std::unique_ptr<std::istream>
+make_udp_input_stream(std::shared_ptr<udp_receiver> receiver);
+
+} // namespace vast::detail
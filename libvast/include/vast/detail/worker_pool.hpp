@@ -0,0 +1,67 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vast::detail {
+
+/// A fixed set of threads that repeatedly run the iterations of a loop
+/// together with the calling thread. The threads live as long as the pool, so
+/// running a loop does not start any threads.
+class worker_pool {
+public:
+  /// Starts the threads of the pool.
+  /// @param num_workers The number of threads that run a loop, including the
+  /// calling thread.
+  explicit worker_pool(size_t num_workers);
+
+  /// Stops and joins the threads of the pool.
+  ~worker_pool() noexcept;
+
+  worker_pool(const worker_pool&) = delete;
+  worker_pool& operator=(const worker_pool&) = delete;
+  worker_pool(worker_pool&&) = delete;
+  worker_pool& operator=(worker_pool&&) = delete;
+
+  /// Returns the number of threads that run a loop, including the calling
+  /// thread.
+  [[nodiscard]] size_t size() const noexcept;
+
+  /// Invokes `f(i)` for all `i` in `[0, n)` and returns once all invocations
+  /// finished. Calls from within `f` run on the calling thread only.
+  /// @pre Only one thread at a time runs a loop outside of `f`.
+  void run(size_t n, const std::function<void(size_t)>& f);
+
+private:
+  /// Runs the remaining iterations of the current loop.
+  void drain();
+
+  /// The main function of the threads of the pool.
+  void work();
+
+  std::vector<std::thread> threads_ = {};
+  std::mutex mutex_ = {};
+  std::condition_variable work_available_ = {};
+  std::condition_variable work_done_ = {};
+  const std::function<void(size_t)>* f_ = nullptr;
+  size_t n_ = 0;
+  std::atomic<size_t> next_ = 0;
+  size_t generation_ = 0;
+  size_t busy_ = 0;
+  bool stop_ = false;
+};
+
+} // namespace vast::detail
@@ -0,0 +1,169 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/defaults.hpp"
+#include "vast/detail/flat_map.hpp"
+#include "vast/operator.hpp"
+#include "vast/qualified_record_field.hpp"
+#include "vast/type.hpp"
+#include "vast/uuid.hpp"
+#include "vast/view.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace vast {
+
+/// The digests of the values that the buffered synopses of a partition held
+/// before they were shrunk, along with the synopses whose contents the digests
+/// cover.
+/// @relates digest_index
+struct partition_digests {
+  /// The digests of all buffered values, in no particular order. Every digest
+  /// includes the scope of the synopsis that held the value.
+  std::vector<uint64_t> digests = {};
+
+  /// The fields whose synopses the digests cover.
+  std::vector<qualified_record_field> fields = {};
+
+  /// The types whose synopses the digests cover.
+  std::vector<type> types = {};
+};
+
+/// Computes the scope of the digests of a field synopsis.
+/// @relates digest_index
+uint64_t digest_scope(const qualified_record_field& field);
+
+/// Computes the scope of the digests of a type synopsis.
+/// @relates digest_index
+uint64_t digest_scope(const type& t);
+
+/// Computes the digest under which the digest index stores a value.
+/// @param x The value.
+/// @param scope The scope of the synopsis that holds the value, so that a
+///        value only matches in the field or type it occurs in.
+/// @returns The digest of *x*, or `std::nullopt` if the index does not store
+///          values of the type of *x*.
+/// @relates digest_index
+std::optional<uint64_t> digest(data_view x, uint64_t scope);
+
+/// An index from value digests to the partitions that contain them.
+///
+/// The catalog answers equality and membership queries against the Bloom
+/// filter synopses of every partition, which costs one probe per value and
+/// partition. The digest index maps the digest of every buffered value to the
+/// set of partitions that contain it, so a query costs one probe per value
+/// instead. The index only knows the partitions that were added to it; all
+/// other partitions must still be checked through their synopses.
+///
+/// Like the synopses, the index may report false positives when digests
+/// collide, but never false negatives.
+///
+/// The index lives in memory only. It holds at most a fixed number of digests,
+/// and evicts the partitions that it received first when it grows beyond that.
+/// Evicted partitions fall back to their synopses.
+class digest_index {
+public:
+  // -- constructors, destructors, and assignment operators --------------------
+
+  digest_index() = default;
+
+  /// Constructs an index that holds at most *max_digests* digests.
+  explicit digest_index(size_t max_digests);
+
+  // -- modifiers --------------------------------------------------------------
+
+  /// Adds the digests of a partition, replacing the ones that the index
+  /// previously held for the partition. Partitions with more digests than the
+  /// index may hold are not added.
+  /// @param partition The partition.
+  /// @param digests The digests of the partition.
+  void add(const uuid& partition, const partition_digests& digests);
+
+  /// Removes a partition from the index.
+  /// @param partition The partition.
+  void erase(const uuid& partition);
+
+  // -- inspectors -------------------------------------------------------------
+
+  /// Checks whether the index covers the synopsis of a field in a partition.
+  [[nodiscard]] bool
+  covers(const uuid& partition, const qualified_record_field& field) const;
+
+  /// Checks whether the index covers the synopsis of a type in a partition.
+  [[nodiscard]] bool covers(const uuid& partition, const type& t) const;
+
+  /// Looks up the partitions that contain at least one of a set of digests.
+  /// @param digests The digests to look for.
+  /// @returns The sorted list of matching partitions.
+  [[nodiscard]] std::vector<uuid> lookup(std::vector<uint64_t> digests) const;
+
+  /// Looks up the partitions that may satisfy a predicate whose LHS is a
+  /// covered synopsis.
+  /// @param op The operator of the predicate.
+  /// @param rhs The RHS of the predicate.
+  /// @param scope The scope of the synopsis.
+  /// @returns The sorted list of matching partitions, or `std::nullopt` if
+  ///          the index cannot evaluate the predicate.
+  [[nodiscard]] std::optional<std::vector<uuid>>
+  lookup(relational_operator op, data_view rhs, uint64_t scope) const;
+
+  /// @returns The number of partitions in the index.
+  [[nodiscard]] size_t size() const;
+
+  /// @returns The number of digests in the index.
+  [[nodiscard]] size_t num_digests() const;
+
+  /// @returns A best-effort estimate of the memory usage in bytes.
+  [[nodiscard]] size_t memusage() const;
+
+private:
+  /// A digest along with the ordinal of a partition that contains it.
+  struct entry {
+    uint64_t digest;
+    uint32_t partition;
+
+    friend auto operator<=>(const entry&, const entry&) = default;
+  };
+
+  /// Removes the entries of a set of ordinals.
+  void erase_entries(const std::vector<uint32_t>& ordinals);
+
+  /// The bookkeeping for a single partition.
+  struct partition_state {
+    uint32_t ordinal;
+    size_t num_digests;
+    std::vector<qualified_record_field> fields;
+    std::vector<type> types;
+  };
+
+  /// The partitions by their ID.
+  detail::flat_map<uuid, partition_state> partitions_ = {};
+
+  /// Maps the ordinals of the partitions back to their ID.
+  std::vector<uuid> ordinals_ = {};
+
+  /// The ordinals that became available through erasure.
+  std::vector<uint32_t> free_ordinals_ = {};
+
+  /// All entries, sorted by digest and ordinal.
+  std::vector<entry> entries_ = {};
+
+  /// The partitions in the order the index received them.
+  std::vector<uuid> insertion_order_ = {};
+
+  /// The maximum number of entries.
+  size_t max_digests_ = defaults::system::max_digest_index_size;
+};
+
+} // namespace vast
@@ -110,6 +110,20 @@ public:
 
   void flip();
 
+  // -- bitwise operations ---------------------------------------------------
+
+  // These operate on whole words instead of bit sequences: clean words
+  // combine in bulk and dirty words in tight loops that the compiler
+  // vectorizes.
+
+  friend ewah_bitmap operator&(const ewah_bitmap& x, const ewah_bitmap& y);
+
+  friend ewah_bitmap operator|(const ewah_bitmap& x, const ewah_bitmap& y);
+
+  friend ewah_bitmap operator^(const ewah_bitmap& x, const ewah_bitmap& y);
+
+  friend ewah_bitmap operator-(const ewah_bitmap& x, const ewah_bitmap& y);
+
   // -- concepts -------------------------------------------------------------
 
   friend bool operator==(const ewah_bitmap& x, const ewah_bitmap& y);
@@ -126,6 +140,15 @@ public:
   friend auto unpack(const fbs::bitmap::EWAHBitmap& from, ewah_bitmap& to)
     -> caf::error;
 
+  /// Counts the 1-bits in *[0,i]*.
+  /// @pre `i < size()`
+  [[nodiscard]] size_type rank1(size_type i) const;
+
+  /// Locates the *i*-th 1-bit, or the last 1-bit if `i == word_type::npos`.
+  /// @returns The position of the 1-bit or `word_type::npos`.
+  /// @pre `i > 0`
+  [[nodiscard]] size_type select1(size_type i) const;
+
 private:
   /// Incorporates the most recent (complete) dirty block.
   /// @pre `num_bits_ % word_type::width == 0`
@@ -141,6 +164,26 @@ private:
   size_type num_bits_ = 0;
 };
 
+/// Counts the 1-bits or 0-bits in *[0,i]* of an EWAH bitmap without
+/// decoding clean words.
+/// @relates ewah_bitmap
+template <bool Bit = true>
+ewah_bitmap::size_type rank(const ewah_bitmap& bm, ewah_bitmap::size_type i) {
+  VAST_ASSERT(i < bm.size());
+  auto result = bm.rank1(i);
+  return Bit ? result : i + 1 - result;
+}
+
+/// Locates the *i*-th 1-bit of an EWAH bitmap without decoding clean words.
+/// @relates ewah_bitmap
+template <bool Bit = true>
+  requires(Bit)
+ewah_bitmap::size_type
+select(const ewah_bitmap& bm, ewah_bitmap::size_type i) {
+  VAST_ASSERT(i > 0);
+  return bm.select1(i);
+}
+
 class ewah_bitmap_range
   : public bit_range_base<ewah_bitmap_range, ewah_bitmap::block_type> {
 public:
@@ -54,6 +54,12 @@ class RandomAccessFile;
 
 } // namespace io
 
+namespace util {
+
+class Codec;
+
+} // namespace util
+
 } // namespace arrow
 
 // -- flatbuffers -------------------------------------------------------------
@@ -168,6 +174,7 @@ struct model;
 struct negation;
 struct legacy_none_type;
 struct offset;
+struct partial_aggregation;
 struct partition_synopsis;
 struct partition_synopsis_pair;
 struct partition_info;
@@ -263,6 +270,7 @@ namespace bitmap {
 
 struct EWAHBitmap;
 struct NullBitmap;
+struct RoaringBitmap;
 struct WAHBitmap;
 
 } // namespace bitmap
@@ -275,6 +283,14 @@ struct MultiLevelCoder;
 
 } // namespace coder
 
+namespace sketch {
+
+struct ColumnSketch;
+struct CountMin;
+struct HyperLogLog;
+
+} // namespace sketch
+
 namespace table_slice {
 
 namespace msgpack {
@@ -12,6 +12,7 @@
 #include "vast/coder.hpp"
 #include "vast/detail/legacy_deserialize.hpp"
 #include "vast/error.hpp"
+#include "vast/ewah_bitmap.hpp"
 #include "vast/ids.hpp"
 #include "vast/value_index.hpp"
 #include "vast/view.hpp"
@@ -26,6 +27,13 @@
 namespace vast {
 
 /// An index for lists.
+///
+/// The index flattens all list elements into a single element column and
+/// indexes it with one nested value index. A bitmap over the flattened column
+/// marks the last element of every list, and a second bitmap holds the rows of
+/// all non-empty lists, which together map element positions back to rows.
+/// A membership lookup thus performs a single nested lookup instead of one per
+/// list position.
 class list_index : public value_index {
 public:
   /// Constructs a sequence index of a given type.
@@ -46,6 +54,8 @@ public:
 private:
   bool append_impl(data_view x, id pos) override;
 
+  bool append_array_impl(const arrow::Array& array, id pos) override;
+
   caf::expected<ids>
   lookup_impl(relational_operator op, data_view x) const override;
 
@@ -58,7 +68,28 @@ private:
 
   caf::error unpack_impl(const fbs::ValueIndex& from) override;
 
+  /// Records a list after its first *size* elements have been appended to the
+  /// element index.
+  void append_list(id row, size_t size);
+
+  /// Maps positions in the flattened element column to the rows of their
+  /// lists.
+  [[nodiscard]] ids to_rows(const ids& elements) const;
+
+  /// The element indexes: a single index over the flattened elements, or one
+  /// index per list position for indexes written by earlier versions, which
+  /// are read-only.
   std::vector<value_index_ptr> elements_;
+
+  /// Marks the last element of every non-empty list in the element index.
+  ewah_bitmap ends_;
+
+  /// The rows of all non-empty lists.
+  ewah_bitmap rows_;
+
+  /// Whether `elements_` holds the index over the flattened elements.
+  bool flat_ = false;
+
   size_t max_size_;
   size_bitmap_index size_;
   vast::type value_type_;
@@ -0,0 +1,81 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/bitmap_index.hpp"
+#include "vast/coder.hpp"
+#include "vast/detail/legacy_deserialize.hpp"
+#include "vast/ewah_bitmap.hpp"
+#include "vast/ids.hpp"
+#include "vast/value_index.hpp"
+#include "vast/view.hpp"
+
+#include <caf/error.hpp>
+#include <caf/expected.hpp>
+#include <caf/fwd.hpp>
+#include <tsl/robin_map.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace vast {
+
+/// An inverted index over the trigrams of strings.
+///
+/// The index maps every sequence of three consecutive bytes to the IDs of the
+/// strings containing it. A substring lookup intersects the posting lists of
+/// the trigrams of the needle, and a pattern lookup those of the literals that
+/// every match of the pattern contains. Unlike the `string_index`, the lookup
+/// results are a superset of the actual hits, and the store verifies them
+/// exactly. Negated predicates therefore yield all IDs.
+class ngram_index : public value_index {
+public:
+  /// The number of bytes per n-gram.
+  static constexpr size_t ngram_size = 3;
+
+  /// Constructs an n-gram index.
+  /// @param t An instance of `string_type`.
+  /// @param opts Runtime context for index parameterization.
+  explicit ngram_index(vast::type t, caf::settings opts = {});
+
+  caf::error serialize(caf::serializer& sink) const override;
+
+  caf::error deserialize(caf::deserializer& source) override;
+
+  bool deserialize(detail::legacy_deserializer& source) override;
+
+private:
+  /// The index which holds the string length.
+  using length_bitmap_index
+    = bitmap_index<uint32_t, multi_level_coder<range_coder<ids>>>;
+
+  bool append_impl(data_view x, id pos) override;
+
+  caf::expected<ids>
+  lookup_impl(relational_operator op, data_view x) const override;
+
+  size_t memusage_impl() const override;
+
+  flatbuffers::Offset<fbs::ValueIndex>
+  pack_impl(flatbuffers::FlatBufferBuilder& builder,
+            flatbuffers::Offset<fbs::value_index::detail::ValueIndexBase>
+              base_offset) override;
+
+  caf::error unpack_impl(const fbs::ValueIndex& from) override;
+
+  /// Computes the candidates for strings that contain a literal.
+  [[nodiscard]] ids contains(std::string_view literal) const;
+
+  size_t max_length_;
+  length_bitmap_index length_;
+  tsl::robin_map<uint32_t, ewah_bitmap> postings_;
+};
+
+} // namespace vast
@@ -0,0 +1,132 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/address.hpp"
+#include "vast/detail/legacy_deserialize.hpp"
+#include "vast/ewah_bitmap.hpp"
+#include "vast/ids.hpp"
+#include "vast/value_index.hpp"
+#include "vast/view.hpp"
+
+#include <caf/error.hpp>
+#include <caf/expected.hpp>
+#include <caf/fwd.hpp>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace vast {
+
+/// A prefix index for IP addresses and subnets.
+///
+/// The index is a compressed binary radix trie over the 128-bit
+/// representation of addresses, where IPv4 addresses are mapped into the
+/// IPv6 space. Every node stores the rows of all values in its subtree, and
+/// the rows of the values that equal its prefix. Subnet containment queries
+/// thus descend the trie along the prefix of the query and return a single
+/// bitmap, instead of combining a bitmap per bit of the prefix like the
+/// `address_index`. For subnet fields, the index also finds all stored
+/// subnets that contain a value by walking the path of the value.
+class radix_index : public value_index {
+public:
+  /// Constructs a radix index.
+  /// @param t An instance of `address_type` or `subnet_type`.
+  /// @param opts Runtime context for index parameterization.
+  explicit radix_index(vast::type t, caf::settings opts = {});
+
+  caf::error serialize(caf::serializer& sink) const override;
+
+  caf::error deserialize(caf::deserializer& source) override;
+
+  bool deserialize(detail::legacy_deserializer& source) override;
+
+  /// Finds the rows of the longest stored prefix that contains an address.
+  /// @param x The address to match.
+  /// @returns The rows of the most specific stored subnet that contains *x*.
+  [[nodiscard]] ids longest_prefix_match(const address& x) const;
+
+private:
+  /// A prefix of a 128-bit address in network byte order.
+  struct prefix {
+    uint64_t hi;
+    uint64_t lo;
+    uint8_t length;
+  };
+
+  /// A node of the trie. Inner nodes exist only where paths branch or a
+  /// value ends.
+  struct node {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+    uint8_t length = 0;
+    bool terminal = false;
+    std::array<uint32_t, 2> children = {};
+
+    /// The rows of all values with this prefix.
+    ewah_bitmap subtree = {};
+
+    /// The rows of the values that equal this prefix. Empty for leaves, whose
+    /// subtree contains only such values.
+    ewah_bitmap exact = {};
+
+    template <class Inspector>
+    friend auto inspect(Inspector& f, node& x) {
+      return f(x.hi, x.lo, x.length, x.terminal, x.children, x.subtree,
+               x.exact);
+    }
+  };
+
+  bool append_impl(data_view x, id pos) override;
+
+  caf::expected<ids>
+  lookup_impl(relational_operator op, data_view x) const override;
+
+  size_t memusage_impl() const override;
+
+  flatbuffers::Offset<fbs::ValueIndex>
+  pack_impl(flatbuffers::FlatBufferBuilder& builder,
+            flatbuffers::Offset<fbs::value_index::detail::ValueIndexBase>
+              base_offset) override;
+
+  caf::error unpack_impl(const fbs::ValueIndex& from) override;
+
+  /// Adds a row for a prefix.
+  void insert(const prefix& p, id row);
+
+  /// Finds the highest node whose subtree contains exactly the values with a
+  /// given prefix.
+  /// @returns The index of the node, or `std::nullopt` if no value has the
+  ///          prefix.
+  [[nodiscard]] std::optional<uint32_t> find(const prefix& p) const;
+
+  /// @returns The rows of the values that equal a prefix.
+  [[nodiscard]] ids lookup_equal(const prefix& p) const;
+
+  /// @returns The rows of the values that start with a prefix.
+  [[nodiscard]] ids lookup_within(const prefix& p) const;
+
+  /// @returns The rows of the values that are a prefix of a prefix.
+  [[nodiscard]] ids lookup_covering(const prefix& p) const;
+
+  /// Converts a bitmap of rows to a result of the size of the index.
+  [[nodiscard]] ids to_ids(const ewah_bitmap& rows) const;
+
+  /// @returns The rows of the values that equal the prefix of a node.
+  [[nodiscard]] const ewah_bitmap& exact_rows(const node& n) const;
+
+  /// Checks that all child indexes are in bounds and point downwards.
+  [[nodiscard]] bool is_valid() const;
+
+  std::vector<node> nodes_;
+};
+
+} // namespace vast
@@ -0,0 +1,122 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/detail/legacy_deserialize.hpp"
+#include "vast/ids.hpp"
+#include "vast/value_index.hpp"
+#include "vast/view.hpp"
+
+#include <caf/error.hpp>
+#include <caf/expected.hpp>
+#include <caf/fwd.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace vast {
+
+/// An index for arithmetic values of high cardinality.
+///
+/// The `arithmetic_index` maintains a range-coded bitmap per bin and digit,
+/// which is compact for few distinct values but grows large for timestamps,
+/// durations, or 64-bit counters. The sorted index instead stores all (value,
+/// row) pairs sorted by value, split into fixed-size blocks. Every block keeps
+/// its minimum and maximum value and stores its values and rows bit-packed
+/// relative to the minimum, i.e., with frame-of-reference compression. A range
+/// lookup binary-searches the blocks and materializes the matching rows as a
+/// bitmap.
+///
+/// Values appended after the last sealing are buffered and scanned linearly
+/// until the index is packed.
+class sorted_index : public value_index {
+public:
+  /// The number of entries per block.
+  static constexpr size_t block_size = 128;
+
+  /// Checks whether the index supports values of a type.
+  /// @param t The type to check.
+  static bool supports(const vast::type& t);
+
+  /// Constructs a sorted index.
+  /// @param t An integer, count, real, duration, or time type.
+  /// @param opts Runtime context for index parameterization.
+  explicit sorted_index(vast::type t, caf::settings opts = {});
+
+  caf::error serialize(caf::serializer& sink) const override;
+
+  caf::error deserialize(caf::deserializer& source) override;
+
+  bool deserialize(detail::legacy_deserializer& source) override;
+
+private:
+  /// A value in its order-preserving unsigned representation and its row.
+  using entry = std::pair<uint64_t, id>;
+
+  /// The header of a block of entries.
+  struct block {
+    uint64_t min_key;
+    uint64_t max_key;
+    uint64_t min_row;
+    uint64_t offset;
+    uint32_t size;
+    uint8_t key_width;
+    uint8_t row_width;
+  };
+
+  bool append_impl(data_view x, id pos) override;
+
+  caf::expected<ids>
+  lookup_impl(relational_operator op, data_view x) const override;
+
+  size_t memusage_impl() const override;
+
+  flatbuffers::Offset<fbs::ValueIndex>
+  pack_impl(flatbuffers::FlatBufferBuilder& builder,
+            flatbuffers::Offset<fbs::value_index::detail::ValueIndexBase>
+              base_offset) override;
+
+  caf::error unpack_impl(const fbs::ValueIndex& from) override;
+
+  /// Maps a value to its order-preserving unsigned representation.
+  /// @returns The key, or `std::nullopt` if the value cannot be compared with
+  ///          the values of the index.
+  [[nodiscard]] std::optional<uint64_t> key(data_view x) const;
+
+  /// Computes the rows whose keys lie in the closed interval [*lo*, *hi*].
+  [[nodiscard]] ids lookup_range(uint64_t lo, uint64_t hi) const;
+
+  /// Decodes all entries and merges them with the buffered ones.
+  [[nodiscard]] std::vector<entry> entries() const;
+
+  /// Compresses the buffered entries into blocks.
+  void seal();
+
+  /// Encodes a sorted sequence of entries into blocks.
+  static void encode(const std::vector<entry>& xs, std::vector<block>& blocks,
+                     std::vector<uint64_t>& words);
+
+  /// Converts between blocks and their flat representation for the CAF
+  /// serializers.
+  static std::vector<uint64_t> flatten(const std::vector<block>& blocks);
+  static bool unflatten(const std::vector<uint64_t>& xs,
+                        std::vector<block>& blocks);
+
+  /// Checks that blocks are sorted and fit into the given number of words.
+  static bool is_valid(const std::vector<block>& blocks, size_t num_words);
+
+  std::vector<block> blocks_;
+  std::vector<uint64_t> words_;
+  std::vector<entry> buffer_;
+};
+
+} // namespace vast
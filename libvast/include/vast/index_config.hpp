@@ -26,10 +26,13 @@ struct index_config {
     std::vector<std::string> targets = {};
     double fp_rate = defaults::system::fp_rate;
     bool create_partition_index = defaults::system::create_partition_index;
+    std::string value_index = {};
+    bool create_sketches = defaults::system::create_sketches;
 
     template <class Inspector>
     friend auto inspect(Inspector& f, rule& x) {
-      return f(x.targets, x.fp_rate, x.create_partition_index);
+      return f(x.targets, x.fp_rate, x.create_partition_index, x.value_index,
+               x.create_sketches);
     }
 
     static inline const record_type& layout() noexcept {
@@ -37,6 +40,8 @@ struct index_config {
         {"targets", list_type{string_type{}}},
         {"fp-rate", real_type{}},
         {"partition-index", bool_type{}},
+        {"value-index", string_type{}},
+        {"sketches", bool_type{}},
       };
       return result;
     }
@@ -62,4 +67,16 @@ struct index_config {
 bool should_create_partition_index(const qualified_record_field& index_qf,
                                    const std::vector<index_config::rule>& rules);
 
+/// Determines whether to maintain cardinality and frequency sketches for a
+/// field in the partition synopsis. The first rule that matches the field
+/// decides; fields without a matching rule have no sketches.
+bool should_create_sketches(const qualified_record_field& index_qf,
+                            const std::vector<index_config::rule>& rules);
+
+/// Determines the type to create the dense index of a field with. The first
+/// rule that matches the field and selects a value index, e.g., `ngram` or
+/// `hash`, attaches it as `#index` attribute to the field type.
+type make_index_type(const qualified_record_field& index_qf,
+                     const std::vector<index_config::rule>& rules);
+
 } // namespace vast
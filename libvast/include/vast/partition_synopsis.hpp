@@ -9,10 +9,12 @@
 #pragma once
 
 #include "vast/detail/friend_attribute.hpp"
+#include "vast/digest_index.hpp"
 #include "vast/fbs/partition_synopsis.hpp"
 #include "vast/index_config.hpp"
 #include "vast/index_statistics.hpp"
 #include "vast/qualified_record_field.hpp"
+#include "vast/sketch/column_sketch.hpp"
 #include "vast/synopsis.hpp"
 #include "vast/table_slice.hpp"
 #include "vast/uuid.hpp"
@@ -43,8 +45,9 @@ struct partition_synopsis final : public caf::ref_counted {
   void add(const table_slice& slice, size_t partition_capacity,
            const index_config& synopsis_options);
 
-  /// Optimizes the partition synopsis contents for size.
-  /// @related buffered_synopsis
+  /// Optimizes the partition synopsis contents for size. Records the digests
+  /// of buffered synopses before shrinking them.
+  /// @related buffered_synopsis digest_index
   void shrink();
 
   /// Estimate the memory footprint of this partition synopsis.
@@ -77,6 +80,17 @@ struct partition_synopsis final : public caf::ref_counted {
   /// Synopsis data structures for individual columns.
   std::unordered_map<qualified_record_field, synopsis_ptr> field_synopses_;
 
+  /// Cardinality and frequency sketches for the columns whose index rule
+  /// enables them.
+  std::unordered_map<qualified_record_field, sketch::column_sketch>
+    field_sketches_;
+
+  /// The digests of the values that the buffered synopses held before
+  /// `shrink()` replaced them. The catalog copies them into its digest index
+  /// when it receives the partition synopsis, and drops them from its own
+  /// copy of the synopsis. Not persisted.
+  std::shared_ptr<const partition_digests> digests_ = {};
+
   // -- flatbuffer -------------------------------------------------------------
 
   FRIEND_ATTRIBUTE_NODISCARD friend caf::expected<
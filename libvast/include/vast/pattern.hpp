@@ -10,6 +10,10 @@
 
 #include "vast/detail/operators.hpp"
 
+#include <caf/error.hpp>
+#include <caf/meta/load_callback.hpp>
+
+#include <memory>
 #include <string>
 
 namespace vast {
@@ -17,7 +21,9 @@ namespace vast {
 struct access;
 class data;
 
-/// A regular expression.
+/// A regular expression. Patterns compile their expression once on
+/// construction, and match in linear time unless the expression requires
+/// features of `std::regex` that cannot be expressed as a finite automaton.
 class pattern : detail::totally_ordered<pattern>,
                 detail::addable<pattern>,
                 detail::orable<pattern>,
@@ -83,13 +89,29 @@ public:
 
   template <class Inspector>
   friend auto inspect(Inspector& f, pattern& p) {
-    return f(p.str_);
+    if constexpr (Inspector::reads_state) {
+      return f(p.str_);
+    } else {
+      auto load = [&]() -> caf::error {
+        p.compile();
+        return {};
+      };
+      return f(p.str_, caf::meta::load_callback(load));
+    }
   }
 
   friend bool convert(const pattern& p, data& d);
 
 private:
+  struct compiled;
+
+  /// Compiles the expression after modifications.
+  void compile();
+
   std::string str_;
+
+  /// The compiled expression, or nullptr if the expression is invalid.
+  std::shared_ptr<const compiled> compiled_;
 };
 
 } // namespace vast
@@ -8,11 +8,17 @@
 
 #pragma once
 
+#include "vast/data.hpp"
+#include "vast/detail/worker_pool.hpp"
 #include "vast/ids.hpp"
 #include "vast/pipeline_operator.hpp"
 #include "vast/type.hpp"
 
+#include <memory>
+#include <optional>
 #include <queue>
+#include <string>
+#include <utility>
 
 namespace vast {
 
@@ -30,9 +36,32 @@ public:
 
   void add_operator(std::unique_ptr<pipeline_operator> op);
 
+  /// Creates a pipeline operator from its configuration and adds it. Unlike
+  /// operators that were added directly, such operators may run next to the
+  /// data as part of a partial aggregation.
+  /// @param name The name of the pipeline operator plugin.
+  /// @param options The settings configured for the operator.
+  [[nodiscard]] caf::error
+  add_operator(const std::string& name, const record& options);
+
   /// Returns true if any of the pipeline operators is aggregate.
   [[nodiscard]] bool is_aggregate() const;
 
+  /// Returns true if all aggregate pipeline operators are incremental.
+  [[nodiscard]] bool is_incremental() const;
+
+  /// Requests that the next call to finish returns all results of incremental
+  /// pipeline operators.
+  void flush();
+
+  /// Returns the metrics of all pipeline operators.
+  [[nodiscard]] std::vector<system::data_point> metrics() const;
+
+  /// Returns the partial aggregation that the stores can apply to events
+  /// before shipping them, if the pipeline starts with an aggregate operator
+  /// that supports it. The pipeline itself then merges the partial results.
+  [[nodiscard]] std::optional<partial_aggregation> pushdown() const;
+
   /// Tests whether the transform applies to events of the given type.
   [[nodiscard]] bool applies_to(std::string_view event_name) const;
 
@@ -50,6 +79,11 @@ private:
   // An empty vector means that the transform should apply to everything.
   [[nodiscard]] const std::vector<std::string>& schema_names() const;
 
+  /// Creates a pipeline with new instances of the same pipeline operators.
+  /// @returns An error if an operator was added directly instead of from its
+  /// configuration.
+  [[nodiscard]] caf::expected<pipeline> replicate() const;
+
   /// Add the batch to the internal queue of batches to be transformed.
   [[nodiscard]] caf::error
   add_batch(vast::type layout, std::shared_ptr<arrow::RecordBatch> batch);
@@ -63,6 +97,13 @@ private:
   process_queue(const std::unique_ptr<pipeline_operator>& op,
                 std::vector<pipeline_batch>& result, bool check_layout);
 
+  /// Applies a chain of stateless pipeline operators to every batch in the
+  /// queue in a single pass, filtering the rows of every batch at most once.
+  caf::error process_fused(
+    std::vector<std::unique_ptr<pipeline_operator>>::const_iterator first,
+    std::vector<std::unique_ptr<pipeline_operator>>::const_iterator last,
+    std::vector<pipeline_batch>& result, bool check_layout);
+
   /// Grant access to the pipelines engine so it can call
   /// add_batch/finsih_batch.
   friend class pipeline_executor;
@@ -73,6 +114,10 @@ private:
   /// Sequence of pipelines steps
   std::vector<std::unique_ptr<pipeline_operator>> operators_;
 
+  /// The plugin names and options of the pipeline operators, or an empty name
+  /// for operators that were added directly.
+  std::vector<std::pair<std::string, record>> definitions_;
+
   /// Triggers for this transform
   std::vector<std::string> schema_names_;
 
@@ -87,8 +132,9 @@ class pipeline_executor {
 public:
   /// Controls the validation of the pipelines Engine.
   enum class allow_aggregate_pipelines {
-    yes, /// Allows the usage of aggregate pipeline operators.
-    no,  /// Forbids using aggregate pipeline operators.
+    yes,         /// Allows the usage of aggregate pipeline operators.
+    no,          /// Forbids using aggregate pipeline operators.
+    incremental, /// Allows only incremental aggregate pipeline operators.
   };
 
   // member functions
@@ -101,6 +147,32 @@ public:
   /// aggregates are not allowed.
   caf::error validate(enum allow_aggregate_pipelines);
 
+  /// Returns true if any of the pipelines is an aggregate.
+  [[nodiscard]] bool is_aggregate() const;
+
+  /// Allows finish to apply the pipelines on a pool of threads that lives as
+  /// long as the executor. The executor then applies the pipelines of every
+  /// layout independently, and splits the batches of a layout among multiple
+  /// instances of pipelines without aggregate operators while preserving their
+  /// order. Aggregate operators thus see the events of every layout in a
+  /// separate instance.
+  /// @param num_workers The maximum number of threads, including the calling
+  /// thread.
+  /// @returns An error if a pipeline operator was added directly instead of
+  /// from its configuration, as it cannot be instantiated once per thread.
+  caf::error parallelize(size_t num_workers);
+
+  /// Requests that the next call to finish returns all results of incremental
+  /// pipeline operators.
+  void flush();
+
+  /// Returns the metrics of all pipeline operators.
+  [[nodiscard]] std::vector<system::data_point> metrics() const;
+
+  /// Returns the partial aggregation that the stores can apply to events
+  /// before shipping them. This is only supported for a single pipeline.
+  [[nodiscard]] std::optional<partial_aggregation> pushdown() const;
+
   /// Starts applying relevant pipelines to the table.
   caf::error add(table_slice&&);
 
@@ -115,6 +187,17 @@ private:
   static caf::error
   process_queue(pipeline& transform, std::deque<pipeline_batch>& queue);
 
+  /// Applies the pipelines with the given indices to the batches of a layout,
+  /// using the instance per worker of each pipeline in *instances*.
+  caf::error process_layout(std::vector<std::vector<pipeline>>& instances,
+                            const std::vector<size_t>& indices,
+                            std::deque<pipeline_batch>& queue);
+
+  /// Applies the pipelines to the batches of multiple layouts in parallel.
+  caf::error process_parallel(
+    const std::vector<std::pair<vast::type, std::vector<size_t>>>& work,
+    std::unordered_map<vast::type, std::deque<pipeline_batch>>& batches);
+
   /// Apply relevant pipelines to the table slice.
   caf::expected<table_slice> transform_slice(table_slice&& x);
 
@@ -129,6 +212,18 @@ private:
 
   /// The slices being transformed.
   std::unordered_map<vast::type, std::deque<table_slice>> to_transform_;
+
+  /// Whether the next call to finish flushes the aggregate pipelines.
+  bool flush_ = false;
+
+  /// The threads that finish uses, if it applies the pipelines in parallel.
+  std::unique_ptr<detail::worker_pool> workers_ = {};
+
+  /// The pipeline instances for parallel execution. Every layout has a list of
+  /// instances per pipeline, with one instance for aggregate pipelines and up
+  /// to one instance per worker otherwise.
+  std::unordered_map<vast::type, std::vector<std::vector<pipeline>>>
+    replicas_;
 };
 
 } // namespace vast
@@ -8,12 +8,17 @@
 
 #pragma once
 
+#include "vast/fwd.hpp"
+
+#include "vast/ids.hpp"
 #include "vast/table_slice.hpp"
 
 #include <arrow/record_batch.h>
 #include <caf/expected.hpp>
 
+#include <optional>
 #include <queue>
+#include <vector>
 
 namespace vast {
 
@@ -25,6 +30,25 @@ struct pipeline_batch {
   std::shared_ptr<arrow::RecordBatch> batch;
 };
 
+/// A batch that passes through a chain of fused stateless pipeline operators.
+/// Operators that filter rows only narrow the selection, and the pipeline
+/// applies the selection once after the last operator of the chain. Operators
+/// that drop the entire batch reset it.
+struct fused_batch {
+  vast::type layout;
+  std::shared_ptr<arrow::RecordBatch> batch;
+
+  /// The rows that the chain selected so far, or an empty bitmap if it
+  /// selected all rows.
+  ids selection = {};
+};
+
+/// Applies the selection of a fused batch to all of its columns at once.
+/// @returns The selected rows, or `std::nullopt` if the batch was dropped or
+/// no rows are selected.
+/// @relates fused_batch
+caf::expected<std::optional<pipeline_batch>> apply_selection(fused_batch x);
+
 /// An individual pipeline operator. This is mainly used in the plugin API,
 /// later code deals with a complete `transform`.
 class pipeline_operator {
@@ -37,6 +61,26 @@ public:
     return false;
   }
 
+  /// Returns true for aggregate pipeline operators that emit results
+  /// incrementally while keeping bounded state, which allows for using them on
+  /// unbounded streams of events.
+  /// @note pipeline operators are not incremental by default.
+  [[nodiscard]] virtual bool is_incremental() const {
+    return false;
+  }
+
+  /// Requests that the next call to finish returns all results, including
+  /// those that incremental operators hold back because they may still change.
+  /// This is used when the input ends.
+  virtual void flush() {
+    // nop
+  }
+
+  /// Returns metrics about the work of the pipeline operator, which get
+  /// reported to the accountant.
+  /// @note The default implementation returns no metrics.
+  [[nodiscard]] virtual std::vector<system::data_point> metrics() const;
+
   /// Starts applyings the transformation to a batch with a corresponding vast
   /// layout.
   [[nodiscard]] virtual caf::error
@@ -47,9 +91,44 @@ public:
   /// TODO: add another function abort() to free up internal resources.
   /// NOTE: If there is nothing to transform return an empty vector.
   [[nodiscard]] virtual caf::expected<std::vector<pipeline_batch>> finish() = 0;
+
+  /// Returns true for pipeline operators that transform every batch
+  /// independently through `apply`. The pipeline fuses consecutive stateless
+  /// operators into a single pass over every batch.
+  /// @note pipeline operators are not stateless by default.
+  [[nodiscard]] virtual bool is_stateless() const {
+    return false;
+  }
+
+  /// Applies a stateless pipeline operator to a single batch.
+  /// @pre `is_stateless()`
+  /// @note The default implementation returns an error.
+  [[nodiscard]] virtual caf::error apply(fused_batch& x);
+};
+
+/// A pipeline operator that transforms every batch independently of all
+/// other batches, and implements `add` and `finish` in terms of `apply`.
+class stateless_pipeline_operator : public pipeline_operator {
+public:
+  [[nodiscard]] bool is_stateless() const final {
+    return true;
+  }
+
+  [[nodiscard]] caf::error
+  add(type layout, std::shared_ptr<arrow::RecordBatch> batch) final;
+
+  [[nodiscard]] caf::expected<std::vector<pipeline_batch>> finish() final;
+
+private:
+  /// The transformed batches.
+  std::vector<pipeline_batch> transformed_ = {};
 };
 
 caf::expected<std::unique_ptr<pipeline_operator>>
 make_pipeline_operator(const std::string& name, const vast::record& options);
 
+caf::expected<std::unique_ptr<pipeline_operator>>
+make_partial_pipeline_operator(const std::string& name,
+                               const vast::record& options);
+
 } // namespace vast
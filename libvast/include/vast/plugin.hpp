@@ -247,6 +247,16 @@ public:
   /// @param options The settings configured for this operator.
   [[nodiscard]] virtual caf::expected<std::unique_ptr<pipeline_operator>>
   make_pipeline_operator(const vast::record& options) const = 0;
+
+  /// Creates the partial phase of an aggregate pipeline operator, which runs
+  /// next to the data and produces partial results that the operator created
+  /// by `make_pipeline_operator` merges. This allows for pushing aggregations
+  /// down into the stores.
+  /// @param options The settings configured for this operator.
+  /// @note The default implementation returns an error, i.e., pipeline
+  /// operators do not support partial aggregation by default.
+  [[nodiscard]] virtual caf::expected<std::unique_ptr<pipeline_operator>>
+  make_partial_pipeline_operator(const vast::record& options) const;
 };
 
 // -- aggregation function plugin ---------------------------------------------
@@ -16,6 +16,11 @@
 
 #include <caf/typed_actor_view.hpp>
 
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <vector>
+
 namespace vast {
 
 /// A count query to collect the number of hits for the expression.
@@ -35,18 +40,54 @@ struct count_query_context {
   }
 };
 
+/// An aggregate pipeline operator whose partial phase runs next to the data.
+struct partial_aggregation {
+  /// The name of the pipeline operator plugin.
+  std::string name;
+
+  /// The configured options of the pipeline operator.
+  record options;
+
+  /// The schemas the operator applies to, or all schemas if empty.
+  std::vector<std::string> schema_names;
+
+  /// Tests whether the operator applies to events of the given schema.
+  [[nodiscard]] bool applies_to(std::string_view schema_name) const {
+    return schema_names.empty()
+           || std::find(schema_names.begin(), schema_names.end(), schema_name)
+                != schema_names.end();
+  }
+
+  friend bool
+  operator==(const partial_aggregation& lhs, const partial_aggregation& rhs) {
+    return lhs.name == rhs.name && lhs.options == rhs.options
+           && lhs.schema_names == rhs.schema_names;
+  }
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, partial_aggregation& x) {
+    return f(caf::meta::type_name("vast.query.partial_aggregation"), x.name,
+             x.options, x.schema_names);
+  }
+};
+
 /// An extract query to retrieve the events that match the expression.
 struct extract_query_context {
   system::receiver_actor<table_slice> sink;
 
+  /// The aggregation to apply to the events before shipping them, if any. The
+  /// sink then receives partial results instead of events.
+  std::optional<partial_aggregation> aggregation = {};
+
   friend bool operator==(const extract_query_context& lhs,
                          const extract_query_context& rhs) {
-    return lhs.sink == rhs.sink;
+    return lhs.sink == rhs.sink && lhs.aggregation == rhs.aggregation;
   }
 
   template <class Inspector>
   friend auto inspect(Inspector& f, extract_query_context& x) {
-    return f(caf::meta::type_name("vast.query.extract"), x.sink);
+    return f(caf::meta::type_name("vast.query.extract"), x.sink,
+             x.aggregation);
   }
 };
 
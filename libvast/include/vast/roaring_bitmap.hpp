@@ -0,0 +1,214 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/bitmap_base.hpp"
+#include "vast/detail/operators.hpp"
+#include "vast/word.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace vast {
+
+class roaring_bitmap_range;
+
+/// A bitmap that partitions its bits into chunks of 2^16 bits and stores
+/// every chunk that contains a 1-bit in the container that suits its density
+/// best, after the *Roaring* bitmap by Chambi et al. A sparse chunk is an
+/// *array* of the positions of its 1-bits, a dense chunk a *bitset*, and a
+/// chunk with few homogeneous runs a sequence of *runs*.
+///
+/// Unlike the run-length encoded bitmaps, a roaring bitmap supports *rank*,
+/// *select*, and bitwise operations with costs that scale with the number of
+/// chunks instead of the number of runs, which pays off for sets of medium
+/// density. Long homogeneous runs cost one container per chunk, though.
+///
+/// The implementation maintains the invariant that there exist no empty
+/// containers, and that the containers are sorted by their key.
+class roaring_bitmap : public bitmap_base<roaring_bitmap>,
+                       detail::equality_comparable<roaring_bitmap> {
+  friend roaring_bitmap_range;
+
+public:
+  /// The number of bits per container.
+  static constexpr size_type container_bits = size_type{1} << 16;
+
+  /// The maximum number of 1-bits in an array container.
+  static constexpr size_t max_array_size = 4096;
+
+  /// The number of blocks of a bitset container.
+  static constexpr size_t bitset_blocks = container_bits / word_type::width;
+
+  /// The bits of a single chunk.
+  struct container {
+    enum class kind : uint8_t {
+      array,  ///< The sorted positions of the 1-bits.
+      bitset, ///< The uncompressed blocks.
+      run,    ///< The first and last positions of the runs of 1-bits.
+    };
+
+    /// The index of the chunk.
+    uint64_t key = 0;
+
+    /// The representation of the chunk.
+    kind type = kind::array;
+
+    /// The positions for array and run containers.
+    std::vector<uint16_t> values = {};
+
+    /// The blocks for bitset containers.
+    std::vector<block_type> blocks = {};
+
+    template <class Inspector>
+    friend auto inspect(Inspector& f, container& x) {
+      return f(x.key, x.type, x.values, x.blocks);
+    }
+  };
+
+  roaring_bitmap() = default;
+
+  explicit roaring_bitmap(size_type n, bool bit = false);
+
+  // -- inspectors -----------------------------------------------------------
+
+  [[nodiscard]] bool empty() const;
+
+  [[nodiscard]] size_type size() const;
+
+  [[nodiscard]] size_t memusage() const;
+
+  [[nodiscard]] const std::vector<container>& containers() const;
+
+  // -- modifiers ------------------------------------------------------------
+
+  void append_bit(bool bit);
+
+  void append_bits(bool bit, size_type n);
+
+  void append_block(block_type bits, size_type n = word_type::width);
+
+  void flip();
+
+  // -- bitwise operations ---------------------------------------------------
+
+  friend roaring_bitmap
+  operator&(const roaring_bitmap& x, const roaring_bitmap& y);
+
+  friend roaring_bitmap
+  operator|(const roaring_bitmap& x, const roaring_bitmap& y);
+
+  friend roaring_bitmap
+  operator^(const roaring_bitmap& x, const roaring_bitmap& y);
+
+  friend roaring_bitmap
+  operator-(const roaring_bitmap& x, const roaring_bitmap& y);
+
+  roaring_bitmap& operator&=(const roaring_bitmap& other);
+
+  roaring_bitmap& operator|=(const roaring_bitmap& other);
+
+  roaring_bitmap& operator^=(const roaring_bitmap& other);
+
+  roaring_bitmap& operator-=(const roaring_bitmap& other);
+
+  // -- concepts -------------------------------------------------------------
+
+  friend bool operator==(const roaring_bitmap& x, const roaring_bitmap& y);
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, roaring_bitmap& bm) {
+    return f(bm.containers_, bm.num_bits_);
+  }
+
+  friend auto
+  pack(flatbuffers::FlatBufferBuilder& builder, const roaring_bitmap& from)
+    -> flatbuffers::Offset<fbs::bitmap::RoaringBitmap>;
+
+  friend auto unpack(const fbs::bitmap::RoaringBitmap& from, roaring_bitmap& to)
+    -> caf::error;
+
+  /// Counts the 1-bits in *[0,i]*.
+  /// @pre `i < size()`
+  [[nodiscard]] size_type rank1(size_type i) const;
+
+  /// Locates the *i*-th 1-bit, or the last 1-bit if `i == word_type::npos`.
+  /// @returns The position of the 1-bit or `word_type::npos`.
+  /// @pre `i > 0`
+  [[nodiscard]] size_type select1(size_type i) const;
+
+private:
+  /// Combines the containers of two bitmaps chunk by chunk.
+  /// @param keep_x Whether to keep the containers that only *x* has.
+  /// @param keep_y Whether to keep the containers that only *y* has.
+  /// @param op The operation to combine containers with equal keys.
+  template <class Operation>
+  static roaring_bitmap merge(const roaring_bitmap& x, const roaring_bitmap& y,
+                              bool keep_x, bool keep_y, Operation op);
+
+  /// Retrieves the container that appending bit *i* modifies.
+  container& container_for_append(size_type i);
+
+  /// Retrieves the block of 64 bits at a position that is a multiple of 64.
+  [[nodiscard]] block_type block_at(size_type i, size_t& hint) const;
+
+  /// Locates the first position starting at a multiple of 64 whose value is
+  /// not *bit*, or `size()` if no such position exists.
+  [[nodiscard]] size_type
+  homogeneous_end(size_type i, bool bit, size_t hint) const;
+
+  std::vector<container> containers_;
+  size_type num_bits_ = 0;
+};
+
+/// Counts the 1-bits or 0-bits in *[0,i]* of a roaring bitmap in time linear
+/// in the number of containers.
+/// @relates roaring_bitmap
+template <bool Bit = true>
+roaring_bitmap::size_type
+rank(const roaring_bitmap& bm, roaring_bitmap::size_type i) {
+  VAST_ASSERT(i < bm.size());
+  auto result = bm.rank1(i);
+  return Bit ? result : i + 1 - result;
+}
+
+/// Locates the *i*-th 1-bit of a roaring bitmap in time linear in the number
+/// of containers.
+/// @relates roaring_bitmap
+template <bool Bit = true>
+  requires(Bit)
+roaring_bitmap::size_type
+select(const roaring_bitmap& bm, roaring_bitmap::size_type i) {
+  VAST_ASSERT(i > 0);
+  return bm.select1(i);
+}
+
+class roaring_bitmap_range
+  : public bit_range_base<roaring_bitmap_range, roaring_bitmap::block_type> {
+public:
+  using word_type = roaring_bitmap::word_type;
+
+  roaring_bitmap_range() = default;
+
+  explicit roaring_bitmap_range(const roaring_bitmap& bm);
+
+  void next();
+  [[nodiscard]] bool done() const;
+
+private:
+  void scan();
+
+  const roaring_bitmap* bm_ = nullptr;
+  roaring_bitmap::size_type pos_ = 0;
+  size_t hint_ = 0;
+};
+
+roaring_bitmap_range bit_range(const roaring_bitmap& bm);
+
+} // namespace vast
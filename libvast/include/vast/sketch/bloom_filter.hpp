@@ -22,6 +22,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 namespace vast::sketch {
@@ -39,6 +40,13 @@ public:
   /// may exist according to the false-positive probability of the filter.
   bool lookup(uint64_t digest) const noexcept;
 
+  /// Test whether any of a sequence of hash digests is in the Bloom filter.
+  /// This is faster than testing the digests one by one, because it overlaps
+  /// the memory accesses of multiple digests.
+  /// @param digests The digests to test.
+  /// @returns `true` if at least one of the *digests* may exist.
+  bool lookup_any(std::span<const uint64_t> digests) const noexcept;
+
   /// Retrieves the parameters of the filter.
   const bloom_filter_params& parameters() const noexcept;
 
@@ -69,6 +77,13 @@ public:
   /// may exist according to the false-positive probability of the filter.
   bool lookup(uint64_t digest) const noexcept;
 
+  /// Test whether any of a sequence of hash digests is in the Bloom filter.
+  /// This is faster than testing the digests one by one, because it overlaps
+  /// the memory accesses of multiple digests.
+  /// @param digests The digests to test.
+  /// @returns `true` if at least one of the *digests* may exist.
+  bool lookup_any(std::span<const uint64_t> digests) const noexcept;
+
   /// Retrieves the parameters of the filter.
   const bloom_filter_params& parameters() const noexcept;
 
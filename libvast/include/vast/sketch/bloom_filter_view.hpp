@@ -17,6 +17,7 @@
 #include <caf/expected.hpp>
 #include <flatbuffers/flatbuffers.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <span>
@@ -70,6 +71,24 @@ struct bloom_filter_view {
     return true;
   }
 
+  /// Checks whether any of a sequence of hash digests exists in the filter.
+  /// Instead of probing one digest after another, this function first
+  /// prefetches the cells of a batch of digests and then tests them, so that
+  /// the cache misses of the batch overlap.
+  bool lookup_any(std::span<const uint64_t> digests) const noexcept {
+    constexpr size_t batch_size = 16;
+    while (!digests.empty()) {
+      auto batch = digests.first(std::min(batch_size, digests.size()));
+      for (auto digest : batch)
+        prefetch(digest);
+      for (auto digest : batch)
+        if (lookup(digest))
+          return true;
+      digests = digests.subspan(batch.size());
+    }
+    return false;
+  }
+
   /// Retrieves the Bloom filter paramers.
   const bloom_filter_params& parameters() const noexcept {
     return params_;
@@ -98,6 +117,15 @@ struct bloom_filter_view {
     return {};
   }
 
+  /// Issues prefetches for the cells of a hash digest.
+  void prefetch(uint64_t digest) const noexcept {
+    for (size_t i = 0; i < params_.k; ++i) {
+      auto [upper, lower] = vast::detail::wide_mul(params_.m, digest);
+      __builtin_prefetch(bits_.data() + (upper >> 6));
+      digest = lower;
+    }
+  }
+
   bloom_filter_params params_;
   std::span<Word> bits_;
 };
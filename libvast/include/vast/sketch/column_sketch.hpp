@@ -0,0 +1,110 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/data.hpp"
+#include "vast/sketch/count_min.hpp"
+#include "vast/sketch/hyperloglog.hpp"
+#include "vast/view.hpp"
+
+#include <caf/error.hpp>
+#include <caf/expected.hpp>
+#include <flatbuffers/flatbuffers.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace vast::sketch {
+
+/// The parameters of a column sketch.
+struct column_sketch_config {
+  /// The precision of the HyperLogLog sketch.
+  uint8_t precision = 10;
+
+  /// The width of the Count-Min sketch.
+  uint64_t width = 511;
+
+  /// The depth of the Count-Min sketch.
+  uint64_t depth = 4;
+
+  /// The number of heavy hitters to track.
+  size_t heavy_hitters = 16;
+};
+
+/// Approximate statistics about the values of a single column: the number of
+/// distinct values, the frequency of every value, and the most frequent
+/// values. The latter are the values with the highest Count-Min estimate that
+/// the sketch has seen so far.
+class column_sketch {
+public:
+  using heavy_hitter = std::pair<data, uint64_t>;
+
+  /// Default-constructs an invalid sketch, e.g., to unpack into.
+  column_sketch() = default;
+
+  /// Constructs a column sketch.
+  /// @param cfg The sketch parameters.
+  /// @returns The sketch iff the parameters are valid.
+  static caf::expected<column_sketch> make(const column_sketch_config& cfg);
+
+  /// Adds a value to the sketch.
+  /// @param x The value to add.
+  void add(data_view x);
+
+  /// Adds all non-null values of an Arrow array to the sketch.
+  /// @param t The type of the values.
+  /// @param array The values to add.
+  void add(const type& t, const arrow::Array& array);
+
+  /// Estimates the number of distinct values.
+  [[nodiscard]] uint64_t distinct() const noexcept;
+
+  /// Estimates the number of occurrences of a value. Never undercounts.
+  /// @param x The value to look for.
+  [[nodiscard]] uint64_t frequency(data_view x) const noexcept;
+
+  /// Retrieves the most frequent values along with their estimated
+  /// frequencies, in descending order of frequency.
+  /// @param k The maximum number of values to return.
+  [[nodiscard]] std::vector<heavy_hitter> top(size_t k) const;
+
+  /// Merges another sketch into this one.
+  /// @param other The sketch to merge.
+  /// @returns An error if the sketches have different parameters.
+  caf::error merge(const column_sketch& other);
+
+  // -- concepts --------------------------------------------------------------
+
+  friend bool
+  operator==(const column_sketch& x, const column_sketch& y) noexcept;
+
+  friend size_t mem_usage(const column_sketch& x) noexcept;
+
+  friend flatbuffers::Offset<fbs::sketch::ColumnSketch>
+  pack(flatbuffers::FlatBufferBuilder& builder, const column_sketch& x);
+
+  friend caf::error
+  unpack(const fbs::sketch::ColumnSketch& table, column_sketch& x);
+
+private:
+  /// Inserts a value into the heavy hitters if it is more frequent than the
+  /// least frequent one.
+  void update_heavy_hitters(data_view x, uint64_t count);
+
+  hyperloglog distinct_;
+  count_min frequencies_;
+  size_t max_heavy_hitters_ = 0;
+  std::vector<heavy_hitter> heavy_hitters_;
+};
+
+} // namespace vast::sketch
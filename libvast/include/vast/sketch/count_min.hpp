@@ -0,0 +1,80 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include <caf/error.hpp>
+#include <caf/expected.hpp>
+#include <flatbuffers/flatbuffers.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vast::sketch {
+
+/// A Count-Min sketch to estimate the frequencies of elements, after Cormode
+/// and Muthukrishnan. The sketch takes as input existing hash digests and
+/// remixes them once per row using worm hashing, like the Bloom filter.
+///
+/// An estimate never undercounts. With width *w* and depth *d*, it overcounts
+/// by more than *e/w* times the total count with a probability of at most
+/// *e^-d*. Two sketches with equal dimensions merge into the sketch of the
+/// union of their inputs.
+class count_min {
+public:
+  /// Default-constructs an invalid sketch, e.g., to unpack into.
+  count_min() = default;
+
+  /// Constructs a Count-Min sketch. An even width is decremented by one,
+  /// because worm hashing requires an odd multiplier.
+  /// @param width The number of counters per row.
+  /// @param depth The number of rows.
+  /// @returns The sketch iff the dimensions are valid.
+  static caf::expected<count_min> make(uint64_t width, uint64_t depth);
+
+  /// Adds occurrences of a hash digest to the sketch.
+  /// @param digest The digest to add.
+  /// @param n The number of occurrences.
+  void add(uint64_t digest, uint32_t n = 1) noexcept;
+
+  /// Estimates the number of occurrences of a hash digest.
+  /// @param digest The digest to look for.
+  [[nodiscard]] uint64_t estimate(uint64_t digest) const noexcept;
+
+  /// Merges another sketch into this one.
+  /// @param other The sketch to merge.
+  /// @returns An error if the sketches have different dimensions.
+  caf::error merge(const count_min& other);
+
+  /// Retrieves the number of counters per row.
+  [[nodiscard]] uint64_t width() const noexcept;
+
+  /// Retrieves the number of rows.
+  [[nodiscard]] uint64_t depth() const noexcept;
+
+  // -- concepts --------------------------------------------------------------
+
+  friend bool operator==(const count_min& x, const count_min& y) noexcept;
+
+  friend size_t mem_usage(const count_min& x) noexcept;
+
+  friend flatbuffers::Offset<fbs::sketch::CountMin>
+  pack(flatbuffers::FlatBufferBuilder& builder, const count_min& x);
+
+  friend caf::error unpack(const fbs::sketch::CountMin& table, count_min& x);
+
+private:
+  uint64_t width_ = 0;
+  uint64_t depth_ = 0;
+  std::vector<uint32_t> counters_;
+};
+
+} // namespace vast::sketch
@@ -0,0 +1,90 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include <caf/error.hpp>
+#include <caf/expected.hpp>
+#include <flatbuffers/flatbuffers.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace vast::sketch {
+
+/// A HyperLogLog sketch to estimate the number of distinct elements, after
+/// Flajolet et al. The sketch takes as input existing hash digests. It splits
+/// every digest into a bucket index from the upper *precision* bits and a
+/// rank from the number of leading zeros of the remaining bits, and keeps the
+/// maximum rank per bucket.
+///
+/// The standard error of the estimate is about *1.04 / sqrt(2^precision)*.
+/// Two sketches with equal precision merge into the sketch of the union of
+/// their inputs.
+class hyperloglog {
+public:
+  /// The minimum supported precision.
+  static constexpr uint8_t min_precision = 4;
+
+  /// The maximum supported precision.
+  static constexpr uint8_t max_precision = 16;
+
+  /// Default-constructs an invalid sketch, e.g., to unpack into.
+  hyperloglog() = default;
+
+  /// Constructs a HyperLogLog sketch.
+  /// @param precision The number of bits that select the bucket.
+  /// @returns The sketch iff the precision is valid.
+  static caf::expected<hyperloglog> make(uint8_t precision);
+
+  /// Constructs a HyperLogLog sketch from existing registers.
+  /// @param registers The registers, one per bucket.
+  /// @returns The sketch iff the number of registers corresponds to a valid
+  ///          precision.
+  static caf::expected<hyperloglog> make(std::span<const uint8_t> registers);
+
+  /// Adds a hash digest to the sketch.
+  /// @param digest The digest to add.
+  void add(uint64_t digest) noexcept;
+
+  /// Estimates the number of distinct digests added so far.
+  [[nodiscard]] double estimate() const noexcept;
+
+  /// Merges another sketch into this one.
+  /// @param other The sketch to merge.
+  /// @returns An error if the sketches have different precisions.
+  caf::error merge(const hyperloglog& other);
+
+  /// Retrieves the precision of the sketch.
+  [[nodiscard]] uint8_t precision() const noexcept;
+
+  /// Retrieves the registers of the sketch, one per bucket.
+  [[nodiscard]] std::span<const uint8_t> registers() const noexcept;
+
+  // -- concepts --------------------------------------------------------------
+
+  friend bool operator==(const hyperloglog& x, const hyperloglog& y) noexcept;
+
+  friend size_t mem_usage(const hyperloglog& x) noexcept;
+
+  friend flatbuffers::Offset<fbs::sketch::HyperLogLog>
+  pack(flatbuffers::FlatBufferBuilder& builder, const hyperloglog& x);
+
+  friend caf::error unpack(const fbs::sketch::HyperLogLog& table,
+                           hyperloglog& x);
+
+private:
+  uint8_t precision_ = 0;
+  std::vector<uint8_t> registers_;
+};
+
+} // namespace vast::sketch
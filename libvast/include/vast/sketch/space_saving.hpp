@@ -0,0 +1,112 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/data.hpp"
+#include "vast/view.hpp"
+
+#include <caf/expected.hpp>
+#include <tsl/robin_map.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vast::sketch {
+
+/// A SpaceSaving sketch to find the most frequent values of a stream, after
+/// Metwally et al. The sketch keeps a fixed number of counters. A value
+/// without a counter takes over the counter with the smallest count, and
+/// inherits its count as the maximum overestimation error.
+///
+/// Every value that occurs more often than *n / capacity* times in a stream of
+/// *n* values is guaranteed to have a counter. Two sketches with equal
+/// capacity merge into a sketch of the union of their inputs, after Cafaro et
+/// al.
+class space_saving {
+public:
+  /// A tracked value along with its estimated count. The true count lies in
+  /// `[count - error, count]`.
+  struct counter {
+    data value;
+    uint64_t count;
+    uint64_t error;
+
+    friend bool operator==(const counter&, const counter&) = default;
+  };
+
+  /// Constructs a SpaceSaving sketch.
+  /// @param capacity The number of counters.
+  /// @returns The sketch iff the capacity is positive.
+  static caf::expected<space_saving> make(size_t capacity);
+
+  /// Constructs a SpaceSaving sketch from existing counters.
+  /// @param capacity The number of counters.
+  /// @param counters The counters to start with.
+  /// @returns The sketch iff the capacity is positive, and the counters are
+  ///          distinct, fit into the capacity, and have valid errors.
+  static caf::expected<space_saving>
+  make(size_t capacity, std::vector<counter> counters);
+
+  /// Adds a value to the sketch.
+  /// @param x The value to add.
+  /// @param weight The number of occurrences of the value.
+  void add(data_view x, uint64_t weight = 1);
+
+  /// Retrieves the most frequent values in descending order of their count.
+  /// @param k The maximum number of values to return.
+  [[nodiscard]] std::vector<counter> top(size_t k) const;
+
+  /// Merges another sketch into this one.
+  /// @param other The sketch to merge.
+  /// @returns An error if the sketches have different capacities.
+  caf::error merge(const space_saving& other);
+
+  /// Retrieves the number of counters.
+  [[nodiscard]] size_t capacity() const noexcept;
+
+  // -- concepts --------------------------------------------------------------
+
+  friend size_t mem_usage(const space_saving& x) noexcept;
+
+private:
+  /// A counter along with the digest of its value.
+  struct entry {
+    uint64_t digest;
+    struct counter counter;
+  };
+
+  /// The count of the smallest counter that a new value would take over, or
+  /// zero if there are unused counters.
+  [[nodiscard]] uint64_t threshold() const noexcept;
+
+  /// Restores the heap property for an entry whose count grew.
+  void sift_down(size_t i);
+
+  /// Restores the heap property for an entry whose count shrank.
+  void sift_up(size_t i);
+
+  /// Moves an entry to a position in the heap.
+  void place(size_t i, entry x);
+
+  /// Restores the heap property and the positions for all entries.
+  void rebuild();
+
+  size_t capacity_ = 0;
+
+  /// The entries, ordered as a binary min-heap by count.
+  std::vector<entry> heap_ = {};
+
+  /// The position of an entry in the heap by its digest.
+  tsl::robin_map<uint64_t, size_t> positions_ = {};
+};
+
+} // namespace vast::sketch
@@ -0,0 +1,104 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include <caf/expected.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace vast::sketch {
+
+/// A t-digest to estimate quantiles of a distribution of real numbers, after
+/// Dunning and Ertl. The sketch summarizes its input as clusters of nearby
+/// values, called centroids, whose size is bounded by a scale function that
+/// keeps clusters small near the tails of the distribution. Estimates are
+/// thus most accurate for extreme quantiles.
+///
+/// The sketch buffers added values and merges them into the centroids in
+/// bulk. The number of centroids is roughly bounded by the *compression*. Two
+/// sketches merge into the sketch of the union of their inputs.
+class tdigest {
+public:
+  /// A cluster of values.
+  struct centroid {
+    double mean;
+    double weight;
+
+    friend bool operator==(const centroid&, const centroid&) = default;
+  };
+
+  /// The default compression.
+  static constexpr double default_compression = 100.0;
+
+  /// Constructs an empty t-digest.
+  /// @param compression The bound on the number of centroids.
+  /// @pre `compression > 0`
+  explicit tdigest(double compression = default_compression) noexcept;
+
+  /// Constructs a t-digest from existing centroids.
+  /// @param compression The bound on the number of centroids.
+  /// @param centroids The centroids in ascending order of their means.
+  /// @param min The smallest value of the input.
+  /// @param max The largest value of the input.
+  /// @returns The sketch iff the centroids are sorted, have positive weights,
+  ///          and lie within *min* and *max*.
+  static caf::expected<tdigest>
+  make(double compression, std::vector<centroid> centroids, double min,
+       double max);
+
+  /// Adds a value to the sketch.
+  /// @param x The value to add.
+  /// @param weight The weight of the value.
+  /// @pre *x* is not NaN and `weight > 0`.
+  void add(double x, double weight = 1.0);
+
+  /// Merges another sketch into this one.
+  /// @param other The sketch to merge.
+  void merge(const tdigest& other);
+
+  /// Merges all buffered values into the centroids.
+  void compress();
+
+  /// Estimates a quantile of the values added so far.
+  /// @param q The quantile in [0, 1].
+  /// @returns The estimate, or `std::nullopt` if the sketch is empty.
+  /// @note Compresses the sketch first.
+  [[nodiscard]] std::optional<double> quantile(double q);
+
+  /// Retrieves the centroids in ascending order of their means.
+  /// @pre The sketch has no buffered values, i.e., was compressed.
+  [[nodiscard]] const std::vector<centroid>& centroids() const noexcept;
+
+  /// Retrieves the total weight of all values added so far.
+  [[nodiscard]] double weight() const noexcept;
+
+  /// Retrieves the smallest value added so far.
+  [[nodiscard]] double min() const noexcept;
+
+  /// Retrieves the largest value added so far.
+  [[nodiscard]] double max() const noexcept;
+
+  // -- concepts --------------------------------------------------------------
+
+  friend size_t mem_usage(const tdigest& x) noexcept;
+
+private:
+  double compression_ = default_compression;
+  double weight_ = 0.0;
+  double min_ = 0.0;
+  double max_ = 0.0;
+  std::vector<centroid> centroids_ = {};
+  std::vector<centroid> buffer_ = {};
+};
+
+} // namespace vast::sketch
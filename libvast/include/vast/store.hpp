@@ -11,6 +11,7 @@
 #include "vast/fwd.hpp"
 
 #include "vast/detail/generator.hpp"
+#include "vast/pipeline_operator.hpp"
 #include "vast/system/actors.hpp"
 #include "vast/table_slice.hpp"
 #include "vast/uuid.hpp"
@@ -94,7 +95,11 @@ struct base_query_state {
 struct count_query_state : public base_query_state<uint64_t> {};
 
 /// Keeps track of all relevant state for an in-progress extract query.
-struct extract_query_state : public base_query_state<table_slice> {};
+struct extract_query_state : public base_query_state<table_slice> {
+  /// The partial aggregation to feed the results into instead of shipping
+  /// them directly, if any.
+  std::unique_ptr<pipeline_operator> aggregation = {};
+};
 
 /// The state of the default passive store actor implementation.
 struct default_passive_store_state {
@@ -19,8 +19,10 @@
 
 #include <caf/fwd.hpp>
 
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <vector>
 
 namespace vast {
 
@@ -65,6 +67,15 @@ public:
   /// This currently only makes sense for the `buffered_address_synopsis`.
   [[nodiscard]] virtual synopsis_ptr shrink() const;
 
+  /// Appends the digests of all values in this synopsis to *result*. This
+  /// requires a synopsis that retains its input, such as a buffered synopsis.
+  /// @param scope The scope of the synopsis within its partition.
+  /// @param result The vector to append the digests to.
+  /// @returns `false` if the synopsis does not retain its input.
+  /// @relates digest_index
+  virtual bool
+  append_digests(uint64_t scope, std::vector<uint64_t>& result) const;
+
   /// Tests whether two objects are equal.
   [[nodiscard]] virtual bool equals(const synopsis& other) const noexcept = 0;
 
@@ -471,7 +471,9 @@ using transformer_actor = typed_actor_fwd<
     caf::outbound_stream_slot<table_slice>>,
   // Send transformed slices to this sink; pass the string through along with
   // the stream handshake.
-  caf::reacts_to<stream_sink_actor<table_slice, std::string>, std::string>>
+  caf::reacts_to<stream_sink_actor<table_slice, std::string>, std::string>,
+  // INTERNAL: Apply the pipelines to the collected table slices.
+  caf::reacts_to<atom::internal, atom::flush>>
   // Conform to the protocol of the STREAM SINK actor for framed table slices
   ::extend_with<stream_sink_actor<detail::framed<table_slice>>>
   // Conform to the protocol of the STATUS CLIENT actor.
@@ -0,0 +1,133 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/system/report.hpp"
+#include "vast/time.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace vast::system {
+
+/// Adapts the size of the table slices and the batch timeout of a SOURCE to
+/// the observed input rate, the backlog of its outbound stream, and an
+/// end-to-end latency target.
+///
+/// The controller aims for table slices that fill up within the latency
+/// target at the current input rate, bounded by the configured batch size.
+/// When the downstream stream buffers table slices because it lacks credit,
+/// the controller doubles the table slice size to reduce the per-slice
+/// overhead in the IMPORTER and the INDEX.
+class batching_controller {
+public:
+  // -- member types -----------------------------------------------------------
+
+  /// Configures the controller.
+  struct options {
+    /// The upper bound for the size of a table slice.
+    size_t max_table_slice_size = 0;
+
+    /// The lower bound for the size of a table slice.
+    size_t min_table_slice_size = 1'024;
+
+    /// The maximum time until an event leaves the source. A value of zero
+    /// disables the adaptation.
+    duration latency_target = {};
+  };
+
+  /// A histogram with fixed bucket boundaries.
+  template <size_t Buckets>
+  struct histogram {
+    /// Adds a single observation.
+    void add(double x, std::span<const double, Buckets> bounds) {
+      auto i = size_t{0};
+      while (i < Buckets && x > bounds[i])
+        ++i;
+      ++counts[i];
+    }
+
+    /// The number of observations per bucket, where the last bucket contains
+    /// all observations above the largest boundary.
+    std::array<uint64_t, Buckets + 1> counts = {};
+  };
+
+  /// The upper bucket boundaries for the time between two consecutive table
+  /// slices in milliseconds.
+  static constexpr auto interval_buckets = std::array<double, 12>{
+    1, 2, 5, 10, 20, 50, 100, 200, 500, 1'000, 2'000, 5'000,
+  };
+
+  /// The upper bucket boundaries for input rates in events per second.
+  static constexpr auto rate_buckets = std::array<double, 7>{
+    1, 10, 100, 1'000, 10'000, 100'000, 1'000'000,
+  };
+
+  // -- constructors -----------------------------------------------------------
+
+  batching_controller() = default;
+
+  explicit batching_controller(options opts);
+
+  // -- properties -------------------------------------------------------------
+
+  /// @returns Whether the controller adapts the batching.
+  [[nodiscard]] bool enabled() const noexcept;
+
+  /// @returns The current upper bound for the size of a table slice.
+  [[nodiscard]] size_t table_slice_size() const noexcept;
+
+  /// @returns The timeout after which readers should flush partial table
+  /// slices.
+  [[nodiscard]] duration batch_timeout() const noexcept;
+
+  /// @returns The smoothed input rate in events per second.
+  [[nodiscard]] double rate() const noexcept;
+
+  // -- observers --------------------------------------------------------------
+
+  /// Records a table slice leaving the source.
+  /// @param rows The number of events in the table slice.
+  /// @param now The current time.
+  void observe_slice(size_t rows, time now);
+
+  /// Recomputes the table slice size before a read iteration.
+  /// @param buffered The number of table slices buffered in the outbound
+  /// stream due to missing credit.
+  /// @param now The current time.
+  void adapt(size_t buffered, time now);
+
+  // -- reporting --------------------------------------------------------------
+
+  /// Creates a report of the current batching parameters and the histograms
+  /// of observations since the last report, and resets the histograms.
+  /// @param name The name of the source to prefix all keys with.
+  report make_report(std::string_view name);
+
+private:
+  /// The minimum length of the window for estimating the input rate.
+  static constexpr auto rate_window = std::chrono::milliseconds{100};
+
+  /// The weight of the most recent window for smoothing the input rate.
+  static constexpr auto rate_weight = 0.5;
+
+  options options_ = {};
+  size_t table_slice_size_ = 0;
+  double rate_ = 0.0;
+  size_t window_events_ = 0;
+  time window_start_ = {};
+  time last_slice_ = {};
+  histogram<interval_buckets.size()> intervals_ = {};
+  histogram<rate_buckets.size()> rates_ = {};
+};
+
+} // namespace vast::system
@@ -12,10 +12,12 @@
 
 #include "vast/detail/flat_map.hpp"
 #include "vast/detail/range_map.hpp"
+#include "vast/digest_index.hpp"
 #include "vast/fbs/index.hpp"
 #include "vast/fbs/partition.hpp"
 #include "vast/ids.hpp"
 #include "vast/partition_synopsis.hpp"
+#include "vast/sketch/column_sketch.hpp"
 #include "vast/synopsis.hpp"
 #include "vast/system/actors.hpp"
 #include "vast/time_synopsis.hpp"
@@ -26,6 +28,7 @@
 
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace vast::system {
@@ -66,6 +69,17 @@ public:
   [[nodiscard]] std::vector<partition_info>
   lookup_impl(const expression& expr) const;
 
+  /// Merges the cardinality and frequency sketches of a field across all
+  /// partitions, which answers approximate distinct counts, value
+  /// frequencies, and top-k queries without touching the partitions. The
+  /// detailed status of the catalog reports the merged sketches. Query
+  /// evaluation does not use them yet.
+  /// @param field The fully qualified name or the name of the field.
+  /// @returns The merged sketch, or an error if no partition has a sketch for
+  ///          the field.
+  [[nodiscard]] caf::expected<sketch::column_sketch>
+  merge_sketches(std::string_view field) const;
+
   /// @returns A best-effort estimate of the amount of memory used for this
   /// catalog (in bytes).
   [[nodiscard]] size_t memusage() const;
@@ -87,6 +101,12 @@ public:
   // See also ae9dbed.
   detail::flat_map<uuid, partition_synopsis_ptr> synopses = {};
 
+  /// Maps the digests of buffered values to the partitions that contain them,
+  /// so that equality and membership queries need not probe the synopses of
+  /// every partition. The index holds a bounded number of digests and covers
+  /// the most recently merged partitions.
+  digest_index digests = {};
+
   /// The set of fields that should not be touched by the pruner.
   detail::heterogeneous_string_hashset unprunable_fields;
 };
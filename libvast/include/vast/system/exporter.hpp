@@ -65,6 +65,11 @@ struct exporter_state {
   /// Stores the time point for when this actor got started via 'run'.
   std::chrono::system_clock::time_point start = {};
 
+  /// Stores how many more events the client requests from the output of
+  /// aggregate pipelines. Aggregate pipelines consume all results, so the
+  /// requested number of events applies to their output instead.
+  uint64_t requested_aggregates = 0;
+
   /// Stores various meta information about the progress we made on the query.
   struct query_status query_status = {};
 
@@ -13,6 +13,7 @@
 #include "vast/detail/lru_cache.hpp"
 #include "vast/detail/stable_set.hpp"
 #include "vast/fbs/index.hpp"
+#include "vast/hash/hash.hpp"
 #include "vast/index_statistics.hpp"
 #include "vast/plugin.hpp"
 #include "vast/query_context.hpp"
@@ -22,6 +23,7 @@
 #include "vast/system/catalog.hpp"
 #include "vast/system/importer.hpp"
 #include "vast/system/query_cursor.hpp"
+#include "vast/type.hpp"
 #include "vast/uuid.hpp"
 
 #include <caf/actor.hpp>
@@ -50,10 +52,37 @@ enum class send_initial_dbstate : bool {
   no = false,
 };
 
+/// Identifies an active partition in the stream stage of the index. The index
+/// spreads table slices of the same schema across a fixed number of active
+/// partitions, which allows for building them in parallel.
+struct active_partition_key {
+  /// The schema of all events in the partition.
+  type schema = {};
+
+  /// The shard of the schema that the partition belongs to.
+  size_t shard = 0;
+
+  /// The number of shards per schema.
+  size_t num_shards = 1;
+
+  friend bool operator==(const active_partition_key& lhs,
+                         const active_partition_key& rhs) noexcept
+    = default;
+};
+
+/// Selects the shard for a table slice. Table slices carry no routing
+/// information, so the shard derives from their import time, which is unique
+/// enough to spread the slices evenly.
+/// @param slice The table slice to route.
+/// @param num_shards The number of shards per schema.
+/// @returns The shard in `[0, num_shards)`.
+size_t active_partition_shard(const table_slice& slice, size_t num_shards);
+
 /// Helper class used to route table slice columns to the correct indexer
 /// in the CAF stream stage.
 struct i_partition_selector {
-  bool operator()(const type& filter, const table_slice& slice) const;
+  bool operator()(const active_partition_key& filter,
+                  const table_slice& slice) const;
 };
 
 /// Extract a partition synopsis from the partition at `partition_path`
@@ -144,8 +173,9 @@ struct index_state {
   // -- type aliases -----------------------------------------------------------
 
   using index_stream_stage_ptr = caf::stream_stage_ptr<
-    table_slice, caf::broadcast_downstream_manager<table_slice, vast::type,
-                                                   i_partition_selector>>;
+    table_slice,
+    caf::broadcast_downstream_manager<table_slice, active_partition_key,
+                                      i_partition_selector>>;
 
   // -- constructor ------------------------------------------------------------
 
@@ -204,20 +234,21 @@ struct index_state {
   vast::uuid create_query_id();
 
   /// Creates a new active partition.
-  /// @param schema The schema of the new partition. All events routed to the
-  /// partition are assumed to have the exact same schema.
+  /// @param key The schema and shard of the new partition. All events routed
+  /// to the partition are assumed to have the exact same schema.
   /// @returns An iterator to the new active partition.
-  [[nodiscard]] caf::expected<
-    std::unordered_map<type, active_partition_info>::iterator>
-  create_active_partition(const type& schema);
+  [[nodiscard]] caf::expected<std::unordered_map<
+    active_partition_key, active_partition_info>::iterator>
+  create_active_partition(const active_partition_key& key);
 
   /// Decommissions the active partition.
-  /// @param schema The schema of the active partition to decommission.
+  /// @param key The schema and shard of the active partition to decommission.
   /// @param completion The completion handler; called in the actor context of
   /// the index when the partition was decommissioned.
   /// @note This invalidates iterators to the *active_partitions* map.
   void decommission_active_partition(
-    const type& schema, std::function<void(const caf::error&)> completion);
+    const active_partition_key& key,
+    std::function<void(const caf::error&)> completion);
 
   /// Adds a new partition creation listener.
   void
@@ -246,8 +277,9 @@ struct index_state {
   /// The streaming stage.
   index_stream_stage_ptr stage;
 
-  /// One active (read/write) partition per layout.
-  std::unordered_map<type, active_partition_info> active_partitions = {};
+  /// One active (read/write) partition per layout and shard.
+  std::unordered_map<active_partition_key, active_partition_info>
+    active_partitions = {};
 
   /// Partitions that are currently in the process of persisting.
   // TODO: An alternative to keeping an explicit set of unpersisted partitions
@@ -275,6 +307,9 @@ struct index_state {
   /// Timeout after which an active partition is forcibly flushed.
   duration active_partition_timeout = {};
 
+  /// The number of active partitions per schema.
+  size_t active_partition_shards = 1;
+
   /// The maximum size of the partition LRU cache (or the maximum number of
   /// read-only partition loaded to memory).
   size_t max_inmem_partitions = {};
@@ -370,6 +405,8 @@ struct index_state {
 /// @param partition_capacity The maximum number of events per partition.
 /// @param active_partition_timeout Timeout after which an active partition is
 /// forcibly flushed.
+/// @param active_partition_shards The number of active partitions per schema
+/// that get built in parallel.
 /// @param max_inmem_partitions The maximum number of passive partitions loaded
 /// into memory.
 /// @param taste_partitions How many lookup partitions to schedule immediately.
@@ -379,6 +416,7 @@ struct index_state {
 /// @param index_config The meta-index configuration of the false-positives
 /// rates for the types and fields.
 /// @pre `partition_capacity > 0
+/// @pre `active_partition_shards > 0`
 //  TODO: Use a settings struct for the various parameters.
 index_actor::behavior_type
 index(index_actor::stateful_pointer<index_state> self,
@@ -386,8 +424,21 @@ index(index_actor::stateful_pointer<index_state> self,
       archive_actor archive, catalog_actor catalog,
       type_registry_actor type_registry, const std::filesystem::path& dir,
       std::string store_backend, size_t partition_capacity,
-      duration active_partition_timeout, size_t max_inmem_partitions,
-      size_t taste_partitions, size_t max_concurrent_partition_lookups,
+      duration active_partition_timeout, size_t active_partition_shards,
+      size_t max_inmem_partitions, size_t taste_partitions,
+      size_t max_concurrent_partition_lookups,
       const std::filesystem::path& catalog_dir, index_config);
 
 } // namespace vast::system
+
+namespace std {
+
+template <>
+struct hash<vast::system::active_partition_key> {
+  size_t
+  operator()(const vast::system::active_partition_key& key) const noexcept {
+    return vast::hash(std::hash<vast::type>{}(key.schema), key.shard);
+  }
+};
+
+} // namespace std
@@ -0,0 +1,96 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/system/actors.hpp"
+
+#include <caf/broadcast_downstream_manager.hpp>
+#include <caf/stream_source.hpp>
+#include <caf/typed_event_based_actor.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vast::system {
+
+/// The SHM INGEST actor interface.
+using shm_ingest_actor = typed_actor_fwd<
+  // INTERNAL: Accept new connections and read table slices from all clients.
+  caf::reacts_to<atom::internal, atom::read>>
+  // Conform to the protocol of the COMPONENT PLUGIN actor.
+  ::extend_with<component_plugin_actor>::unwrap;
+
+/// The state of the SHM INGEST actor.
+struct shm_ingest_state {
+  /// The interval in which the listener checks for input after it found some,
+  /// or while the stream applies backpressure.
+  static constexpr auto min_poll_interval = std::chrono::milliseconds{1};
+
+  /// The longest interval in which the listener checks for input while idle.
+  static constexpr auto max_poll_interval = std::chrono::milliseconds{200};
+
+  shm_ingest_state() = default;
+  shm_ingest_state(const shm_ingest_state&) = delete;
+  shm_ingest_state& operator=(const shm_ingest_state&) = delete;
+  shm_ingest_state(shm_ingest_state&&) = delete;
+  shm_ingest_state& operator=(shm_ingest_state&&) = delete;
+
+  /// Closes all connections and removes the listening socket.
+  ~shm_ingest_state() noexcept;
+
+  /// Accepts all pending connections.
+  /// @returns The number of accepted connections.
+  size_t accept();
+
+  /// Reads as many table slices from the clients as the stream can take.
+  /// @returns The number of table slices read.
+  size_t read();
+
+  /// Pointer to the owning actor.
+  shm_ingest_actor::pointer self = {};
+
+  /// The filesystem path of the listening socket.
+  std::string path = {};
+
+  /// The listening socket, or -1 if shared-memory ingest is disabled.
+  int listen_fd = -1;
+
+  /// The connected clients.
+  std::vector<int> connections = {};
+
+  /// The stream to the IMPORTER.
+  caf::stream_source_ptr<caf::broadcast_downstream_manager<table_slice>> mgr
+    = {};
+
+  /// The delay until the next check for input. Doubles with every check that
+  /// finds no input, up to `max_poll_interval`.
+  std::chrono::milliseconds poll_interval = min_poll_interval;
+
+  /// The number of received table slices.
+  uint64_t slices = 0;
+
+  /// Name of this actor in log events.
+  static inline const char* name = "shm-ingest";
+};
+
+/// Accepts table slices from import clients on the same host, and forwards
+/// them to the IMPORTER. The counterpart of the SHM SINK actor.
+/// @param self The actor handle.
+/// @param importer The IMPORTER actor.
+/// @param path The filesystem path of the listening socket. The actor stays
+/// idle if the path is empty.
+shm_ingest_actor::behavior_type
+shm_ingest(shm_ingest_actor::stateful_pointer<shm_ingest_state> self,
+           stream_sink_actor<table_slice> importer, std::string path);
+
+} // namespace vast::system
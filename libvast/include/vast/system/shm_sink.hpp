@@ -0,0 +1,69 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/system/actors.hpp"
+
+#include <caf/typed_event_based_actor.hpp>
+
+#include <cstdint>
+#include <string>
+
+namespace vast::system {
+
+/// The interface of the SHM SINK actor, which takes the place of the IMPORTER
+/// for import clients that run on the same host as the node.
+using shm_sink_actor = stream_sink_actor<table_slice, std::string>;
+
+/// The state of the SHM SINK actor.
+struct shm_sink_state {
+  shm_sink_state() = default;
+  shm_sink_state(const shm_sink_state&) = delete;
+  shm_sink_state& operator=(const shm_sink_state&) = delete;
+  shm_sink_state(shm_sink_state&&) = delete;
+  shm_sink_state& operator=(shm_sink_state&&) = delete;
+
+  /// Closes the connection to the node.
+  ~shm_sink_state() noexcept;
+
+  /// The connection to the shared-memory ingest socket of the node.
+  int fd = -1;
+
+  /// The number of forwarded table slices.
+  uint64_t slices = 0;
+
+  /// The number of forwarded bytes.
+  uint64_t bytes = 0;
+
+  /// Name of this actor in log events.
+  static inline const char* name = "shm-sink";
+};
+
+/// Connects to the shared-memory ingest socket of a co-located node.
+/// @param path The filesystem path of the socket, i.e., the value of the
+/// `vast.import.shm-socket` option of the node.
+/// @returns The connected socket or an error.
+caf::expected<int> connect_shm_ingest(const std::string& path);
+
+/// Forwards table slices to a node on the same host without going through
+/// CAF's network layer. Every table slice is copied into a sealed in-memory
+/// file whose descriptor gets passed over a UNIX domain socket; the node maps
+/// the file and adopts the mapping as the chunk of the table slice. The actor
+/// terminates after the node acknowledged all table slices of the stream.
+/// @note The actor blocks while the node applies backpressure and until the
+/// node acknowledges the stream, so it must run in a detached thread.
+/// @param self The actor handle.
+/// @param fd The socket returned by `connect_shm_ingest`; the actor takes
+/// ownership.
+shm_sink_actor::behavior_type
+shm_sink(shm_sink_actor::stateful_pointer<shm_sink_state> self, int fd);
+
+} // namespace vast::system
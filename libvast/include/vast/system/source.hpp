@@ -16,6 +16,7 @@
 #include "vast/module.hpp"
 #include "vast/pipeline.hpp"
 #include "vast/system/actors.hpp"
+#include "vast/system/batching_controller.hpp"
 #include "vast/system/instrumentation.hpp"
 #include "vast/system/report.hpp"
 #include "vast/system/status.hpp"
@@ -24,6 +25,7 @@
 #include <caf/stream_source.hpp>
 #include <caf/typed_event_based_actor.hpp>
 
+#include <functional>
 #include <optional>
 #include <unordered_map>
 
@@ -83,12 +85,20 @@ struct source_state {
   /// The maximum size for a table slice.
   size_t table_slice_size = {};
 
+  /// Adapts the table slice size and batch timeout to the input rate and the
+  /// downstream backlog.
+  batching_controller batching = {};
+
   /// Current metrics for the accountant.
   measurement metrics = {};
 
   /// Per-event counters for the accountant.
   std::unordered_map<std::string, vast::count> event_counters = {};
 
+  /// Produces transport-level metrics for the accountant, e.g., the receive
+  /// and drop counters of a batched UDP receiver.
+  std::function<report()> input_status = {};
+
   /// The amount of time to wait until the next wakeup.
   std::chrono::milliseconds wakeup_delay = std::chrono::milliseconds::zero();
 
@@ -121,11 +131,15 @@ struct source_state {
 /// @param type_filter Restriction for considered types.
 /// @param accountant_actor The actor handle for the accountant component.
 /// @param input_transformations The input transformations to be applied.
+/// @param latency_target The end-to-end latency target for adaptive batching,
+/// or zero to use static batching.
+/// @param input_status An optional producer of transport-level metrics.
 caf::behavior
 source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
        size_t table_slice_size, std::optional<size_t> max_events,
        const type_registry_actor& type_registry, vast::module local_module,
        std::string type_filter, accountant_actor accountant,
-       std::vector<pipeline>&& input_pipelines);
+       std::vector<pipeline>&& input_pipelines, duration latency_target,
+       std::function<report()> input_status);
 
 } // namespace vast::system
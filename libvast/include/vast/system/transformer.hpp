@@ -45,7 +45,30 @@ struct transformer_state {
   /// The cached status response.
   record status;
 
-  bool reassign_offset_ranges;
+  bool reassign_offset_ranges = false;
+
+  /// The offset after the last transformed table slice.
+  id next_offset = 0;
+
+  /// Whether the stream stage shuts down because the input ended.
+  bool received_eof = false;
+
+  /// The maximum number of table slices that the executor collects before
+  /// applying the pipelines, which allows for applying them in parallel.
+  size_t max_buffered_slices = 1;
+
+  /// The number of table slices that the executor collected.
+  size_t num_buffered_slices = 0;
+
+  /// The number of rows in the collected table slices.
+  uint64_t num_buffered_rows = 0;
+
+  /// The offset of the first collected table slice.
+  id buffered_offset = invalid_id;
+
+  /// Whether a request to apply the pipelines to the collected table slices
+  /// is pending.
+  bool flush_pending = false;
 
   /// Name of the TRANSFORMER actor type.
   static constexpr const char* name = "transformer";
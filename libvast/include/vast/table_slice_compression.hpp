@@ -0,0 +1,84 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/die.hpp"
+
+#include <caf/fwd.hpp>
+#include <fmt/format.h>
+
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace vast {
+
+/// The compression codecs for the Arrow IPC backing of table slices.
+/// @note Readers detect the codec from the IPC data, so changing the codec
+/// does not affect the compatibility of serialized table slices.
+enum class table_slice_compression : uint8_t {
+  none, ///< Write uncompressed IPC data directly into the table slice.
+  lz4,  ///< Compress with the LZ4 frame format.
+  zstd, ///< Compress with Zstd.
+};
+
+/// Parses a table slice compression codec from its name.
+/// @returns The codec or `std::nullopt` for an unknown name.
+std::optional<table_slice_compression>
+to_table_slice_compression(std::string_view name) noexcept;
+
+/// Sets the codec for all table slices subsequently serialized by this
+/// process. Defaults to Zstd at its default compression level.
+/// @param compression The codec to use.
+/// @param level The compression level, or the codec's default if unset.
+/// @returns An error if Arrow lacks support for the codec or level.
+/// @note This function is not thread-safe, and must be called before spawning
+/// the actor system.
+caf::error set_table_slice_compression(table_slice_compression compression,
+                                       std::optional<int> level = {});
+
+/// Sets the codec for all table slices subsequently serialized by this
+/// process from the options `vast.import.batch-compression` and
+/// `vast.import.batch-compression-level`.
+/// @note This function is not thread-safe, and must be called before spawning
+/// the actor system.
+caf::error set_table_slice_compression(const caf::settings& options);
+
+/// @returns The Arrow codec for serializing table slices, or `nullptr` if
+/// table slices are not compressed.
+const std::shared_ptr<arrow::util::Codec>& table_slice_codec() noexcept;
+
+} // namespace vast
+
+namespace fmt {
+
+template <>
+struct formatter<vast::table_slice_compression> {
+  template <class ParseContext>
+  constexpr auto parse(ParseContext& ctx) {
+    return ctx.begin();
+  }
+
+  template <typename FormatContext>
+  auto format(const vast::table_slice_compression& x, FormatContext& ctx) const {
+    switch (x) {
+      case vast::table_slice_compression::none:
+        return format_to(ctx.out(), "none");
+      case vast::table_slice_compression::lz4:
+        return format_to(ctx.out(), "lz4");
+      case vast::table_slice_compression::zstd:
+        return format_to(ctx.out(), "zstd");
+    }
+    vast::die("unreachable");
+  }
+};
+
+} // namespace fmt
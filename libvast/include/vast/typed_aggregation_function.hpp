@@ -0,0 +1,89 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/aggregation_function.hpp"
+#include "vast/arrow_table_slice.hpp"
+#include "vast/type.hpp"
+#include "vast/view.hpp"
+
+#include <arrow/array.h>
+#include <arrow/util/bit_run_reader.h>
+
+namespace vast {
+
+/// An aggregation function over a statically known input type.
+///
+/// Implementations provide a kernel `void accumulate(view_type x)` that adds a
+/// single non-null value. The kernel gets instantiated for the concrete type
+/// at compile time and called directly from the batch path, which walks the
+/// Arrow buffers and skips null values in bulk using the validity bitmap.
+/// Implementations may additionally provide a batch kernel
+/// `void accumulate(const array_type& array)` that consumes a whole array,
+/// including its null values, in which case the batch path uses it instead.
+/// The per-value path through `add(const data_view&)` remains as a fallback.
+/// @tparam Type The concrete input type of the function.
+/// @tparam Derived The implementing class.
+template <concrete_type Type, class Derived>
+class typed_aggregation_function : public aggregation_function {
+public:
+  /// The view type of the values passed to the kernel.
+  using view_type = view<type_to_data_t<Type>>;
+
+  /// The Arrow array type passed to the batch kernel.
+  using array_type = type_to_arrow_array_storage_t<Type>;
+
+  void add(const data_view& view) final {
+    if (caf::holds_alternative<caf::none_t>(view))
+      return;
+    self().accumulate(caf::get<view_type>(view));
+  }
+
+  void add(const arrow::Array& array) final {
+    const auto& typed_array = caf::get<type_to_arrow_array_t<Type>>(array);
+    if constexpr (arrow::is_extension_type<type_to_arrow_type_t<Type>>::value)
+      add_storage(*typed_array.storage());
+    else
+      add_storage(typed_array);
+  }
+
+protected:
+  /// Constructs the typed aggregation function.
+  /// @param input_type The input type from the aggregation function plugin.
+  /// @pre *input_type* must hold *Type*.
+  explicit typed_aggregation_function(type input_type) noexcept
+    : aggregation_function(std::move(input_type)) {
+    VAST_ASSERT(caf::holds_alternative<Type>(this->input_type()));
+  }
+
+private:
+  Derived& self() noexcept {
+    return static_cast<Derived&>(*this);
+  }
+
+  void add_storage(const array_type& array) {
+    if constexpr (requires(Derived& f) { f.accumulate(array); }) {
+      self().accumulate(array);
+    } else {
+      const auto& type = caf::get<Type>(input_type());
+      auto accumulate_run = [&](int64_t position, int64_t length) {
+        for (auto row = position; row < position + length; ++row)
+          self().accumulate(value_at(type, array, row));
+      };
+      if (array.null_count() == 0)
+        accumulate_run(0, array.length());
+      else
+        arrow::internal::VisitSetBitRunsVoid(array.null_bitmap_data(),
+                                             array.offset(), array.length(),
+                                             accumulate_run);
+    }
+  }
+};
+
+} // namespace vast
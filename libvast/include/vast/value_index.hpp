@@ -51,6 +51,12 @@ public:
   /// @returns `true` if appending succeeded.
   caf::expected<void> append(data_view x, id pos);
 
+  /// Appends all non-null values of an Arrow array.
+  /// @param array The values to append to the index.
+  /// @param pos The positional identifier of the first value in *array*.
+  /// @returns An error if appending failed.
+  caf::expected<void> append(const arrow::Array& array, id pos);
+
   /// Looks up data under a relational operator. If the value to look up is
   /// `nil`, only `==` and `!=` are valid operations. The concrete index
   /// type determines validity of other values.
@@ -97,6 +103,11 @@ protected:
 private:
   virtual bool append_impl(data_view x, id pos) = 0;
 
+  /// Appends all non-null values of an Arrow array at consecutive positions.
+  /// The default implementation appends the values one by one; indexes that
+  /// can consume the Arrow buffers directly override it.
+  virtual bool append_array_impl(const arrow::Array& array, id pos);
+
   [[nodiscard]] virtual caf::expected<ids>
   lookup_impl(relational_operator op, data_view x) const = 0;
 
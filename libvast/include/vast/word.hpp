@@ -341,21 +341,12 @@ static constexpr auto find_prev(T x, detail::word_size_type i) {
 /// @pre `i > 0 && i <= width`
 template <bool Bit = true, concepts::unsigned_integral T>
 static constexpr detail::word_size_type select(T x, detail::word_size_type i) {
-  // TODO: make this efficient and branch-free. There is one implementation
-  // that counts from the right for 64-bit here:
-  // http://graphics.stanford.edu/~seander/bithacks.html
-  const auto pred = [](const auto&... args) {
-    if constexpr (Bit)
-      return word<T>::test(args...);
-    else
-      return !word<T>::test(args...);
-  };
-  auto cum = 0u;
-  for (auto j = 0u; j < word<T>::width; ++j)
-    if (pred(x, j))
-      if (++cum == i)
-        return j;
-  return word<T>::npos;
+  if constexpr (!Bit)
+    x = static_cast<T>(~x);
+  // Clear the lowest i-1 1-bits, which leaves the i-th one as the lowest.
+  for (auto j = detail::word_size_type{1}; j < i && x != 0; ++j)
+    x = static_cast<T>(x & (x - 1));
+  return x == 0 ? word<T>::npos : word<T>::count_trailing_zeros(x);
 }
 
 } // namespace vast
@@ -6,48 +6,50 @@
 // SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
 // SPDX-License-Identifier: BSD-3-Clause
 
-#include <vast/aggregation_function.hpp>
 #include <vast/plugin.hpp>
+#include <vast/typed_aggregation_function.hpp>
 
 namespace vast::plugins::all {
 
 namespace {
 
-class all_function final : public aggregation_function {
+class all_function final
+  : public typed_aggregation_function<bool_type, all_function> {
 public:
   explicit all_function(type input_type) noexcept
-    : aggregation_function(std::move(input_type)) {
+    : typed_aggregation_function<bool_type, all_function>(
+      std::move(input_type)) {
     // nop
   }
 
-private:
-  [[nodiscard]] type output_type() const override {
-    VAST_ASSERT(caf::holds_alternative<bool_type>(input_type()));
-    return input_type();
+  void accumulate(bool x) {
+    all_ = all_.value_or(true) && x;
   }
 
-  void add(const data_view& view) override {
-    using view_type = vast::view<bool>;
-    if (caf::holds_alternative<caf::none_t>(view))
+  void accumulate(const arrow::BooleanArray& array) {
+    if (array.null_count() == array.length())
       return;
-    if (!all_)
-      all_ = materialize(caf::get<view_type>(view));
-    else
-      all_ = *all_ && caf::get<view_type>(view);
+    all_ = all_.value_or(true) && array.false_count() == 0;
   }
 
-  void add(const arrow::Array& array) override {
-    const auto& bool_array = caf::get<type_to_arrow_array_t<bool_type>>(array);
-    if (!all_)
-      all_ = bool_array.false_count() == 0;
-    else
-      all_ = *all_ && bool_array.false_count() == 0;
+private:
+  [[nodiscard]] type output_type() const override {
+    return input_type();
   }
 
   [[nodiscard]] caf::expected<data> finish() && override {
     return data{all_};
   }
 
+  [[nodiscard]] type partial_type() const override {
+    return output_type();
+  }
+
+  [[nodiscard]] caf::error merge(const data_view& partial) override {
+    add(partial);
+    return {};
+  }
+
   std::optional<bool> all_ = {};
 };
 
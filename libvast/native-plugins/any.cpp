@@ -6,48 +6,50 @@
 // SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
 // SPDX-License-Identifier: BSD-3-Clause
 
-#include <vast/aggregation_function.hpp>
 #include <vast/plugin.hpp>
+#include <vast/typed_aggregation_function.hpp>
 
 namespace vast::plugins::any {
 
 namespace {
 
-class any_function final : public aggregation_function {
+class any_function final
+  : public typed_aggregation_function<bool_type, any_function> {
 public:
   explicit any_function(type input_type) noexcept
-    : aggregation_function(std::move(input_type)) {
+    : typed_aggregation_function<bool_type, any_function>(
+      std::move(input_type)) {
     // nop
   }
 
-private:
-  [[nodiscard]] type output_type() const override {
-    VAST_ASSERT(caf::holds_alternative<bool_type>(input_type()));
-    return input_type();
+  void accumulate(bool x) {
+    any_ = any_.value_or(false) || x;
   }
 
-  void add(const data_view& view) override {
-    using view_type = vast::view<bool>;
-    if (caf::holds_alternative<caf::none_t>(view))
+  void accumulate(const arrow::BooleanArray& array) {
+    if (array.null_count() == array.length())
       return;
-    if (!any_)
-      any_ = materialize(caf::get<view_type>(view));
-    else
-      any_ = *any_ || caf::get<view_type>(view);
+    any_ = any_.value_or(false) || array.true_count() > 0;
   }
 
-  void add(const arrow::Array& array) override {
-    const auto& bool_array = caf::get<type_to_arrow_array_t<bool_type>>(array);
-    if (!any_)
-      any_ = bool_array.true_count() > 0;
-    else
-      any_ = *any_ || bool_array.true_count() > 0;
+private:
+  [[nodiscard]] type output_type() const override {
+    return input_type();
   }
 
   [[nodiscard]] caf::expected<data> finish() && override {
     return data{any_};
   }
 
+  [[nodiscard]] type partial_type() const override {
+    return output_type();
+  }
+
+  [[nodiscard]] caf::error merge(const data_view& partial) override {
+    add(partial);
+    return {};
+  }
+
   std::optional<bool> any_ = {};
 };
 
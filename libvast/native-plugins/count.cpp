@@ -42,6 +42,17 @@ private:
     return count_;
   }
 
+  [[nodiscard]] type partial_type() const override {
+    return type{count_type{}};
+  }
+
+  [[nodiscard]] caf::error merge(const data_view& partial) override {
+    if (caf::holds_alternative<caf::none_t>(partial))
+      return {};
+    count_ += caf::get<view<vast::count>>(partial);
+    return {};
+  }
+
   vast::count count_ = {};
 };
 
@@ -0,0 +1,203 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <vast/hash/hash.hpp>
+#include <vast/plugin.hpp>
+#include <vast/sketch/hyperloglog.hpp>
+#include <vast/typed_aggregation_function.hpp>
+
+#include <tsl/robin_set.h>
+
+#include <cmath>
+
+namespace vast::plugins::count_distinct {
+
+namespace {
+
+/// The precision of the HyperLogLog sketch, for a standard error of about
+/// 0.8%.
+constexpr auto precision = uint8_t{14};
+
+/// The name of the partial type, which distinguishes partial states from
+/// input values.
+constexpr auto partial_name = std::string_view{"vast.count_distinct"};
+
+/// The number of registers that get packed into a single element of the
+/// partial state.
+constexpr auto registers_per_element = sizeof(count);
+
+/// Counts distinct hash digests. Like HyperLogLog++, the counter keeps the
+/// digests themselves as long as they use less memory than the registers of a
+/// HyperLogLog sketch, which makes it exact for small cardinalities.
+///
+/// The partial state is a list whose first element is the precision of the
+/// sketch, followed by its registers packed into the remaining elements, or
+/// zero followed by the digests themselves.
+class distinct_counter {
+public:
+  void add(uint64_t digest) {
+    if (dense_) {
+      dense_->add(digest);
+      return;
+    }
+    sparse_.insert(digest);
+    if (sparse_.size() * sizeof(uint64_t) > (size_t{1} << precision))
+      densify();
+  }
+
+  [[nodiscard]] caf::error merge(const view<list>& partial) {
+    if (partial.empty())
+      return caf::make_error(ec::invalid_argument,
+                             "count_distinct partial state must not be empty");
+    auto elements = std::vector<count>{};
+    elements.reserve(partial.size());
+    for (const auto& element : partial) {
+      const auto* x = caf::get_if<view<count>>(&element);
+      if (!x)
+        return caf::make_error(ec::invalid_argument,
+                               "count_distinct partial state must consist of "
+                               "counts");
+      elements.push_back(*x);
+    }
+    if (elements.front() == 0) {
+      for (auto it = elements.begin() + 1; it != elements.end(); ++it)
+        add(*it);
+      return {};
+    }
+    auto registers = std::vector<uint8_t>{};
+    registers.reserve((elements.size() - 1) * registers_per_element);
+    for (auto it = elements.begin() + 1; it != elements.end(); ++it)
+      for (size_t i = 0; i < registers_per_element; ++i)
+        registers.push_back(static_cast<uint8_t>(*it >> (8 * i)));
+    auto other = sketch::hyperloglog::make(registers);
+    if (!other)
+      return std::move(other.error());
+    if (other->precision() != elements.front())
+      return caf::make_error(ec::invalid_argument,
+                             fmt::format("count_distinct partial state with "
+                                         "precision {} has {} registers",
+                                         elements.front(), registers.size()));
+    if (!dense_)
+      densify();
+    return dense_->merge(*other);
+  }
+
+  [[nodiscard]] count estimate() const {
+    if (dense_)
+      return static_cast<count>(std::llround(dense_->estimate()));
+    return sparse_.size();
+  }
+
+  [[nodiscard]] list save() const {
+    auto result = list{};
+    if (!dense_) {
+      result.reserve(sparse_.size() + 1);
+      result.emplace_back(count{0});
+      for (auto digest : sparse_)
+        result.emplace_back(count{digest});
+      return result;
+    }
+    const auto registers = dense_->registers();
+    result.reserve(registers.size() / registers_per_element + 1);
+    result.emplace_back(count{dense_->precision()});
+    for (size_t i = 0; i < registers.size(); i += registers_per_element) {
+      auto element = count{0};
+      for (size_t j = 0; j < registers_per_element; ++j)
+        element |= count{registers[i + j]} << (8 * j);
+      result.emplace_back(element);
+    }
+    return result;
+  }
+
+  [[nodiscard]] size_t memusage() const {
+    return sparse_.bucket_count() * sizeof(uint64_t)
+           + (dense_ ? mem_usage(*dense_) : 0);
+  }
+
+private:
+  void densify() {
+    auto dense = sketch::hyperloglog::make(precision);
+    VAST_ASSERT(dense);
+    for (auto digest : sparse_)
+      dense->add(digest);
+    dense_ = std::move(*dense);
+    sparse_ = {};
+  }
+
+  tsl::robin_set<uint64_t> sparse_ = {};
+  std::optional<sketch::hyperloglog> dense_ = {};
+};
+
+template <concrete_type Type>
+class count_distinct_function final
+  : public typed_aggregation_function<Type, count_distinct_function<Type>> {
+public:
+  explicit count_distinct_function(type input_type) noexcept
+    : typed_aggregation_function<Type, count_distinct_function<Type>>(
+      std::move(input_type)) {
+    // nop
+  }
+
+  void accumulate(view<type_to_data_t<Type>> x) {
+    counter_.add(hash(x));
+  }
+
+private:
+  [[nodiscard]] type output_type() const override {
+    return type{count_type{}};
+  }
+
+  [[nodiscard]] caf::expected<data> finish() && override {
+    return data{counter_.estimate()};
+  }
+
+  [[nodiscard]] type partial_type() const override {
+    return type{partial_name, list_type{count_type{}}};
+  }
+
+  [[nodiscard]] caf::expected<data> save() && override {
+    return data{counter_.save()};
+  }
+
+  [[nodiscard]] caf::error merge(const data_view& partial) override {
+    if (caf::holds_alternative<caf::none_t>(partial))
+      return {};
+    return counter_.merge(caf::get<view<list>>(partial));
+  }
+
+  [[nodiscard]] size_t memusage() const override {
+    return counter_.memusage();
+  }
+
+  distinct_counter counter_ = {};
+};
+
+class plugin : public virtual aggregation_function_plugin {
+  caf::error initialize([[maybe_unused]] data config) override {
+    return {};
+  }
+
+  [[nodiscard]] const char* name() const override {
+    return "count_distinct";
+  };
+
+  [[nodiscard]] caf::expected<std::unique_ptr<aggregation_function>>
+  make_aggregation_function(const type& input_type) const override {
+    auto f = [&]<concrete_type Type>(
+               const Type&) -> std::unique_ptr<aggregation_function> {
+      return std::make_unique<count_distinct_function<Type>>(input_type);
+    };
+    return caf::visit(f, input_type);
+  }
+};
+
+} // namespace
+
+} // namespace vast::plugins::count_distinct
+
+VAST_REGISTER_PLUGIN(vast::plugins::count_distinct::plugin)
@@ -64,24 +64,10 @@ private:
   }
 
   void add(const data_view& view) override {
-    using view_type = vast::view<type_to_data_t<Type>>;
-    const auto handle_value_view = [&](const data_view& view) {
-      if (caf::holds_alternative<caf::none_t>(view))
-        return;
-      const auto& typed_view = caf::get<view_type>(view);
-      if (!distinct_.contains(typed_view)) {
-        const auto [it, inserted] = distinct_.insert(materialize(typed_view));
-        VAST_ASSERT(inserted);
-      }
-    };
-    if constexpr (IsList) {
-      if (caf::holds_alternative<caf::none_t>(view))
-        return;
-      for (const auto& value_view : caf::get<vast::view<list>>(view))
-        handle_value_view(value_view);
-    } else {
-      handle_value_view(view);
-    }
+    if constexpr (IsList)
+      add_list(view);
+    else
+      add_value(view);
   }
 
   [[nodiscard]] caf::expected<data> finish() && override {
@@ -93,9 +79,46 @@ private:
     return data{std::move(result)};
   }
 
+  [[nodiscard]] type partial_type() const override {
+    return output_type();
+  }
+
+  [[nodiscard]] caf::error merge(const data_view& partial) override {
+    add_list(partial);
+    return {};
+  }
+
+  [[nodiscard]] size_t memusage() const override {
+    return distinct_.bucket_count() * sizeof(type_to_data_t<Type>)
+           + value_bytes_;
+  }
+
+  void add_value(const data_view& view) {
+    using view_type = vast::view<type_to_data_t<Type>>;
+    if (caf::holds_alternative<caf::none_t>(view))
+      return;
+    const auto& typed_view = caf::get<view_type>(view);
+    if (!distinct_.contains(typed_view)) {
+      const auto [it, inserted] = distinct_.insert(materialize(typed_view));
+      VAST_ASSERT(inserted);
+      if constexpr (std::is_same_v<type_to_data_t<Type>, std::string>)
+        value_bytes_ += it->size();
+    }
+  }
+
+  void add_list(const data_view& view) {
+    if (caf::holds_alternative<caf::none_t>(view))
+      return;
+    for (const auto& value_view : caf::get<vast::view<list>>(view))
+      add_value(value_view);
+  }
+
   tsl::robin_set<type_to_data_t<Type>, heterogeneous_data_hash<Type>,
                  heterogeneous_data_equal<Type>>
     distinct_ = {};
+
+  /// The number of bytes that the distinct values allocated on the heap.
+  size_t value_bytes_ = 0;
 };
 
 class plugin : public virtual aggregation_function_plugin {
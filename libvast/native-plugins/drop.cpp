@@ -18,6 +18,9 @@
 
 #include <arrow/type.h>
 
+#include <optional>
+#include <unordered_map>
+
 namespace vast::plugins::drop {
 
 namespace {
@@ -47,27 +50,48 @@ struct configuration {
 };
 
 /// Drops the specifed fields from the input.
-class drop_operator : public pipeline_operator {
+class drop_operator : public stateless_pipeline_operator {
 public:
   explicit drop_operator(configuration config) noexcept
     : config_{std::move(config)} {
     // nop
   }
 
-  caf::error
-  add(type layout, std::shared_ptr<arrow::RecordBatch> batch) override {
-    VAST_DEBUG("drop operator adds batch");
-    // Determine whether we want to drop the entire batch first.
+  caf::error apply(fused_batch& x) override {
+    VAST_DEBUG("drop operator applies to batch");
+    auto transformations = bound_transformations_.find(x.layout);
+    if (transformations == bound_transformations_.end())
+      transformations = bound_transformations_
+                          .emplace(type{chunk::copy(x.layout)},
+                                   bind_transformations(x.layout))
+                          .first;
+    // Drop the entire batch if the schema is configured for dropping.
+    if (!transformations->second) {
+      x.batch = nullptr;
+      return caf::none;
+    }
+    if (transformations->second->empty())
+      return caf::none;
+    std::tie(x.layout, x.batch)
+      = transform_columns(x.layout, x.batch, *transformations->second);
+    VAST_ASSERT(!x.layout == !x.batch);
+    return caf::none;
+  }
+
+private:
+  /// Determines the transformations that drop the configured fields from a
+  /// schema, or `std::nullopt` if the entire schema is to be dropped.
+  std::optional<std::vector<indexed_transformation>>
+  bind_transformations(const type& layout) const {
     const auto drop_schema
       = std::any_of(config_.schemas.begin(), config_.schemas.end(),
                     [&](const auto& dropped_schema) {
                       return dropped_schema == layout.name();
                     });
     if (drop_schema)
-      return caf::none;
-    // Apply the transformation.
+      return std::nullopt;
     auto transform_fn
-      = [&](struct record_type::field, std::shared_ptr<arrow::Array>) noexcept
+      = [](struct record_type::field, std::shared_ptr<arrow::Array>) noexcept
       -> std::vector<
         std::pair<struct record_type::field, std::shared_ptr<arrow::Array>>> {
       return {};
@@ -82,27 +106,15 @@ public:
     // again in that case.
     if (config_.fields.size() > 1)
       std::sort(transformations.begin(), transformations.end());
-    auto [adjusted_layout, adjusted_batch]
-      = transform_columns(layout, batch, transformations);
-    if (adjusted_layout) {
-      VAST_ASSERT(adjusted_batch);
-      transformed_.emplace_back(std::move(adjusted_layout),
-                                std::move(adjusted_batch));
-    }
-    return caf::none;
-  }
-
-  caf::expected<std::vector<pipeline_batch>> finish() override {
-    VAST_DEBUG("drop operator finished transformation");
-    return std::exchange(transformed_, {});
+    return transformations;
   }
 
-private:
-  /// The slices being transformed.
-  std::vector<pipeline_batch> transformed_;
-
   /// The underlying configuration of the transformation.
   configuration config_;
+
+  /// The transformations bound to a specific schema.
+  std::unordered_map<type, std::optional<std::vector<indexed_transformation>>>
+    bound_transformations_ = {};
 };
 
 class plugin final : public virtual pipeline_operator_plugin {
@@ -17,6 +17,9 @@
 #include <arrow/array.h>
 #include <fmt/format.h>
 
+#include <memory>
+#include <unordered_set>
+
 namespace vast::plugins::extend {
 
 namespace {
@@ -37,43 +40,67 @@ struct configuration {
     result.fields.reserve(fields->size());
     for (const auto& [key, _] : *fields)
       result.fields.emplace_back(key);
-    result.transformation = [fields = *fields](
-                              struct record_type::field field,
-                              std::shared_ptr<arrow::Array> array) noexcept {
-      const auto length = array->length();
-      auto result = std::vector<
-        std::pair<struct record_type::field, std::shared_ptr<arrow::Array>>>{
-        {std::move(field), std::move(array)},
-      };
-      for (const auto& kvp : fields) {
-        auto& entry = result.emplace_back();
-        entry.first.name = kvp.first;
-        entry.first.type = type::infer(kvp.second);
-        VAST_ASSERT(entry.first.type);
-        auto builder
-          = entry.first.type.make_arrow_builder(arrow::default_memory_pool());
-        auto f = [&]<concrete_type Type>(const Type& type) {
-          if (caf::holds_alternative<caf::none_t>(kvp.second)) {
-            for (int i = 0; i < length; ++i) {
-              const auto append_status = builder->AppendNull();
-              VAST_ASSERT(append_status.ok(), append_status.ToString().c_str());
-            }
-          } else {
-            for (int i = 0; i < length; ++i) {
-              VAST_ASSERT(
-                caf::holds_alternative<type_to_data_t<Type>>(kvp.second));
-              const auto append_status = append_builder(
-                type, caf::get<type_to_arrow_builder_t<Type>>(*builder),
-                make_view(caf::get<type_to_data_t<Type>>(kvp.second)));
-              VAST_ASSERT(append_status.ok(), append_status.ToString().c_str());
-            }
+    // The added columns hold constant values, so we build them only once per
+    // batch length and share them between batches of the same length.
+    result.transformation
+      = [fields = *fields, cache = std::make_shared<column_cache>()](
+          struct record_type::field field,
+          std::shared_ptr<arrow::Array> array) noexcept {
+          const auto length = array->length();
+          auto result = std::vector<std::pair<struct record_type::field,
+                                              std::shared_ptr<arrow::Array>>>{
+            {std::move(field), std::move(array)},
+          };
+          if (cache->length != length || cache->columns.empty()) {
+            cache->length = length;
+            cache->columns.clear();
+            for (const auto& kvp : fields)
+              cache->columns.push_back(make_column(kvp.first, kvp.second,
+                                                   length));
           }
+          result.insert(result.end(), cache->columns.begin(),
+                        cache->columns.end());
+          return result;
         };
-        caf::visit(f, entry.first.type);
-        entry.second = builder->Finish().ValueOrDie();
+    return result;
+  }
+
+  /// The columns added to the batches of a given length.
+  struct column_cache {
+    int64_t length = 0;
+    std::vector<
+      std::pair<struct record_type::field, std::shared_ptr<arrow::Array>>>
+      columns = {};
+  };
+
+  /// Creates a column that repeats a value.
+  static std::pair<struct record_type::field, std::shared_ptr<arrow::Array>>
+  make_column(const std::string& name, const data& value, int64_t length) {
+    auto result
+      = std::pair<struct record_type::field, std::shared_ptr<arrow::Array>>{};
+    result.first.name = name;
+    result.first.type = type::infer(value);
+    VAST_ASSERT(result.first.type);
+    auto builder
+      = result.first.type.make_arrow_builder(arrow::default_memory_pool());
+    auto f = [&]<concrete_type Type>(const Type& type) {
+      if (caf::holds_alternative<caf::none_t>(value)) {
+        for (int i = 0; i < length; ++i) {
+          const auto append_status = builder->AppendNull();
+          VAST_ASSERT(append_status.ok(), append_status.ToString().c_str());
+        }
+      } else {
+        for (int i = 0; i < length; ++i) {
+          VAST_ASSERT(caf::holds_alternative<type_to_data_t<Type>>(value));
+          const auto append_status = append_builder(
+            type, caf::get<type_to_arrow_builder_t<Type>>(*builder),
+            make_view(caf::get<type_to_data_t<Type>>(value)));
+          VAST_ASSERT(append_status.ok(), append_status.ToString().c_str());
+        }
       }
-      return result;
     };
+    caf::visit(f, result.first.type);
+    result.second = builder->Finish().ValueOrDie();
     return result;
   }
 
@@ -81,44 +108,41 @@ struct configuration {
   indexed_transformation::function_type transformation = {};
 };
 
-class extend_operator : public pipeline_operator {
+class extend_operator : public stateless_pipeline_operator {
 public:
   explicit extend_operator(configuration config) noexcept
     : config_{std::move(config)} {
     // nop
   }
 
-  caf::error
-  add(type schema, std::shared_ptr<arrow::RecordBatch> batch) override {
-    const auto& schema_rt = caf::get<record_type>(schema);
-    for (const auto& field : config_.fields)
-      if (schema_rt.resolve_key(field).has_value())
-        return caf::make_error(ec::invalid_configuration,
-                               fmt::format("cannot extend {} with field {} "
-                                           "as it already has a field with "
-                                           "this name",
-                                           schema, field));
-    auto [adjusted_layout, adjusted_batch] = transform_columns(
-      schema, batch,
+  caf::error apply(fused_batch& x) override {
+    const auto& schema = x.layout;
+    if (!validated_schemas_.contains(schema)) {
+      const auto& schema_rt = caf::get<record_type>(schema);
+      for (const auto& field : config_.fields)
+        if (schema_rt.resolve_key(field).has_value())
+          return caf::make_error(ec::invalid_configuration,
+                                 fmt::format("cannot extend {} with field {} "
+                                             "as it already has a field with "
+                                             "this name",
+                                             schema, field));
+      validated_schemas_.emplace(chunk::copy(schema));
+    }
+    std::tie(x.layout, x.batch) = transform_columns(
+      schema, x.batch,
       {{offset{caf::get<record_type>(schema).num_fields() - 1},
         config_.transformation}});
-    VAST_ASSERT(adjusted_layout);
-    VAST_ASSERT(adjusted_batch);
-    transformed_.emplace_back(std::move(adjusted_layout),
-                              std::move(adjusted_batch));
+    VAST_ASSERT(x.layout);
+    VAST_ASSERT(x.batch);
     return caf::none;
   }
 
-  caf::expected<std::vector<pipeline_batch>> finish() override {
-    return std::exchange(transformed_, {});
-  }
-
 private:
-  /// The transformed slices.
-  std::vector<pipeline_batch> transformed_ = {};
-
   /// The underlying configuration of the transformation.
   configuration config_ = {};
+
+  /// The schemas that have none of the added fields.
+  std::unordered_set<type> validated_schemas_ = {};
 };
 
 class plugin final : public virtual pipeline_operator_plugin {
@@ -6,23 +6,33 @@
 // SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
 // SPDX-License-Identifier: BSD-3-Clause
 
+#include <vast/address.hpp>
 #include <vast/arrow_table_slice.hpp>
 #include <vast/arrow_table_slice_builder.hpp>
+#include <vast/as_bytes.hpp>
 #include <vast/concept/convertible/data.hpp>
 #include <vast/concept/convertible/to.hpp>
 #include <vast/detail/narrow.hpp>
 #include <vast/error.hpp>
 #include <vast/hash/default_hash.hpp>
+#include <vast/hash/hash.hpp>
 #include <vast/hash/hash_append.hpp>
+#include <vast/hash/xxhash.hpp>
 #include <vast/optional.hpp>
 #include <vast/pipeline.hpp>
 #include <vast/plugin.hpp>
 #include <vast/table_slice_builder_factory.hpp>
 
 #include <arrow/array/builder_binary.h>
+#include <arrow/array/builder_primitive.h>
 #include <arrow/scalar.h>
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <array>
+#include <span>
+#include <vector>
+
 namespace vast::plugins::hash {
 
 namespace {
@@ -32,11 +42,12 @@ struct configuration {
   std::string field;
   std::string out;
   std::optional<std::string> salt;
+  std::optional<std::string> format;
 
   /// Support type inspection for easy parsing with convertible.
   template <class Inspector>
   friend auto inspect(Inspector& f, configuration& x) {
-    return f(x.field, x.out, x.salt);
+    return f(x.field, x.out, x.salt, x.format);
   }
 
   /// Enable parsing from a record via convertible.
@@ -45,47 +56,252 @@ struct configuration {
       {"field", string_type{}},
       {"out", string_type{}},
       {"salt", string_type{}},
+      {"format", string_type{}},
     };
     return result;
   }
 };
 
-class hash_operator : public pipeline_operator {
+/// A hash algorithm that records the bytes it is fed instead of hashing them.
+/// This lets us learn which bytes `hash_append` produces for a value.
+struct byte_recorder {
+  static constexpr detail::endian endian = detail::endian::native;
+
+  void add(std::span<const std::byte> bytes) noexcept {
+    buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+  }
+
+  std::vector<std::byte> buffer = {};
+};
+
+/// The types whose values we hash straight from the Arrow buffers.
+template <class Type>
+concept raw_hashable_type
+  = detail::is_any_v<Type, integer_type, count_type, real_type, duration_type,
+                     time_type, address_type, string_type>;
+
+/// Returns a distinctive value of a type, whose byte representation does not
+/// alias the bytes that a data view prepends or appends to it.
+template <raw_hashable_type Type>
+auto sentinel() -> view<type_to_data_t<Type>> {
+  if constexpr (std::is_same_v<Type, integer_type>) {
+    return integer{0x0123'4567'89ab'cdef};
+  } else if constexpr (std::is_same_v<Type, count_type>) {
+    return count{0xfedc'ba98'7654'3210};
+  } else if constexpr (std::is_same_v<Type, real_type>) {
+    return real{-1.234'567'89e-123};
+  } else if constexpr (std::is_same_v<Type, duration_type>) {
+    return duration{0x0123'4567'89ab'cdef};
+  } else if constexpr (std::is_same_v<Type, time_type>) {
+    return time{duration{0x0123'4567'89ab'cdef}};
+  } else if constexpr (std::is_same_v<Type, address_type>) {
+    static constexpr auto bytes = std::array<uint8_t, 16>{
+      0xf0, 0xe1, 0xd2, 0xc3, 0xb4, 0xa5, 0x96, 0x87,
+      0x78, 0x69, 0x5a, 0x4b, 0x3c, 0x2d, 0x1e, 0x0f,
+    };
+    return address::v6(std::span<const uint8_t, 16>{bytes});
+  } else if constexpr (std::is_same_v<Type, string_type>) {
+    return std::string_view{"\x01vast-hash-sentinel\x02"};
+  }
+}
+
+/// The bytes that hashing a data view feeds into the hash algorithm before and
+/// after the bytes of the contained value, e.g., the variant discriminator.
+struct framing {
+  std::vector<std::byte> prefix = {};
+  std::vector<std::byte> suffix = {};
+};
+
+/// Derives the framing of a type by recording the bytes of a data view and of
+/// the contained value, and locating the latter within the former.
+template <raw_hashable_type Type>
+std::optional<framing> make_framing() {
+  const auto value = sentinel<Type>();
+  auto outer = byte_recorder{};
+  hash_append(outer, data_view{value});
+  auto inner = byte_recorder{};
+  hash_append(inner, value);
+  const auto it = std::search(outer.buffer.begin(), outer.buffer.end(),
+                              inner.buffer.begin(), inner.buffer.end());
+  if (it == outer.buffer.end())
+    return std::nullopt;
+  return framing{
+    {outer.buffer.begin(), it},
+    {it + detail::narrow_cast<std::ptrdiff_t>(inner.buffer.size()),
+     outer.buffer.end()},
+  };
+}
+
+/// Appends the bytes that `hash_append` produces for a value to a buffer,
+/// reading them directly from the Arrow buffers of an array.
+template <raw_hashable_type Type>
+void append_raw_bytes(const type_to_arrow_array_storage_t<Type>& array,
+                      int64_t row, std::vector<std::byte>& buffer) {
+  auto append = [&](const void* data, size_t size) {
+    const auto bytes = as_bytes(data, size);
+    buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+  };
+  if constexpr (std::is_same_v<Type, real_type>) {
+    // When hashing, we treat -0 and 0 the same.
+    auto x = array.Value(row);
+    if (x == 0)
+      x = 0;
+    append(&x, sizeof(x));
+  } else if constexpr (std::is_same_v<Type, address_type>) {
+    append(array.GetValue(row), 16);
+  } else if constexpr (std::is_same_v<Type, string_type>) {
+    const auto str = array.GetView(row);
+    const auto size = static_cast<size_t>(str.size());
+    append(str.data(), str.size());
+    append(&size, sizeof(size));
+  } else {
+    const auto x = array.Value(row);
+    append(&x, sizeof(x));
+  }
+}
+
+/// Computes the digest of every value of a fixed-width or string array from
+/// the raw Arrow buffers. Returns false without invoking the callback if the
+/// raw bytes would not match the bytes of hashing the data view.
+template <raw_hashable_type Type, class F>
+bool for_each_raw_digest(const Type& type, const arrow::Array& array,
+                         const std::optional<std::string>& salt, F& f) {
+  static const auto frame = make_framing<Type>();
+  if (!frame)
+    return false;
+  // Extension arrays hand out their storage by value, so we need to keep it
+  // alive for the duration of the loop.
+  auto owner = std::shared_ptr<arrow::Array>{};
+  const auto& storage = [&]() -> const type_to_arrow_array_storage_t<Type>& {
+    if constexpr (arrow::is_extension_type<type_to_arrow_type_t<Type>>::value) {
+      auto result = caf::get<type_to_arrow_array_t<Type>>(array).storage();
+      owner = result;
+      return *result;
+    } else {
+      return caf::get<type_to_arrow_array_t<Type>>(array);
+    }
+  }();
+  auto scratch = frame->prefix;
+  // Verify the raw bytes of the first valid value against the bytes of the
+  // value view, so that we never emit a digest that differs from hashing the
+  // data view.
+  for (int64_t row = 0; row < storage.length(); ++row) {
+    if (storage.IsNull(row))
+      continue;
+    auto expected = byte_recorder{};
+    hash_append(expected, value_at(type, storage, row));
+    append_raw_bytes<Type>(storage, row, scratch);
+    const auto offset
+      = detail::narrow_cast<std::ptrdiff_t>(frame->prefix.size());
+    if (!std::equal(scratch.begin() + offset, scratch.end(),
+                    expected.buffer.begin(), expected.buffer.end()))
+      return false;
+    break;
+  }
+  auto salt_bytes = byte_recorder{};
+  if (salt)
+    hash_append(salt_bytes, *salt);
+  const auto null_digest
+    = salt ? vast::hash(data_view{}, *salt) : vast::hash(data_view{});
+  for (int64_t row = 0; row < storage.length(); ++row) {
+    if (storage.IsNull(row)) {
+      f(null_digest);
+      continue;
+    }
+    scratch.resize(frame->prefix.size());
+    append_raw_bytes<Type>(storage, row, scratch);
+    scratch.insert(scratch.end(), frame->suffix.begin(), frame->suffix.end());
+    scratch.insert(scratch.end(), salt_bytes.buffer.begin(),
+                   salt_bytes.buffer.end());
+    f(xxh3_64::make(scratch));
+  }
+  return true;
+}
+
+/// Computes the digest of every value of an array, and invokes a callback
+/// with each digest. The digests are identical to hashing the data view of a
+/// value, followed by the salt if one is given.
+template <class F>
+void for_each_digest(const type& t, const arrow::Array& array,
+                     const std::optional<std::string>& salt, F f) {
+  static_assert(std::is_same_v<default_hash, xxh3_64>,
+                "raw digests must match the default hash algorithm");
+  auto raw = [&]<concrete_type Type>([[maybe_unused]] const Type& type) {
+    if constexpr (raw_hashable_type<Type>)
+      return for_each_raw_digest(type, array, salt, f);
+    else
+      return false;
+  };
+  if (caf::visit(raw, t))
+    return;
+  if (salt)
+    for (const auto& value : values(t, array))
+      f(vast::hash(value, *salt));
+  else
+    for (const auto& value : values(t, array))
+      f(vast::hash(value));
+}
+
+/// Computes the digests of an array as hex strings.
+std::shared_ptr<arrow::Array>
+make_hex_digests(const type& t, const arrow::Array& array,
+                 const std::optional<std::string>& salt) {
+  static constexpr auto max_width = 2 * sizeof(xxh3_64::result_type);
+  // We write all digests into a single preallocated data buffer.
+  auto builder = string_type::make_arrow_builder(arrow::default_memory_pool());
+  auto status = builder->Reserve(array.length());
+  if (status.ok())
+    status = builder->ReserveData(array.length() * int64_t{max_width});
+  VAST_ASSERT(status.ok(), status.ToString().c_str());
+  for_each_digest(t, array, salt, [&](xxh3_64::result_type digest) {
+    auto hex = std::array<char, max_width>{};
+    const auto* end = fmt::format_to(hex.data(), "{:x}", digest);
+    builder->UnsafeAppend(hex.data(),
+                          detail::narrow_cast<int32_t>(end - hex.data()));
+  });
+  return builder->Finish().ValueOrDie();
+}
+
+/// Computes the digests of an array as unsigned integers.
+std::shared_ptr<arrow::Array>
+make_count_digests(const type& t, const arrow::Array& array,
+                   const std::optional<std::string>& salt) {
+  auto builder = count_type::make_arrow_builder(arrow::default_memory_pool());
+  const auto status = builder->Reserve(array.length());
+  VAST_ASSERT(status.ok(), status.ToString().c_str());
+  for_each_digest(t, array, salt, [&](xxh3_64::result_type digest) {
+    builder->UnsafeAppend(digest);
+  });
+  return builder->Finish().ValueOrDie();
+}
+
+class hash_operator : public stateless_pipeline_operator {
 public:
   explicit hash_operator(configuration configuration);
 
-  [[nodiscard]] caf::error
-  add(type layout, std::shared_ptr<arrow::RecordBatch> batch) override {
-    VAST_TRACE("hash operator adds batch");
+  [[nodiscard]] caf::error apply(fused_batch& x) override {
+    VAST_TRACE("hash operator applies to batch");
     // Get the target field if it exists.
-    const auto& layout_rt = caf::get<record_type>(layout);
-    auto column_index = layout_rt.resolve_key(config_.field);
-    if (!column_index) {
-      transformed_.emplace_back(layout, std::move(batch));
+    auto column_index = bound_indices_.find(x.layout);
+    if (column_index == bound_indices_.end())
+      column_index
+        = bound_indices_
+            .emplace(type{chunk::copy(x.layout)},
+                     caf::get<record_type>(x.layout).resolve_key(config_.field))
+            .first;
+    if (!column_index->second)
       return caf::none;
-    }
     // Apply the transformation.
     auto transform_fn = [&](struct record_type::field field,
                             std::shared_ptr<arrow::Array> array) noexcept
       -> std::vector<
         std::pair<struct record_type::field, std::shared_ptr<arrow::Array>>> {
-      auto hashes_builder
-        = string_type::make_arrow_builder(arrow::default_memory_pool());
-      if (config_.salt) {
-        for (const auto& value : values(field.type, *array)) {
-          const auto digest = vast::hash(value, *config_.salt);
-          const auto append_result
-            = hashes_builder->Append(fmt::format("{:x}", digest));
-          VAST_ASSERT(append_result.ok(), append_result.ToString().c_str());
-        }
-      } else {
-        for (const auto& value : values(field.type, *array)) {
-          const auto digest = vast::hash(value);
-          const auto append_result
-            = hashes_builder->Append(fmt::format("{:x}", digest));
-          VAST_ASSERT(append_result.ok(), append_result.ToString().c_str());
-        }
-      }
+      auto digests
+        = config_.format == "count"
+            ? std::pair{type{count_type{}},
+                        make_count_digests(field.type, *array, config_.salt)}
+            : std::pair{type{string_type{}},
+                        make_hex_digests(field.type, *array, config_.salt)};
       return {
         {
           std::move(field),
@@ -94,32 +310,25 @@ public:
         {
           {
             config_.out,
-            string_type{},
+            std::move(digests.first),
           },
-          hashes_builder->Finish().ValueOrDie(),
+          std::move(digests.second),
         },
       };
     };
-    auto [adjusted_layout, adjusted_batch] = transform_columns(
-      layout, batch, {{*column_index, std::move(transform_fn)}});
-    VAST_ASSERT(adjusted_layout);
-    VAST_ASSERT(adjusted_batch);
-    transformed_.emplace_back(std::move(adjusted_layout),
-                              std::move(adjusted_batch));
+    std::tie(x.layout, x.batch) = transform_columns(
+      x.layout, x.batch, {{*column_index->second, std::move(transform_fn)}});
+    VAST_ASSERT(x.layout);
+    VAST_ASSERT(x.batch);
     return caf::none;
   }
 
-  [[nodiscard]] caf::expected<std::vector<pipeline_batch>> finish() override {
-    VAST_DEBUG("hash operator finished transformation");
-    return std::exchange(transformed_, {});
-  }
-
 private:
-  /// The slices being transformed.
-  std::vector<pipeline_batch> transformed_;
-
   /// The underlying configuration of the transformation.
   configuration config_ = {};
+
+  /// The index of the target field per schema, if it exists.
+  std::unordered_map<type, std::optional<offset>> bound_indices_ = {};
 };
 
 hash_operator::hash_operator(configuration configuration)
@@ -151,6 +360,12 @@ public:
     auto config = to<configuration>(options);
     if (!config)
       return config.error();
+    if (config->format && *config->format != "hex"
+        && *config->format != "count")
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("hash operator got invalid format "
+                                         "'{}'; expected 'hex' or 'count'",
+                                         *config->format));
     return std::make_unique<hash_operator>(std::move(*config));
   }
 };
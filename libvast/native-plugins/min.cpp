@@ -6,39 +6,46 @@
 // SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
 // SPDX-License-Identifier: BSD-3-Clause
 
-#include <vast/aggregation_function.hpp>
 #include <vast/plugin.hpp>
+#include <vast/typed_aggregation_function.hpp>
 
 namespace vast::plugins::min {
 
 namespace {
 
 template <basic_type Type>
-class min_function final : public aggregation_function {
+class min_function final
+  : public typed_aggregation_function<Type, min_function<Type>> {
 public:
   explicit min_function(type input_type) noexcept
-    : aggregation_function(std::move(input_type)) {
+    : typed_aggregation_function<Type, min_function<Type>>(
+      std::move(input_type)) {
     // nop
   }
 
-private:
-  [[nodiscard]] type output_type() const override {
-    VAST_ASSERT(caf::holds_alternative<Type>(input_type()));
-    return input_type();
+  void accumulate(view<type_to_data_t<Type>> x) {
+    if (!min_ || x < *min_)
+      min_ = materialize(x);
   }
 
-  void add(const data_view& view) override {
-    using view_type = vast::view<type_to_data_t<Type>>;
-    if (caf::holds_alternative<caf::none_t>(view))
-      return;
-    if (!min_ || caf::get<view_type>(view) < *min_)
-      min_ = materialize(caf::get<view_type>(view));
+private:
+  [[nodiscard]] type output_type() const override {
+    return this->input_type();
   }
 
   [[nodiscard]] caf::expected<data> finish() && override {
     return data{min_};
   }
 
+  [[nodiscard]] type partial_type() const override {
+    return output_type();
+  }
+
+  [[nodiscard]] caf::error merge(const data_view& partial) override {
+    this->add(partial);
+    return {};
+  }
+
   std::optional<type_to_data_t<Type>> min_ = {};
 };
 
@@ -0,0 +1,261 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <vast/logger.hpp>
+#include <vast/plugin.hpp>
+#include <vast/sketch/tdigest.hpp>
+#include <vast/typed_aggregation_function.hpp>
+
+#include <cmath>
+
+namespace vast::plugins::quantile {
+
+namespace {
+
+/// The names of the partial types, which distinguish partial states from
+/// input values, and durations from numbers.
+constexpr auto partial_name = std::string_view{"vast.quantile"};
+constexpr auto duration_partial_name
+  = std::string_view{"vast.quantile.duration"};
+
+/// Estimates a quantile with a t-digest.
+///
+/// The partial state is a list of real numbers that starts with the minimum
+/// and maximum of the input, followed by the mean and weight of every
+/// centroid of the digest.
+class quantile_state {
+public:
+  quantile_state(double q, bool is_duration) noexcept
+    : q_{q}, is_duration_{is_duration} {
+    // nop
+  }
+
+  void add(double x) {
+    if (!std::isnan(x))
+      digest_.add(x);
+  }
+
+  [[nodiscard]] type output_type() const {
+    if (is_duration_)
+      return type{duration_type{}};
+    return type{real_type{}};
+  }
+
+  [[nodiscard]] type partial_type() const {
+    return type{is_duration_ ? duration_partial_name : partial_name,
+                list_type{real_type{}}};
+  }
+
+  [[nodiscard]] data finish() {
+    const auto result = digest_.quantile(q_);
+    if (!result)
+      return {};
+    if (is_duration_)
+      return duration{static_cast<duration::rep>(std::llround(*result))};
+    return *result;
+  }
+
+  [[nodiscard]] data save() {
+    digest_.compress();
+    const auto& centroids = digest_.centroids();
+    if (centroids.empty())
+      return {};
+    auto result = list{};
+    result.reserve(2 + 2 * centroids.size());
+    result.emplace_back(digest_.min());
+    result.emplace_back(digest_.max());
+    for (const auto& centroid : centroids) {
+      result.emplace_back(centroid.mean);
+      result.emplace_back(centroid.weight);
+    }
+    return data{std::move(result)};
+  }
+
+  [[nodiscard]] caf::error merge(const view<list>& partial) {
+    auto values = std::vector<double>{};
+    values.reserve(partial.size());
+    for (const auto& element : partial) {
+      const auto* x = caf::get_if<view<real>>(&element);
+      if (!x)
+        return caf::make_error(ec::invalid_argument,
+                               "quantile partial state must consist of real "
+                               "numbers");
+      values.push_back(*x);
+    }
+    if (values.empty())
+      return {};
+    if (values.size() % 2 != 0)
+      return caf::make_error(ec::invalid_argument,
+                             fmt::format("quantile partial state must have an "
+                                         "even number of elements, got {}",
+                                         values.size()));
+    auto centroids = std::vector<sketch::tdigest::centroid>{};
+    centroids.reserve(values.size() / 2 - 1);
+    for (size_t i = 2; i < values.size(); i += 2)
+      centroids.push_back({values[i], values[i + 1]});
+    auto other = sketch::tdigest::make(sketch::tdigest::default_compression,
+                                       std::move(centroids), values[0],
+                                       values[1]);
+    if (!other)
+      return std::move(other.error());
+    digest_.merge(*other);
+    return {};
+  }
+
+  [[nodiscard]] size_t memusage() const {
+    return mem_usage(digest_) - sizeof(digest_);
+  }
+
+private:
+  double q_ = {};
+  bool is_duration_ = {};
+  sketch::tdigest digest_ = {};
+};
+
+template <basic_type Type>
+class quantile_function final
+  : public typed_aggregation_function<Type, quantile_function<Type>> {
+public:
+  quantile_function(type input_type, double q) noexcept
+    : typed_aggregation_function<Type, quantile_function<Type>>(
+      std::move(input_type)),
+      state_{q, std::is_same_v<Type, duration_type>} {
+    // nop
+  }
+
+  void accumulate(view<type_to_data_t<Type>> x) {
+    if constexpr (std::is_same_v<Type, duration_type>)
+      state_.add(static_cast<double>(x.count()));
+    else if constexpr (std::is_same_v<Type, integer_type>)
+      state_.add(static_cast<double>(x.value));
+    else
+      state_.add(static_cast<double>(x));
+  }
+
+private:
+  [[nodiscard]] type output_type() const override {
+    return state_.output_type();
+  }
+
+  [[nodiscard]] caf::expected<data> finish() && override {
+    return state_.finish();
+  }
+
+  [[nodiscard]] type partial_type() const override {
+    return state_.partial_type();
+  }
+
+  [[nodiscard]] caf::expected<data> save() && override {
+    return state_.save();
+  }
+
+  [[nodiscard]] caf::error merge(const data_view& partial) override {
+    if (caf::holds_alternative<caf::none_t>(partial))
+      return {};
+    return state_.merge(caf::get<view<list>>(partial));
+  }
+
+  [[nodiscard]] size_t memusage() const override {
+    return state_.memusage();
+  }
+
+  quantile_state state_;
+};
+
+/// Merges partial states of the quantile function.
+class quantile_merge_function final : public aggregation_function {
+public:
+  quantile_merge_function(type input_type, double q, bool is_duration) noexcept
+    : aggregation_function(std::move(input_type)), state_{q, is_duration} {
+    // nop
+  }
+
+private:
+  [[nodiscard]] type output_type() const override {
+    return state_.output_type();
+  }
+
+  void add(const data_view& view) override {
+    if (auto err = merge(view))
+      VAST_WARN("quantile aggregation function failed to merge partial state: "
+                "{}",
+                err);
+  }
+
+  [[nodiscard]] caf::expected<data> finish() && override {
+    return state_.finish();
+  }
+
+  [[nodiscard]] type partial_type() const override {
+    return state_.partial_type();
+  }
+
+  [[nodiscard]] caf::expected<data> save() && override {
+    return state_.save();
+  }
+
+  [[nodiscard]] caf::error merge(const data_view& partial) override {
+    if (caf::holds_alternative<caf::none_t>(partial))
+      return {};
+    return state_.merge(caf::get<view<list>>(partial));
+  }
+
+  [[nodiscard]] size_t memusage() const override {
+    return state_.memusage();
+  }
+
+  quantile_state state_;
+};
+
+/// An aggregation function plugin for a fixed percentile.
+/// @tparam Percentile The percentile in [0, 100].
+template <size_t Percentile>
+class plugin : public virtual aggregation_function_plugin {
+  static_assert(Percentile <= 100);
+
+  caf::error initialize([[maybe_unused]] data config) override {
+    return {};
+  }
+
+  [[nodiscard]] const char* name() const override {
+    static const auto name = fmt::format("p{}", Percentile);
+    return name.c_str();
+  };
+
+  [[nodiscard]] caf::expected<std::unique_ptr<aggregation_function>>
+  make_aggregation_function(const type& input_type) const override {
+    constexpr auto q = static_cast<double>(Percentile) / 100.0;
+    if (caf::holds_alternative<list_type>(input_type)) {
+      if (input_type.name() == partial_name)
+        return std::make_unique<quantile_merge_function>(input_type, q, false);
+      if (input_type.name() == duration_partial_name)
+        return std::make_unique<quantile_merge_function>(input_type, q, true);
+    }
+    auto f = [&]<concrete_type Type>(const Type&)
+      -> caf::expected<std::unique_ptr<aggregation_function>> {
+      if constexpr (detail::is_any_v<Type, integer_type, count_type, real_type,
+                                     duration_type>)
+        return std::make_unique<quantile_function<Type>>(input_type, q);
+      else
+        return caf::make_error(ec::invalid_configuration,
+                               fmt::format("{} aggregation function does not "
+                                           "support type {}",
+                                           name(), input_type));
+    };
+    return caf::visit(f, input_type);
+  }
+};
+
+} // namespace
+
+} // namespace vast::plugins::quantile
+
+VAST_REGISTER_PLUGIN(vast::plugins::quantile::plugin<50>)
+VAST_REGISTER_PLUGIN(vast::plugins::quantile::plugin<90>)
+VAST_REGISTER_PLUGIN(vast::plugins::quantile::plugin<95>)
+VAST_REGISTER_PLUGIN(vast::plugins::quantile::plugin<99>)
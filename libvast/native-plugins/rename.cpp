@@ -18,6 +18,9 @@
 
 #include <arrow/table.h>
 
+#include <optional>
+#include <unordered_map>
+
 namespace vast::plugins::rename {
 
 /// The configuration of the rename pipeline operator.
@@ -65,7 +68,7 @@ struct configuration {
   }
 };
 
-class rename_operator : public pipeline_operator {
+class rename_operator : public stateless_pipeline_operator {
 public:
   rename_operator(configuration config) : config_{std::move(config)} {
     // nop
@@ -73,66 +76,89 @@ public:
 
   /// Applies the transformation to an Arrow Record Batch with a corresponding
   /// VAST layout.
-  [[nodiscard]] caf::error
-  add(type layout, std::shared_ptr<arrow::RecordBatch> batch) override {
+  [[nodiscard]] caf::error apply(fused_batch& x) override {
+    auto config = bound_config_.find(x.layout);
+    if (config == bound_config_.end())
+      config
+        = bound_config_.emplace(type{chunk::copy(x.layout)}, bind(x.layout))
+            .first;
+    auto& bound = config->second;
+    auto& layout = x.layout;
+    auto& batch = x.batch;
     // Step 1: Adjust field names.
-    if (!config_.fields.empty()) {
-      auto field_transformations = std::vector<indexed_transformation>{};
-      for (const auto& field : config_.fields) {
-        for (const auto& index :
-             caf::get<record_type>(layout).resolve_key_suffix(field.from,
-                                                              layout.name())) {
-          auto transformation
-            = [&](struct record_type::field old_field,
-                  std::shared_ptr<arrow::Array> array) noexcept
-            -> std::vector<std::pair<struct record_type::field,
-                                     std::shared_ptr<arrow::Array>>> {
-            return {
-              {{field.to, old_field.type}, array},
-            };
-          };
-          field_transformations.push_back({index, std::move(transformation)});
-        }
-      }
-      std::sort(field_transformations.begin(), field_transformations.end());
+    if (!bound.field_transformations.empty())
       std::tie(layout, batch)
-        = transform_columns(layout, batch, field_transformations);
-    }
-    // Step 2: Adjust schema names.
-    if (!config_.schemas.empty()) {
-      const auto schema
-        = std::find_if(config_.schemas.begin(), config_.schemas.end(),
-                       [&](const auto& name_mapping) noexcept {
-                         return name_mapping.from == layout.name();
-                       });
-      if (schema == config_.schemas.end()) {
-        transformed_batches_.emplace_back(std::move(layout), std::move(batch));
-        return caf::none;
+        = transform_columns(layout, batch, bound.field_transformations);
+    // Step 2: Adjust schema names. The renamed layout only depends on the
+    // input layout, so we compute it and its Arrow schema only once.
+    if (bound.schema) {
+      if (!bound.renamed_layout) {
+        auto rename_layout = [&](const concrete_type auto& pruned_layout) {
+          VAST_ASSERT(!layout.has_attributes());
+          return type{*bound.schema, pruned_layout};
+        };
+        bound.renamed_layout = caf::visit(rename_layout, layout);
+        bound.renamed_arrow_schema = bound.renamed_layout->to_arrow_schema();
       }
-      auto rename_layout = [&](const concrete_type auto& pruned_layout) {
-        VAST_ASSERT(!layout.has_attributes());
-        return type{schema->to, pruned_layout};
-      };
-      layout = caf::visit(rename_layout, layout);
-      batch = arrow::RecordBatch::Make(layout.to_arrow_schema(),
+      layout = *bound.renamed_layout;
+      batch = arrow::RecordBatch::Make(bound.renamed_arrow_schema,
                                        batch->num_rows(), batch->columns());
     }
-    // Finally, store the result for later retrieval.
-    transformed_batches_.emplace_back(std::move(layout), std::move(batch));
     return caf::none;
-  } // namespace vast::plugins::rename
-
-  /// Retrieves the result of the transformation.
-  [[nodiscard]] caf::expected<std::vector<pipeline_batch>> finish() override {
-    return std::exchange(transformed_batches_, {});
   }
 
 private:
-  /// Cache for transformed batches.
-  std::vector<pipeline_batch> transformed_batches_ = {};
+  /// The configuration bound to a specific schema.
+  struct bound_configuration {
+    /// The transformations that rename fields.
+    std::vector<indexed_transformation> field_transformations = {};
+
+    /// The new name of the schema, if any.
+    std::optional<std::string> schema = {};
+
+    /// The renamed layout and its Arrow schema, once known.
+    std::optional<type> renamed_layout = {};
+    std::shared_ptr<arrow::Schema> renamed_arrow_schema = {};
+  };
+
+  /// Binds the configuration to a schema.
+  bound_configuration bind(const type& layout) const {
+    auto result = bound_configuration{};
+    for (const auto& field : config_.fields) {
+      for (const auto& index :
+           caf::get<record_type>(layout).resolve_key_suffix(field.from,
+                                                            layout.name())) {
+        auto transformation
+          = [to = field.to](struct record_type::field old_field,
+                            std::shared_ptr<arrow::Array> array) noexcept
+          -> std::vector<std::pair<struct record_type::field,
+                                   std::shared_ptr<arrow::Array>>> {
+          return {
+            {{to, old_field.type}, array},
+          };
+        };
+        result.field_transformations.push_back(
+          {index, std::move(transformation)});
+      }
+    }
+    std::sort(result.field_transformations.begin(),
+              result.field_transformations.end());
+    // Renaming fields keeps the name of the layout.
+    const auto schema
+      = std::find_if(config_.schemas.begin(), config_.schemas.end(),
+                     [&](const auto& name_mapping) noexcept {
+                       return name_mapping.from == layout.name();
+                     });
+    if (schema != config_.schemas.end())
+      result.schema = schema->to;
+    return result;
+  }
 
   /// Step-specific configuration, including the layout name mapping.
   configuration config_ = {};
+
+  /// The configuration bound to a specific schema.
+  std::unordered_map<type, bound_configuration> bound_config_ = {};
 };
 
 // -- plugin ------------------------------------------------------------------
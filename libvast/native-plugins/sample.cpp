@@ -47,6 +47,15 @@ private:
     return std::move(sample_);
   }
 
+  [[nodiscard]] type partial_type() const override {
+    return output_type();
+  }
+
+  [[nodiscard]] caf::error merge(const data_view& partial) override {
+    add(partial);
+    return {};
+  }
+
   data sample_ = {};
 };
 
@@ -13,6 +13,7 @@
 #include <vast/fbs/utils.hpp>
 #include <vast/ids.hpp>
 #include <vast/logger.hpp>
+#include <vast/pipeline_operator.hpp>
 #include <vast/plugin.hpp>
 #include <vast/query_context.hpp>
 #include <vast/segment_store.hpp>
@@ -132,7 +133,7 @@ handle_lookup(Actor& self, const vast::query_context& query_context,
     }
   }
   auto handle_query = detail::overload{
-    [&](const count_query_context& count) {
+    [&](const count_query_context& count) -> caf::error {
       if (count.mode == count_query_context::estimate)
         die("logic error detected");
       for (size_t i = 0; i < slices.size(); ++i) {
@@ -142,21 +143,56 @@ handle_lookup(Actor& self, const vast::query_context& query_context,
         num_hits += result;
         self->send(count.sink, result);
       }
+      return {};
     },
-    [&](const extract_query_context& extract) {
+    [&](const extract_query_context& extract) -> caf::error {
       VAST_ASSERT(slices.size() == checkers.size());
+      // Feed the results into the partial aggregation of the query, if any,
+      // and ship only its results.
+      auto aggregation = std::unique_ptr<pipeline_operator>{};
+      if (extract.aggregation) {
+        auto op = make_partial_pipeline_operator(extract.aggregation->name,
+                                                 extract.aggregation->options);
+        if (op)
+          aggregation = std::move(*op);
+        else
+          VAST_WARN("{} ships events for query {} without partial "
+                    "aggregation: {}",
+                    *self, query_context.id, op.error());
+      }
       for (size_t i = 0; i < slices.size(); ++i) {
         const auto& slice = slices[i];
         const auto& checker = checkers[i];
         auto final_slice = filter(slice, checker, ids);
         if (final_slice) {
+          // With a partial aggregation, the hits are the partial results that
+          // the store ships instead of the matching events.
+          if (aggregation
+              && extract.aggregation->applies_to(
+                final_slice->layout().name())) {
+            if (auto err = aggregation->add(final_slice->layout(),
+                                            to_record_batch(*final_slice)))
+              return err;
+            continue;
+          }
           num_hits += final_slice->rows();
           self->send(extract.sink, *final_slice);
         }
       }
+      if (aggregation) {
+        auto batches = aggregation->finish();
+        if (!batches)
+          return std::move(batches.error());
+        for (auto& [layout, batch] : *batches) {
+          num_hits += batch->num_rows();
+          self->send(extract.sink, table_slice{batch, std::move(layout)});
+        }
+      }
+      return {};
     },
   };
-  caf::visit(handle_query, query_context.cmd);
+  if (auto err = caf::visit(handle_query, query_context.cmd))
+    return err;
   return num_hits;
 }
 
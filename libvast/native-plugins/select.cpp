@@ -19,6 +19,7 @@
 #include <caf/expected.hpp>
 
 #include <algorithm>
+#include <unordered_map>
 #include <utility>
 
 namespace vast::plugins::select {
@@ -45,7 +46,7 @@ struct configuration {
   }
 };
 
-class select_operator : public pipeline_operator {
+class select_operator : public stateless_pipeline_operator {
 public:
   explicit select_operator(configuration config) noexcept
     : config_{std::move(config)} {
@@ -53,37 +54,37 @@ public:
   }
 
   /// Projects an arrow record batch.
-  /// @returns The new layout and the projected record batch.
-  caf::error
-  add(type layout, std::shared_ptr<arrow::RecordBatch> batch) override {
-    VAST_TRACE("select operator adds batch");
-    auto indices = std::vector<offset>{};
-    for (const auto& field : config_.fields)
-      for (auto&& index : caf::get<record_type>(layout).resolve_key_suffix(
-             field, layout.name()))
-        indices.push_back(std::move(index));
-    std::sort(indices.begin(), indices.end());
-    auto [adjusted_layout, adjusted_batch]
-      = select_columns(layout, batch, indices);
-    if (adjusted_layout) {
-      VAST_ASSERT(adjusted_batch);
-      transformed_.emplace_back(std::move(adjusted_layout),
-                                std::move(adjusted_batch));
+  caf::error apply(fused_batch& x) override {
+    VAST_TRACE("select operator applies to batch");
+    auto indices = bound_indices_.find(x.layout);
+    if (indices == bound_indices_.end()) {
+      auto new_indices = std::vector<offset>{};
+      for (const auto& field : config_.fields)
+        for (auto&& index : caf::get<record_type>(x.layout).resolve_key_suffix(
+               field, x.layout.name()))
+          new_indices.push_back(std::move(index));
+      std::sort(new_indices.begin(), new_indices.end());
+      indices = bound_indices_
+                  .emplace(type{chunk::copy(x.layout)},
+                           std::move(new_indices))
+                  .first;
     }
+    if (indices->second.empty()) {
+      x.batch = nullptr;
+      return caf::none;
+    }
+    std::tie(x.layout, x.batch)
+      = select_columns(x.layout, x.batch, indices->second);
+    VAST_ASSERT(!x.layout == !x.batch);
     return caf::none;
   }
 
-  caf::expected<std::vector<pipeline_batch>> finish() override {
-    VAST_TRACE("select operator finished transformation");
-    return std::exchange(transformed_, {});
-  }
-
 private:
-  /// The slices being transformed.
-  std::vector<pipeline_batch> transformed_ = {};
-
   /// The underlying configuration of the transformation.
   configuration config_ = {};
+
+  /// The sorted indices of the selected fields per schema.
+  std::unordered_map<type, std::vector<offset>> bound_indices_ = {};
 };
 
 class plugin final : public virtual pipeline_operator_plugin {
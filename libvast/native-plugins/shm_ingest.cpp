@@ -0,0 +1,48 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <vast/plugin.hpp>
+#include <vast/system/node.hpp>
+#include <vast/system/shm_ingest.hpp>
+
+#include <caf/settings.hpp>
+
+#include <string>
+
+namespace vast::plugins::shm_ingest {
+
+namespace {
+
+class plugin final : public virtual component_plugin {
+public:
+  caf::error initialize(data) override {
+    return caf::none;
+  }
+
+  [[nodiscard]] const char* name() const override {
+    return "shm-ingest";
+  }
+
+  system::component_plugin_actor
+  make_component(system::node_actor::stateful_pointer<system::node_state> node)
+    const override {
+    auto [importer] = node->state.registry.find<system::importer_actor>();
+    auto path = caf::get_or(node->system().config(), "vast.import.shm-socket",
+                            std::string{});
+    return node->spawn(system::shm_ingest,
+                       static_cast<system::stream_sink_actor<table_slice>>(
+                         std::move(importer)),
+                       std::move(path));
+  }
+};
+
+} // namespace
+
+} // namespace vast::plugins::shm_ingest
+
+VAST_REGISTER_PLUGIN(vast::plugins::shm_ingest::plugin)
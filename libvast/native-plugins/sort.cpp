@@ -0,0 +1,1142 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <vast/arrow_table_slice.hpp>
+#include <vast/arrow_table_slice_builder.hpp>
+#include <vast/defaults.hpp>
+#include <vast/detail/narrow.hpp>
+#include <vast/detail/spill.hpp>
+#include <vast/detail/type_traits.hpp>
+#include <vast/error.hpp>
+#include <vast/logger.hpp>
+#include <vast/pipeline.hpp>
+#include <vast/plugin.hpp>
+#include <vast/system/report.hpp>
+#include <vast/type.hpp>
+#include <vast/uuid.hpp>
+
+#include <arrow/array/array_primitive.h>
+#include <arrow/buffer.h>
+#include <arrow/compute/api_vector.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/ipc/writer.h>
+#include <arrow/record_batch.h>
+#include <arrow/util/byte_size.h>
+#include <caf/expected.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cmath>
+#include <compare>
+#include <filesystem>
+#include <functional>
+#include <numeric>
+#include <unordered_map>
+
+namespace vast::plugins::sort {
+
+namespace {
+
+/// The maximum number of rows of an output batch that the operators assemble
+/// from rows of different input batches.
+constexpr auto max_assembled_rows
+  = detail::narrow_cast<int64_t>(defaults::import::table_slice_size);
+
+/// The minimum number of consecutive rows of an input batch that the
+/// operators emit as a zero-copy slice of the input batch rather than copying
+/// them into an assembled output batch.
+constexpr auto min_slice_rows = int64_t{1'024};
+
+/// The number of events that the head operator keeps by default.
+constexpr auto default_limit = count{10};
+
+/// The configuration of the sort and head pipeline operators, for example:
+///
+///   sort:
+///     fields:
+///       - ts
+///       - id.orig_h
+///     order: descending
+///     memory-budget: 512 MiB
+///
+///   head:
+///     limit: 100
+///     fields: ts
+///     order: descending
+///
+struct configuration {
+  /// Create a configuration from the operator configuration.
+  /// @param config The configuration of the pipeline operator.
+  /// @param head Whether the configuration is for the head operator.
+  static caf::expected<configuration> make(const record& config, bool head) {
+    const auto* name = head ? "head" : "sort";
+    auto result = configuration{};
+    if (head)
+      result.limit = default_limit;
+    for (const auto& [key, value] : config) {
+      if (key == "fields") {
+        auto fields = parse_fields(value);
+        if (!fields)
+          return fields.error();
+        result.fields = std::move(*fields);
+        continue;
+      }
+      if (key == "order") {
+        if (const auto* order = caf::get_if<std::string>(&value)) {
+          if (*order == "ascending" || *order == "descending") {
+            result.descending = *order == "descending";
+            continue;
+          }
+        }
+        return caf::make_error(ec::invalid_configuration,
+                               fmt::format("unexpected config key: order {} is "
+                                           "neither 'ascending' nor "
+                                           "'descending'",
+                                           value));
+      }
+      if (head && key == "limit") {
+        if (const auto* limit = caf::get_if<count>(&value)) {
+          result.limit = *limit;
+          continue;
+        }
+        if (const auto* limit = caf::get_if<integer>(&value);
+            limit && limit->value >= 0) {
+          result.limit = limit->value;
+          continue;
+        }
+        return caf::make_error(ec::invalid_configuration,
+                               fmt::format("unexpected config key: limit {} "
+                                           "is not a number of events",
+                                           value));
+      }
+      if (!head && key == "memory-budget") {
+        auto memory_budget = detail::parse_memory_budget(value);
+        if (!memory_budget)
+          return memory_budget.error();
+        result.memory_budget = *memory_budget;
+        continue;
+      }
+      if (!head && key == "spill-directory") {
+        auto spill_directory = detail::parse_spill_directory(value);
+        if (!spill_directory)
+          return spill_directory.error();
+        result.spill_directory = std::move(*spill_directory);
+        continue;
+      }
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("unexpected config key for {} "
+                                         "operator: {}",
+                                         name, key));
+    }
+    if (!head && result.fields.empty())
+      return caf::make_error(ec::invalid_configuration,
+                             "key 'fields' is missing in configuration for "
+                             "sort operator");
+    return result;
+  }
+
+  /// Unresolved extractors for the sort keys, in order of precedence.
+  std::vector<std::string> fields = {};
+
+  /// Whether to sort in descending rather than ascending order.
+  bool descending = false;
+
+  /// The maximum number of events per schema for the head operator.
+  std::optional<count> limit = {};
+
+  /// The optional number of bytes that the sorted runs may use before the
+  /// operator moves them to disk. The budget applies while the operator
+  /// accumulates its input only: the pipeline operator API returns the entire
+  /// sorted output from a single call to finish.
+  std::optional<count> memory_budget = {};
+
+  /// The directory for runs moved to disk. Defaults to the directory for
+  /// temporary files if empty.
+  std::filesystem::path spill_directory = {};
+
+private:
+  /// Parse the unresolved sort key extractors from their configuration.
+  /// @param config The relevant configuration subsection.
+  static caf::expected<std::vector<std::string>>
+  parse_fields(const data& config) {
+    if (const auto* extractor = caf::get_if<std::string>(&config))
+      return std::vector<std::string>{*extractor};
+    if (const auto* extractors = caf::get_if<list>(&config)) {
+      auto result = std::vector<std::string>{};
+      result.reserve(extractors->size());
+      for (const auto& extractor_data : *extractors) {
+        if (const auto* extractor = caf::get_if<std::string>(&extractor_data)) {
+          result.push_back(*extractor);
+          continue;
+        }
+        return caf::make_error(ec::invalid_configuration,
+                               fmt::format("unexpected config key: fields {} "
+                                           "is not a string",
+                                           extractor_data));
+      }
+      return result;
+    }
+    return caf::make_error(ec::invalid_configuration,
+                           fmt::format("unexpected config key: fields {} is "
+                                       "neither a string nor a list of strings",
+                                       config));
+  }
+};
+
+/// Compares two non-null values of the same type.
+using value_comparator
+  = std::weak_ordering (*)(const type&, const arrow::Array&, int64_t,
+                           const arrow::Array&, int64_t) noexcept;
+
+template <concrete_type Type>
+std::weak_ordering
+compare_values(const type& t, const arrow::Array& lhs, int64_t lhs_row,
+               const arrow::Array& rhs, int64_t rhs_row) noexcept {
+  const auto& concrete = caf::get<Type>(t);
+  const auto x = value_at(concrete, lhs, lhs_row);
+  const auto y = value_at(concrete, rhs, rhs_row);
+  // NaN sorts after all other numbers, which keeps the order strict weak.
+  if constexpr (std::is_same_v<Type, real_type>)
+    if (std::isnan(x) || std::isnan(y))
+      return std::isnan(x) <=> std::isnan(y);
+  if (x < y)
+    return std::weak_ordering::less;
+  if (y < x)
+    return std::weak_ordering::greater;
+  return std::weak_ordering::equivalent;
+}
+
+/// The arrays of the sort key columns of a batch.
+using key_columns = arrow::ArrayVector;
+
+/// The sort keys of a schema, in order of precedence. Null values sort last
+/// regardless of the order.
+class sort_keys {
+public:
+  /// Binds the configured sort key extractors to a schema.
+  /// @param schema The schema to bind to.
+  /// @param config The configuration to bind.
+  static sort_keys make(const type& schema, const configuration& config) {
+    auto result = sort_keys{};
+    result.descending_ = config.descending;
+    const auto& schema_rt = caf::get<record_type>(schema);
+    for (const auto& extractor : config.fields) {
+      for (auto index :
+           schema_rt.resolve_key_suffix(extractor, schema.name())) {
+        auto field_type = schema_rt.field(index).type;
+        const auto compare = caf::visit(
+          []<concrete_type Type>(const Type&) noexcept -> value_comparator {
+            return &compare_values<Type>;
+          },
+          field_type);
+        result.keys_.push_back({index, std::move(field_type), compare});
+      }
+    }
+    return result;
+  }
+
+  /// Returns whether no configured field exists in the schema.
+  [[nodiscard]] bool empty() const noexcept {
+    return keys_.empty();
+  }
+
+  /// Selects the arrays of the sort key columns of a batch.
+  [[nodiscard]] key_columns columns(const arrow::RecordBatch& batch) const {
+    auto result = key_columns{};
+    result.reserve(keys_.size());
+    for (const auto& key : keys_)
+      result.push_back(
+        static_cast<arrow::FieldPath>(key.index).Get(batch).ValueOrDie());
+    return result;
+  }
+
+  /// Compares two rows by their sort keys.
+  [[nodiscard]] std::weak_ordering
+  compare(const key_columns& lhs, int64_t lhs_row, const key_columns& rhs,
+          int64_t rhs_row) const noexcept {
+    for (size_t i = 0; i < keys_.size(); ++i) {
+      const auto lhs_null = lhs[i]->IsNull(lhs_row);
+      const auto rhs_null = rhs[i]->IsNull(rhs_row);
+      if (lhs_null || rhs_null) {
+        if (lhs_null != rhs_null)
+          return lhs_null ? std::weak_ordering::greater
+                          : std::weak_ordering::less;
+        continue;
+      }
+      const auto order
+        = keys_[i].compare(keys_[i].type, *lhs[i], lhs_row, *rhs[i], rhs_row);
+      if (order != std::weak_ordering::equivalent)
+        return descending_ ? 0 <=> order : order;
+    }
+    return std::weak_ordering::equivalent;
+  }
+
+  /// Computes the permutation that sorts the rows of a batch stably.
+  /// @returns The row indices in sort order, or an empty vector if the rows
+  /// are sorted already.
+  [[nodiscard]] std::vector<int64_t> sort(const key_columns& columns) const {
+    const auto num_rows = columns.empty() ? 0 : columns.front()->length();
+    auto is_sorted = true;
+    for (int64_t row = 1; row < num_rows && is_sorted; ++row)
+      is_sorted = compare(columns, row - 1, columns, row) <= 0;
+    if (is_sorted)
+      return {};
+    auto result = std::vector<int64_t>(num_rows);
+    std::iota(result.begin(), result.end(), int64_t{0});
+    // A single fixed-width key without nulls is by far the most common case,
+    // e.g., for timestamps. We sort by the raw values for it, which avoids
+    // dispatching on the type for every comparison.
+    if (keys_.size() == 1 && columns.front()->null_count() == 0) {
+      auto sort_by_values = [&]<class Array>(const Array& array) {
+        const auto* values = array.raw_values();
+        if (descending_)
+          std::stable_sort(result.begin(), result.end(),
+                           [&](int64_t lhs, int64_t rhs) {
+                             return values[rhs] < values[lhs];
+                           });
+        else
+          std::stable_sort(result.begin(), result.end(),
+                           [&](int64_t lhs, int64_t rhs) {
+                             return values[lhs] < values[rhs];
+                           });
+      };
+      auto f = [&]<concrete_type Type>(const Type&) {
+        if constexpr (detail::is_any_v<Type, integer_type, count_type,
+                                       duration_type, time_type>) {
+          sort_by_values(
+            caf::get<type_to_arrow_array_t<Type>>(*columns.front()));
+          return true;
+        }
+        return false;
+      };
+      if (caf::visit(f, keys_.front().type))
+        return result;
+    }
+    std::stable_sort(result.begin(), result.end(),
+                     [&](int64_t lhs, int64_t rhs) {
+                       return compare(columns, lhs, columns, rhs) < 0;
+                     });
+    return result;
+  }
+
+private:
+  /// A sort key that was bound to a schema.
+  struct key {
+    offset index = {};              ///< The column of the key.
+    type type = {};                 ///< The type of the column.
+    value_comparator compare = {};  ///< The comparison for the type.
+  };
+
+  std::vector<key> keys_ = {};
+  bool descending_ = false;
+};
+
+/// Assembles consecutive rows of input batches into output batches. Long
+/// ranges of rows pass through as zero-copy slices of their input batch, and
+/// short ranges get copied together so that interleaved inputs do not
+/// fragment the output into tiny batches.
+class batch_assembler {
+public:
+  /// The consumer of the output batches.
+  using sink_type
+    = std::function<caf::error(std::shared_ptr<arrow::RecordBatch>)>;
+
+  batch_assembler(type schema, sink_type sink)
+    : schema_{std::move(schema)}, sink_{std::move(sink)} {
+    for (auto&& field : caf::get<record_type>(schema_).fields())
+      field_types_.emplace_back(field.type);
+  }
+
+  /// Adds a range of rows of a batch to the output.
+  [[nodiscard]] caf::error
+  add(const std::shared_ptr<arrow::RecordBatch>& batch, int64_t offset,
+      int64_t length) {
+    if (length == 0)
+      return {};
+    if (length >= std::min(batch->num_rows(), min_slice_rows)) {
+      if (auto err = flush())
+        return err;
+      if (offset == 0 && length == batch->num_rows())
+        return sink_(batch);
+      return sink_(batch->Slice(offset, length));
+    }
+    if (!builder_) {
+      builder_ = caf::get<record_type>(schema_).make_arrow_builder(
+        arrow::default_memory_pool());
+      VAST_ASSERT(builder_);
+    }
+    auto status = builder_->AppendValues(length, /*valid_bytes*/ nullptr);
+    for (size_t column = 0; column < field_types_.size() && status.ok();
+         ++column) {
+      const auto& array = *batch->column(detail::narrow_cast<int>(column));
+      auto& builder
+        = *builder_->field_builder(detail::narrow_cast<int>(column));
+      for (auto row = offset; row < offset + length && status.ok(); ++row)
+        status = append_builder(field_types_[column], builder,
+                                value_at(field_types_[column], array, row));
+    }
+    if (!status.ok())
+      return caf::make_error(ec::system_error,
+                             fmt::format("failed to append rows: {}",
+                                         status.ToString()));
+    if (builder_->length() >= max_assembled_rows)
+      return flush();
+    return {};
+  }
+
+  /// Emits the rows that were copied so far.
+  [[nodiscard]] caf::error flush() {
+    if (!builder_ || builder_->length() == 0)
+      return {};
+    const auto num_rows = builder_->length();
+    auto array = builder_->Finish();
+    if (!array.ok())
+      return caf::make_error(ec::system_error,
+                             fmt::format("failed to finish: {}",
+                                         array.status().ToString()));
+    return sink_(arrow::RecordBatch::Make(
+      schema_.to_arrow_schema(), num_rows,
+      caf::get<type_to_arrow_array_t<record_type>>(*array.MoveValueUnsafe())
+        .fields()));
+  }
+
+private:
+  type schema_ = {};
+  sink_type sink_ = {};
+  std::vector<type> field_types_ = {};
+  std::shared_ptr<type_to_arrow_builder_t<record_type>> builder_ = {};
+};
+
+/// Statistics about moving runs to disk.
+struct spill_statistics {
+  uint64_t spills = 0; ///< The number of times that runs moved to disk.
+  uint64_t rows = 0;   ///< The number of events moved to disk.
+  uint64_t bytes = 0;  ///< The number of bytes written to disk.
+
+  spill_statistics& operator+=(const spill_statistics& other) noexcept {
+    spills += other.spills;
+    rows += other.rows;
+    bytes += other.bytes;
+    return *this;
+  }
+};
+
+/// A sequence of batches whose concatenation is sorted. A run either lives in
+/// memory, or in an Arrow IPC file, i.e., a Feather V2 file, on disk.
+struct run {
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches = {};
+  std::filesystem::path path = {};
+};
+
+/// Reads the batches of a run one at a time. Runs on disk are memory-mapped,
+/// so the batches read from them reference the pages of the file rather than
+/// buffers on the heap, which the operating system may evict under memory
+/// pressure. The mapping stays valid after the file gets removed.
+class run_reader {
+public:
+  /// Creates a reader for a run that must outlive the reader.
+  static caf::expected<run_reader> make(const run& run) {
+    auto result = run_reader{};
+    result.run_ = &run;
+    if (run.path.empty())
+      return result;
+    auto file = arrow::io::MemoryMappedFile::Open(run.path.string(),
+                                                  arrow::io::FileMode::READ);
+    if (!file.ok())
+      return caf::make_error(ec::filesystem_error,
+                             fmt::format("failed to open {}: {}", run.path,
+                                         file.status().ToString()));
+    auto reader
+      = arrow::ipc::RecordBatchFileReader::Open(file.MoveValueUnsafe());
+    if (!reader.ok())
+      return caf::make_error(ec::filesystem_error,
+                             fmt::format("failed to read {}: {}", run.path,
+                                         reader.status().ToString()));
+    result.reader_ = reader.MoveValueUnsafe();
+    return result;
+  }
+
+  /// Reads the next non-empty batch of the run.
+  /// @returns The batch, or nullptr after the last batch.
+  caf::expected<std::shared_ptr<arrow::RecordBatch>> next() {
+    while (true) {
+      auto batch = std::shared_ptr<arrow::RecordBatch>{};
+      if (!reader_) {
+        if (next_ >= detail::narrow_cast<int>(run_->batches.size()))
+          return nullptr;
+        batch = run_->batches[next_++];
+      } else {
+        if (next_ >= reader_->num_record_batches())
+          return nullptr;
+        auto maybe_batch = reader_->ReadRecordBatch(next_++);
+        if (!maybe_batch.ok())
+          return caf::make_error(ec::filesystem_error,
+                                 fmt::format("failed to read {}: {}",
+                                             run_->path,
+                                             maybe_batch.status().ToString()));
+        batch = maybe_batch.MoveValueUnsafe();
+      }
+      if (batch->num_rows() > 0)
+        return batch;
+    }
+  }
+
+private:
+  const struct run* run_ = {};
+  std::shared_ptr<arrow::ipc::RecordBatchFileReader> reader_ = {};
+  int next_ = 0;
+};
+
+/// Merges sorted runs of the same schema into a single sorted output. Events
+/// that compare equal keep the order of their runs.
+/// @param runs The runs to merge, in the order in which their events arrived.
+/// @param keys The sort keys of the schema.
+/// @param output The assembler for the merged output.
+caf::error merge(const std::vector<run>& runs, const sort_keys& keys,
+                 batch_assembler& output) {
+  struct cursor {
+    run_reader reader;
+    size_t index = {};
+    std::shared_ptr<arrow::RecordBatch> batch = {};
+    key_columns columns = {};
+    int64_t row = {};
+  };
+  auto load = [&](cursor& x) -> caf::error {
+    auto batch = x.reader.next();
+    if (!batch)
+      return std::move(batch.error());
+    x.batch = std::move(*batch);
+    x.columns = x.batch ? keys.columns(*x.batch) : key_columns{};
+    x.row = 0;
+    return {};
+  };
+  auto cursors = std::vector<cursor>{};
+  cursors.reserve(runs.size());
+  for (size_t index = 0; index < runs.size(); ++index) {
+    auto reader = run_reader::make(runs[index]);
+    if (!reader)
+      return std::move(reader.error());
+    cursors.push_back(cursor{std::move(*reader), index});
+    if (auto err = load(cursors.back()))
+      return err;
+  }
+  // Returns whether a row of a cursor comes before the current row of another
+  // cursor in the output.
+  auto precedes
+    = [&](const cursor& lhs, int64_t lhs_row, const cursor& rhs) noexcept {
+        const auto order
+          = keys.compare(lhs.columns, lhs_row, rhs.columns, rhs.row);
+        return order < 0 || (order == 0 && lhs.index < rhs.index);
+      };
+  // The heap has the cursor with the next row in the output at its front.
+  auto after = [&](const cursor* lhs, const cursor* rhs) noexcept {
+    return precedes(*rhs, rhs->row, *lhs);
+  };
+  auto heap = std::vector<cursor*>{};
+  heap.reserve(cursors.size());
+  for (auto& x : cursors)
+    if (x.batch)
+      heap.push_back(&x);
+  std::make_heap(heap.begin(), heap.end(), after);
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end(), after);
+    auto& current = *heap.back();
+    // Emit all rows of the current batch that come before the next row of any
+    // other cursor at once. For runs that do not overlap, e.g., because the
+    // input arrived ordered by time already, this emits entire batches.
+    auto end = current.batch->num_rows();
+    if (heap.size() > 1) {
+      const auto& next = *heap.front();
+      end = current.row + 1;
+      while (end < current.batch->num_rows() && precedes(current, end, next))
+        ++end;
+    }
+    if (auto err = output.add(current.batch, current.row, end - current.row))
+      return err;
+    current.row = end;
+    if (current.row == current.batch->num_rows()) {
+      if (auto err = load(current))
+        return err;
+      if (!current.batch) {
+        heap.pop_back();
+        continue;
+      }
+    }
+    std::push_heap(heap.begin(), heap.end(), after);
+  }
+  return output.flush();
+}
+
+/// Sorts the events of a single schema. Every added batch gets sorted in
+/// memory, and extends the last run if it continues its order, or starts a
+/// new run otherwise. Finishing merges all runs.
+class sorter {
+public:
+  sorter(type schema, sort_keys keys) noexcept
+    : schema_{std::move(schema)}, keys_{std::move(keys)} {
+    // nop
+  }
+
+  /// Adds a batch of the schema.
+  [[nodiscard]] caf::error add(std::shared_ptr<arrow::RecordBatch> batch) {
+    if (batch->num_rows() == 0)
+      return {};
+    auto columns = keys_.columns(*batch);
+    if (auto indices = keys_.sort(columns); !indices.empty()) {
+      const auto indices_array = std::make_shared<arrow::Int64Array>(
+        detail::narrow_cast<int64_t>(indices.size()),
+        arrow::Buffer::Wrap(indices));
+      auto sorted = arrow::compute::Take(batch, indices_array);
+      if (!sorted.ok())
+        return caf::make_error(ec::system_error,
+                               fmt::format("sort operator failed to sort "
+                                           "batch: {}",
+                                           sorted.status().ToString()));
+      batch = sorted.MoveValueUnsafe().record_batch();
+      columns = keys_.columns(*batch);
+    }
+    bytes_ += detail::narrow_cast<size_t>(arrow::util::TotalBufferSize(*batch));
+    if (!runs_.empty() && runs_.back().path.empty()) {
+      const auto& tail = runs_.back().batches.back();
+      if (keys_.compare(keys_.columns(*tail), tail->num_rows() - 1, columns, 0)
+          <= 0) {
+        runs_.back().batches.push_back(std::move(batch));
+        return {};
+      }
+    }
+    runs_.emplace_back().batches.push_back(std::move(batch));
+    return {};
+  }
+
+  /// Merges all runs into the sorted output. Note that the output holds all
+  /// events of the schema: Consecutive rows of a run pass through as slices of
+  /// its batches, which for runs on disk reference the memory-mapped file, and
+  /// interleaved rows of different runs get copied.
+  [[nodiscard]] caf::expected<std::vector<pipeline_batch>> finish() {
+    auto result = std::vector<pipeline_batch>{};
+    auto output = batch_assembler{
+      schema_,
+      [&](std::shared_ptr<arrow::RecordBatch> batch) -> caf::error {
+        result.emplace_back(schema_, std::move(batch));
+        return {};
+      },
+    };
+    auto runs = std::exchange(runs_, {});
+    bytes_ = 0;
+    auto err = merge(runs, keys_, output);
+    remove_files(runs);
+    if (err)
+      return err;
+    return result;
+  }
+
+  /// Moves all runs in memory to disk, merged into a single run.
+  /// @param directory The directory for the file of the run.
+  [[nodiscard]] caf::error spill(const std::filesystem::path& directory) {
+    auto in_memory = std::vector<run>{};
+    auto on_disk = std::vector<run>{};
+    for (auto& run : runs_)
+      (run.path.empty() ? in_memory : on_disk).push_back(std::move(run));
+    runs_ = std::move(on_disk);
+    bytes_ = 0;
+    if (in_memory.empty())
+      return {};
+    auto& spilled = runs_.emplace_back();
+    spilled.path = directory / fmt::format("{}.feather", uuid::random());
+    auto stream = std::shared_ptr<arrow::io::FileOutputStream>{};
+    auto writer = std::shared_ptr<arrow::ipc::RecordBatchWriter>{};
+    auto output = batch_assembler{
+      schema_,
+      [&](std::shared_ptr<arrow::RecordBatch> batch) -> caf::error {
+        if (!writer) {
+          auto maybe_stream
+            = arrow::io::FileOutputStream::Open(spilled.path.string());
+          if (!maybe_stream.ok())
+            return caf::make_error(
+              ec::filesystem_error,
+              fmt::format("failed to open {}: {}", spilled.path,
+                          maybe_stream.status().ToString()));
+          stream = maybe_stream.MoveValueUnsafe();
+          auto maybe_writer
+            = arrow::ipc::MakeFileWriter(stream, batch->schema());
+          if (!maybe_writer.ok())
+            return caf::make_error(
+              ec::filesystem_error,
+              fmt::format("failed to write {}: {}", spilled.path,
+                          maybe_writer.status().ToString()));
+          writer = maybe_writer.MoveValueUnsafe();
+        }
+        if (auto status = writer->WriteRecordBatch(*batch); !status.ok())
+          return caf::make_error(ec::filesystem_error,
+                                 fmt::format("failed to write {}: {}",
+                                             spilled.path, status.ToString()));
+        statistics_.rows += detail::narrow_cast<uint64_t>(batch->num_rows());
+        return {};
+      },
+    };
+    if (auto err = merge(in_memory, keys_, output))
+      return err;
+    if (writer) {
+      auto status = writer->Close();
+      if (status.ok())
+        statistics_.bytes
+          += detail::narrow_cast<uint64_t>(stream->Tell().ValueOr(0));
+      if (status.ok())
+        status = stream->Close();
+      if (!status.ok())
+        return caf::make_error(ec::filesystem_error,
+                               fmt::format("failed to close {}: {}",
+                                           spilled.path, status.ToString()));
+    }
+    ++statistics_.spills;
+    return {};
+  }
+
+  /// Returns the number of bytes of the runs in memory.
+  [[nodiscard]] size_t memusage() const noexcept {
+    return bytes_;
+  }
+
+  /// Returns statistics about moving runs to disk.
+  [[nodiscard]] const spill_statistics& statistics() const noexcept {
+    return statistics_;
+  }
+
+  /// Returns whether the configured fields exist in the schema.
+  [[nodiscard]] bool has_keys() const noexcept {
+    return !keys_.empty();
+  }
+
+private:
+  /// Removes the files of runs that were moved to disk.
+  static void remove_files(const std::vector<run>& runs) noexcept {
+    for (const auto& run : runs) {
+      if (run.path.empty())
+        continue;
+      auto err = std::error_code{};
+      std::filesystem::remove(run.path, err);
+      if (err)
+        VAST_WARN("sort operator failed to remove spilled run {}: {}",
+                  run.path, err.message());
+    }
+  }
+
+  type schema_ = {};
+  sort_keys keys_ = {};
+  std::vector<run> runs_ = {};
+  size_t bytes_ = 0;
+  spill_statistics statistics_ = {};
+};
+
+/// The sort pipeline operator, which sorts the events of every schema by the
+/// configured fields.
+class sort_operator final : public pipeline_operator {
+public:
+  explicit sort_operator(configuration config) noexcept
+    : config_{std::move(config)} {
+    // nop
+  }
+
+  sort_operator(const sort_operator&) = delete;
+  sort_operator& operator=(const sort_operator&) = delete;
+
+  ~sort_operator() noexcept override {
+    sorters_.clear();
+    if (spill_directory_.empty())
+      return;
+    auto err = std::error_code{};
+    std::filesystem::remove_all(spill_directory_, err);
+    if (err)
+      VAST_WARN("sort operator failed to remove spilled runs in {}: {}",
+                spill_directory_, err.message());
+  }
+
+private:
+  /// Signal that the sort operator needs all of its input before it can emit
+  /// any events.
+  [[nodiscard]] bool is_aggregate() const override {
+    return true;
+  }
+
+  [[nodiscard]] caf::error
+  add(type schema, std::shared_ptr<arrow::RecordBatch> batch) override {
+    VAST_ASSERT(schema);
+    VAST_ASSERT(caf::holds_alternative<record_type>(schema));
+    VAST_ASSERT(batch);
+    auto index = indices_.find(schema);
+    if (index == indices_.end()) {
+      auto keys = sort_keys::make(schema, config_);
+      if (keys.empty())
+        VAST_WARN("sort operator does not find fields {} in schema {} and "
+                  "leaves its events in order",
+                  fmt::join(config_.fields, ", "), schema);
+      // Note: We intentionally decouple the lifetime of the type's underlying
+      // chunk here in order to make sure that no data is held alive for the
+      // duration of the pipeline operator's existence.
+      auto decoupled_schema = type{chunk::copy(schema)};
+      sorters_.emplace_back(decoupled_schema, std::move(keys));
+      index = indices_.emplace(std::move(decoupled_schema), sorters_.size() - 1)
+                .first;
+    }
+    if (auto err = sorters_[index->second].add(std::move(batch)))
+      return err;
+    return enforce_memory_budget();
+  }
+
+  /// Retrieves the sorted events of all schemas, in the order in which the
+  /// schemas first occurred.
+  [[nodiscard]] caf::expected<std::vector<pipeline_batch>> finish() override {
+    auto result = std::vector<pipeline_batch>{};
+    for (auto& sorter : sorters_) {
+      auto batches = sorter.finish();
+      if (!batches)
+        return batches.error();
+      result.insert(result.end(), std::make_move_iterator(batches->begin()),
+                    std::make_move_iterator(batches->end()));
+      retired_statistics_ += sorter.statistics();
+    }
+    sorters_.clear();
+    indices_.clear();
+    return result;
+  }
+
+  /// Moves the runs of all schemas to disk if they exceed the memory budget
+  /// together.
+  [[nodiscard]] caf::error enforce_memory_budget() {
+    if (!config_.memory_budget)
+      return {};
+    auto memusage = size_t{0};
+    for (const auto& sorter : sorters_)
+      memusage += sorter.memusage();
+    if (memusage <= *config_.memory_budget)
+      return {};
+    if (spill_directory_.empty()) {
+      auto directory
+        = detail::make_spill_directory(config_.spill_directory, "sort");
+      if (!directory)
+        return directory.error();
+      spill_directory_ = std::move(*directory);
+    }
+    for (auto& sorter : sorters_) {
+      if (sorter.memusage() == 0)
+        continue;
+      VAST_DEBUG("sort operator moves {} bytes of sorted runs to disk",
+                 sorter.memusage());
+      if (auto err = sorter.spill(spill_directory_))
+        return err;
+    }
+    return {};
+  }
+
+  /// Returns statistics about moving runs to disk.
+  [[nodiscard]] std::vector<system::data_point> metrics() const override {
+    auto statistics = retired_statistics_;
+    for (const auto& sorter : sorters_)
+      statistics += sorter.statistics();
+    if (statistics.spills == 0)
+      return {};
+    return {
+      {"sort.spills", statistics.spills},
+      {"sort.spilled-rows", statistics.rows},
+      {"sort.spilled-bytes", statistics.bytes},
+    };
+  }
+
+  /// The underlying configuration of the sort operator.
+  configuration config_ = {};
+
+  /// The sorters for every schema, in the order in which the schemas first
+  /// occurred.
+  std::vector<sorter> sorters_ = {};
+
+  /// The position of the sorter for a schema.
+  std::unordered_map<type, size_t> indices_ = {};
+
+  /// The directory for runs moved to disk, which is created on demand.
+  std::filesystem::path spill_directory_ = {};
+
+  /// Statistics about moving runs to disk of finished sorters.
+  spill_statistics retired_statistics_ = {};
+};
+
+/// Keeps the first events of a single schema in sort order. A bounded max-heap
+/// holds references to the rows that are currently among the first, so that
+/// every other row costs a single comparison with the last of them. The
+/// batches that the heap references get compacted once they hold more than
+/// twice as many rows as the limit.
+class selector {
+public:
+  selector(type schema, sort_keys keys, uint64_t limit) noexcept
+    : schema_{std::move(schema)}, keys_{std::move(keys)}, limit_{limit} {
+    // nop
+  }
+
+  /// Adds a batch of the schema.
+  [[nodiscard]] caf::error add(std::shared_ptr<arrow::RecordBatch> batch) {
+    const auto num_rows = batch->num_rows();
+    if (num_rows == 0 || limit_ == 0)
+      return {};
+    // Without sort keys, the first rows are final once the heap is full.
+    if (keys_.empty() && heap_.size() == limit_)
+      return {};
+    auto columns = keys_.columns(*batch);
+    batches_.push_back({std::move(batch), std::move(columns)});
+    const auto batch_index = batches_.size() - 1;
+    auto used = false;
+    for (int64_t row = 0; row < num_rows; ++row) {
+      auto candidate = entry{batch_index, row, sequence_++};
+      if (heap_.size() < limit_) {
+        heap_.push_back(candidate);
+        std::push_heap(heap_.begin(), heap_.end(), precedes());
+        used = true;
+        continue;
+      }
+      if (!precedes()(candidate, heap_.front()))
+        continue;
+      std::pop_heap(heap_.begin(), heap_.end(), precedes());
+      heap_.back() = candidate;
+      std::push_heap(heap_.begin(), heap_.end(), precedes());
+      used = true;
+    }
+    if (!used) {
+      batches_.pop_back();
+      return {};
+    }
+    retained_rows_ += detail::narrow_cast<uint64_t>(num_rows);
+    if (retained_rows_ > 2 * limit_)
+      return compact();
+    return {};
+  }
+
+  /// Retrieves the first events in sort order.
+  [[nodiscard]] caf::expected<std::vector<pipeline_batch>> finish() {
+    auto result = std::vector<pipeline_batch>{};
+    auto err = assemble(
+      [&](std::shared_ptr<arrow::RecordBatch> batch) -> caf::error {
+        result.emplace_back(schema_, std::move(batch));
+        return {};
+      });
+    if (err)
+      return err;
+    batches_.clear();
+    heap_.clear();
+    retained_rows_ = 0;
+    return result;
+  }
+
+private:
+  /// A reference to a row that is currently among the first.
+  struct entry {
+    size_t batch = {};     ///< The index of the batch of the row.
+    int64_t row = {};      ///< The row in its batch.
+    uint64_t sequence = {}; ///< The position of the row in the input.
+  };
+
+  /// A batch that the heap references, along with its sort key columns.
+  struct retained {
+    std::shared_ptr<arrow::RecordBatch> batch = {};
+    key_columns columns = {};
+  };
+
+  /// Returns the ordering of the heap, which puts the last of the first rows
+  /// at its front.
+  [[nodiscard]] auto precedes() const noexcept {
+    return [this](const entry& lhs, const entry& rhs) noexcept {
+      const auto order
+        = keys_.compare(batches_[lhs.batch].columns, lhs.row,
+                        batches_[rhs.batch].columns, rhs.row);
+      return order < 0 || (order == 0 && lhs.sequence < rhs.sequence);
+    };
+  }
+
+  /// Assembles the referenced rows in sort order.
+  [[nodiscard]] caf::error assemble(batch_assembler::sink_type sink) {
+    auto entries = heap_;
+    std::sort_heap(entries.begin(), entries.end(), precedes());
+    auto output = batch_assembler{schema_, std::move(sink)};
+    for (size_t i = 0; i < entries.size();) {
+      // Copy consecutive rows of the same batch together.
+      auto j = i + 1;
+      while (j < entries.size() && entries[j].batch == entries[i].batch
+             && entries[j].row == entries[j - 1].row + 1)
+        ++j;
+      const auto& batch = batches_[entries[i].batch].batch;
+      if (auto err = output.add(batch, entries[i].row,
+                                detail::narrow_cast<int64_t>(j - i)))
+        return err;
+      i = j;
+    }
+    return output.flush();
+  }
+
+  /// Replaces the referenced batches with batches of just the referenced rows.
+  [[nodiscard]] caf::error compact() {
+    auto sequences = std::vector<uint64_t>{};
+    sequences.reserve(heap_.size());
+    auto entries = heap_;
+    std::sort_heap(entries.begin(), entries.end(), precedes());
+    for (const auto& entry : entries)
+      sequences.push_back(entry.sequence);
+    auto batches = std::vector<retained>{};
+    auto err = assemble(
+      [&](std::shared_ptr<arrow::RecordBatch> batch) -> caf::error {
+        auto columns = keys_.columns(*batch);
+        batches.push_back({std::move(batch), std::move(columns)});
+        return {};
+      });
+    if (err)
+      return err;
+    batches_ = std::move(batches);
+    heap_.clear();
+    retained_rows_ = 0;
+    for (size_t batch_index = 0; batch_index < batches_.size(); ++batch_index) {
+      const auto num_rows = batches_[batch_index].batch->num_rows();
+      for (int64_t row = 0; row < num_rows; ++row)
+        heap_.push_back({batch_index, row, sequences[heap_.size()]});
+      retained_rows_ += detail::narrow_cast<uint64_t>(num_rows);
+    }
+    std::make_heap(heap_.begin(), heap_.end(), precedes());
+    return {};
+  }
+
+  type schema_ = {};
+  sort_keys keys_ = {};
+  uint64_t limit_ = {};
+  std::vector<retained> batches_ = {};
+  std::vector<entry> heap_ = {};
+  uint64_t retained_rows_ = 0;
+  uint64_t sequence_ = 0;
+};
+
+/// The head pipeline operator, which keeps the first events of every schema,
+/// optionally in the order of the configured fields.
+class head_operator final : public pipeline_operator {
+public:
+  explicit head_operator(configuration config) noexcept
+    : config_{std::move(config)} {
+    // nop
+  }
+
+private:
+  /// Signal that the head operator drops events, and may only decide which
+  /// events to keep once it has seen all of its input.
+  [[nodiscard]] bool is_aggregate() const override {
+    return true;
+  }
+
+  [[nodiscard]] caf::error
+  add(type schema, std::shared_ptr<arrow::RecordBatch> batch) override {
+    VAST_ASSERT(schema);
+    VAST_ASSERT(caf::holds_alternative<record_type>(schema));
+    VAST_ASSERT(batch);
+    auto index = indices_.find(schema);
+    if (index == indices_.end()) {
+      auto keys = sort_keys::make(schema, config_);
+      if (keys.empty() && !config_.fields.empty())
+        VAST_WARN("head operator does not find fields {} in schema {} and "
+                  "keeps its first events in order",
+                  fmt::join(config_.fields, ", "), schema);
+      // Note: We intentionally decouple the lifetime of the type's underlying
+      // chunk here in order to make sure that no data is held alive for the
+      // duration of the pipeline operator's existence.
+      auto decoupled_schema = type{chunk::copy(schema)};
+      selectors_.emplace_back(decoupled_schema, std::move(keys),
+                              *config_.limit);
+      index
+        = indices_.emplace(std::move(decoupled_schema), selectors_.size() - 1)
+            .first;
+    }
+    return selectors_[index->second].add(std::move(batch));
+  }
+
+  /// Retrieves the first events of all schemas, in the order in which the
+  /// schemas first occurred.
+  [[nodiscard]] caf::expected<std::vector<pipeline_batch>> finish() override {
+    auto result = std::vector<pipeline_batch>{};
+    for (auto& selector : selectors_) {
+      auto batches = selector.finish();
+      if (!batches)
+        return batches.error();
+      result.insert(result.end(), std::make_move_iterator(batches->begin()),
+                    std::make_move_iterator(batches->end()));
+    }
+    selectors_.clear();
+    indices_.clear();
+    return result;
+  }
+
+  /// The underlying configuration of the head operator.
+  configuration config_ = {};
+
+  /// The selectors for every schema, in the order in which the schemas first
+  /// occurred.
+  std::vector<selector> selectors_ = {};
+
+  /// The position of the selector for a schema.
+  std::unordered_map<type, size_t> indices_ = {};
+};
+
+/// The sort pipeline operator plugin. Stores sort their events before shipping
+/// them, so that the operator only needs to merge the sorted runs.
+class sort_plugin final : public virtual pipeline_operator_plugin {
+public:
+  caf::error initialize([[maybe_unused]] data config) override {
+    return {};
+  }
+
+  [[nodiscard]] const char* name() const override {
+    return "sort";
+  };
+
+  [[nodiscard]] caf::expected<std::unique_ptr<pipeline_operator>>
+  make_pipeline_operator(const record& options) const override {
+    auto config = configuration::make(options, false);
+    if (!config)
+      return config.error();
+    return std::make_unique<sort_operator>(std::move(*config));
+  }
+
+  [[nodiscard]] caf::expected<std::unique_ptr<pipeline_operator>>
+  make_partial_pipeline_operator(const record& options) const override {
+    return make_pipeline_operator(options);
+  }
+};
+
+/// The head pipeline operator plugin. Stores keep only their first events
+/// before shipping them.
+class head_plugin final : public virtual pipeline_operator_plugin {
+public:
+  caf::error initialize([[maybe_unused]] data config) override {
+    return {};
+  }
+
+  [[nodiscard]] const char* name() const override {
+    return "head";
+  };
+
+  [[nodiscard]] caf::expected<std::unique_ptr<pipeline_operator>>
+  make_pipeline_operator(const record& options) const override {
+    auto config = configuration::make(options, true);
+    if (!config)
+      return config.error();
+    return std::make_unique<head_operator>(std::move(*config));
+  }
+
+  [[nodiscard]] caf::expected<std::unique_ptr<pipeline_operator>>
+  make_partial_pipeline_operator(const record& options) const override {
+    return make_pipeline_operator(options);
+  }
+};
+
+} // namespace
+
+} // namespace vast::plugins::sort
+
+VAST_REGISTER_PLUGIN(vast::plugins::sort::sort_plugin)
+VAST_REGISTER_PLUGIN(vast::plugins::sort::head_plugin)
@@ -11,25 +11,39 @@
 #include <vast/arrow_table_slice_builder.hpp>
 #include <vast/concept/convertible/data.hpp>
 #include <vast/concept/convertible/to.hpp>
+#include <vast/detail/spill.hpp>
 #include <vast/error.hpp>
 #include <vast/hash/hash_append.hpp>
+#include <vast/hash/xxhash.hpp>
 #include <vast/pipeline.hpp>
 #include <vast/plugin.hpp>
+#include <vast/system/report.hpp>
 #include <vast/table_slice_builder_factory.hpp>
 #include <vast/type.hpp>
 
+#include <arrow/buffer.h>
 #include <arrow/compute/api_scalar.h>
+#include <arrow/compute/api_vector.h>
+#include <arrow/io/file.h>
+#include <arrow/ipc/reader.h>
+#include <arrow/ipc/writer.h>
 #include <arrow/type.h>
 #include <caf/expected.hpp>
 #include <tsl/robin_map.h>
 
 #include <algorithm>
+#include <array>
+#include <filesystem>
+#include <limits>
 #include <utility>
 
 namespace vast::plugins::summarize {
 
 namespace {
 
+/// The attribute that marks the schemas of partial results.
+constexpr auto partial_attribute = "partial";
+
 /// Converts a duration into the options required for Arrow Compute's
 /// {Round,Floor,Ceil}Temporal functions.
 /// @param time_resolution The multiple to round to.
@@ -47,6 +61,16 @@ make_round_temporal_options(duration time_resolution) noexcept {
   };
 }
 
+/// Rounds a point in time down to a multiple of a duration since the epoch.
+/// @param x The point in time to round.
+/// @param multiple The multiple to round to.
+time round_down(time x, duration multiple) noexcept {
+  auto remainder = x.time_since_epoch() % multiple;
+  if (remainder < duration::zero())
+    remainder += multiple;
+  return x - remainder;
+}
+
 /// The configuration of a summarize pipeline operator, for example:
 ///
 ///   summarize:
@@ -62,6 +86,21 @@ make_round_temporal_options(duration time_resolution) noexcept {
 ///           - net.dst.ip
 ///       max_ts:
 ///         max: :timestamp
+///     memory-budget: 1 GiB
+///
+/// Alternatively, the operator aggregates events into windows of time, and
+/// emits the results for a window once it closes:
+///
+///   summarize:
+///     group-by: proto
+///     window:
+///       field: ts
+///       size: 5 minutes
+///       slide: 1 minute
+///       allowed-lateness: 30 seconds
+///     aggregate:
+///       n:
+///         count: proto
 ///
 struct configuration {
   /// Create a configuration from the operator configuration.
@@ -94,6 +133,27 @@ struct configuration {
         result.aggregations = std::move(*aggregations);
         continue;
       }
+      if (key == "window") {
+        auto window = parse_window(value);
+        if (!window)
+          return window.error();
+        result.window = std::move(*window);
+        continue;
+      }
+      if (key == "memory-budget") {
+        auto memory_budget = detail::parse_memory_budget(value);
+        if (!memory_budget)
+          return memory_budget.error();
+        result.memory_budget = *memory_budget;
+        continue;
+      }
+      if (key == "spill-directory") {
+        auto spill_directory = detail::parse_spill_directory(value);
+        if (!spill_directory)
+          return spill_directory.error();
+        result.spill_directory = std::move(*spill_directory);
+        continue;
+      }
       return caf::make_error(ec::invalid_configuration,
                              fmt::format("unexpected config key: {}", key));
     }
@@ -107,6 +167,14 @@ struct configuration {
     std::string output;                        ///< The output field name.
   };
 
+  /// The configuration of windowed aggregation.
+  struct window_configuration {
+    std::string field;              ///< Unresolved time extractor.
+    duration size = {};             ///< The length of a window.
+    duration slide = {};            ///< The distance between windows.
+    duration allowed_lateness = {}; ///< The delay for closing windows.
+  };
+
   /// Unresolved group-by extractors.
   std::vector<std::string> group_by_extractors = {};
 
@@ -116,6 +184,17 @@ struct configuration {
   /// Configuration for aggregation columns.
   std::vector<aggregation> aggregations = {};
 
+  /// The optional configuration for windowed aggregation.
+  std::optional<window_configuration> window = {};
+
+  /// The optional number of bytes that the groups may use before the
+  /// operator moves them to disk.
+  std::optional<count> memory_budget = {};
+
+  /// The directory for groups moved to disk. Defaults to the directory for
+  /// temporary files if empty.
+  std::filesystem::path spill_directory = {};
+
 private:
   /// Parse the unresolved group-by-extractors from their configuration.
   /// @param config The relevant configuration subsection.
@@ -205,6 +284,69 @@ private:
                                        "{} is not a record",
                                        config));
   }
+
+  /// Parse the windowed aggregation from its configuration.
+  /// @param config The relevant configuration subsection.
+  static caf::expected<window_configuration>
+  parse_window(const data& config) {
+    const auto* window_config = caf::get_if<record>(&config);
+    if (!window_config)
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("unexpected config key: window {} "
+                                         "is not a record",
+                                         config));
+    auto result = window_configuration{};
+    auto slide = std::optional<duration>{};
+    for (const auto& [key, value] : *window_config) {
+      if (key == "field") {
+        if (const auto* field = caf::get_if<std::string>(&value)) {
+          result.field = *field;
+          continue;
+        }
+        return caf::make_error(ec::invalid_configuration,
+                               fmt::format("unexpected config key: window "
+                                           "field {} is not a string",
+                                           value));
+      }
+      const auto* value_duration = caf::get_if<duration>(&value);
+      if (key == "size" || key == "slide" || key == "allowed-lateness") {
+        if (!value_duration)
+          return caf::make_error(ec::invalid_configuration,
+                                 fmt::format("unexpected config key: window "
+                                             "{} {} is not a duration",
+                                             key, value));
+        if (key == "size")
+          result.size = *value_duration;
+        else if (key == "slide")
+          slide = *value_duration;
+        else
+          result.allowed_lateness = *value_duration;
+        continue;
+      }
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("unexpected config key: window {}",
+                                         key));
+    }
+    result.slide = slide.value_or(result.size);
+    if (result.field.empty())
+      return caf::make_error(ec::invalid_configuration,
+                             "unexpected config key: window field is "
+                             "missing");
+    if (result.size <= duration::zero() || result.slide <= duration::zero())
+      return caf::make_error(ec::invalid_configuration,
+                             "unexpected config key: window size and slide "
+                             "must be positive");
+    if (result.size % result.slide != duration::zero())
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("unexpected config key: window size "
+                                         "{} is not a multiple of slide {}",
+                                         result.size, result.slide));
+    if (result.allowed_lateness < duration::zero())
+      return caf::make_error(ec::invalid_configuration,
+                             "unexpected config key: window allowed-lateness "
+                             "must not be negative");
+    return result;
+  }
 };
 
 /// A group-by column that was bound to a given schema.
@@ -232,7 +374,7 @@ struct group_by_column {
         column.type = field.type;
       }
     }
-    if (result.empty())
+    if (result.empty() && !config.window)
       return caf::make_error(ec::invalid_configuration,
                              fmt::format("group-by extractors {} did not "
                                          "resolve for schema {}",
@@ -243,6 +385,76 @@ struct group_by_column {
                 return lhs.input < rhs.input;
               });
     result.erase(std::unique(result.begin(), result.end()), result.end());
+    if (config.window) {
+      // The window column always comes first, and replaces a group-by column
+      // for the same field.
+      auto window_column = make_window(schema, *config.window);
+      if (!window_column)
+        return window_column.error();
+      std::erase(result, *window_column);
+      result.insert(result.begin(), std::move(*window_column));
+    }
+    return result;
+  }
+
+  /// Creates the group-by column that holds the start of the window that rows
+  /// are aggregated into.
+  /// @param schema The schema to bind to.
+  /// @param window The configuration of the windowed aggregation.
+  static caf::expected<group_by_column>
+  make_window(const type& schema,
+              const configuration::window_configuration& window) {
+    const auto& schema_rt = caf::get<record_type>(schema);
+    auto offsets = std::vector<offset>{};
+    for (auto offset :
+         schema_rt.resolve_key_suffix(window.field, schema.name()))
+      offsets.push_back(std::move(offset));
+    if (offsets.size() != 1)
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("window field {} must resolve to "
+                                         "exactly one field for schema {}",
+                                         window.field, schema));
+    auto field = schema_rt.field(offsets.front());
+    if (!caf::holds_alternative<time_type>(field.type))
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("window field {} is not of type "
+                                         "time for schema {}",
+                                         window.field, schema));
+    auto result = group_by_column{};
+    result.input = std::move(offsets.front());
+    result.name = schema_rt.key(result.input);
+    result.type = field.type;
+    return result;
+  }
+
+  /// Creates a set of group-by columns by binding the configuration to the
+  /// schema of partial results, whose group-by columns are all fields that do
+  /// not hold aggregation results.
+  /// @param schema The schema of partial results to bind to.
+  /// @param config The configuration to bind.
+  static caf::expected<std::vector<group_by_column>>
+  make_merge(const type& schema, const configuration& config) {
+    auto result = std::vector<group_by_column>{};
+    const auto& schema_rt = caf::get<record_type>(schema);
+    for (size_t i = 0; const auto& field : schema_rt.fields()) {
+      const auto input = offset{i++};
+      const auto is_aggregation = std::any_of(
+        config.aggregations.begin(), config.aggregations.end(),
+        [&](const configuration::aggregation& aggregation) noexcept {
+          return aggregation.output == field.name;
+        });
+      if (is_aggregation)
+        continue;
+      auto& column = result.emplace_back();
+      column.input = input;
+      column.name = std::string{field.name};
+      column.type = field.type;
+    }
+    if (result.empty())
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("partial results {} have no "
+                                         "group-by columns",
+                                         schema));
     return result;
   }
 
@@ -340,6 +552,50 @@ struct aggregation_column {
       column.input_type = std::move(input_type);
       column.output_name = aggregation.output;
       column.output_type = std::move(output_type);
+      column.partial_type = (*instance)->partial_type();
+    }
+    return result;
+  }
+
+  /// Creates a set of aggregation columns by binding the configuration to the
+  /// schema of partial results. The aggregation functions are created for the
+  /// partial types as input types, and merge the partial states.
+  /// @param schema The schema of partial results to bind to.
+  /// @param config The configuration to bind.
+  static caf::expected<std::vector<aggregation_column>>
+  make_merge(const type& schema, const configuration& config) {
+    auto result = std::vector<aggregation_column>{};
+    const auto& schema_rt = caf::get<record_type>(schema);
+    for (const auto& aggregation : config.aggregations) {
+      for (size_t i = 0; const auto& field : schema_rt.fields()) {
+        const auto input = offset{i++};
+        if (field.name != aggregation.output)
+          continue;
+        const auto* aggregation_function
+          = plugins::find<aggregation_function_plugin>(
+            aggregation.function_name);
+        if (!aggregation_function)
+          return caf::make_error(ec::invalid_configuration,
+                                 fmt::format("unknown aggregation function {}",
+                                             aggregation.function_name));
+        auto instance
+          = aggregation_function->make_aggregation_function(field.type);
+        if (!instance)
+          return caf::make_error(ec::invalid_configuration,
+                                 fmt::format("aggregation function {} failed "
+                                             "to instantiate for partial type "
+                                             "{}: {}",
+                                             aggregation.function_name,
+                                             field.type, instance.error()));
+        auto& column = result.emplace_back();
+        column.function_name = aggregation.function_name;
+        column.inputs = {input};
+        column.input_type = field.type;
+        column.output_name = aggregation.output;
+        column.output_type = (*instance)->output_type();
+        column.partial_type = field.type;
+        break;
+      }
     }
     return result;
   }
@@ -358,77 +614,179 @@ struct aggregation_column {
 
   /// The output field's type.
   class type output_type = {};
+
+  /// The type of the partial state, or the null type if the aggregation
+  /// function does not support partial aggregation.
+  class type partial_type = {};
 };
 
 /// The key by which aggregations are grouped. Essentially, this is a vector of
-/// data. We create a new type here to support a custom hash and equality
-/// operation to support lookups with non-materialized keys.
+/// data.
 struct group_by_key : std::vector<data> {
   using vector::vector;
 };
 
-/// A view on a group-by key.
-struct group_by_key_view : std::vector<data_view> {
-  using vector::vector;
+/// Statistics about moving groups to disk.
+struct spill_statistics {
+  uint64_t spills = 0; ///< The number of times that groups moved to disk.
+  uint64_t rows = 0;   ///< The number of groups moved to disk.
+  uint64_t bytes = 0;  ///< The number of bytes written to disk.
 
-  /// Materializes a view on a group-by key.
-  /// @param views The group-by key view to materialize.
-  friend group_by_key materialize(const group_by_key_view& views) {
-    auto result = group_by_key{};
-    result.reserve(views.size());
-    for (const auto& view : views)
-      result.push_back(materialize(view));
-    return result;
+  spill_statistics& operator+=(const spill_statistics& other) noexcept {
+    spills += other.spills;
+    rows += other.rows;
+    bytes += other.bytes;
+    return *this;
   }
 };
 
-/// The hash functor for enabling use of *group_by_key* as a key in unordered
-/// map data structures with transparent lookup.
-struct group_by_key_hash {
-  size_t operator()(const group_by_key& x) const noexcept {
-    auto hasher = xxh64{};
-    for (const auto& value : x)
-      hash_append(hasher, make_view(value));
-    return hasher.finish();
+/// The partitions of partial results that an aggregation moved to disk. Every
+/// partition is an Arrow IPC file, i.e., a Feather V2 file, that is removed
+/// together with its directory once the state is destroyed.
+///
+/// A partition that does not fit into the memory budget when merging it gets
+/// split into partitions of its own at the next level. Every level partitions
+/// by the next bits of the hash of the group-by values.
+struct spill_state {
+  /// The number of bits of the hash that select the partition of a group.
+  static constexpr auto partition_bits = size_t{4};
+
+  /// The number of partitions to split the groups into.
+  static constexpr auto num_partitions = size_t{1} << partition_bits;
+
+  /// The number of levels after which the hash has no bits left to split by.
+  static constexpr auto max_levels = 64 / partition_bits;
+
+  spill_state(std::filesystem::path directory, configuration config,
+              size_t level)
+    : directory{std::move(directory)}, config{std::move(config)}, level{level} {
+    VAST_ASSERT(level < max_levels);
   }
 
-  size_t operator()(const group_by_key_view& x) const noexcept {
-    auto hasher = xxh64{};
-    for (const auto& value : x)
-      hash_append(hasher, value);
-    return hasher.finish();
+  spill_state(const spill_state&) = delete;
+  spill_state& operator=(const spill_state&) = delete;
+
+  ~spill_state() noexcept {
+    static_cast<void>(close());
+    auto err = std::error_code{};
+    std::filesystem::remove_all(directory, err);
+    if (err)
+      VAST_WARN("summarize operator failed to remove spilled partitions in "
+                "{}: {}",
+                directory, err.message());
   }
-};
 
-/// The equality functor for enabling use of *group_by_key* as a key in
-/// unordered map data structures with transparent lookup.
-struct group_by_key_equal {
-  using is_transparent = void;
+  /// Returns the partition of a group.
+  /// @param hash The hash of the group-by values of the group.
+  [[nodiscard]] size_t partition(uint64_t hash) const noexcept {
+    return (hash >> (level * partition_bits)) % num_partitions;
+  }
 
-  bool
-  operator()(const group_by_key_view& x, const group_by_key& y) const noexcept {
-    return std::equal(x.begin(), x.end(), y.begin(), y.end(),
-                      [](const auto& lhs, const auto& rhs) {
-                        return lhs == make_view(rhs);
-                      });
+  /// Returns the path of a partition.
+  [[nodiscard]] std::filesystem::path path(size_t partition) const {
+    return directory / fmt::format("{}.feather", partition);
   }
 
-  bool
-  operator()(const group_by_key& x, const group_by_key_view& y) const noexcept {
-    return std::equal(x.begin(), x.end(), y.begin(), y.end(),
-                      [](const auto& lhs, const auto& rhs) {
-                        return make_view(lhs) == rhs;
-                      });
+  /// Appends a batch to a partition.
+  /// @returns The number of bytes written.
+  [[nodiscard]] caf::expected<uint64_t>
+  write(size_t partition, const arrow::RecordBatch& batch) {
+    VAST_ASSERT(partition < num_partitions);
+    auto& [stream, writer] = files[partition];
+    if (!writer) {
+      auto maybe_stream = arrow::io::FileOutputStream::Open(
+        path(partition).string());
+      if (!maybe_stream.ok())
+        return caf::make_error(ec::filesystem_error,
+                               fmt::format("failed to open {}: {}",
+                                           path(partition),
+                                           maybe_stream.status().ToString()));
+      stream = maybe_stream.MoveValueUnsafe();
+      auto maybe_writer = arrow::ipc::MakeFileWriter(stream, batch.schema());
+      if (!maybe_writer.ok())
+        return caf::make_error(ec::filesystem_error,
+                               fmt::format("failed to write {}: {}",
+                                           path(partition),
+                                           maybe_writer.status().ToString()));
+      writer = maybe_writer.MoveValueUnsafe();
+    }
+    const auto begin = stream->Tell().ValueOr(0);
+    if (auto status = writer->WriteRecordBatch(batch); !status.ok())
+      return caf::make_error(ec::filesystem_error,
+                             fmt::format("failed to write {}: {}",
+                                         path(partition), status.ToString()));
+    return detail::narrow_cast<uint64_t>(stream->Tell().ValueOr(begin)
+                                         - begin);
   }
 
-  bool operator()(const group_by_key& x, const group_by_key& y) const noexcept {
-    return x == y;
+  /// Closes all partitions for writing.
+  [[nodiscard]] caf::error close() {
+    for (size_t partition = 0; auto& [stream, writer] : files) {
+      if (writer) {
+        auto status = writer->Close();
+        if (status.ok())
+          status = stream->Close();
+        writer = nullptr;
+        stream = nullptr;
+        if (!status.ok())
+          return caf::make_error(ec::filesystem_error,
+                                 fmt::format("failed to close {}: {}",
+                                             path(partition),
+                                             status.ToString()));
+      }
+      ++partition;
+    }
+    return {};
   }
 
-  bool operator()(const group_by_key_view& x,
-                  const group_by_key_view& y) const noexcept {
-    return x == y;
+  /// Reads the batches of a partition one at a time.
+  /// @param partition The partition to read.
+  /// @param f The callback to invoke with every batch.
+  template <class F>
+  [[nodiscard]] caf::error read(size_t partition, F f) const {
+    if (!std::filesystem::exists(path(partition)))
+      return {};
+    auto file = arrow::io::ReadableFile::Open(path(partition).string());
+    if (!file.ok())
+      return caf::make_error(ec::filesystem_error,
+                             fmt::format("failed to open {}: {}",
+                                         path(partition),
+                                         file.status().ToString()));
+    auto reader
+      = arrow::ipc::RecordBatchFileReader::Open(file.MoveValueUnsafe());
+    if (!reader.ok())
+      return caf::make_error(ec::filesystem_error,
+                             fmt::format("failed to read {}: {}",
+                                         path(partition),
+                                         reader.status().ToString()));
+    for (int i = 0; i < (*reader)->num_record_batches(); ++i) {
+      auto batch = (*reader)->ReadRecordBatch(i);
+      if (!batch.ok())
+        return caf::make_error(ec::filesystem_error,
+                               fmt::format("failed to read {}: {}",
+                                           path(partition),
+                                           batch.status().ToString()));
+      if (auto err = f(batch.MoveValueUnsafe()))
+        return err;
+    }
+    return {};
   }
+
+  /// The directory that holds the partitions.
+  std::filesystem::path directory = {};
+
+  /// The configuration of the summarize pipeline operator, which is required
+  /// for merging the partitions.
+  configuration config = {};
+
+  /// The number of times that the groups were partitioned before.
+  size_t level = 0;
+
+  /// The open files for every partition.
+  std::array<std::pair<std::shared_ptr<arrow::io::FileOutputStream>,
+                       std::shared_ptr<arrow::ipc::RecordBatchWriter>>,
+             num_partitions>
+    files = {};
 };
 
 /// A configured aggregation that is bound to a single schema.
@@ -452,146 +810,322 @@ public:
     auto result = aggregation{};
     result.group_by_columns = std::move(*group_by_columns);
     result.aggregation_columns = std::move(*aggregation_columns);
-    result.output_schema = [&]() noexcept -> type {
-      auto fields = std::vector<record_type::field_view>{};
-      fields.reserve(result.group_by_columns.size()
-                     + result.aggregation_columns.size());
-      for (const auto& column : result.group_by_columns)
-        fields.emplace_back(column.name, column.type);
-      for (const auto& column : result.aggregation_columns)
-        fields.emplace_back(column.output_name, column.output_type);
-      return {schema.name(), record_type{fields}};
-    }();
+    result.window = config.window;
+    result.output_schema = result.make_output_schema(schema.name());
+    const auto partial = std::all_of(
+      result.aggregation_columns.begin(), result.aggregation_columns.end(),
+      [](const aggregation_column& column) noexcept {
+        return static_cast<bool>(column.partial_type);
+      });
+    if (partial)
+      result.partial_schema = result.make_partial_schema(schema.name());
+    return result;
+  }
+
+  /// Create an aggregation that merges partial results by binding the
+  /// summarize pipeline operator configuration to the schema of partial
+  /// results.
+  [[nodiscard]] static caf::expected<aggregation>
+  make_merge(const type& schema, const configuration& config) noexcept {
+    auto group_by_columns = group_by_column::make_merge(schema, config);
+    if (!group_by_columns)
+      return group_by_columns.error();
+    auto aggregation_columns = aggregation_column::make_merge(schema, config);
+    if (!aggregation_columns)
+      return aggregation_columns.error();
+    auto result = aggregation{};
+    result.group_by_columns = std::move(*group_by_columns);
+    result.aggregation_columns = std::move(*aggregation_columns);
+    result.output_schema = result.make_output_schema(schema.name());
+    result.partial_schema = schema;
+    result.merge = true;
     return result;
   }
 
+  /// Checks whether a schema describes partial results.
+  [[nodiscard]] static bool is_partial(const type& schema) noexcept {
+    return schema.attribute(partial_attribute).has_value();
+  }
+
+  /// Return the schema of the partial results, or the null type if the
+  /// aggregation does not support partial aggregation.
+  [[nodiscard]] const type& partial() const noexcept {
+    return partial_schema;
+  }
+
   /// Aggregate a batch.
   /// @param batch The record batch to aggregate. Must exactly match the
   /// configured schema.
-  void add(const std::shared_ptr<arrow::RecordBatch>& batch) {
+  [[nodiscard]] caf::error
+  add(const std::shared_ptr<arrow::RecordBatch>& batch) {
     VAST_ASSERT(batch);
+    VAST_ASSERT(batch->num_rows() > 0);
+    auto num_rows = detail::narrow_cast<size_t>(batch->num_rows());
     // Determine the inputs only once ahead of time.
-    const auto group_by_arrays = make_group_by_arrays(*batch);
-    const auto aggregation_arrays = make_aggregation_arrays(*batch);
-    // Helper lambda for updating a bucket.
-    const auto update_bucket = [&](bucket& bucket, int offset,
-                                   int length) noexcept {
-      VAST_ASSERT(length > 0);
-      if (length == 1) {
-        for (size_t column = 0; column < aggregation_columns.size(); ++column) {
-          for (const auto& array : aggregation_arrays[column])
-            bucket[column]->add(
-              value_at(aggregation_columns[column].input_type, *array, offset));
-        }
-      } else {
-        for (size_t column = 0; column < aggregation_columns.size(); ++column) {
-          for (const auto& array : aggregation_arrays[column])
-            bucket[column]->add(*array->Slice(offset, length));
+    auto group_by_arrays = make_group_by_arrays(*batch);
+    auto aggregation_arrays = make_aggregation_arrays(*batch);
+    // For windowed aggregations, every row contributes to each window that it
+    // falls into, except for the windows that were emitted already.
+    auto window_starts = std::vector<time>{};
+    if (window) {
+      auto indices = std::vector<uint32_t>{};
+      assign_windows(*group_by_arrays.front(), indices, window_starts);
+      if (indices.empty())
+        return {};
+      // The indices are ascending, so they select all rows exactly once if
+      // there are as many as rows and none of them repeats.
+      if (indices.size() != num_rows
+          || std::adjacent_find(indices.begin(), indices.end())
+               != indices.end()) {
+        num_rows = indices.size();
+        const auto indices_array = arrow::UInt32Array{
+          detail::narrow_cast<int64_t>(num_rows), arrow::Buffer::Wrap(indices)};
+        for (size_t column = 1; column < group_by_arrays.size(); ++column)
+          group_by_arrays[column]
+            = arrow::compute::Take(*group_by_arrays[column], indices_array)
+                .ValueOrDie();
+        for (auto& arrays : aggregation_arrays)
+          for (auto& array : arrays)
+            array = arrow::compute::Take(*array, indices_array).ValueOrDie();
+      }
+    }
+    // Decode and hash the group-by columns one column at a time, so that we
+    // dispatch on the column type once per batch rather than once per cell.
+    auto keys = std::vector<std::vector<data_view>>{};
+    keys.reserve(group_by_columns.size());
+    auto hashes = std::vector<uint64_t>(num_rows, 0);
+    for (size_t column = 0; column < group_by_columns.size(); ++column) {
+      auto& column_keys = keys.emplace_back();
+      column_keys.reserve(num_rows);
+      if (column == 0 && window) {
+        for (size_t row = 0; row < num_rows; ++row) {
+          auto value = data_view{window_starts[row]};
+          auto hasher = xxh64{hashes[row]};
+          hash_append(hasher, value);
+          hashes[row] = hasher.finish();
+          column_keys.push_back(std::move(value));
         }
+        continue;
       }
-    };
-    // A key view used to determine the bucket for the current row.
-    auto reusable_key_view = group_by_key_view{};
-    reusable_key_view.resize(group_by_columns.size(), {});
-    // Helper lambda for finding a bucket, or creating a new one lazily.
-    const auto find_or_create_bucket = [&](int row) -> bucket* {
-      for (size_t column = 0; column < group_by_columns.size(); ++column)
-        reusable_key_view[column] = value_at(group_by_columns[column].type,
-                                             *group_by_arrays[column], row);
-      if (auto bucket = buckets.find(reusable_key_view);
-          bucket != buckets.end())
-        return bucket.value().get();
-      auto new_bucket = std::make_shared<bucket>();
-      new_bucket->reserve(aggregation_columns.size());
-      for (const auto& column : aggregation_columns) {
-        auto function
-          = plugins::find<aggregation_function_plugin>(column.function_name)
-              ->make_aggregation_function(column.input_type);
-        // We check whether it's possible to create the aggregation function for
-        // the column's input type ahead of time, so there's no need to check
-        // again here.
-        VAST_ASSERT(function);
-        new_bucket->push_back(std::move(*function));
+      for (size_t row = 0;
+           auto&& value :
+           values(group_by_columns[column].type, *group_by_arrays[column])) {
+        auto hasher = xxh64{hashes[row]};
+        hash_append(hasher, value);
+        hashes[row] = hasher.finish();
+        column_keys.push_back(std::move(value));
+        ++row;
       }
-      auto [it, inserted] = buckets.emplace(materialize(reusable_key_view),
-                                            std::move(new_bucket));
-      VAST_ASSERT(inserted);
-      return it.value().get();
-    };
-    // Iterate over all rows of the batch, and determine a sliding window of
-    // rows beloging to the same batch as large as possible, and then update the
-    // corresponding bucket.
-    auto first_row = 0;
-    auto* first_bucket = find_or_create_bucket(first_row);
-    VAST_ASSERT(batch->num_rows() > 0);
-    for (auto row = 1; row < batch->num_rows(); ++row) {
-      auto* bucket = find_or_create_bucket(row);
-      if (bucket == first_bucket)
-        continue;
-      update_bucket(*first_bucket, first_row, row - first_row);
-      first_row = row;
-      first_bucket = bucket;
     }
-    update_bucket(*first_bucket, first_row,
-                  detail::narrow_cast<int>(batch->num_rows()) - first_row);
+    // Assign every row a group id, and number the groups of this batch in the
+    // order of their first appearance.
+    auto row_groups = std::vector<uint32_t>(num_rows);
+    auto batch_groups = std::vector<uint32_t>{};
+    auto batch_group_sizes = std::vector<uint32_t>{};
+    for (size_t row = 0; row < num_rows; ++row) {
+      const auto id = find_or_create_group(keys, row, hashes[row]);
+      auto& state = groups[id];
+      if (state.batch_group == no_group) {
+        state.batch_group = detail::narrow_cast<uint32_t>(batch_groups.size());
+        batch_groups.push_back(id);
+        batch_group_sizes.push_back(0);
+      }
+      row_groups[row] = state.batch_group;
+      ++batch_group_sizes[state.batch_group];
+    }
+    for (auto id : batch_groups)
+      groups[id].batch_group = no_group;
+    // If all rows belong to the same group we can pass the arrays unchanged.
+    if (batch_groups.size() == 1) {
+      auto& functions = groups[batch_groups.front()].functions;
+      for (size_t column = 0; column < aggregation_columns.size(); ++column)
+        for (const auto& array : aggregation_arrays[column])
+          if (auto err = add(column, *functions[column], *array))
+            return err;
+      update_memusage(batch_groups);
+      return {};
+    }
+    // Otherwise, order the rows by group with a counting sort, and gather the
+    // aggregation columns in that order so that every group's rows form a
+    // contiguous slice.
+    auto group_offsets = std::vector<uint32_t>(batch_groups.size() + 1, 0);
+    for (size_t i = 0; i < batch_groups.size(); ++i)
+      group_offsets[i + 1] = group_offsets[i] + batch_group_sizes[i];
+    auto indices = std::vector<uint32_t>(num_rows);
+    {
+      auto next = group_offsets;
+      for (size_t row = 0; row < num_rows; ++row)
+        indices[next[row_groups[row]]++] = detail::narrow_cast<uint32_t>(row);
+    }
+    const auto indices_array = arrow::UInt32Array{
+      detail::narrow_cast<int64_t>(num_rows), arrow::Buffer::Wrap(indices)};
+    for (size_t column = 0; column < aggregation_columns.size(); ++column) {
+      for (const auto& array : aggregation_arrays[column]) {
+        const auto sorted
+          = arrow::compute::Take(*array, indices_array).ValueOrDie();
+        for (size_t i = 0; i < batch_groups.size(); ++i) {
+          auto& function = *groups[batch_groups[i]].functions[column];
+          const auto offset = detail::narrow_cast<int64_t>(group_offsets[i]);
+          const auto length = batch_group_sizes[i];
+          if (auto err = add(column, function, *sorted->Slice(offset, length)))
+            return err;
+        }
+      }
+    }
+    update_memusage(batch_groups);
+    return {};
+  }
+
+  /// Finish the buckets into new batches.
+  /// @param all Whether to finish windows that are still open.
+  [[nodiscard]] caf::expected<std::vector<pipeline_batch>>
+  finish(bool all = true) {
+    if (spill_)
+      return finish_spilled(false);
+    auto batch = finish(output_schema, false, all);
+    if (!batch)
+      return batch.error();
+    return std::vector{std::move(*batch)};
+  }
+
+  /// Finish the buckets into new batches of partial results.
+  /// @pre *partial()* must not be the null type.
+  [[nodiscard]] caf::expected<std::vector<pipeline_batch>> save() {
+    VAST_ASSERT(partial_schema);
+    if (spill_)
+      return finish_spilled(true);
+    auto batch = finish(partial_schema, true, true);
+    if (!batch)
+      return batch.error();
+    return std::vector{std::move(*batch)};
+  }
+
+  /// Return an estimate of the memory that the groups use, in bytes.
+  [[nodiscard]] size_t memusage() const noexcept {
+    return memusage_;
+  }
+
+  /// Checks whether the aggregation can move its groups to disk, which
+  /// requires partial aggregation. Windowed aggregations never spill, as they
+  /// release their groups when windows close. Aggregations that merge a
+  /// spilled partition can only split it further while the hash has bits
+  /// left.
+  [[nodiscard]] bool can_spill() const noexcept {
+    return partial_schema && !window && spill_level_ < spill_state::max_levels;
+  }
+
+  /// Return the statistics about moving groups to disk.
+  [[nodiscard]] const spill_statistics& statistics() const noexcept {
+    return statistics_;
   }
 
+  /// Moves the groups to disk as partial results, partitioned by the hash of
+  /// their group-by values, so that finishing the aggregation can merge one
+  /// partition at a time.
+  /// @param config The configuration of the summarize pipeline operator.
+  /// @pre *can_spill()* must be true.
+  [[nodiscard]] caf::error spill(const configuration& config);
+
+private:
   /// Finish the buckets into a new batch.
-  [[nodiscard]] caf::expected<pipeline_batch> finish() {
-    auto builder = caf::get<record_type>(output_schema)
-                     .make_arrow_builder(arrow::default_memory_pool());
-    VAST_ASSERT(builder);
-    const auto num_rows = detail::narrow_cast<int>(buckets.size());
-    const auto reserve_status = builder->Reserve(num_rows);
-    if (!reserve_status.ok())
-      return caf::make_error(ec::system_error,
-                             fmt::format("failed to reserve: {}",
-                                         reserve_status.ToString()));
-    for (auto [key, bucket] : std::exchange(buckets, {})) {
-      const auto append_row_status = builder->Append();
-      if (!append_row_status.ok())
-        return caf::make_error(ec::system_error,
-                               fmt::format("failed to append row: {}",
-                                           append_row_status.ToString()));
-      for (size_t column = 0; column < key.size(); ++column) {
-        const auto append_status = append_builder(
-          group_by_columns[column].type,
-          *builder->field_builder(detail::narrow_cast<int>(column)),
-          make_data_view(key[column]));
-        if (!append_status.ok())
-          return caf::make_error(ec::system_error,
-                                 fmt::format("failed to append grouped {}: {}",
-                                             key[column],
-                                             append_status.ToString()));
-      }
-      for (size_t column = 0; column < bucket->size(); ++column) {
-        auto value = std::move(*(*bucket)[column]).finish();
-        if (!value)
-          return value.error();
-        const auto append_status
-          = append_builder(aggregation_columns[column].output_type,
-                           *builder->field_builder(
-                             detail::narrow_cast<int>(key.size() + column)),
-                           make_data_view(*value));
-        if (!append_status.ok())
-          return caf::make_error(
-            ec::system_error, fmt::format("failed to append aggregated {}: {}",
-                                          *value, append_status.ToString()));
+  /// @param schema The schema of the batch.
+  /// @param partial Whether to finish into partial states.
+  /// @param all Whether to finish windows that are still open.
+  [[nodiscard]] caf::expected<pipeline_batch>
+  finish(const type& schema, bool partial, bool all) {
+    if (late_rows > 0) {
+      VAST_WARN("summarize operator dropped {} events of schema {} that "
+                "arrived after their window closed",
+                late_rows, schema.name());
+      late_rows = 0;
+    }
+    auto finished_groups = take_groups(all);
+    return make_batch(schema, partial, finished_groups);
+  }
+
+  /// Assigns the rows of a batch to the windows that they fall into, and
+  /// advances the watermark.
+  /// @param array The values of the window column.
+  /// @param indices The rows to aggregate, once for every window of a row.
+  /// @param starts The start of the window for every entry in *indices*.
+  void assign_windows(const arrow::Array& array, std::vector<uint32_t>& indices,
+                      std::vector<time>& starts) {
+    VAST_ASSERT(window);
+    const auto windows_per_row = window->size / window->slide;
+    auto max_time = std::optional<time>{};
+    for (uint32_t row = 0;
+         auto&& value : values(group_by_columns.front().type, array)) {
+      // Rows without a timestamp do not belong to any window.
+      if (const auto* timestamp = caf::get_if<view<time>>(&value)) {
+        if (!max_time || *timestamp > *max_time)
+          max_time = *timestamp;
+        auto start = round_down(*timestamp, window->slide);
+        auto late = true;
+        // Windows are visited from the latest to the earliest, so once we
+        // find one that was emitted already all others were emitted as well.
+        for (int64_t i = 0; i < windows_per_row; ++i, start -= window->slide) {
+          if (emitted_until && start + window->size <= *emitted_until)
+            break;
+          indices.push_back(row);
+          starts.push_back(start);
+          late = false;
+        }
+        if (late)
+          ++late_rows;
       }
+      ++row;
+    }
+    if (max_time) {
+      const auto candidate = *max_time - window->allowed_lateness;
+      if (!watermark || candidate > *watermark)
+        watermark = candidate;
     }
-    auto array = builder->Finish();
-    if (!array.ok())
-      return caf::make_error(ec::system_error,
-                             fmt::format("failed to finish: {}",
-                                         array.status().ToString()));
-    auto batch = arrow::RecordBatch::Make(
-      output_schema.to_arrow_schema(), num_rows,
-      caf::get<type_to_arrow_array_t<record_type>>(*array.MoveValueUnsafe())
-        .fields());
-    return pipeline_batch{output_schema, std::move(batch)};
   }
 
-private:
+  /// Feed a slice of an aggregation column into an aggregation function.
+  /// @param column The index of the aggregation column.
+  /// @param function The aggregation function of a group.
+  /// @param array The values for the group.
+  [[nodiscard]] caf::error add(size_t column, aggregation_function& function,
+                               const arrow::Array& array) {
+    const auto& input_type = aggregation_columns[column].input_type;
+    if (merge) {
+      for (auto&& partial : values(input_type, array))
+        if (auto err = function.merge(partial))
+          return err;
+      return {};
+    }
+    if (array.length() == 1)
+      function.add(value_at(input_type, array, 0));
+    else
+      function.add(array);
+    return {};
+  }
+
+  /// Create the output schema from the bound columns.
+  /// @param name The name of the input schema.
+  [[nodiscard]] type make_output_schema(std::string_view name) const {
+    auto fields = std::vector<record_type::field_view>{};
+    fields.reserve(group_by_columns.size() + aggregation_columns.size());
+    for (const auto& column : group_by_columns)
+      fields.emplace_back(column.name, column.type);
+    for (const auto& column : aggregation_columns)
+      fields.emplace_back(column.output_name, column.output_type);
+    return {name, record_type{fields}};
+  }
+
+  /// Create the schema of partial results from the bound columns.
+  /// @param name The name of the input schema.
+  [[nodiscard]] type make_partial_schema(std::string_view name) const {
+    auto fields = std::vector<record_type::field_view>{};
+    fields.reserve(group_by_columns.size() + aggregation_columns.size());
+    for (const auto& column : group_by_columns)
+      fields.emplace_back(column.name, column.type);
+    for (const auto& column : aggregation_columns)
+      fields.emplace_back(column.output_name, column.partial_type);
+    return {name, record_type{fields}, {{partial_attribute}}};
+  }
+
   /// Read the input arrays for the configured group-by columns.
   /// @param batch The record batch to extract from.
   arrow::ArrayVector
@@ -640,19 +1174,334 @@ private:
   /// The output schema.
   type output_schema = {};
 
-  /// The buckets for the ongoing aggregation.
-  tsl::robin_map<group_by_key, std::shared_ptr<bucket>, group_by_key_hash,
-                 group_by_key_equal>
-    buckets = {};
+  /// The schema of partial results, or the null type if the aggregation does
+  /// not support partial aggregation.
+  type partial_schema = {};
+
+  /// Whether the aggregation merges partial results.
+  bool merge = false;
+
+  /// The optional windowed aggregation configuration. If set, the first
+  /// group-by column holds the start of the window.
+  std::optional<configuration::window_configuration> window = {};
+
+  /// The latest event time seen minus the allowed lateness. Windows that end
+  /// before the watermark are closed.
+  std::optional<time> watermark = {};
+
+  /// All windows that end before this point in time were emitted already.
+  std::optional<time> emitted_until = {};
+
+  /// The number of rows dropped because they arrived after their window
+  /// closed.
+  size_t late_rows = 0;
+
+  /// The estimated memory usage of all groups in bytes.
+  size_t memusage_ = 0;
+
+  /// The partitions of groups that were moved to disk, if any.
+  std::unique_ptr<spill_state> spill_ = {};
+
+  /// The level of the partitions when moving groups to disk, which is nonzero
+  /// for aggregations that merge a spilled partition.
+  size_t spill_level_ = 0;
+
+  /// Statistics about moving groups to disk.
+  spill_statistics statistics_ = {};
+
+  /// Finds the group of a row, or creates a new one lazily.
+  /// @param keys The decoded group-by columns of the batch.
+  /// @param row The row within the batch.
+  /// @param hash The hash of the group-by values of *row*.
+  /// @returns The id of the group.
+  uint32_t find_or_create_group(const std::vector<std::vector<data_view>>& keys,
+                                size_t row, uint64_t hash) {
+    const auto matches = [&](const group_by_key& key) noexcept {
+      for (size_t column = 0; column < keys.size(); ++column)
+        if (keys[column][row] != make_view(key[column]))
+          return false;
+      return true;
+    };
+    auto head = group_heads.try_emplace(hash, no_group).first;
+    for (auto id = head->second; id != no_group; id = groups[id].next)
+      if (matches(groups[id].key))
+        return id;
+    auto& new_group = groups.emplace_back();
+    new_group.hash = hash;
+    new_group.key.reserve(keys.size());
+    for (const auto& column_keys : keys)
+      new_group.key.push_back(materialize(column_keys[row]));
+    new_group.functions.reserve(aggregation_columns.size());
+    for (const auto& column : aggregation_columns) {
+      auto function
+        = plugins::find<aggregation_function_plugin>(column.function_name)
+            ->make_aggregation_function(column.input_type);
+      // We check whether it's possible to create the aggregation function for
+      // the column's input type ahead of time, so there's no need to check
+      // again here.
+      VAST_ASSERT(function);
+      new_group.functions.push_back(std::move(*function));
+    }
+    new_group.next = head->second;
+    const auto id = detail::narrow_cast<uint32_t>(groups.size() - 1);
+    head.value() = id;
+    return id;
+  }
+
+  /// A sentinel for the absence of a group id.
+  static constexpr auto no_group = std::numeric_limits<uint32_t>::max();
+
+  /// A group of rows with equal group-by values, and the aggregation functions
+  /// that its rows are fed into.
+  struct group {
+    group_by_key key = {};
+    bucket functions = {};
+
+    /// The hash of the key.
+    uint64_t hash = 0;
+
+    /// The estimated memory usage of the group in bytes.
+    size_t bytes = 0;
+
+    /// The next group with the same hash.
+    uint32_t next = no_group;
+
+    /// The position of the group within the batch being added.
+    uint32_t batch_group = no_group;
+  };
+
+  /// The groups for the ongoing aggregation in order of their first
+  /// appearance.
+  std::vector<group> groups = {};
+
+  /// Maps key hashes to the most recently created group with that hash. Groups
+  /// with colliding hashes are chained via `group::next`.
+  tsl::robin_map<uint64_t, uint32_t> group_heads = {};
+
+  /// Removes the groups that are ready to be finished.
+  /// @param all Whether to remove the groups of windows that are still open.
+  /// @returns The removed groups.
+  std::vector<group> take_groups(bool all) {
+    if (!window) {
+      group_heads.clear();
+      memusage_ = 0;
+      return std::exchange(groups, {});
+    }
+    // A window closes once the watermark passes its end. We remember up to
+    // which point in time all windows have closed, so that we can drop rows
+    // for windows that we already emitted.
+    const auto window_end = [&](const group& x) {
+      return caf::get<time>(x.key.front()) + window->size;
+    };
+    auto result = std::vector<group>{};
+    auto open_groups = std::vector<group>{};
+    for (auto& x : std::exchange(groups, {})) {
+      if (all || (watermark && window_end(x) <= *watermark)) {
+        if (!emitted_until || window_end(x) > *emitted_until)
+          emitted_until = window_end(x);
+        result.push_back(std::move(x));
+      } else {
+        open_groups.push_back(std::move(x));
+      }
+    }
+    if (!all && watermark && (!emitted_until || *watermark > *emitted_until))
+      emitted_until = watermark;
+    group_heads.clear();
+    groups = std::move(open_groups);
+    memusage_ = 0;
+    for (size_t id = 0; id < groups.size(); ++id) {
+      auto head = group_heads.try_emplace(groups[id].hash, no_group).first;
+      groups[id].next = head->second;
+      head.value() = detail::narrow_cast<uint32_t>(id);
+      memusage_ += groups[id].bytes;
+    }
+    return result;
+  }
+
+  /// Updates the estimated memory usage after adding rows to groups.
+  /// @param ids The ids of the groups that rows were added to.
+  void update_memusage(const std::vector<uint32_t>& ids) {
+    // We assume that aggregation functions with fixed-size state fit into
+    // this many bytes, and account for the function objects with it.
+    constexpr auto function_bytes = size_t{64};
+    for (auto id : ids) {
+      auto& x = groups[id];
+      auto bytes = sizeof(group) + sizeof(std::pair<uint64_t, uint32_t>);
+      for (const auto& value : x.key) {
+        bytes += sizeof(data);
+        if (const auto* str = caf::get_if<std::string>(&value))
+          bytes += str->size();
+      }
+      for (const auto& function : x.functions)
+        bytes += function_bytes + function->memusage();
+      memusage_ = memusage_ - x.bytes + bytes;
+      x.bytes = bytes;
+    }
+  }
+
+  /// Finish the partitions of groups that were moved to disk, including the
+  /// groups that are still in memory.
+  /// @param partial Whether to finish into partial states.
+  [[nodiscard]] caf::expected<std::vector<pipeline_batch>>
+  finish_spilled(bool partial);
+
+  /// Finish groups into a new batch.
+  /// @param schema The schema of the batch.
+  /// @param partial Whether to finish into partial states.
+  /// @param finished_groups The groups to finish.
+  [[nodiscard]] caf::expected<pipeline_batch>
+  make_batch(const type& schema, bool partial,
+             std::vector<group>& finished_groups) {
+    auto builder = caf::get<record_type>(schema).make_arrow_builder(
+      arrow::default_memory_pool());
+    VAST_ASSERT(builder);
+    const auto num_rows = detail::narrow_cast<int>(finished_groups.size());
+    const auto reserve_status = builder->Reserve(num_rows);
+    if (!reserve_status.ok())
+      return caf::make_error(ec::system_error,
+                             fmt::format("failed to reserve: {}",
+                                         reserve_status.ToString()));
+    for (auto& [key, functions, hash, bytes, next, batch_group] :
+         finished_groups) {
+      const auto append_row_status = builder->Append();
+      if (!append_row_status.ok())
+        return caf::make_error(ec::system_error,
+                               fmt::format("failed to append row: {}",
+                                           append_row_status.ToString()));
+      for (size_t column = 0; column < key.size(); ++column) {
+        const auto append_status = append_builder(
+          group_by_columns[column].type,
+          *builder->field_builder(detail::narrow_cast<int>(column)),
+          make_data_view(key[column]));
+        if (!append_status.ok())
+          return caf::make_error(ec::system_error,
+                                 fmt::format("failed to append grouped {}: {}",
+                                             key[column],
+                                             append_status.ToString()));
+      }
+      for (size_t column = 0; column < functions.size(); ++column) {
+        auto value = partial ? std::move(*functions[column]).save()
+                             : std::move(*functions[column]).finish();
+        if (!value)
+          return value.error();
+        const auto& column_type
+          = partial ? aggregation_columns[column].partial_type
+                    : aggregation_columns[column].output_type;
+        const auto append_status
+          = append_builder(column_type,
+                           *builder->field_builder(
+                             detail::narrow_cast<int>(key.size() + column)),
+                           make_data_view(*value));
+        if (!append_status.ok())
+          return caf::make_error(
+            ec::system_error, fmt::format("failed to append aggregated {}: {}",
+                                          *value, append_status.ToString()));
+      }
+    }
+    auto array = builder->Finish();
+    if (!array.ok())
+      return caf::make_error(ec::system_error,
+                             fmt::format("failed to finish: {}",
+                                         array.status().ToString()));
+    auto batch = arrow::RecordBatch::Make(
+      schema.to_arrow_schema(), num_rows,
+      caf::get<type_to_arrow_array_t<record_type>>(*array.MoveValueUnsafe())
+        .fields());
+    return pipeline_batch{schema, std::move(batch)};
+  }
 };
 
+caf::error aggregation::spill(const configuration& config) {
+  VAST_ASSERT(can_spill());
+  if (!spill_) {
+    auto directory
+      = detail::make_spill_directory(config.spill_directory, "summarize");
+    if (!directory)
+      return directory.error();
+    spill_ = std::make_unique<spill_state>(std::move(*directory), config,
+                                           spill_level_);
+  }
+  auto spilled_groups = take_groups(true);
+  auto partitions
+    = std::vector<std::vector<group>>(spill_state::num_partitions);
+  for (auto& x : spilled_groups)
+    partitions[spill_->partition(x.hash)].push_back(std::move(x));
+  ++statistics_.spills;
+  statistics_.rows += spilled_groups.size();
+  for (size_t partition = 0; partition < partitions.size(); ++partition) {
+    if (partitions[partition].empty())
+      continue;
+    auto batch = make_batch(partial_schema, true, partitions[partition]);
+    if (!batch)
+      return batch.error();
+    auto bytes = spill_->write(partition, *batch->batch);
+    if (!bytes)
+      return bytes.error();
+    statistics_.bytes += *bytes;
+  }
+  return {};
+}
+
+caf::expected<std::vector<pipeline_batch>>
+aggregation::finish_spilled(bool partial) {
+  VAST_ASSERT(spill_);
+  if (!groups.empty())
+    if (auto err = spill(spill_->config))
+      return err;
+  auto spilled = std::exchange(spill_, nullptr);
+  if (auto err = spilled->close())
+    return err;
+  // Every group resides in exactly one partition, so we can merge the
+  // partitions one after another. A partition whose groups exceed the memory
+  // budget when merging it gets split into partitions of the next level, which
+  // live in a subdirectory of this level.
+  auto nested_config = spilled->config;
+  nested_config.spill_directory = spilled->directory;
+  auto result = std::vector<pipeline_batch>{};
+  for (size_t partition = 0; partition < spill_state::num_partitions;
+       ++partition) {
+    auto merged = make_merge(partial_schema, nested_config);
+    if (!merged)
+      return merged.error();
+    merged->spill_level_ = spilled->level + 1;
+    auto num_batches = size_t{0};
+    auto read_error = spilled->read(
+      partition,
+      [&](const std::shared_ptr<arrow::RecordBatch>& batch) -> caf::error {
+        ++num_batches;
+        if (batch->num_rows() == 0)
+          return {};
+        if (auto err = merged->add(batch))
+          return err;
+        if (nested_config.memory_budget
+            && merged->memusage() > *nested_config.memory_budget
+            && merged->can_spill())
+          return merged->spill(nested_config);
+        return {};
+      });
+    if (read_error)
+      return read_error;
+    if (num_batches == 0)
+      continue;
+    auto finished = partial ? merged->save() : merged->finish();
+    if (!finished)
+      return finished.error();
+    statistics_ += merged->statistics();
+    result.insert(result.end(), std::make_move_iterator(finished->begin()),
+                  std::make_move_iterator(finished->end()));
+  }
+  return result;
+}
+
 /// The summarize pipeline operator implementation.
 class summarize_operator : public pipeline_operator {
 public:
   /// Creates a pipeline operator from its configuration.
   /// @param config The parsed configuration of the summarize operator.
-  explicit summarize_operator(configuration config) noexcept
-    : config_{std::move(config)} {
+  /// @param partial Whether to produce partial results that another summarize
+  /// operator with the same configuration merges.
+  explicit summarize_operator(configuration config, bool partial) noexcept
+    : config_{std::move(config)}, partial_{partial} {
     // nop
   }
 
@@ -663,6 +1512,18 @@ private:
     return true;
   }
 
+  /// Signal that the summarize operator emits results incrementally if it
+  /// aggregates into windows, as it finishes windows once they close.
+  [[nodiscard]] bool is_incremental() const override {
+    return config_.window.has_value() && !partial_;
+  }
+
+  /// Finish all windows with the next call to finish, including those that
+  /// are still open.
+  void flush() override {
+    flush_ = true;
+  }
+
   /// Adds a batch to the operator, which effectively calls the corresponding
   /// add for the lazily created aggregation for the schema.
   [[nodiscard]] caf::error
@@ -674,8 +1535,9 @@ private:
     // forward the batch to it.
     if (auto aggregation = aggregations_.find(schema);
         aggregation != aggregations_.end()) {
-      aggregation->second.add(batch);
-      return {};
+      if (auto err = aggregation->second.add(batch))
+        return err;
+      return enforce_memory_budget();
     }
     // Check if we already blacklisted this schema.
     if (auto blacklist_entry = blacklist_.find(schema);
@@ -683,8 +1545,21 @@ private:
       blacklist_entry->second.emplace_back(std::move(schema), std::move(batch));
       return {};
     }
-    // We didn't have one, so we create a new one for this schema.
-    auto aggregation = aggregation::make(schema, config_);
+    // We didn't have one, so we create a new one for this schema. Partial
+    // results from other summarize operators get merged, and the partial
+    // operator leaves events unchanged if it cannot aggregate them partially.
+    const auto is_partial = aggregation::is_partial(schema);
+    auto aggregation = is_partial ? aggregation::make_merge(schema, config_)
+                                  : aggregation::make(schema, config_);
+    if (aggregation && partial_ && !aggregation->partial())
+      aggregation = caf::make_error(ec::unimplemented,
+                                    "an aggregation function does not support "
+                                    "partial aggregation");
+    if (!aggregation && is_partial)
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("summarize operator failed to merge "
+                                         "partial results: {}",
+                                         aggregation.error()));
     // Note: We intentionally decouple the lifetime of the type's underlying
     // chunk here in order to make sure that no data is held alive for the
     // duration of the pipeline operator's existence.
@@ -702,32 +1577,128 @@ private:
     auto [it, inserted] = aggregations_.emplace(std::move(decoupled_schema),
                                                 std::move(*aggregation));
     VAST_ASSERT(inserted);
-    it->second.add(batch);
-    return {};
+    if (auto err = it->second.add(batch))
+      return err;
+    return enforce_memory_budget();
   }
 
   /// Retrieves the results of all configured aggregations.
   [[nodiscard]] caf::expected<std::vector<pipeline_batch>> finish() override {
+    if (!partial_)
+      if (auto err = merge_partial_results())
+        return err;
+    const auto all = !is_incremental() || std::exchange(flush_, false);
     auto result = std::vector<pipeline_batch>{};
     result.reserve(aggregations_.size());
     for (auto& [schema, aggregation] : aggregations_) {
-      auto batch = aggregation.finish();
-      if (!batch)
-        return batch.error();
-      result.push_back(std::move(*batch));
+      auto batches = partial_ ? aggregation.save() : aggregation.finish(all);
+      if (!batches)
+        return batches.error();
+      // Aggregations may have finished all of their groups already, and
+      // incremental aggregations may not have any closed windows yet.
+      for (auto& batch : *batches)
+        if (batch.batch->num_rows() > 0)
+          result.push_back(std::move(batch));
     }
     for (auto& [schema, batches] : blacklist_) {
       result.reserve(result.size() + batches.size());
       result.insert(result.end(), std::make_move_iterator(batches.begin()),
                     std::make_move_iterator(batches.end()));
+      batches.clear();
     }
 
     return result;
   }
 
+  /// Merges the results of aggregations over events into the aggregations
+  /// over partial results for the same schema, so that every group ends up in
+  /// a single output row.
+  [[nodiscard]] caf::error merge_partial_results() {
+    for (auto it = aggregations_.begin(); it != aggregations_.end();) {
+      auto& aggregation = it->second;
+      auto merge = aggregation.partial()
+                     ? aggregations_.find(aggregation.partial())
+                     : aggregations_.end();
+      if (merge == aggregations_.end() || merge == it) {
+        ++it;
+        continue;
+      }
+      auto batches = aggregation.save();
+      if (!batches)
+        return batches.error();
+      for (const auto& batch : *batches) {
+        if (batch.batch->num_rows() == 0)
+          continue;
+        if (auto err = merge->second.add(batch.batch))
+          return err;
+        if (auto err = enforce_memory_budget())
+          return err;
+      }
+      retired_statistics_ += aggregation.statistics();
+      it = aggregations_.erase(it);
+    }
+    return {};
+  }
+
+  /// Moves the groups of all aggregations to disk if they exceed the memory
+  /// budget together.
+  [[nodiscard]] caf::error enforce_memory_budget() {
+    if (!config_.memory_budget)
+      return {};
+    auto memusage = size_t{0};
+    for (const auto& [schema, aggregation] : aggregations_)
+      memusage += aggregation.memusage();
+    if (memusage <= *config_.memory_budget)
+      return {};
+    for (auto& [schema, aggregation] : aggregations_) {
+      if (aggregation.memusage() == 0)
+        continue;
+      if (!aggregation.can_spill()) {
+        if (!memory_budget_warned_)
+          VAST_WARN("summarize operator exceeds its memory budget of {} bytes "
+                    "but cannot move groups of schema {} to disk",
+                    *config_.memory_budget, schema);
+        memory_budget_warned_ = true;
+        continue;
+      }
+      VAST_DEBUG("summarize operator moves groups of schema {} to disk",
+                 schema);
+      if (auto err = aggregation.spill(config_))
+        return err;
+    }
+    return {};
+  }
+
+  /// Returns statistics about moving groups to disk.
+  [[nodiscard]] std::vector<system::data_point> metrics() const override {
+    auto statistics = retired_statistics_;
+    for (const auto& [schema, aggregation] : aggregations_)
+      statistics += aggregation.statistics();
+    if (statistics.spills == 0)
+      return {};
+    return {
+      {"summarize.spills", statistics.spills},
+      {"summarize.spilled-rows", statistics.rows},
+      {"summarize.spilled-bytes", statistics.bytes},
+    };
+  }
+
   /// The underlying configuration of the summary transformation.
   configuration config_ = {};
 
+  /// Whether the operator produces partial results.
+  bool partial_ = false;
+
+  /// Whether the next call to finish finishes all windows.
+  bool flush_ = false;
+
+  /// Whether we warned about exceeding the memory budget already.
+  bool memory_budget_warned_ = false;
+
+  /// Statistics about moving groups to disk of aggregations that were merged
+  /// into other aggregations.
+  spill_statistics retired_statistics_ = {};
+
   /// The currently in-progress aggregations.
   std::unordered_map<type, aggregation> aggregations_ = {};
 
@@ -736,11 +1707,12 @@ private:
 };
 
 caf::expected<std::unique_ptr<pipeline_operator>>
-make_summarize_operator(const record& config) {
+make_summarize_operator(const record& config, bool partial) {
   auto parsed_config = configuration::make(config);
   if (!parsed_config)
     return parsed_config.error();
-  return std::make_unique<summarize_operator>(std::move(*parsed_config));
+  return std::make_unique<summarize_operator>(std::move(*parsed_config),
+                                              partial);
 }
 
 std::vector<std::string>
@@ -759,7 +1731,8 @@ get_keys_from_legacy_sections(const data& legacy_section) {
 /// change legacy config into newer format
 caf::expected<std::unique_ptr<pipeline_operator>>
 try_handle_deprecations(const record& config,
-                        const std::vector<std::string>& sections_to_reformat) {
+                        const std::vector<std::string>& sections_to_reformat,
+                        bool partial) {
   auto new_config = config;
   auto aggregate = record{};
   for (const auto& section : sections_to_reformat) {
@@ -780,7 +1753,7 @@ try_handle_deprecations(const record& config,
     new_config.erase(section);
   }
   new_config.emplace("aggregate", std::move(aggregate));
-  return make_summarize_operator(new_config);
+  return make_summarize_operator(new_config, partial);
 }
 
 /// The summarize pipeline operator plugin.
@@ -798,6 +1771,17 @@ public:
 
   [[nodiscard]] caf::expected<std::unique_ptr<pipeline_operator>>
   make_pipeline_operator(const record& config) const override {
+    return make(config, false);
+  }
+
+  [[nodiscard]] caf::expected<std::unique_ptr<pipeline_operator>>
+  make_partial_pipeline_operator(const record& config) const override {
+    return make(config, true);
+  }
+
+private:
+  [[nodiscard]] static caf::expected<std::unique_ptr<pipeline_operator>>
+  make(const record& config, bool partial) {
     std::vector<std::string> sections_to_reformat;
     for (const auto& key : {"min", "max", "any", "all", "sum"}) {
       if (config.contains(key))
@@ -805,7 +1789,7 @@ public:
     }
     // new format detected. Proceed as usual
     if (sections_to_reformat.empty())
-      return make_summarize_operator(config);
+      return make_summarize_operator(config, partial);
     if (config.contains("aggregate")) {
       return caf::make_error(
         ec::invalid_configuration,
@@ -815,7 +1799,7 @@ public:
                     "names",
                     fmt::join(sections_to_reformat, "', '")));
     }
-    return try_handle_deprecations(config, sections_to_reformat);
+    return try_handle_deprecations(config, sections_to_reformat, partial);
   }
 };
 
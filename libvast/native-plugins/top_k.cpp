@@ -0,0 +1,166 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <vast/detail/overload.hpp>
+#include <vast/plugin.hpp>
+#include <vast/sketch/space_saving.hpp>
+#include <vast/typed_aggregation_function.hpp>
+
+namespace vast::plugins::top_k {
+
+namespace {
+
+/// The number of most frequent values in the result.
+constexpr auto k = size_t{10};
+
+/// The number of counters of the SpaceSaving sketch. Every value that makes up
+/// more than 1% of the input is guaranteed to be tracked.
+constexpr auto capacity = size_t{100};
+
+/// The name of the partial type, which distinguishes partial states from
+/// input values.
+constexpr auto partial_name = std::string_view{"vast.top_k"};
+
+template <concrete_type Type>
+class top_k_function final
+  : public typed_aggregation_function<Type, top_k_function<Type>> {
+public:
+  /// Constructs the function.
+  /// @param input_type The input type, which is either the type of the values
+  /// or the partial type.
+  /// @param value_type The type of the values.
+  top_k_function(type input_type, type value_type) noexcept
+    : typed_aggregation_function<Type, top_k_function<Type>>(
+      std::move(input_type)),
+      value_type_{std::move(value_type)},
+      sketch_{*sketch::space_saving::make(capacity)} {
+    // nop
+  }
+
+  void accumulate(view<type_to_data_t<Type>> x) {
+    sketch_.add(data_view{x});
+  }
+
+private:
+  [[nodiscard]] type output_type() const override {
+    return type{list_type{record_type{
+      {"value", value_type_},
+      {"count", count_type{}},
+    }}};
+  }
+
+  [[nodiscard]] caf::expected<data> finish() && override {
+    auto result = list{};
+    for (auto& counter : sketch_.top(k))
+      result.emplace_back(record{
+        {"value", std::move(counter.value)},
+        {"count", counter.count},
+      });
+    return data{std::move(result)};
+  }
+
+  [[nodiscard]] type partial_type() const override {
+    return type{partial_name, list_type{record_type{
+                                {"value", value_type_},
+                                {"count", count_type{}},
+                                {"error", count_type{}},
+                              }}};
+  }
+
+  [[nodiscard]] caf::expected<data> save() && override {
+    auto result = list{};
+    for (auto& counter : sketch_.top(capacity))
+      result.emplace_back(record{
+        {"value", std::move(counter.value)},
+        {"count", counter.count},
+        {"error", counter.error},
+      });
+    return data{std::move(result)};
+  }
+
+  [[nodiscard]] caf::error merge(const data_view& partial) override {
+    if (caf::holds_alternative<caf::none_t>(partial))
+      return {};
+    auto counters = std::vector<sketch::space_saving::counter>{};
+    for (const auto& element : caf::get<view<list>>(partial)) {
+      const auto* fields = caf::get_if<view<record>>(&element);
+      if (!fields)
+        return caf::make_error(ec::invalid_argument,
+                               "top_k partial state must consist of records");
+      auto& counter = counters.emplace_back();
+      for (const auto& [name, value] : *fields) {
+        if (name == "value") {
+          counter.value = materialize(value);
+        } else if (const auto* x = caf::get_if<view<count>>(&value)) {
+          if (name == "count")
+            counter.count = *x;
+          else if (name == "error")
+            counter.error = *x;
+        }
+      }
+    }
+    auto other = sketch::space_saving::make(capacity, std::move(counters));
+    if (!other)
+      return std::move(other.error());
+    return sketch_.merge(*other);
+  }
+
+  [[nodiscard]] size_t memusage() const override {
+    return mem_usage(sketch_);
+  }
+
+  type value_type_ = {};
+  sketch::space_saving sketch_;
+};
+
+class plugin : public virtual aggregation_function_plugin {
+  caf::error initialize([[maybe_unused]] data config) override {
+    return {};
+  }
+
+  [[nodiscard]] const char* name() const override {
+    return "top_k";
+  };
+
+  [[nodiscard]] caf::expected<std::unique_ptr<aggregation_function>>
+  make_aggregation_function(const type& input_type) const override {
+    auto f = detail::overload{
+      [&]<basic_type Type>(
+        const Type&) -> caf::expected<std::unique_ptr<aggregation_function>> {
+        return std::make_unique<top_k_function<Type>>(input_type, input_type);
+      },
+      [&](const list_type& list)
+        -> caf::expected<std::unique_ptr<aggregation_function>> {
+        const auto element_type = list.value_type();
+        const auto* record = caf::get_if<record_type>(&element_type);
+        if (input_type.name() != partial_name || !record
+            || record->num_fields() == 0)
+          return caf::make_error(ec::invalid_configuration,
+                                 fmt::format("top_k aggregation function does "
+                                             "not support complex type {}",
+                                             input_type));
+        return std::make_unique<top_k_function<list_type>>(
+          input_type, record->field(0).type);
+      },
+      []<complex_type Type>(const Type& type)
+        -> caf::expected<std::unique_ptr<aggregation_function>> {
+        return caf::make_error(ec::invalid_configuration,
+                               fmt::format("top_k aggregation function does "
+                                           "not support complex type {}",
+                                           type));
+      },
+    };
+    return caf::visit(f, input_type);
+  }
+};
+
+} // namespace
+
+} // namespace vast::plugins::top_k
+
+VAST_REGISTER_PLUGIN(vast::plugins::top_k::plugin)
@@ -6,21 +6,23 @@
 // SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
 // SPDX-License-Identifier: BSD-3-Clause
 
-#include <vast/arrow_table_slice_builder.hpp>
+#include <vast/bitmap_algorithms.hpp>
 #include <vast/concept/convertible/data.hpp>
 #include <vast/concept/convertible/to.hpp>
 #include <vast/concept/parseable/to.hpp>
 #include <vast/concept/parseable/vast/expression.hpp>
+#include <vast/detail/narrow.hpp>
 #include <vast/error.hpp>
 #include <vast/expression.hpp>
 #include <vast/logger.hpp>
 #include <vast/pipeline.hpp>
 #include <vast/plugin.hpp>
-#include <vast/table_slice_builder_factory.hpp>
 
 #include <arrow/type.h>
 #include <caf/expected.hpp>
 
+#include <unordered_map>
+
 namespace vast::plugins::where {
 
 namespace {
@@ -46,7 +48,7 @@ struct configuration {
 };
 
 // Selects matching rows from the input.
-class where_operator : public pipeline_operator {
+class where_operator : public stateless_pipeline_operator {
 public:
   /// Constructs a *where* pipeline operator.
   /// @pre *expr* must be normalized and validated
@@ -59,36 +61,37 @@ public:
 #endif // VAST_ENABLE_ASSERTIONS
   }
 
-  /// Applies the transformation to a record batch with a corresponding vast
-  /// layout.
-  [[nodiscard]] caf::error
-  add(type layout, std::shared_ptr<arrow::RecordBatch> batch) override {
-    VAST_TRACE("where operator adds batch");
-    auto tailored_expr = tailor(expr_, layout);
-    if (!tailored_expr) {
-      transformed_.clear();
-      return tailored_expr.error();
-    }
-    // TODO: Replace this with an Arrow-native filter function as soon as we are
-    // able to directly evaluate expressions on a record batch.
-    if (auto new_slice = filter(table_slice{batch}, *tailored_expr)) {
-      auto as_batch = to_record_batch(*new_slice);
-      transformed_.emplace_back(new_slice->layout(), std::move(as_batch));
+  /// Narrows the selection of a batch to the rows that match the expression.
+  [[nodiscard]] caf::error apply(fused_batch& x) override {
+    VAST_TRACE("where operator applies to batch");
+    auto tailored_expr = tailored_exprs_.find(x.layout);
+    if (tailored_expr == tailored_exprs_.end()) {
+      auto new_expr = tailor(expr_, x.layout);
+      if (!new_expr)
+        return new_expr.error();
+      tailored_expr = tailored_exprs_
+                        .emplace(type{chunk::copy(x.layout)},
+                                 std::move(*new_expr))
+                        .first;
     }
+    // Evaluate the expression only for the rows that previous operators
+    // selected. The pipeline applies the selection to all columns at once.
+    const auto num_rows = x.batch->num_rows();
+    auto selection = evaluate(tailored_expr->second,
+                              table_slice{x.batch, x.layout}, x.selection);
+    const auto num_selected = rank(selection);
+    if (num_selected == 0)
+      x.batch = nullptr;
+    else if (num_selected != detail::narrow_cast<uint64_t>(num_rows))
+      x.selection = std::move(selection);
     return caf::none;
   }
 
-  /// Retrieves the result of the transformation.
-  [[nodiscard]] caf::expected<std::vector<pipeline_batch>> finish() override {
-    VAST_DEBUG("where operator finished transformation");
-    return std::exchange(transformed_, {});
-  }
-
 private:
   expression expr_ = {};
 
-  /// The slices being transformed.
-  std::vector<pipeline_batch> transformed_ = {};
+  /// The expression tailored to a specific schema.
+  std::unordered_map<type, expression> tailored_exprs_ = {};
 };
 
 class plugin final : public virtual pipeline_operator_plugin {
@@ -9,6 +9,7 @@
 #include "vast/aggregation_function.hpp"
 
 #include "vast/arrow_table_slice.hpp"
+#include "vast/error.hpp"
 
 namespace vast {
 
@@ -17,6 +18,26 @@ void aggregation_function::add(const arrow::Array& array) {
     add(value);
 }
 
+type aggregation_function::partial_type() const {
+  return {};
+}
+
+caf::expected<data> aggregation_function::save() && {
+  return std::move(*this).finish();
+}
+
+caf::error aggregation_function::merge(const data_view&) {
+  return caf::make_error(ec::unimplemented,
+                         fmt::format("aggregation function with output type "
+                                     "{} does not support merging partial "
+                                     "states",
+                                     output_type()));
+}
+
+size_t aggregation_function::memusage() const {
+  return 0;
+}
+
 aggregation_function::aggregation_function(type input_type) noexcept
   : input_type_{std::move(input_type)} {
   // nop
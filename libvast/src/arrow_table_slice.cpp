@@ -903,13 +903,7 @@ void arrow_table_slice<FlatBuffer>::append_column_to_index(
   } else if constexpr (std::is_same_v<FlatBuffer, fbs::table_slice::arrow::v2>) {
     if (auto&& batch = record_batch()) {
       auto&& array = state_.flat_columns[column];
-      const auto& layout = caf::get<record_type>(this->layout());
-      auto type = layout.field(layout.resolve_flat_index(column)).type;
-      for (size_t row = 0; auto&& value : values(type, *array)) {
-        if (!caf::holds_alternative<view<caf::none_t>>(value))
-          index.append(value, offset + row);
-        ++row;
-      }
+      index.append(*array, offset);
     }
   } else {
     static_assert(detail::always_false_v<FlatBuffer>, "unhandled arrow table "
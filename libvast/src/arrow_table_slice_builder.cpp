@@ -15,14 +15,17 @@
 #include "vast/detail/narrow.hpp"
 #include "vast/detail/overload.hpp"
 #include "vast/detail/zip_iterator.hpp"
+#include "vast/die.hpp"
 #include "vast/fbs/table_slice.hpp"
 #include "vast/fbs/utils.hpp"
 #include "vast/logger.hpp"
+#include "vast/table_slice_compression.hpp"
 #include "vast/type.hpp"
 
 #include <arrow/api.h>
 #include <arrow/io/api.h>
 #include <arrow/ipc/writer.h>
+#include <arrow/util/compression.h>
 
 #include <simdjson.h>
 
@@ -51,6 +54,65 @@ size_t arrow_table_slice_builder::columns() const noexcept {
 
 namespace {
 
+/// Writes a record batch in the Arrow IPC stream format.
+arrow::Status
+write_ipc_stream(const arrow::RecordBatch& record_batch,
+                 const std::shared_ptr<arrow::io::OutputStream>& sink,
+                 const arrow::ipc::IpcWriteOptions& opts) {
+  ARROW_ASSIGN_OR_RAISE(auto stream_writer,
+                        arrow::ipc::MakeStreamWriter(
+                          sink, record_batch.schema(), opts));
+  return stream_writer->WriteRecordBatch(record_batch);
+}
+
+/// Serializes a record batch into a FlatBuffers vector.
+/// @param record_batch The record batch to serialize.
+/// @param builder The FlatBuffers builder to use.
+/// @returns The vector containing the Arrow IPC data.
+flatbuffers::Offset<flatbuffers::Vector<uint8_t>>
+create_ipc_vector(const arrow::RecordBatch& record_batch,
+                  flatbuffers::FlatBufferBuilder& builder) {
+  auto opts = arrow::ipc::IpcWriteOptions::Defaults();
+  opts.codec = table_slice_codec();
+  if (!opts.codec) {
+    // Without compression we can determine the size of the IPC data cheaply
+    // ahead of time, which allows for writing it directly into the memory
+    // owned by the FlatBuffers builder instead of copying it there. We align
+    // the vector such that the buffers within the IPC data are aligned as
+    // well, which allows for using them without copying when reading.
+    auto mock_ostream = std::make_shared<arrow::io::MockOutputStream>();
+    if (auto status = write_ipc_stream(record_batch, mock_ostream, opts);
+        !status.ok())
+      die(fmt::format("failed to determine record batch size: {}",
+                      status.ToString()));
+    const auto size
+      = detail::narrow_cast<size_t>(mock_ostream->GetExtentBytesWritten());
+    builder.ForceVectorAlignment(size, sizeof(uint8_t),
+                                 arrow::kDefaultBufferAlignment);
+    auto* data = static_cast<uint8_t*>(nullptr);
+    auto result = builder.CreateUninitializedVector(size, &data);
+    auto buffer = std::make_shared<arrow::MutableBuffer>(
+      data, detail::narrow_cast<int64_t>(size));
+    auto ipc_ostream
+      = std::make_shared<arrow::io::FixedSizeBufferWriter>(buffer);
+    if (auto status = write_ipc_stream(record_batch, ipc_ostream, opts);
+        !status.ok())
+      die(fmt::format("failed to write record batch: {}", status.ToString()));
+    VAST_ASSERT(ipc_ostream->Tell().ValueOrDie()
+                == detail::narrow_cast<int64_t>(size));
+    return result;
+  }
+  // The compressed size is only known after compressing, so we compress into
+  // an intermediate buffer and copy its contents.
+  auto ipc_ostream = arrow::io::BufferOutputStream::Create().ValueOrDie();
+  if (auto status = write_ipc_stream(record_batch, ipc_ostream, opts);
+      !status.ok())
+    VAST_ERROR("failed to write record batch: {}", status.ToString());
+  auto arrow_ipc_buffer = ipc_ostream->Finish().ValueOrDie();
+  return builder.CreateVector(arrow_ipc_buffer->data(),
+                              arrow_ipc_buffer->size());
+}
+
 /// Create a table slice from a record batch.
 /// @param record_batch The record batch to encode.
 /// @param builder The flatbuffers builder to use.
@@ -67,25 +129,8 @@ create_table_slice(const std::shared_ptr<arrow::RecordBatch>& record_batch,
   VAST_ASSERT(validate_status.ok(), validate_status.ToString().c_str());
 #endif // VAST_ENABLE_ASSERTIONS
   auto fbs_ipc_buffer = flatbuffers::Offset<flatbuffers::Vector<uint8_t>>{};
-  if (serialize == table_slice::serialize::yes) {
-    auto ipc_ostream = arrow::io::BufferOutputStream::Create().ValueOrDie();
-    auto opts = arrow::ipc::IpcWriteOptions::Defaults();
-    opts.codec
-      = arrow::util::Codec::Create(
-          arrow::Compression::ZSTD,
-          arrow::util::Codec::DefaultCompressionLevel(arrow::Compression::ZSTD)
-            .ValueOrDie())
-          .ValueOrDie();
-    auto stream_writer
-      = arrow::ipc::MakeStreamWriter(ipc_ostream, record_batch->schema(), opts)
-          .ValueOrDie();
-    auto status = stream_writer->WriteRecordBatch(*record_batch);
-    if (!status.ok())
-      VAST_ERROR("failed to write record batch: {}", status.ToString());
-    auto arrow_ipc_buffer = ipc_ostream->Finish().ValueOrDie();
-    fbs_ipc_buffer = builder.CreateVector(arrow_ipc_buffer->data(),
-                                          arrow_ipc_buffer->size());
-  }
+  if (serialize == table_slice::serialize::yes)
+    fbs_ipc_buffer = create_ipc_vector(*record_batch, builder);
   // Create Arrow-encoded table slices. We need to set the import time to
   // something other than 0, as it cannot be modified otherwise. We then later
   // reset it to the clock's epoch.
@@ -77,6 +77,68 @@ void bitmap::flip() {
     bitmap_);
 }
 
+namespace {
+
+/// Applies a bitwise operation to the concrete bitmaps if both have the same
+/// type with a specialized implementation, and falls back to the generic
+/// algorithm otherwise.
+template <class Operation, class Fallback>
+bitmap eval(const bitmap& x, const bitmap& y, Operation op, Fallback fallback) {
+  if (const auto* lhs = caf::get_if<ewah_bitmap>(&x.get_data()))
+    if (const auto* rhs = caf::get_if<ewah_bitmap>(&y.get_data()))
+      return op(*lhs, *rhs);
+  if (const auto* lhs = caf::get_if<roaring_bitmap>(&x.get_data()))
+    if (const auto* rhs = caf::get_if<roaring_bitmap>(&y.get_data()))
+      return op(*lhs, *rhs);
+  return fallback(x, y);
+}
+
+} // namespace
+
+bitmap operator&(const bitmap& x, const bitmap& y) {
+  return eval(
+    x, y,
+    [](const auto& lhs, const auto& rhs) {
+      return lhs & rhs;
+    },
+    [](const auto& lhs, const auto& rhs) {
+      return binary_and(lhs, rhs);
+    });
+}
+
+bitmap operator|(const bitmap& x, const bitmap& y) {
+  return eval(
+    x, y,
+    [](const auto& lhs, const auto& rhs) {
+      return lhs | rhs;
+    },
+    [](const auto& lhs, const auto& rhs) {
+      return binary_or(lhs, rhs);
+    });
+}
+
+bitmap operator^(const bitmap& x, const bitmap& y) {
+  return eval(
+    x, y,
+    [](const auto& lhs, const auto& rhs) {
+      return lhs ^ rhs;
+    },
+    [](const auto& lhs, const auto& rhs) {
+      return binary_xor(lhs, rhs);
+    });
+}
+
+bitmap operator-(const bitmap& x, const bitmap& y) {
+  return eval(
+    x, y,
+    [](const auto& lhs, const auto& rhs) {
+      return lhs - rhs;
+    },
+    [](const auto& lhs, const auto& rhs) {
+      return binary_nand(lhs, rhs);
+    });
+}
+
 bitmap::variant& bitmap::get_data() {
   return bitmap_;
 }
@@ -107,6 +169,11 @@ auto pack(flatbuffers::FlatBufferBuilder& builder, const bitmap& from)
       return fbs::CreateBitmap(builder, fbs::bitmap::Bitmap::wah,
                                wah_offset.Union());
     },
+    [&](const roaring_bitmap& roaring) {
+      const auto roaring_offset = pack(builder, roaring).Union();
+      return fbs::CreateBitmap(builder, fbs::bitmap::Bitmap::roaring,
+                               roaring_offset.Union());
+    },
   };
   return caf::visit(f, from.bitmap_);
 }
@@ -128,6 +195,8 @@ auto unpack(const fbs::Bitmap& from, bitmap& to) -> caf::error {
       return do_unpack(*from.bitmap_as_null(), null_bitmap{});
     case fbs::bitmap::Bitmap::wah:
       return do_unpack(*from.bitmap_as_wah(), wah_bitmap{});
+    case fbs::bitmap::Bitmap::roaring:
+      return do_unpack(*from.bitmap_as_roaring(), roaring_bitmap{});
   }
   __builtin_unreachable();
 }
@@ -10,6 +10,7 @@
 
 #include "vast/detail/absorb_line.hpp"
 #include "vast/detail/fdinbuf.hpp"
+#include "vast/detail/udp_receiver.hpp"
 #include "vast/logger.hpp"
 
 namespace vast {
@@ -42,17 +43,23 @@ void line_range::next() {
 
 bool line_range::next_timeout(std::chrono::milliseconds timeout) {
   auto* p = dynamic_cast<fdinbuf*>(input_.rdbuf());
+  auto* u = p ? nullptr : dynamic_cast<udp_inbuf*>(input_.rdbuf());
   if (p)
     p->read_timeout() = timeout;
+  else if (u)
+    u->read_timeout() = timeout;
   // Clear if the previous read did not time out.
   if (!timed_out_)
     line_.clear();
   // Try to read next line.
   next_impl();
   timed_out_ = false;
-  if (p) {
-    timed_out_ = p->timed_out();
-    p->read_timeout() = std::nullopt;
+  if (p || u) {
+    timed_out_ = p ? p->timed_out() : u->timed_out();
+    if (p)
+      p->read_timeout() = std::nullopt;
+    else
+      u->read_timeout() = std::nullopt;
     // Clear error state if the read timed out
     if (timed_out_) {
       input_.clear();
@@ -0,0 +1,121 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/detail/memfd.hpp"
+
+#include "vast/chunk.hpp"
+#include "vast/config.hpp"
+#include "vast/error.hpp"
+
+#include <caf/expected.hpp>
+#include <fmt/format.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace vast::detail {
+
+namespace {
+
+#if VAST_LINUX
+
+/// The seals that guarantee that the contents of a file remain unchanged.
+constexpr auto immutable_seals = F_SEAL_SEAL | F_SEAL_SHRINK | F_SEAL_GROW
+                                 | F_SEAL_WRITE;
+
+#endif
+
+} // namespace
+
+caf::expected<int>
+make_sealed_memfd(const char* name, std::span<const std::byte> bytes) {
+#if VAST_LINUX
+  auto fd = ::memfd_create(name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0)
+    return caf::make_error(ec::system_error,
+                           fmt::format("failed to create memfd: {}",
+                                       std::strerror(errno)));
+  auto fail = [&](std::string_view what) {
+    auto err = caf::make_error(ec::system_error,
+                               fmt::format("failed to {} memfd: {}", what,
+                                           std::strerror(errno)));
+    ::close(fd);
+    return err;
+  };
+  if (::ftruncate(fd, static_cast<::off_t>(bytes.size())) < 0)
+    return fail("resize");
+  if (!bytes.empty()) {
+    // Writing through a shared mapping avoids the per-call overhead of
+    // write(2) for large buffers. The mapping must be gone before we can
+    // apply F_SEAL_WRITE.
+    auto* map = ::mmap(nullptr, bytes.size(), PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+      return fail("map");
+    std::memcpy(map, bytes.data(), bytes.size());
+    ::munmap(map, bytes.size());
+  }
+  if (::fcntl(fd, F_ADD_SEALS, immutable_seals) < 0)
+    return fail("seal");
+  return fd;
+#else
+  static_cast<void>(name);
+  static_cast<void>(bytes);
+  return caf::make_error(ec::unimplemented, "sealed memfds are only supported "
+                                            "on Linux");
+#endif
+}
+
+caf::expected<chunk_ptr> map_sealed_memfd(int fd) {
+#if VAST_LINUX
+  auto fail = [&](std::string_view what) {
+    auto err = caf::make_error(ec::system_error,
+                               fmt::format("failed to {} memfd: {}", what,
+                                           std::strerror(errno)));
+    ::close(fd);
+    return err;
+  };
+  // Mapping a file that the sender can still modify would allow it to change
+  // the data after we verified it, so we only accept immutable files.
+  auto seals = ::fcntl(fd, F_GET_SEALS);
+  if (seals < 0)
+    return fail("get seals of");
+  if ((seals & immutable_seals) != immutable_seals) {
+    ::close(fd);
+    return caf::make_error(ec::invalid_argument, "refusing to map memfd that "
+                                                 "is not sealed against "
+                                                 "modification");
+  }
+  struct ::stat st = {};
+  if (::fstat(fd, &st) < 0)
+    return fail("stat");
+  const auto size = static_cast<size_t>(st.st_size);
+  if (size == 0) {
+    ::close(fd);
+    return chunk::make_empty();
+  }
+  auto* map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED)
+    return fail("map");
+  // The mapping keeps the file alive, so we can close the descriptor now.
+  ::close(fd);
+  return chunk::make(map, size, [=]() noexcept {
+    ::munmap(map, size);
+  });
+#else
+  ::close(fd);
+  return caf::make_error(ec::unimplemented, "sealed memfds are only supported "
+                                            "on Linux");
+#endif
+}
+
+} // namespace vast::detail
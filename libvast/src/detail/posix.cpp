@@ -203,8 +203,13 @@ bool uds_send_fd(int socket, int fd) {
   c->cmsg_type = SCM_RIGHTS;
   c->cmsg_len = CMSG_LEN(sizeof(int));
   *reinterpret_cast<int*>(CMSG_DATA(c)) = fd;
-  // Send a message.
+  // Send a message. A closed receiving end should fail the call rather than
+  // raise SIGPIPE.
+#ifdef MSG_NOSIGNAL
+  return ::sendmsg(socket, &m, MSG_NOSIGNAL) > 0;
+#else
   return ::sendmsg(socket, &m, 0) > 0;
+#endif
 }
 
 int uds_recv_fd(int socket) {
@@ -0,0 +1,963 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/detail/regex.hpp"
+
+#include "vast/detail/assert.hpp"
+#include "vast/error.hpp"
+
+#include <caf/expected.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+namespace vast::detail {
+
+namespace {
+
+using byte_set = std::bitset<256>;
+
+/// The maximum nesting depth of groups.
+constexpr size_t max_depth = 256;
+
+/// The maximum bound of a counted repetition.
+constexpr size_t max_repetitions = 1'000;
+
+/// The maximum number of instructions of the NFA program.
+constexpr size_t max_program_size = 10'000;
+
+/// The maximum number of transitions of a DFA.
+constexpr size_t max_transitions = 256 * 1'024;
+
+/// The maximum number of NFA instructions in all states of a DFA. Every state
+/// is a set of instructions that the construction stores and rescans for
+/// every transition, so this bounds both the memory and the time it takes.
+constexpr size_t max_dfa_instructions = 64 * 1'024;
+
+/// Marks an unbounded repetition.
+constexpr auto unbounded = std::numeric_limits<size_t>::max();
+
+/// A node of the syntax tree.
+struct node {
+  enum class kind { set, concat, alternate, repeat, begin, end };
+
+  kind k = kind::concat;
+  byte_set set = {};
+  std::vector<node> children = {};
+  size_t min = 0;
+  size_t max = 0;
+};
+
+byte_set make_range(unsigned char first, unsigned char last) {
+  auto result = byte_set{};
+  for (auto c = size_t{first}; c <= last; ++c)
+    result.set(c);
+  return result;
+}
+
+byte_set make_byte(unsigned char c) {
+  auto result = byte_set{};
+  result.set(c);
+  return result;
+}
+
+/// The set for `.`, which matches everything but line terminators.
+byte_set any_set() {
+  auto result = ~byte_set{};
+  result.reset('\n');
+  result.reset('\r');
+  return result;
+}
+
+/// Parses the ECMAScript grammar of `std::regex` into a syntax tree.
+class parser {
+public:
+  explicit parser(std::string_view str) : str_{str} {
+    // nop
+  }
+
+  caf::expected<node> parse() {
+    auto result = alternation();
+    if (!result)
+      return result;
+    if (pos_ != str_.size())
+      return caf::make_error(ec::parse_error, "unbalanced parenthesis");
+    return result;
+  }
+
+private:
+  [[nodiscard]] bool at_end() const {
+    return pos_ == str_.size();
+  }
+
+  [[nodiscard]] char peek() const {
+    return str_[pos_];
+  }
+
+  caf::expected<node> alternation() {
+    if (++depth_ > max_depth)
+      return caf::make_error(ec::unimplemented, "nesting too deep");
+    auto branch = concatenation();
+    if (!branch)
+      return branch;
+    if (at_end() || peek() != '|') {
+      --depth_;
+      return branch;
+    }
+    auto result = node{.k = node::kind::alternate};
+    result.children.push_back(std::move(*branch));
+    while (!at_end() && peek() == '|') {
+      ++pos_;
+      branch = concatenation();
+      if (!branch)
+        return branch;
+      result.children.push_back(std::move(*branch));
+    }
+    --depth_;
+    return result;
+  }
+
+  caf::expected<node> concatenation() {
+    auto result = node{.k = node::kind::concat};
+    while (!at_end() && peek() != '|' && peek() != ')') {
+      auto x = repetition();
+      if (!x)
+        return x;
+      result.children.push_back(std::move(*x));
+    }
+    return result;
+  }
+
+  caf::expected<node> repetition() {
+    auto result = atom();
+    if (!result || at_end())
+      return result;
+    auto min = size_t{0};
+    auto max = unbounded;
+    switch (peek()) {
+      default:
+        return result;
+      case '*':
+        ++pos_;
+        break;
+      case '+':
+        ++pos_;
+        min = 1;
+        break;
+      case '?':
+        ++pos_;
+        max = 1;
+        break;
+      case '{': {
+        ++pos_;
+        auto bound = number();
+        if (!bound)
+          return caf::make_error(ec::parse_error, "invalid repetition");
+        min = max = *bound;
+        if (!at_end() && peek() == ',') {
+          ++pos_;
+          max = unbounded;
+          if (!at_end() && peek() != '}') {
+            bound = number();
+            if (!bound)
+              return caf::make_error(ec::parse_error, "invalid repetition");
+            max = *bound;
+          }
+        }
+        if (at_end() || peek() != '}' || min > max)
+          return caf::make_error(ec::parse_error, "invalid repetition");
+        ++pos_;
+        if (min > max_repetitions
+            || (max != unbounded && max > max_repetitions))
+          return caf::make_error(ec::unimplemented, "repetition too large");
+        break;
+      }
+    }
+    // Lazy quantifiers accept the same language as greedy ones.
+    if (!at_end() && peek() == '?')
+      ++pos_;
+    if (!at_end()
+        && (peek() == '*' || peek() == '+' || peek() == '?' || peek() == '{'))
+      return caf::make_error(ec::parse_error, "nested quantifier");
+    if (result->k == node::kind::begin || result->k == node::kind::end)
+      return caf::make_error(ec::parse_error, "quantified assertion");
+    auto repeat = node{.k = node::kind::repeat, .min = min, .max = max};
+    repeat.children.push_back(std::move(*result));
+    return repeat;
+  }
+
+  std::optional<size_t> number() {
+    auto result = std::optional<size_t>{};
+    while (!at_end() && peek() >= '0' && peek() <= '9') {
+      result = result.value_or(0) * 10 + (peek() - '0');
+      if (*result > max_repetitions * 10)
+        result = max_repetitions * 10;
+      ++pos_;
+    }
+    return result;
+  }
+
+  caf::expected<node> atom() {
+    auto c = peek();
+    switch (c) {
+      case '(': {
+        ++pos_;
+        if (!at_end() && peek() == '?') {
+          if (pos_ + 1 < str_.size() && str_[pos_ + 1] == ':')
+            pos_ += 2;
+          else
+            return caf::make_error(ec::unimplemented, "assertions");
+        }
+        auto result = alternation();
+        if (!result)
+          return result;
+        if (at_end() || peek() != ')')
+          return caf::make_error(ec::parse_error, "unbalanced parenthesis");
+        ++pos_;
+        return result;
+      }
+      case '[':
+        ++pos_;
+        return char_class();
+      case '.':
+        ++pos_;
+        return node{.k = node::kind::set, .set = any_set()};
+      case '^':
+        ++pos_;
+        return node{.k = node::kind::begin};
+      case '$':
+        ++pos_;
+        return node{.k = node::kind::end};
+      case '\\': {
+        ++pos_;
+        auto set = escape(false);
+        if (!set)
+          return set.error();
+        return node{.k = node::kind::set, .set = *set};
+      }
+      case '*':
+      case '+':
+      case '?':
+      case '{':
+        return caf::make_error(ec::parse_error, "quantifier without operand");
+      default:
+        ++pos_;
+        return node{.k = node::kind::set,
+                    .set = make_byte(static_cast<unsigned char>(c))};
+    }
+  }
+
+  /// Parses an escape sequence after the backslash.
+  caf::expected<byte_set> escape(bool in_class) {
+    if (at_end())
+      return caf::make_error(ec::parse_error, "trailing backslash");
+    auto c = peek();
+    ++pos_;
+    auto digit = make_range('0', '9');
+    auto word = make_range('a', 'z') | make_range('A', 'Z') | digit
+                | make_byte('_');
+    auto space = make_byte(' ') | make_range('\t', '\r');
+    switch (c) {
+      case 'd':
+        return digit;
+      case 'D':
+        return ~digit;
+      case 'w':
+        return word;
+      case 'W':
+        return ~word;
+      case 's':
+        return space;
+      case 'S':
+        return ~space;
+      case 't':
+        return make_byte('\t');
+      case 'n':
+        return make_byte('\n');
+      case 'r':
+        return make_byte('\r');
+      case 'f':
+        return make_byte('\f');
+      case 'v':
+        return make_byte('\v');
+      case 'b':
+        if (in_class)
+          return make_byte('\b');
+        return caf::make_error(ec::unimplemented, "word boundaries");
+      case '0':
+        if (!at_end() && peek() >= '0' && peek() <= '9')
+          return caf::make_error(ec::unimplemented, "octal escapes");
+        return make_byte('\0');
+      case 'x': {
+        auto value = 0;
+        for (auto i = 0; i < 2; ++i, ++pos_) {
+          if (at_end())
+            return caf::make_error(ec::parse_error, "invalid hex escape");
+          auto h = peek();
+          if (h >= '0' && h <= '9')
+            value = value * 16 + (h - '0');
+          else if (h >= 'a' && h <= 'f')
+            value = value * 16 + (h - 'a' + 10);
+          else if (h >= 'A' && h <= 'F')
+            value = value * 16 + (h - 'A' + 10);
+          else
+            return caf::make_error(ec::parse_error, "invalid hex escape");
+        }
+        return make_byte(static_cast<unsigned char>(value));
+      }
+      default:
+        // Letters and digits have special meanings, e.g., back references,
+        // that we do not support. Everything else is an identity escape.
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')
+            || (c >= '0' && c <= '9'))
+          return caf::make_error(ec::unimplemented, "escape sequence");
+        return make_byte(static_cast<unsigned char>(c));
+    }
+  }
+
+  /// Parses a character class after the opening bracket.
+  caf::expected<node> char_class() {
+    auto negated = false;
+    if (!at_end() && peek() == '^') {
+      negated = true;
+      ++pos_;
+    }
+    if (!at_end() && peek() == ']')
+      return caf::make_error(ec::unimplemented, "empty character class");
+    auto result = byte_set{};
+    // Parses a single class atom; returns an empty set for class escapes.
+    auto class_atom = [&]() -> caf::expected<byte_set> {
+      auto c = peek();
+      if (c == '[' && pos_ + 1 < str_.size()
+          && (str_[pos_ + 1] == ':' || str_[pos_ + 1] == '.'
+              || str_[pos_ + 1] == '='))
+        return caf::make_error(ec::unimplemented, "POSIX character classes");
+      ++pos_;
+      if (c == '\\')
+        return escape(true);
+      return make_byte(static_cast<unsigned char>(c));
+    };
+    while (true) {
+      if (at_end())
+        return caf::make_error(ec::parse_error, "unbalanced bracket");
+      if (peek() == ']') {
+        ++pos_;
+        break;
+      }
+      auto first = class_atom();
+      if (!first)
+        return first.error();
+      if (pos_ + 1 < str_.size() && peek() == '-' && str_[pos_ + 1] != ']') {
+        ++pos_;
+        auto last = class_atom();
+        if (!last)
+          return last.error();
+        if (first->count() != 1 || last->count() != 1)
+          return caf::make_error(ec::unimplemented, "class escape in range");
+        auto lo = size_t{0};
+        auto hi = size_t{0};
+        while (!first->test(lo))
+          ++lo;
+        while (!last->test(hi))
+          ++hi;
+        if (lo > hi)
+          return caf::make_error(ec::parse_error, "invalid range");
+        if (hi >= 0x80)
+          return caf::make_error(ec::unimplemented, "non-ASCII range");
+        result |= make_range(static_cast<unsigned char>(lo),
+                             static_cast<unsigned char>(hi));
+      } else {
+        result |= *first;
+      }
+    }
+    if (negated)
+      result.flip();
+    return node{.k = node::kind::set, .set = result};
+  }
+
+  std::string_view str_;
+  size_t pos_ = 0;
+  size_t depth_ = 0;
+};
+
+/// Translates a syntax tree into a Thompson NFA.
+class compiler {
+public:
+  compiler(std::vector<regex::instruction>& program,
+           std::vector<byte_set>& sets)
+    : program_{program}, sets_{sets} {
+    // nop
+  }
+
+  bool compile(const node& root) {
+    if (!emit(root))
+      return false;
+    program_.push_back({.op = regex::instruction::opcode::match});
+    return true;
+  }
+
+private:
+  using opcode = regex::instruction::opcode;
+
+  uint32_t pc() const {
+    return static_cast<uint32_t>(program_.size());
+  }
+
+  bool push(regex::instruction x) {
+    if (program_.size() >= max_program_size)
+      return false;
+    program_.push_back(x);
+    return true;
+  }
+
+  bool emit(const node& x) {
+    switch (x.k) {
+      case node::kind::set: {
+        auto [it, inserted]
+          = set_ids_.try_emplace(x.set, static_cast<uint32_t>(sets_.size()));
+        if (inserted)
+          sets_.push_back(x.set);
+        return push({.op = opcode::byte, .x = it->second});
+      }
+      case node::kind::concat:
+        for (const auto& child : x.children)
+          if (!emit(child))
+            return false;
+        return true;
+      case node::kind::alternate: {
+        auto jumps = std::vector<uint32_t>{};
+        for (size_t i = 0; i < x.children.size(); ++i) {
+          auto split = pc();
+          auto last = i + 1 == x.children.size();
+          if (!last && !push({.op = opcode::split, .x = split + 1}))
+            return false;
+          if (!emit(x.children[i]))
+            return false;
+          if (!last) {
+            jumps.push_back(pc());
+            if (!push({.op = opcode::jump}))
+              return false;
+            program_[split].y = pc();
+          }
+        }
+        for (auto jump : jumps)
+          program_[jump].x = pc();
+        return true;
+      }
+      case node::kind::repeat: {
+        const auto& child = x.children[0];
+        for (size_t i = 0; i < x.min; ++i)
+          if (!emit(child))
+            return false;
+        if (x.max == unbounded) {
+          auto split = pc();
+          if (!push({.op = opcode::split, .x = split + 1}))
+            return false;
+          if (!emit(child))
+            return false;
+          if (!push({.op = opcode::jump, .x = split}))
+            return false;
+          program_[split].y = pc();
+          return true;
+        }
+        auto splits = std::vector<uint32_t>{};
+        for (size_t i = x.min; i < x.max; ++i) {
+          splits.push_back(pc());
+          if (!push({.op = opcode::split, .x = pc() + 1}))
+            return false;
+          if (!emit(child))
+            return false;
+        }
+        for (auto split : splits)
+          program_[split].y = pc();
+        return true;
+      }
+      case node::kind::begin:
+        return push({.op = opcode::begin});
+      case node::kind::end:
+        return push({.op = opcode::end});
+    }
+    VAST_ASSERT(!"unreachable");
+    return false;
+  }
+
+  std::vector<regex::instruction>& program_;
+  std::vector<byte_set>& sets_;
+  std::unordered_map<byte_set, uint32_t> set_ids_ = {};
+};
+
+/// Computes epsilon closures over the NFA program.
+class closure {
+public:
+  explicit closure(const std::vector<regex::instruction>& program)
+    : program_{program}, marks_(program.size(), 0) {
+    // nop
+  }
+
+  /// Adds the instructions that consume input, accept, or wait for the end of
+  /// the input, reachable from *pc* without consuming input, to *out*.
+  void add(uint32_t pc, bool at_begin, std::vector<uint32_t>& out) {
+    stack_.push_back(pc);
+    while (!stack_.empty()) {
+      auto x = stack_.back();
+      stack_.pop_back();
+      if (marks_[x] == generation_)
+        continue;
+      marks_[x] = generation_;
+      const auto& inst = program_[x];
+      switch (inst.op) {
+        case regex::instruction::opcode::byte:
+        case regex::instruction::opcode::end:
+        case regex::instruction::opcode::match:
+          out.push_back(x);
+          break;
+        case regex::instruction::opcode::split:
+          stack_.push_back(inst.y);
+          stack_.push_back(inst.x);
+          break;
+        case regex::instruction::opcode::jump:
+          stack_.push_back(inst.x);
+          break;
+        case regex::instruction::opcode::begin:
+          if (at_begin)
+            stack_.push_back(x + 1);
+          break;
+      }
+    }
+  }
+
+  /// Starts a new closure, forgetting all visited instructions.
+  void reset() {
+    if (++generation_ == 0) {
+      std::fill(marks_.begin(), marks_.end(), 0);
+      generation_ = 1;
+    }
+  }
+
+  /// Checks whether a set of instructions accepts at the end of the input.
+  bool accepts_at_end(const std::vector<uint32_t>& xs, bool at_begin) {
+    reset();
+    auto reachable = std::vector<uint32_t>{};
+    for (auto x : xs) {
+      if (program_[x].op == regex::instruction::opcode::match)
+        return true;
+      if (program_[x].op == regex::instruction::opcode::end) {
+        // Passing an end anchor may reach further end anchors.
+        reachable.clear();
+        add(x + 1, at_begin, reachable);
+        for (size_t i = 0; i < reachable.size(); ++i) {
+          auto y = reachable[i];
+          if (program_[y].op == regex::instruction::opcode::match)
+            return true;
+          if (program_[y].op == regex::instruction::opcode::end)
+            add(y + 1, at_begin, reachable);
+        }
+      }
+    }
+    return false;
+  }
+
+private:
+  const std::vector<regex::instruction>& program_;
+  std::vector<uint32_t> marks_;
+  uint32_t generation_ = 1;
+  std::vector<uint32_t> stack_ = {};
+};
+
+/// Appends the leading literal of a syntax tree to *out*.
+/// @returns `true` if the entire tree is a literal.
+bool literal_prefix(const node& x, std::string& out) {
+  switch (x.k) {
+    case node::kind::set:
+      if (x.set.count() != 1)
+        return false;
+      for (size_t c = 0; c < 256; ++c)
+        if (x.set.test(c))
+          out.push_back(static_cast<char>(c));
+      return true;
+    case node::kind::concat:
+      for (const auto& child : x.children)
+        if (!literal_prefix(child, out))
+          return false;
+      return true;
+    case node::kind::repeat: {
+      if (x.min == 0)
+        return false;
+      auto once = std::string{};
+      if (!literal_prefix(x.children[0], once)) {
+        out += once;
+        return false;
+      }
+      for (size_t i = 0; i < x.min; ++i)
+        out += once;
+      return x.min == x.max;
+    }
+    default:
+      return false;
+  }
+}
+
+/// Flattens a syntax tree into the segments of a glob, if possible.
+bool make_glob(const node& x, std::vector<regex::glob_segment>& out) {
+  const auto any = any_set();
+  switch (x.k) {
+    case node::kind::set:
+      if (x.set == any) {
+        out.back().bytes.push_back('\0');
+        out.back().wildcards.push_back(true);
+        return true;
+      }
+      if (x.set.count() != 1 || x.set.test('\n') || x.set.test('\r'))
+        return false;
+      for (size_t c = 0; c < 256; ++c)
+        if (x.set.test(c))
+          out.back().bytes.push_back(static_cast<char>(c));
+      out.back().wildcards.push_back(false);
+      return true;
+    case node::kind::concat:
+      for (const auto& child : x.children)
+        if (!make_glob(child, out))
+          return false;
+      return true;
+    case node::kind::repeat: {
+      if (x.min != 0 || x.max != unbounded)
+        return false;
+      const auto* child = &x.children[0];
+      while (child->k == node::kind::concat && child->children.size() == 1)
+        child = &child->children[0];
+      if (child->k != node::kind::set || child->set != any)
+        return false;
+      out.emplace_back();
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+/// Checks whether a glob segment matches at the given position.
+bool matches_at(const regex::glob_segment& segment, std::string_view str,
+                size_t pos) {
+  for (size_t i = 0; i < segment.bytes.size(); ++i)
+    if (!segment.wildcards[i] && segment.bytes[i] != str[pos + i])
+      return false;
+  return true;
+}
+
+/// Finds the leftmost occurrence of a glob segment in `str[from, to)`.
+size_t find_segment(const regex::glob_segment& segment, std::string_view str,
+                    size_t from, size_t to) {
+  const auto size = segment.bytes.size();
+  if (to < from || to - from < size)
+    return std::string_view::npos;
+  // Use the leading literal bytes of the segment to find candidates.
+  auto literal = size_t{0};
+  while (literal < size && !segment.wildcards[literal])
+    ++literal;
+  if (literal == 0) {
+    for (auto pos = from; pos + size <= to; ++pos)
+      if (matches_at(segment, str, pos))
+        return pos;
+    return std::string_view::npos;
+  }
+  const auto needle = std::string_view{segment.bytes}.substr(0, literal);
+  for (auto pos = str.find(needle, from);
+       pos != std::string_view::npos && pos + size <= to;
+       pos = str.find(needle, pos + 1))
+    if (matches_at(segment, str, pos))
+      return pos;
+  return std::string_view::npos;
+}
+
+} // namespace
+
+caf::expected<regex> regex::make(std::string_view str) {
+  auto root = parser{str}.parse();
+  if (!root)
+    return root.error();
+  auto result = regex{};
+  // Extract the literal prefix, skipping leading anchors.
+  const auto* body = &*root;
+  auto skip = size_t{0};
+  if (body->k == node::kind::concat) {
+    while (skip < body->children.size()
+           && body->children[skip].k == node::kind::begin) {
+      result.anchored_ = true;
+      ++skip;
+    }
+    for (auto i = skip; i < body->children.size(); ++i)
+      if (!literal_prefix(body->children[i], result.prefix_))
+        break;
+  } else {
+    literal_prefix(*body, result.prefix_);
+  }
+  // Expressions consisting of literals, `.`, and `.*` take the fast path.
+  auto segments = std::vector<glob_segment>(1);
+  if (make_glob(*root, segments)) {
+    result.glob_ = std::move(segments);
+    return result;
+  }
+  auto c = compiler{result.program_, result.sets_};
+  if (!c.compile(*root))
+    return caf::make_error(ec::unimplemented, "expression too large");
+  // Partition the bytes into equivalence classes that no set distinguishes.
+  auto signatures = std::map<std::vector<bool>, uint8_t>{};
+  for (size_t b = 0; b < 256; ++b) {
+    auto signature = std::vector<bool>(result.sets_.size());
+    for (size_t i = 0; i < result.sets_.size(); ++i)
+      signature[i] = result.sets_[i].test(b);
+    auto [it, inserted] = signatures.try_emplace(
+      std::move(signature), static_cast<uint8_t>(signatures.size()));
+    result.classes_[b] = it->second;
+  }
+  result.num_classes_ = signatures.size();
+  result.match_dfa_ = result.make_automaton(false);
+  if (result.match_dfa_)
+    result.search_dfa_ = result.make_automaton(true);
+  return result;
+}
+
+bool regex::match(std::string_view str) const {
+  if (glob_) {
+    // No element of a glob matches a line terminator.
+    if (str.find_first_of("\n\r") != std::string_view::npos)
+      return false;
+    return match_glob(str, true);
+  }
+  if (!str.starts_with(prefix_))
+    return false;
+  if (match_dfa_)
+    return run(*match_dfa_, str, 0);
+  return simulate(str, 0, false);
+}
+
+bool regex::search(std::string_view str) const {
+  if (glob_) {
+    // A match cannot span multiple lines, so we search every line separately.
+    auto pos = size_t{0};
+    while (true) {
+      auto end = str.find_first_of("\n\r", pos);
+      auto line = str.substr(pos, end == std::string_view::npos
+                                    ? std::string_view::npos
+                                    : end - pos);
+      if (match_glob(line, false))
+        return true;
+      if (end == std::string_view::npos)
+        return false;
+      pos = end + 1;
+    }
+  }
+  // All matches start with the prefix, so we can skip ahead to its first
+  // occurrence.
+  auto from = size_t{0};
+  if (anchored_) {
+    if (!str.starts_with(prefix_))
+      return false;
+  } else if (!prefix_.empty()) {
+    from = str.find(prefix_);
+    if (from == std::string_view::npos)
+      return false;
+  }
+  if (search_dfa_)
+    return run(*search_dfa_, str, from);
+  return simulate(str, from, true);
+}
+
+const std::string& regex::prefix() const noexcept {
+  return prefix_;
+}
+
+std::vector<std::string> regex::literals() const {
+  auto result = std::vector<std::string>{};
+  if (!glob_) {
+    if (!prefix_.empty())
+      result.push_back(prefix_);
+    return result;
+  }
+  // Every segment of a glob occurs in a match, so the runs of bytes between
+  // the wildcards of a segment do as well.
+  for (const auto& segment : *glob_) {
+    auto run = std::string{};
+    for (size_t i = 0; i < segment.bytes.size(); ++i) {
+      if (!segment.wildcards[i]) {
+        run += segment.bytes[i];
+        continue;
+      }
+      if (!run.empty())
+        result.push_back(std::exchange(run, {}));
+    }
+    if (!run.empty())
+      result.push_back(std::move(run));
+  }
+  return result;
+}
+
+bool regex::is_glob() const noexcept {
+  return glob_.has_value();
+}
+
+bool regex::is_dfa() const noexcept {
+  return search_dfa_.has_value();
+}
+
+bool regex::match_glob(std::string_view str, bool anchored) const {
+  const auto& segments = *glob_;
+  const auto n = str.size();
+  if (!anchored) {
+    auto pos = size_t{0};
+    for (const auto& segment : segments) {
+      auto found = find_segment(segment, str, pos, n);
+      if (found == std::string_view::npos)
+        return false;
+      pos = found + segment.bytes.size();
+    }
+    return true;
+  }
+  const auto& first = segments.front();
+  const auto& last = segments.back();
+  if (segments.size() == 1)
+    return n == first.bytes.size() && matches_at(first, str, 0);
+  if (n < first.bytes.size() + last.bytes.size()
+      || !matches_at(first, str, 0)
+      || !matches_at(last, str, n - last.bytes.size()))
+    return false;
+  auto pos = first.bytes.size();
+  const auto to = n - last.bytes.size();
+  for (size_t i = 1; i + 1 < segments.size(); ++i) {
+    auto found = find_segment(segments[i], str, pos, to);
+    if (found == std::string_view::npos)
+      return false;
+    pos = found + segments[i].bytes.size();
+  }
+  return true;
+}
+
+std::optional<regex::automaton> regex::make_automaton(bool search) const {
+  auto result = automaton{};
+  auto c = closure{program_};
+  auto states = std::vector<std::vector<uint32_t>>{};
+  auto ids = std::map<std::vector<uint32_t>, uint32_t>{};
+  auto num_instructions = size_t{0};
+  auto intern = [&](std::vector<uint32_t> xs) -> std::optional<uint32_t> {
+    std::sort(xs.begin(), xs.end());
+    xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+    if (auto it = ids.find(xs); it != ids.end())
+      return it->second;
+    // Give up on the DFA and simulate the NFA instead if the automaton grows
+    // too large, e.g., for bounded repetitions of wildcards.
+    if ((states.size() + 1) * num_classes_ > max_transitions)
+      return std::nullopt;
+    num_instructions += xs.size();
+    if (num_instructions > max_dfa_instructions)
+      return std::nullopt;
+    auto id = static_cast<uint32_t>(states.size());
+    ids.emplace(xs, id);
+    states.push_back(std::move(xs));
+    return id;
+  };
+  // A search may start a new match at every position after the first.
+  auto restart = std::vector<uint32_t>{};
+  if (search) {
+    c.reset();
+    c.add(0, false, restart);
+  }
+  auto start = std::vector<uint32_t>{};
+  c.reset();
+  c.add(0, true, start);
+  result.start_final = c.accepts_at_end(start, true);
+  auto start_id = intern(start);
+  auto restart_id = intern(restart);
+  if (!start_id || !restart_id)
+    return std::nullopt;
+  result.start = *start_id;
+  result.restart = *restart_id;
+  auto next = std::vector<uint32_t>{};
+  for (size_t i = 0; i < states.size(); ++i) {
+    for (size_t cls = 0; cls < num_classes_; ++cls) {
+      const auto representative = static_cast<size_t>(
+        std::find(classes_.begin(), classes_.end(), cls) - classes_.begin());
+      next.clear();
+      c.reset();
+      for (auto pc : states[i])
+        if (program_[pc].op == instruction::opcode::byte
+            && sets_[program_[pc].x].test(representative))
+          c.add(pc + 1, false, next);
+      next.insert(next.end(), restart.begin(), restart.end());
+      auto id = intern(next);
+      if (!id)
+        return std::nullopt;
+      result.transitions.push_back(*id);
+    }
+  }
+  for (const auto& state : states) {
+    auto flags = uint8_t{0};
+    if (search
+        && std::any_of(state.begin(), state.end(), [&](uint32_t pc) {
+             return program_[pc].op == instruction::opcode::match;
+           }))
+      flags |= automaton::accepting;
+    if (c.accepts_at_end(state, false))
+      flags |= automaton::final;
+    if (state.empty())
+      flags |= automaton::dead;
+    result.flags.push_back(flags);
+  }
+  return result;
+}
+
+bool regex::run(const automaton& dfa, std::string_view str,
+                size_t from) const {
+  if (str.empty())
+    return dfa.start_final;
+  auto state = from == 0 ? dfa.start : dfa.restart;
+  if (dfa.flags[state] & automaton::accepting)
+    return true;
+  for (auto i = from; i < str.size(); ++i) {
+    const auto cls = classes_[static_cast<unsigned char>(str[i])];
+    state = dfa.transitions[state * num_classes_ + cls];
+    if (dfa.flags[state] & (automaton::accepting | automaton::dead))
+      return (dfa.flags[state] & automaton::accepting) != 0;
+  }
+  return (dfa.flags[state] & automaton::final) != 0;
+}
+
+bool regex::simulate(std::string_view str, size_t from, bool search) const {
+  auto c = closure{program_};
+  auto current = std::vector<uint32_t>{};
+  auto next = std::vector<uint32_t>{};
+  auto accepting = [&] {
+    return search
+           && std::any_of(current.begin(), current.end(), [&](uint32_t pc) {
+                return program_[pc].op == instruction::opcode::match;
+              });
+  };
+  c.reset();
+  c.add(0, from == 0, current);
+  for (auto i = from; i < str.size(); ++i) {
+    if (accepting())
+      return true;
+    const auto b = static_cast<unsigned char>(str[i]);
+    next.clear();
+    c.reset();
+    for (auto pc : current)
+      if (program_[pc].op == instruction::opcode::byte
+          && sets_[program_[pc].x].test(b))
+        c.add(pc + 1, false, next);
+    if (search)
+      c.add(0, false, next);
+    if (next.empty())
+      return false;
+    std::swap(current, next);
+  }
+  return accepting() || c.accepts_at_end(current, str.empty());
+}
+
+} // namespace vast::detail
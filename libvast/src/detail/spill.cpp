@@ -0,0 +1,68 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/detail/spill.hpp"
+
+#include "vast/concept/parseable/vast/si.hpp"
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+#include "vast/uuid.hpp"
+
+#include <fmt/format.h>
+
+namespace vast::detail {
+
+caf::expected<uint64_t> parse_memory_budget(const data& value) {
+  if (const auto* bytes = caf::get_if<count>(&value))
+    return *bytes;
+  if (const auto* bytes = caf::get_if<integer>(&value);
+      bytes && bytes->value >= 0)
+    return bytes->value;
+  if (const auto* str = caf::get_if<std::string>(&value)) {
+    auto bytes = count{};
+    if (parsers::bytesize(*str, bytes))
+      return bytes;
+  }
+  return caf::make_error(ec::invalid_configuration,
+                         fmt::format("unexpected config key: memory-budget {} "
+                                     "is not a number of bytes",
+                                     value));
+}
+
+caf::expected<std::filesystem::path> parse_spill_directory(const data& value) {
+  if (const auto* directory = caf::get_if<std::string>(&value))
+    return std::filesystem::path{*directory};
+  return caf::make_error(ec::invalid_configuration,
+                         fmt::format("unexpected config key: spill-directory "
+                                     "{} is not a string",
+                                     value));
+}
+
+caf::expected<std::filesystem::path>
+make_spill_directory(const std::filesystem::path& parent,
+                     std::string_view name) {
+  auto err = std::error_code{};
+  auto result = parent;
+  if (result.empty())
+    result = std::filesystem::temp_directory_path(err);
+  if (err)
+    return caf::make_error(ec::filesystem_error,
+                           fmt::format("failed to find a directory for "
+                                       "spilling: {}",
+                                       err.message()));
+  result /= fmt::format("vast-{}-{}", name, uuid::random());
+  std::filesystem::create_directories(result, err);
+  if (err)
+    return caf::make_error(ec::filesystem_error,
+                           fmt::format("failed to create directory {} for "
+                                       "spilling: {}",
+                                       result, err.message()));
+  return result;
+}
+
+} // namespace vast::detail
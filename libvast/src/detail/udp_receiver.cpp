@@ -0,0 +1,362 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/detail/udp_receiver.hpp"
+
+#include "vast/config.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+
+#include <caf/expected.hpp>
+#include <fmt/format.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <poll.h>
+#include <unistd.h>
+
+namespace vast::detail {
+
+namespace {
+
+/// The interval in which receiver threads check whether they should stop.
+constexpr int poll_interval_ms = 100;
+
+/// The maximum payload size of a UDP datagram.
+constexpr size_t max_datagram_size = 65'535;
+
+/// Opens a single UDP socket bound to the given address.
+caf::expected<int> open_socket(const ::addrinfo& ai, const std::string& host,
+                               uint16_t port,
+                               const udp_receiver::options& opts) {
+  auto fd = ::socket(ai.ai_family, ai.ai_socktype, ai.ai_protocol);
+  if (fd < 0)
+    return caf::make_error(ec::system_error,
+                           fmt::format("failed to create UDP socket: {}",
+                                       std::strerror(errno)));
+  auto fail = [&](std::string_view what) {
+    auto err = caf::make_error(ec::system_error,
+                               fmt::format("failed to {} for UDP socket at "
+                                           "{}:{}: {}",
+                                           what, host, port,
+                                           std::strerror(errno)));
+    ::close(fd);
+    return err;
+  };
+  int on = 1;
+  if (::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0)
+    return fail("set SO_REUSEADDR");
+  if (opts.receivers > 1)
+    if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0)
+      return fail("set SO_REUSEPORT");
+  if (opts.receive_buffer_size > 0) {
+    auto size = static_cast<int>(
+      std::min(opts.receive_buffer_size,
+               static_cast<size_t>(std::numeric_limits<int>::max())));
+#if VAST_LINUX
+    // SO_RCVBUFFORCE bypasses the net.core.rmem_max limit, but requires
+    // CAP_NET_ADMIN. We silently fall back to SO_RCVBUF without it.
+    if (::setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) < 0)
+#endif
+      if (::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)) < 0)
+        return fail("set SO_RCVBUF");
+    int actual = 0;
+    auto len = static_cast<socklen_t>(sizeof(actual));
+    if (::getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &actual, &len) == 0
+        && actual < size)
+      VAST_WARN("UDP receive buffer for port {} is limited to {} bytes "
+                "instead of the requested {} bytes; consider raising "
+                "net.core.rmem_max",
+                port, actual, size);
+  }
+#if VAST_LINUX
+  // Have the kernel attach the number of dropped datagrams to each message.
+  if (::setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &on, sizeof(on)) < 0)
+    return fail("set SO_RXQ_OVFL");
+#endif
+  if (::bind(fd, ai.ai_addr, ai.ai_addrlen) < 0)
+    return fail("bind");
+  return fd;
+}
+
+/// Determines the port a socket is bound to.
+caf::expected<uint16_t> bound_port(int fd) {
+  ::sockaddr_storage addr = {};
+  auto len = static_cast<socklen_t>(sizeof(addr));
+  if (::getsockname(fd, reinterpret_cast<::sockaddr*>(&addr), &len) < 0)
+    return caf::make_error(ec::system_error,
+                           fmt::format("failed to get UDP socket address: {}",
+                                       std::strerror(errno)));
+  if (addr.ss_family == AF_INET6)
+    return ntohs(reinterpret_cast<::sockaddr_in6*>(&addr)->sin6_port);
+  return ntohs(reinterpret_cast<::sockaddr_in*>(&addr)->sin_port);
+}
+
+} // namespace
+
+caf::expected<std::shared_ptr<udp_receiver>>
+udp_receiver::make(options opts) {
+  if (opts.receivers == 0)
+    return caf::make_error(ec::invalid_argument, "UDP receiver requires at "
+                                                 "least one socket");
+  if (opts.batch_size == 0)
+    return caf::make_error(ec::invalid_argument, "UDP receiver requires a "
+                                                 "non-zero batch size");
+  ::addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+  ::addrinfo* ai = nullptr;
+  auto service = std::to_string(opts.port);
+  auto host = opts.host.empty() ? nullptr : opts.host.c_str();
+  if (auto rc = ::getaddrinfo(host, service.c_str(), &hints, &ai); rc != 0)
+    return caf::make_error(ec::system_error,
+                           fmt::format("failed to resolve UDP endpoint {}:{}: "
+                                       "{}",
+                                       opts.host, opts.port,
+                                       ::gai_strerror(rc)));
+  auto result = std::shared_ptr<udp_receiver>{new udp_receiver{opts}};
+  auto port = opts.port;
+  for (size_t i = 0; i < opts.receivers; ++i) {
+    // An ephemeral port gets chosen by the first socket only; all other
+    // sockets must share it.
+    if (port != opts.port) {
+      if (ai->ai_family == AF_INET6)
+        reinterpret_cast<::sockaddr_in6*>(ai->ai_addr)->sin6_port = htons(port);
+      else
+        reinterpret_cast<::sockaddr_in*>(ai->ai_addr)->sin_port = htons(port);
+    }
+    auto fd = open_socket(*ai, opts.host, port, opts);
+    if (!fd) {
+      ::freeaddrinfo(ai);
+      return std::move(fd.error());
+    }
+    result->fds_.push_back(*fd);
+    if (port == 0) {
+      auto actual = bound_port(*fd);
+      if (!actual) {
+        ::freeaddrinfo(ai);
+        return std::move(actual.error());
+      }
+      port = *actual;
+    }
+  }
+  ::freeaddrinfo(ai);
+  result->options_.port = port;
+  for (auto fd : result->fds_)
+    result->threads_.emplace_back([receiver = result.get(), fd] {
+      receiver->run(fd);
+    });
+  VAST_VERBOSE("UDP receiver listens on port {} with {} socket(s)", port,
+               result->fds_.size());
+  return result;
+}
+
+udp_receiver::udp_receiver(options opts) : options_{std::move(opts)} {
+  // nop
+}
+
+udp_receiver::~udp_receiver() noexcept {
+  stop();
+  for (auto& thread : threads_)
+    if (thread.joinable())
+      thread.join();
+  for (auto fd : fds_)
+    ::close(fd);
+}
+
+bool udp_receiver::receive(std::string& out,
+                           std::optional<std::chrono::milliseconds> timeout) {
+  out.clear();
+  auto lock = std::unique_lock{mutex_};
+  auto ready = [this] {
+    return !buffer_.empty() || stopped_;
+  };
+  if (timeout)
+    cv_.wait_for(lock, *timeout, ready);
+  else
+    cv_.wait(lock, ready);
+  if (buffer_.empty())
+    return false;
+  out.swap(buffer_);
+  return true;
+}
+
+void udp_receiver::stop() {
+  {
+    // Setting the flag under the lock guarantees that waiting readers do not
+    // miss the wakeup.
+    auto lock = std::lock_guard{mutex_};
+    stopped_ = true;
+  }
+  cv_.notify_all();
+}
+
+bool udp_receiver::stopped() const {
+  return stopped_;
+}
+
+uint16_t udp_receiver::port() const {
+  return options_.port;
+}
+
+udp_receiver::statistics udp_receiver::stats() const {
+  return {
+    .datagrams = datagrams_,
+    .bytes = bytes_,
+    .batches = batches_,
+    .dropped = dropped_,
+    .kernel_dropped = kernel_dropped_,
+  };
+}
+
+void udp_receiver::append(const char* data, size_t size) {
+  // Strip a trailing newline; we add one back unconditionally so that every
+  // datagram ends up on a line of its own.
+  if (size > 0 && data[size - 1] == '\n')
+    --size;
+  if (buffer_.size() + size + 1 > options_.max_buffered_bytes) {
+    ++dropped_;
+    return;
+  }
+  buffer_.append(data, size);
+  buffer_.push_back('\n');
+  ++datagrams_;
+  bytes_ += size;
+}
+
+void udp_receiver::run(int fd) {
+#if VAST_LINUX
+  const auto n = options_.batch_size;
+  auto storage = std::vector<char>(n * max_datagram_size);
+  auto iovecs = std::vector<::iovec>(n);
+  auto headers = std::vector<::mmsghdr>(n);
+  constexpr auto control_size = CMSG_SPACE(sizeof(uint32_t));
+  auto controls = std::vector<std::array<char, control_size>>(n);
+  for (size_t i = 0; i < n; ++i) {
+    iovecs[i].iov_base = storage.data() + i * max_datagram_size;
+    iovecs[i].iov_len = max_datagram_size;
+  }
+  // The kernel reports the drop counter of the socket cumulatively.
+  auto last_kernel_drops = uint32_t{0};
+#else
+  auto storage = std::vector<char>(max_datagram_size);
+#endif
+  while (!stopped_) {
+    auto pfd = ::pollfd{fd, POLLIN, 0};
+    auto rc = ::poll(&pfd, 1, poll_interval_ms);
+    if (rc < 0 && errno != EINTR) {
+      VAST_WARN("UDP receiver failed to poll socket: {}", std::strerror(errno));
+      break;
+    }
+    if (rc <= 0)
+      continue;
+#if VAST_LINUX
+    for (size_t i = 0; i < n; ++i) {
+      headers[i] = {};
+      headers[i].msg_hdr.msg_iov = &iovecs[i];
+      headers[i].msg_hdr.msg_iovlen = 1;
+      headers[i].msg_hdr.msg_control = controls[i].data();
+      headers[i].msg_hdr.msg_controllen = control_size;
+    }
+    auto received = ::recvmmsg(fd, headers.data(), static_cast<unsigned>(n),
+                               MSG_DONTWAIT, nullptr);
+    if (received < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        VAST_WARN("UDP receiver failed to receive datagrams: {}",
+                  std::strerror(errno));
+      continue;
+    }
+    ++batches_;
+    {
+      auto lock = std::lock_guard{mutex_};
+      for (int i = 0; i < received; ++i)
+        append(static_cast<const char*>(iovecs[i].iov_base), headers[i].msg_len);
+    }
+    cv_.notify_one();
+    for (auto* cmsg = CMSG_FIRSTHDR(&headers[received - 1].msg_hdr);
+         cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&headers[received - 1].msg_hdr, cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+        auto drops = uint32_t{0};
+        std::memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+        kernel_dropped_ += drops - last_kernel_drops;
+        last_kernel_drops = drops;
+      }
+    }
+#else
+    auto received = ::recv(fd, storage.data(), storage.size(), MSG_DONTWAIT);
+    if (received < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        VAST_WARN("UDP receiver failed to receive datagram: {}",
+                  std::strerror(errno));
+      continue;
+    }
+    ++batches_;
+    {
+      auto lock = std::lock_guard{mutex_};
+      append(storage.data(), static_cast<size_t>(received));
+    }
+    cv_.notify_one();
+#endif
+  }
+}
+
+udp_inbuf::udp_inbuf(std::shared_ptr<udp_receiver> receiver)
+  : receiver_{std::move(receiver)} {
+  VAST_ASSERT(receiver_);
+  setg(buffer_.data(), buffer_.data(), buffer_.data());
+}
+
+std::optional<std::chrono::milliseconds>& udp_inbuf::read_timeout() {
+  return read_timeout_;
+}
+
+bool udp_inbuf::timed_out() const {
+  return timed_out_;
+}
+
+const std::shared_ptr<udp_receiver>& udp_inbuf::receiver() const {
+  return receiver_;
+}
+
+udp_inbuf::int_type udp_inbuf::underflow() {
+  if (gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+  timed_out_ = false;
+  if (!receiver_->receive(buffer_, read_timeout_)) {
+    // An empty buffer after a stop means we reached the end of input.
+    timed_out_ = !receiver_->stopped();
+    setg(buffer_.data(), buffer_.data(), buffer_.data());
+    return traits_type::eof();
+  }
+  setg(buffer_.data(), buffer_.data(), buffer_.data() + buffer_.size());
+  return traits_type::to_int_type(*gptr());
+}
+
+std::unique_ptr<std::istream>
+make_udp_input_stream(std::shared_ptr<udp_receiver> receiver) {
+  struct owning_istream : public std::istream {
+    explicit owning_istream(std::shared_ptr<udp_receiver> receiver)
+      : std::istream{nullptr}, buf_{std::move(receiver)} {
+      rdbuf(&buf_);
+    }
+    udp_inbuf buf_;
+  };
+  return std::make_unique<owning_istream>(std::move(receiver));
+}
+
+} // namespace vast::detail
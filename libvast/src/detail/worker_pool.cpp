@@ -0,0 +1,92 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/detail/worker_pool.hpp"
+
+#include <utility>
+
+namespace vast::detail {
+
+namespace {
+
+/// The pool whose loop the current thread runs, if any.
+thread_local const worker_pool* current_pool = nullptr;
+
+} // namespace
+
+worker_pool::worker_pool(size_t num_workers) {
+  for (size_t i = 1; i < num_workers; ++i)
+    threads_.emplace_back([this] {
+      work();
+    });
+}
+
+worker_pool::~worker_pool() noexcept {
+  {
+    auto lock = std::unique_lock{mutex_};
+    stop_ = true;
+  }
+  work_available_.notify_all();
+  for (auto& thread : threads_)
+    thread.join();
+}
+
+size_t worker_pool::size() const noexcept {
+  return threads_.size() + 1;
+}
+
+void worker_pool::run(size_t n, const std::function<void(size_t)>& f) {
+  if (n <= 1 || threads_.empty() || current_pool == this) {
+    for (size_t i = 0; i < n; ++i)
+      f(i);
+    return;
+  }
+  {
+    auto lock = std::unique_lock{mutex_};
+    f_ = &f;
+    n_ = n;
+    next_ = 0;
+    busy_ = threads_.size();
+    ++generation_;
+  }
+  work_available_.notify_all();
+  drain();
+  auto lock = std::unique_lock{mutex_};
+  work_done_.wait(lock, [this] {
+    return busy_ == 0;
+  });
+  f_ = nullptr;
+}
+
+void worker_pool::drain() {
+  auto* previous = std::exchange(current_pool, this);
+  for (auto i = next_++; i < n_; i = next_++)
+    (*f_)(i);
+  current_pool = previous;
+}
+
+void worker_pool::work() {
+  auto generation = size_t{0};
+  while (true) {
+    {
+      auto lock = std::unique_lock{mutex_};
+      work_available_.wait(lock, [&] {
+        return stop_ || generation_ != generation;
+      });
+      if (stop_)
+        return;
+      generation = generation_;
+    }
+    drain();
+    auto lock = std::unique_lock{mutex_};
+    if (--busy_ == 0)
+      work_done_.notify_one();
+  }
+}
+
+} // namespace vast::detail
@@ -0,0 +1,196 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/digest_index.hpp"
+
+#include "vast/address.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/hash/hash.hpp"
+
+#include <algorithm>
+
+namespace vast {
+
+uint64_t digest_scope(const qualified_record_field& field) {
+  return hash(field.name());
+}
+
+uint64_t digest_scope(const type& t) {
+  return hash(t);
+}
+
+std::optional<uint64_t> digest(data_view x, uint64_t scope) {
+  if (const auto* addr = caf::get_if<view<address>>(&x))
+    return hash(*addr, scope);
+  if (const auto* str = caf::get_if<view<std::string>>(&x))
+    return hash(*str, scope);
+  return std::nullopt;
+}
+
+digest_index::digest_index(size_t max_digests) : max_digests_{max_digests} {
+  // nop
+}
+
+void digest_index::add(const uuid& partition,
+                       const partition_digests& digests) {
+  erase(partition);
+  if (digests.fields.empty() && digests.types.empty())
+    return;
+  auto xs = digests.digests;
+  std::sort(xs.begin(), xs.end());
+  xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+  if (xs.size() > max_digests_)
+    return;
+  // Make room by evicting the partitions that we received first.
+  auto evicted = std::vector<uint32_t>{};
+  auto num_entries = entries_.size();
+  auto first = insertion_order_.begin();
+  for (; num_entries + xs.size() > max_digests_; ++first) {
+    VAST_ASSERT(first != insertion_order_.end());
+    auto it = partitions_.find(*first);
+    VAST_ASSERT(it != partitions_.end());
+    num_entries -= it->second.num_digests;
+    evicted.push_back(it->second.ordinal);
+    ordinals_[it->second.ordinal] = uuid::nil();
+    free_ordinals_.push_back(it->second.ordinal);
+    partitions_.erase(it);
+  }
+  insertion_order_.erase(insertion_order_.begin(), first);
+  erase_entries(evicted);
+  auto ordinal = uint32_t{0};
+  if (free_ordinals_.empty()) {
+    ordinal = static_cast<uint32_t>(ordinals_.size());
+    ordinals_.push_back(partition);
+  } else {
+    ordinal = free_ordinals_.back();
+    free_ordinals_.pop_back();
+    ordinals_[ordinal] = partition;
+  }
+  partitions_.emplace(partition, partition_state{ordinal, xs.size(),
+                                                 digests.fields, digests.types});
+  insertion_order_.push_back(partition);
+  // Append the new entries as a sorted run and merge it with the existing
+  // entries, which is linear in the size of the index.
+  auto mid = static_cast<std::ptrdiff_t>(entries_.size());
+  for (auto x : xs)
+    entries_.push_back({x, ordinal});
+  std::inplace_merge(entries_.begin(), entries_.begin() + mid, entries_.end());
+}
+
+void digest_index::erase(const uuid& partition) {
+  auto it = partitions_.find(partition);
+  if (it == partitions_.end())
+    return;
+  auto ordinal = it->second.ordinal;
+  erase_entries({ordinal});
+  ordinals_[ordinal] = uuid::nil();
+  free_ordinals_.push_back(ordinal);
+  partitions_.erase(it);
+  std::erase(insertion_order_, partition);
+}
+
+bool digest_index::covers(const uuid& partition,
+                          const qualified_record_field& field) const {
+  auto it = partitions_.find(partition);
+  if (it == partitions_.end())
+    return false;
+  const auto& fields = it->second.fields;
+  return std::find(fields.begin(), fields.end(), field) != fields.end();
+}
+
+bool digest_index::covers(const uuid& partition, const type& t) const {
+  auto it = partitions_.find(partition);
+  if (it == partitions_.end())
+    return false;
+  const auto& types = it->second.types;
+  return std::find(types.begin(), types.end(), t) != types.end();
+}
+
+std::vector<uuid> digest_index::lookup(std::vector<uint64_t> digests) const {
+  std::sort(digests.begin(), digests.end());
+  digests.erase(std::unique(digests.begin(), digests.end()), digests.end());
+  auto result = std::vector<uuid>{};
+  // Because both the digests and the entries are sorted, every search can
+  // start where the previous one ended.
+  auto first = entries_.begin();
+  for (auto digest : digests) {
+    first = std::lower_bound(first, entries_.end(), entry{digest, 0});
+    for (; first != entries_.end() && first->digest == digest; ++first)
+      result.push_back(ordinals_[first->partition]);
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+std::optional<std::vector<uuid>>
+digest_index::lookup(relational_operator op, data_view rhs,
+                     uint64_t scope) const {
+  auto digests = std::vector<uint64_t>{};
+  // This mirrors the Bloom filter synopsis: a nil value makes the result
+  // unknown, and values of other types never match.
+  auto add = [&](const data_view& x) {
+    if (caf::holds_alternative<view<caf::none_t>>(x))
+      return false;
+    if (auto d = digest(x, scope))
+      digests.push_back(*d);
+    return true;
+  };
+  switch (op) {
+    default:
+      return std::nullopt;
+    case relational_operator::equal:
+      if (!add(rhs))
+        return std::nullopt;
+      break;
+    case relational_operator::in: {
+      const auto* xs = caf::get_if<view<list>>(&rhs);
+      if (!xs)
+        return std::nullopt;
+      for (auto x : **xs)
+        if (!add(x))
+          return std::nullopt;
+      break;
+    }
+  }
+  return lookup(std::move(digests));
+}
+
+void digest_index::erase_entries(const std::vector<uint32_t>& ordinals) {
+  if (ordinals.empty())
+    return;
+  auto erased = std::vector<bool>(ordinals_.size());
+  for (auto ordinal : ordinals)
+    erased[ordinal] = true;
+  std::erase_if(entries_, [&](const entry& x) {
+    return erased[x.partition];
+  });
+}
+
+size_t digest_index::size() const {
+  return partitions_.size();
+}
+
+size_t digest_index::num_digests() const {
+  return entries_.size();
+}
+
+size_t digest_index::memusage() const {
+  auto result = sizeof(*this);
+  result += entries_.capacity() * sizeof(entry);
+  result += ordinals_.capacity() * sizeof(uuid);
+  result += free_ordinals_.capacity() * sizeof(uint32_t);
+  result += insertion_order_.capacity() * sizeof(uuid);
+  for (const auto& [_, state] : partitions_)
+    result += sizeof(uuid) + sizeof(partition_state)
+              + state.fields.size() * sizeof(qualified_record_field)
+              + state.types.size() * sizeof(type);
+  return result;
+}
+
+} // namespace vast
@@ -10,8 +10,181 @@
 
 #include "vast/fbs/bitmap.hpp"
 
+#include <array>
+
 namespace vast {
 
+namespace {
+
+using word_type = ewah_bitmap::word_type;
+using block_type = ewah_bitmap::block_type;
+using size_type = ewah_bitmap::size_type;
+
+/// Walks over the blocks of an EWAH bitmap in segments of either clean or
+/// dirty words.
+class segment_cursor {
+public:
+  explicit segment_cursor(const ewah_bitmap& bm) : blocks_{bm.blocks()} {
+    load();
+  }
+
+  [[nodiscard]] bool done() const {
+    return clean_ == 0 && dirty_ == 0;
+  }
+
+  [[nodiscard]] bool clean() const {
+    return clean_ > 0;
+  }
+
+  /// The value of the words in a clean segment.
+  [[nodiscard]] block_type fill() const {
+    VAST_ASSERT(clean());
+    return bit_ ? word_type::all : word_type::none;
+  }
+
+  /// The words of a dirty segment.
+  [[nodiscard]] const block_type* dirty() const {
+    VAST_ASSERT(!clean());
+    return blocks_.data() + next_;
+  }
+
+  /// The number of remaining words in the current segment.
+  [[nodiscard]] size_type length() const {
+    return clean_ > 0 ? clean_ : dirty_;
+  }
+
+  /// Advances by *n* words within the current segment.
+  void skip(size_type n) {
+    VAST_ASSERT(n <= length());
+    if (clean_ > 0) {
+      clean_ -= n;
+    } else {
+      dirty_ -= n;
+      next_ += n;
+    }
+    if (done())
+      load();
+  }
+
+private:
+  void load() {
+    while (done() && next_ < blocks_.size()) {
+      // The last block is always dirty and not counted by its marker.
+      if (next_ + 1 == blocks_.size()) {
+        dirty_ = 1;
+        return;
+      }
+      auto marker = blocks_[next_++];
+      bit_ = word_type::marker_type(marker);
+      clean_ = word_type::marker_num_clean(marker);
+      dirty_ = word_type::marker_num_dirty(marker);
+    }
+  }
+
+  const ewah_bitmap::block_vector& blocks_;
+  size_t next_ = 0;
+  size_type clean_ = 0;
+  size_type dirty_ = 0;
+  bool bit_ = false;
+};
+
+/// Applies a bitwise operation word by word. Missing words of the shorter
+/// bitmap count as 0-bits, which matches the semantics of `binary_eval` for
+/// all operations with `op(0, 0) == 0`.
+template <class Operation>
+ewah_bitmap combine(const ewah_bitmap& x, const ewah_bitmap& y, Operation op) {
+  VAST_ASSERT(op(word_type::none, word_type::none) == word_type::none);
+  auto result = ewah_bitmap{};
+  const auto size = std::max(x.size(), y.size());
+  if (size == 0)
+    return result;
+  const auto num_words = (size + word_type::width - 1) / word_type::width;
+  auto lhs = segment_cursor{x};
+  auto rhs = segment_cursor{y};
+  // The dirty words of a segment go through a buffer, so that the loop
+  // applying the operation has no dependencies on the bitmap under
+  // construction.
+  auto buffer = std::array<block_type, 64>{};
+  auto append_dirty = [&](size_type n, auto f) {
+    for (size_type i = 0; i < n; i += buffer.size()) {
+      auto m = std::min<size_type>(buffer.size(), n - i);
+      for (size_type j = 0; j < m; ++j)
+        buffer[j] = f(i + j);
+      for (size_type j = 0; j < m; ++j)
+        result.append_block(buffer[j]);
+    }
+  };
+  auto append_clean = [&](block_type fill, size_type n) {
+    if (n == 1)
+      result.append_block(fill);
+    else
+      result.append_bits(fill != 0, n * word_type::width);
+  };
+  // All words but the last one are complete.
+  for (auto pos = size_type{0}; pos + 1 < num_words;) {
+    auto n = num_words - 1 - pos;
+    if (!lhs.done())
+      n = std::min(n, lhs.length());
+    if (!rhs.done())
+      n = std::min(n, rhs.length());
+    const auto lhs_clean = lhs.done() || lhs.clean();
+    const auto rhs_clean = rhs.done() || rhs.clean();
+    const auto lhs_fill
+      = lhs.done() || !lhs_clean ? word_type::none : lhs.fill();
+    const auto rhs_fill
+      = rhs.done() || !rhs_clean ? word_type::none : rhs.fill();
+    if (lhs_clean && rhs_clean) {
+      append_clean(op(lhs_fill, rhs_fill), n);
+    } else if (lhs_clean) {
+      // A fill that dominates the operation makes the dirty words irrelevant.
+      const auto* ys = rhs.dirty();
+      if (op(lhs_fill, word_type::none) == op(lhs_fill, word_type::all))
+        append_clean(op(lhs_fill, word_type::none), n);
+      else
+        append_dirty(n, [&](size_type i) {
+          return op(lhs_fill, ys[i]);
+        });
+    } else if (rhs_clean) {
+      const auto* xs = lhs.dirty();
+      if (op(word_type::none, rhs_fill) == op(word_type::all, rhs_fill))
+        append_clean(op(word_type::none, rhs_fill), n);
+      else
+        append_dirty(n, [&](size_type i) {
+          return op(xs[i], rhs_fill);
+        });
+    } else {
+      const auto* xs = lhs.dirty();
+      const auto* ys = rhs.dirty();
+      append_dirty(n, [&](size_type i) {
+        return op(xs[i], ys[i]);
+      });
+    }
+    if (!lhs.done())
+      lhs.skip(n);
+    if (!rhs.done())
+      rhs.skip(n);
+    pos += n;
+  }
+  // The last word may be incomplete. Its unused bits are 0 in both bitmaps.
+  auto last_word = [](const segment_cursor& cursor) {
+    if (cursor.done())
+      return word_type::none;
+    return cursor.clean() ? cursor.fill() : *cursor.dirty();
+  };
+  const auto remaining = size - (num_words - 1) * word_type::width;
+  result.append_block(op(last_word(lhs), last_word(rhs)), remaining);
+  return result;
+}
+
+size_type popcount(const block_type* xs, size_type n) {
+  auto result = size_type{0};
+  for (size_type i = 0; i < n; ++i)
+    result += word_type::popcount(xs[i]);
+  return result;
+}
+
+} // namespace
+
 ewah_bitmap::ewah_bitmap(size_type n, bool bit) {
   append_bits(bit, n);
 }
@@ -238,6 +411,30 @@ void ewah_bitmap::bump_dirty_count() {
   }
 }
 
+ewah_bitmap operator&(const ewah_bitmap& x, const ewah_bitmap& y) {
+  return combine(x, y, [](auto lhs, auto rhs) {
+    return lhs & rhs;
+  });
+}
+
+ewah_bitmap operator|(const ewah_bitmap& x, const ewah_bitmap& y) {
+  return combine(x, y, [](auto lhs, auto rhs) {
+    return lhs | rhs;
+  });
+}
+
+ewah_bitmap operator^(const ewah_bitmap& x, const ewah_bitmap& y) {
+  return combine(x, y, [](auto lhs, auto rhs) {
+    return lhs ^ rhs;
+  });
+}
+
+ewah_bitmap operator-(const ewah_bitmap& x, const ewah_bitmap& y) {
+  return combine(x, y, [](auto lhs, auto rhs) {
+    return lhs & ~rhs;
+  });
+}
+
 bool operator==(const ewah_bitmap& x, const ewah_bitmap& y) {
   // If the block vector and the number of bits are equal, so must be the
   // marker by construction.
@@ -261,6 +458,65 @@ auto unpack(const fbs::bitmap::EWAHBitmap& from, ewah_bitmap& to)
   return caf::none;
 }
 
+ewah_bitmap::size_type ewah_bitmap::rank1(size_type i) const {
+  VAST_ASSERT(i < num_bits_);
+  auto result = size_type{0};
+  auto pos = size_type{0};
+  for (auto cursor = segment_cursor{*this};; cursor.skip(cursor.length())) {
+    VAST_ASSERT(!cursor.done());
+    const auto bits = cursor.length() * word_type::width;
+    if (cursor.clean()) {
+      if (i < pos + bits)
+        return result + (cursor.fill() != 0 ? i - pos + 1 : 0);
+      result += cursor.fill() != 0 ? bits : 0;
+    } else {
+      const auto* xs = cursor.dirty();
+      if (i < pos + bits) {
+        const auto words = (i - pos) / word_type::width;
+        const auto offset = (i - pos) % word_type::width;
+        return result + popcount(xs, words)
+               + word_type::popcount(xs[words]
+                                     & word_type::lsb_fill(offset + 1));
+      }
+      result += popcount(xs, cursor.length());
+    }
+    pos += bits;
+  }
+}
+
+ewah_bitmap::size_type ewah_bitmap::select1(size_type i) const {
+  VAST_ASSERT(i > 0);
+  if (empty())
+    return word_type::npos;
+  if (i == word_type::npos) {
+    i = rank1(num_bits_ - 1);
+    if (i == 0)
+      return word_type::npos;
+  }
+  auto pos = size_type{0};
+  for (auto cursor = segment_cursor{*this}; !cursor.done();
+       cursor.skip(cursor.length())) {
+    const auto bits = cursor.length() * word_type::width;
+    if (cursor.clean()) {
+      if (cursor.fill() != 0) {
+        if (i <= bits)
+          return pos + i - 1;
+        i -= bits;
+      }
+    } else {
+      const auto* xs = cursor.dirty();
+      for (size_type j = 0; j < cursor.length(); ++j) {
+        const auto count = word_type::popcount(xs[j]);
+        if (i <= count)
+          return pos + j * word_type::width + vast::select(xs[j], i);
+        i -= count;
+      }
+    }
+    pos += bits;
+  }
+  return word_type::npos;
+}
+
 ewah_bitmap_range::ewah_bitmap_range(const ewah_bitmap& bm) : bm_{&bm} {
   if (!bm_->empty())
     scan();
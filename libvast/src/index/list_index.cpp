@@ -8,9 +8,12 @@
 
 #include "vast/index/list_index.hpp"
 
+#include "vast/arrow_table_slice.hpp"
 #include "vast/base.hpp"
+#include "vast/bitmap_algorithms.hpp"
 #include "vast/defaults.hpp"
 #include "vast/detail/legacy_deserialize.hpp"
+#include "vast/detail/narrow.hpp"
 #include "vast/detail/overload.hpp"
 #include "vast/fbs/value_index.hpp"
 #include "vast/index/container_lookup.hpp"
@@ -18,6 +21,8 @@
 #include "vast/type.hpp"
 #include "vast/value_index_factory.hpp"
 
+#include <arrow/array.h>
+#include <caf/deserializer.hpp>
 #include <caf/serializer.hpp>
 #include <caf/settings.hpp>
 
@@ -26,6 +31,22 @@
 
 namespace vast {
 
+namespace {
+
+/// The option that distinguishes the flattened element index from the
+/// positional element indexes of earlier versions in serialized indexes.
+constexpr auto layout_option = "list-layout";
+
+bool is_flat(const std::vector<value_index_ptr>& elements) {
+  if (elements.size() != 1 || !elements.front())
+    return false;
+  const auto* layout
+    = caf::get_if<std::string>(&elements.front()->options(), layout_option);
+  return layout && *layout == "flat";
+}
+
+} // namespace
+
 list_index::list_index(vast::type t, caf::settings opts)
   : value_index{std::move(t), std::move(opts)} {
   max_size_ = caf::get_or(options(), "max-size",
@@ -44,6 +65,16 @@ list_index::list_index(vast::type t, caf::settings opts)
   if (max_size_ % 10 != 0)
     ++components;
   size_ = size_bitmap_index{base::uniform(10, components)};
+  auto element_options = options();
+  caf::put(element_options, layout_option, std::string{"flat"});
+  auto elements = factory<value_index>::make(value_type_, element_options);
+  if (elements) {
+    elements_.push_back(std::move(elements));
+    flat_ = true;
+  } else {
+    VAST_DEBUG("{} failed to create value index for type {}",
+               detail::pretty_type_name(this), value_type_);
+  }
 }
 
 caf::error list_index::serialize(caf::serializer& sink) const {
@@ -53,6 +84,11 @@ caf::error list_index::serialize(caf::serializer& sink) const {
     },
     [&] {
       return sink(elements_, size_, max_size_, value_type_);
+    },
+    [&]() -> caf::error {
+      if (!flat_)
+        return caf::none;
+      return sink(ends_, rows_);
     });
 }
 
@@ -63,13 +99,22 @@ caf::error list_index::deserialize(caf::deserializer& source) {
     },
     [&] {
       return source(elements_, size_, max_size_, value_type_);
+    },
+    [&]() -> caf::error {
+      flat_ = is_flat(elements_);
+      if (!flat_)
+        return caf::none;
+      return source(ends_, rows_);
     });
 }
 
 bool list_index::deserialize(detail::legacy_deserializer& source) {
   if (!value_index::deserialize(source))
     return false;
-  return source(elements_, size_, max_size_, value_type_);
+  if (!source(elements_, size_, max_size_, value_type_))
+    return false;
+  flat_ = is_flat(elements_);
+  return !flat_ || source(ends_, rows_);
 }
 
 bool list_index::append_impl(data_view x, id pos) {
@@ -77,22 +122,11 @@ bool list_index::append_impl(data_view x, id pos) {
     using view_type = std::decay_t<decltype(v)>;
     if constexpr (std::is_same_v<view_type, view<list>>) {
       auto seq_size = std::min(v->size(), max_size_);
-      if (seq_size > elements_.size()) {
-        auto old = elements_.size();
-        elements_.resize(seq_size);
-        for (auto i = old; i < elements_.size(); ++i) {
-          elements_[i] = factory<value_index>::make(value_type_, options());
-          if (!elements_[i])
-            VAST_DEBUG("{} failed to create value index for type {}",
-                       detail::pretty_type_name(this), value_type_);
-        }
-      }
       auto x = v->begin();
-      for (auto i = 0u; i < seq_size; ++i)
-        if (elements_[i])
-          elements_[i]->append(*x++, pos);
-      size_.skip(pos - size_.size());
-      size_.append(seq_size);
+      for (auto i = 0u; i < seq_size; ++i, ++x)
+        if (flat_)
+          elements_.front()->append(*x, ends_.size() + i);
+      append_list(pos, seq_size);
       return true;
     }
     return false;
@@ -100,6 +134,40 @@ bool list_index::append_impl(data_view x, id pos) {
   return caf::visit(f, x);
 }
 
+bool list_index::append_array_impl(const arrow::Array& array, id pos) {
+  VAST_ASSERT(array.type_id() == arrow::Type::LIST);
+  const auto& lists = static_cast<const arrow::ListArray&>(array);
+  const auto num_rows = lists.length();
+  auto row = int64_t{0};
+  auto seq_size = size_t{0};
+  auto finish = [&] {
+    if (!lists.IsNull(row))
+      append_list(pos + detail::narrow_cast<id>(row), seq_size);
+    seq_size = 0;
+    ++row;
+  };
+  // We decode the values buffer of the list array in a single pass. It may
+  // contain elements before the first or after the last list if the array is
+  // a slice of a larger array.
+  auto element = int64_t{0};
+  for (auto&& x : values(value_type_, *lists.values())) {
+    while (row < num_rows && element >= lists.value_offset(row + 1))
+      finish();
+    if (row == num_rows)
+      break;
+    if (element >= lists.value_offset(row) && !lists.IsNull(row)
+        && seq_size < max_size_) {
+      if (flat_)
+        elements_.front()->append(x, ends_.size() + seq_size);
+      ++seq_size;
+    }
+    ++element;
+  }
+  while (row < num_rows)
+    finish();
+  return true;
+}
+
 caf::expected<ids>
 list_index::lookup_impl(relational_operator op, data_view x) const {
   if (!(op == relational_operator::ni || op == relational_operator::not_ni))
@@ -107,17 +175,27 @@ list_index::lookup_impl(relational_operator op, data_view x) const {
   auto result = ids{};
   if (elements_.empty())
     return ids{};
-  for (auto i = 0u; i < elements_.size(); ++i) {
-    if (elements_[i]) {
-      auto mbm = elements_[i]->lookup(relational_operator::equal, x);
-      if (mbm)
-        result |= *mbm;
-      else
-        return mbm;
+  if (flat_) {
+    auto hits = elements_.front()->lookup(relational_operator::equal, x);
+    if (!hits)
+      return hits;
+    result = to_rows(*hits);
+  } else {
+    for (const auto& element : elements_) {
+      if (element) {
+        auto mbm = element->lookup(relational_operator::equal, x);
+        if (mbm)
+          result |= *mbm;
+        else
+          return mbm;
+      }
     }
   }
-  if (op == relational_operator::not_ni)
+  if (op == relational_operator::not_ni) {
+    if (result.size() < offset())
+      result.append_bits(false, offset() - result.size());
     result.flip();
+  }
   return result;
 }
 
@@ -126,6 +204,8 @@ size_t list_index::memusage_impl() const {
   for (const auto& element : elements_)
     if (element)
       acc += element->memusage();
+  acc += ends_.memusage();
+  acc += rows_.memusage();
   acc += size_.memusage();
   return acc;
 }
@@ -134,14 +214,22 @@ flatbuffers::Offset<fbs::ValueIndex> list_index::pack_impl(
   flatbuffers::FlatBufferBuilder& builder,
   flatbuffers::Offset<fbs::value_index::detail::ValueIndexBase> base_offset) {
   auto element_offsets = std::vector<flatbuffers::Offset<fbs::ValueIndex>>{};
-  element_offsets.reserve(elements_.size());
-  for (const auto& element : elements_)
-    element_offsets.emplace_back(pack(builder, element));
+  auto flat_elements_offset = flatbuffers::Offset<fbs::ValueIndex>{};
+  auto ends_offset = flatbuffers::Offset<fbs::bitmap::EWAHBitmap>{};
+  auto rows_offset = flatbuffers::Offset<fbs::bitmap::EWAHBitmap>{};
+  if (flat_) {
+    flat_elements_offset = pack(builder, elements_.front());
+    ends_offset = pack(builder, ends_);
+    rows_offset = pack(builder, rows_);
+  } else {
+    element_offsets.reserve(elements_.size());
+    for (const auto& element : elements_)
+      element_offsets.emplace_back(pack(builder, element));
+  }
   const auto size_bitmap_index_offset = pack(builder, size_);
-  const auto list_index_offset
-    = fbs::value_index::CreateListIndexDirect(builder, base_offset,
-                                              &element_offsets, max_size_,
-                                              size_bitmap_index_offset);
+  const auto list_index_offset = fbs::value_index::CreateListIndexDirect(
+    builder, base_offset, &element_offsets, max_size_,
+    size_bitmap_index_offset, flat_elements_offset, ends_offset, rows_offset);
   return fbs::CreateValueIndex(builder, fbs::value_index::ValueIndex::list,
                                list_index_offset.Union());
 }
@@ -150,11 +238,28 @@ caf::error list_index::unpack_impl(const fbs::ValueIndex& from) {
   const auto* from_list = from.value_index_as_list();
   VAST_ASSERT(from_list);
   elements_.clear();
-  elements_.reserve(from_list->elements()->size());
-  for (const auto* element : *from_list->elements()) {
+  ends_ = {};
+  rows_ = {};
+  flat_ = from_list->flat_elements() != nullptr;
+  if (flat_) {
+    if (!from_list->ends() || !from_list->rows())
+      return caf::make_error(ec::format_error, "list index with flattened "
+                                               "elements lacks list "
+                                               "boundaries");
     auto& to = elements_.emplace_back();
-    if (auto err = unpack(*element, to))
+    if (auto err = unpack(*from_list->flat_elements(), to))
       return err;
+    if (auto err = unpack(*from_list->ends(), ends_))
+      return err;
+    if (auto err = unpack(*from_list->rows(), rows_))
+      return err;
+  } else {
+    elements_.reserve(from_list->elements()->size());
+    for (const auto* element : *from_list->elements()) {
+      auto& to = elements_.emplace_back();
+      if (auto err = unpack(*element, to))
+        return err;
+    }
   }
   max_size_ = from_list->max_size();
   if (auto err = unpack(*from_list->size_bitmap_index(), size_))
@@ -165,4 +270,36 @@ caf::error list_index::unpack_impl(const fbs::ValueIndex& from) {
   return caf::none;
 }
 
+void list_index::append_list(id row, size_t size) {
+  size_.skip(row - size_.size());
+  size_.append(size);
+  if (size == 0)
+    return;
+  ends_.append_bits(false, size - 1);
+  ends_.append_bit(true);
+  rows_.append_bits(false, row - rows_.size());
+  rows_.append_bit(true);
+}
+
+ids list_index::to_rows(const ids& elements) const {
+  auto result = ids{};
+  // The k-th 1-bit in `ends_` marks the last element of the list in the row
+  // of the k-th 1-bit in `rows_`, so we advance both in lockstep.
+  auto ends = select(ends_);
+  auto rows = select(rows_);
+  auto hits = select(elements);
+  while (!hits.done()) {
+    while (ends.get() < hits.get()) {
+      ends.next();
+      rows.next();
+    }
+    VAST_ASSERT(!ends.done() && !rows.done());
+    result.append_bits(false, rows.get() - result.size());
+    result.append_bit(true);
+    // The remaining elements of the same list cannot add anything.
+    hits.next_from(ends.get() + 1);
+  }
+  return result;
+}
+
 } // namespace vast
@@ -0,0 +1,265 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/index/ngram_index.hpp"
+
+#include "vast/bitmap_algorithms.hpp"
+#include "vast/defaults.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/detail/legacy_deserialize.hpp"
+#include "vast/detail/overload.hpp"
+#include "vast/detail/regex.hpp"
+#include "vast/error.hpp"
+#include "vast/fbs/value_index.hpp"
+#include "vast/index/container_lookup.hpp"
+#include "vast/type.hpp"
+
+#include <caf/deserializer.hpp>
+#include <caf/serializer.hpp>
+#include <caf/settings.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace vast {
+
+namespace {
+
+uint32_t make_ngram(std::string_view str, size_t pos) {
+  static_assert(ngram_index::ngram_size == 3);
+  return static_cast<uint32_t>(static_cast<uint8_t>(str[pos])) << 16
+         | static_cast<uint32_t>(static_cast<uint8_t>(str[pos + 1])) << 8
+         | static_cast<uint32_t>(static_cast<uint8_t>(str[pos + 2]));
+}
+
+/// Computes the distinct n-grams of a string.
+std::vector<uint32_t> make_ngrams(std::string_view str) {
+  auto result = std::vector<uint32_t>{};
+  if (str.size() < ngram_index::ngram_size)
+    return result;
+  result.reserve(str.size() - ngram_index::ngram_size + 1);
+  for (size_t i = 0; i + ngram_index::ngram_size <= str.size(); ++i)
+    result.push_back(make_ngram(str, i));
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+} // namespace
+
+ngram_index::ngram_index(vast::type t, caf::settings opts)
+  : value_index{std::move(t), std::move(opts)} {
+  max_length_
+    = caf::get_or(options(), "max-size", defaults::index::max_string_size);
+  auto b = base::uniform(10, std::log10(max_length_) + !!(max_length_ % 10));
+  length_ = length_bitmap_index{std::move(b)};
+}
+
+caf::error ngram_index::serialize(caf::serializer& sink) const {
+  auto ngrams = std::vector<uint32_t>{};
+  ngrams.reserve(postings_.size());
+  for (const auto& [ngram, _] : postings_)
+    ngrams.push_back(ngram);
+  std::sort(ngrams.begin(), ngrams.end());
+  auto postings = std::vector<ewah_bitmap>{};
+  postings.reserve(ngrams.size());
+  for (auto ngram : ngrams)
+    postings.push_back(postings_.at(ngram));
+  return caf::error::eval(
+    [&] {
+      return value_index::serialize(sink);
+    },
+    [&] {
+      return sink(max_length_, length_, ngrams, postings);
+    });
+}
+
+caf::error ngram_index::deserialize(caf::deserializer& source) {
+  auto ngrams = std::vector<uint32_t>{};
+  auto postings = std::vector<ewah_bitmap>{};
+  auto err = caf::error::eval(
+    [&] {
+      return value_index::deserialize(source);
+    },
+    [&] {
+      return source(max_length_, length_, ngrams, postings);
+    });
+  if (err)
+    return err;
+  if (ngrams.size() != postings.size())
+    return caf::make_error(ec::format_error,
+                           fmt::format("n-gram index has {} n-grams but {} "
+                                       "posting lists",
+                                       ngrams.size(), postings.size()));
+  postings_.clear();
+  for (size_t i = 0; i < ngrams.size(); ++i)
+    postings_.emplace(ngrams[i], std::move(postings[i]));
+  return caf::none;
+}
+
+bool ngram_index::deserialize(detail::legacy_deserializer& source) {
+  if (!value_index::deserialize(source))
+    return false;
+  auto ngrams = std::vector<uint32_t>{};
+  auto postings = std::vector<ewah_bitmap>{};
+  if (!source(max_length_, length_, ngrams, postings))
+    return false;
+  if (ngrams.size() != postings.size())
+    return false;
+  postings_.clear();
+  for (size_t i = 0; i < ngrams.size(); ++i)
+    postings_.emplace(ngrams[i], std::move(postings[i]));
+  return true;
+}
+
+bool ngram_index::append_impl(data_view x, id pos) {
+  auto str = caf::get_if<view<std::string>>(&x);
+  if (!str)
+    return false;
+  length_.skip(pos - length_.size());
+  length_.append(std::min(str->size(), max_length_));
+  for (auto ngram : make_ngrams(*str)) {
+    auto& posting = postings_[ngram];
+    posting.append_bits(false, pos - posting.size());
+    posting.append_bit(true);
+  }
+  return true;
+}
+
+caf::expected<ids>
+ngram_index::lookup_impl(relational_operator op, data_view x) const {
+  // Negated predicates are true for all strings that are not actual hits of
+  // the positive predicate, which the n-grams cannot tell apart from the
+  // candidates, so we must leave them to the store.
+  auto everything = [&] {
+    return ids{offset(), true};
+  };
+  auto f = detail::overload{
+    [&](auto x) -> caf::expected<ids> {
+      return caf::make_error(ec::type_clash, materialize(x));
+    },
+    [&](view<std::string> str) -> caf::expected<ids> {
+      switch (op) {
+        default:
+          return caf::make_error(ec::unsupported_operator, op);
+        case relational_operator::equal: {
+          // All strings longer than the maximum length share the same length.
+          auto result = length_.lookup(relational_operator::equal,
+                                       std::min(str.size(), max_length_));
+          if (str.size() >= ngram_size && !all<0>(result))
+            result &= contains(str);
+          return result;
+        }
+        case relational_operator::ni:
+          return contains(str);
+        case relational_operator::not_equal:
+        case relational_operator::not_ni:
+          return everything();
+      }
+    },
+    [&](view<pattern> pat) -> caf::expected<ids> {
+      switch (op) {
+        default:
+          return caf::make_error(ec::unsupported_operator, op);
+        case relational_operator::match:
+        case relational_operator::equal:
+        case relational_operator::in: {
+          // Patterns that the automaton does not support have no known
+          // literals, so every string is a candidate.
+          auto rx = detail::regex::make(pat.string());
+          if (!rx)
+            return everything();
+          auto result = everything();
+          for (const auto& literal : rx->literals()) {
+            result &= contains(literal);
+            if (all<0>(result))
+              break;
+          }
+          return result;
+        }
+        case relational_operator::not_match:
+        case relational_operator::not_equal:
+        case relational_operator::not_in:
+          return everything();
+      }
+    },
+    [&](view<list> xs) {
+      return detail::container_lookup(*this, op, xs);
+    },
+  };
+  return caf::visit(f, x);
+}
+
+ids ngram_index::contains(std::string_view literal) const {
+  auto result = length_.lookup(relational_operator::greater_equal,
+                               std::min(literal.size(), max_length_));
+  for (auto ngram : make_ngrams(literal)) {
+    auto posting = postings_.find(ngram);
+    if (posting == postings_.end())
+      return ids{offset(), false};
+    result &= posting->second;
+    if (all<0>(result))
+      break;
+  }
+  return result;
+}
+
+size_t ngram_index::memusage_impl() const {
+  auto acc = length_.memusage();
+  for (const auto& [_, posting] : postings_)
+    acc += sizeof(uint32_t) + posting.memusage();
+  return acc;
+}
+
+flatbuffers::Offset<fbs::ValueIndex> ngram_index::pack_impl(
+  flatbuffers::FlatBufferBuilder& builder,
+  flatbuffers::Offset<fbs::value_index::detail::ValueIndexBase> base_offset) {
+  auto ngrams = std::vector<uint32_t>{};
+  ngrams.reserve(postings_.size());
+  for (const auto& [ngram, _] : postings_)
+    ngrams.push_back(ngram);
+  std::sort(ngrams.begin(), ngrams.end());
+  auto posting_offsets
+    = std::vector<flatbuffers::Offset<fbs::bitmap::EWAHBitmap>>{};
+  posting_offsets.reserve(ngrams.size());
+  for (auto ngram : ngrams)
+    posting_offsets.emplace_back(pack(builder, postings_.at(ngram)));
+  const auto length_index_offset = pack(builder, length_);
+  const auto ngram_index_offset = fbs::value_index::CreateNGramIndexDirect(
+    builder, base_offset, max_length_, length_index_offset, &ngrams,
+    &posting_offsets);
+  return fbs::CreateValueIndex(builder, fbs::value_index::ValueIndex::ngram,
+                               ngram_index_offset.Union());
+}
+
+caf::error ngram_index::unpack_impl(const fbs::ValueIndex& from) {
+  const auto* from_ngram = from.value_index_as_ngram();
+  VAST_ASSERT(from_ngram);
+  max_length_ = from_ngram->max_length();
+  if (auto err = unpack(*from_ngram->length_index(), length_))
+    return err;
+  const auto* ngrams = from_ngram->ngrams();
+  const auto* postings = from_ngram->postings();
+  if (ngrams->size() != postings->size())
+    return caf::make_error(ec::format_error,
+                           fmt::format("n-gram index has {} n-grams but {} "
+                                       "posting lists",
+                                       ngrams->size(), postings->size()));
+  postings_.clear();
+  postings_.reserve(ngrams->size());
+  for (flatbuffers::uoffset_t i = 0; i < ngrams->size(); ++i) {
+    auto& to = postings_[ngrams->Get(i)];
+    if (auto err = unpack(*postings->Get(i), to))
+      return err;
+  }
+  return caf::none;
+}
+
+} // namespace vast
@@ -0,0 +1,432 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/index/radix_index.hpp"
+
+#include "vast/detail/assert.hpp"
+#include "vast/detail/legacy_deserialize.hpp"
+#include "vast/detail/overload.hpp"
+#include "vast/error.hpp"
+#include "vast/fbs/value_index.hpp"
+#include "vast/index/container_lookup.hpp"
+#include "vast/subnet.hpp"
+#include "vast/type.hpp"
+
+#include <caf/deserializer.hpp>
+#include <caf/serializer.hpp>
+#include <caf/settings.hpp>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <bit>
+
+namespace vast {
+
+namespace {
+
+uint64_t load_be64(const address::byte_array& bytes, size_t offset) {
+  auto result = uint64_t{0};
+  for (size_t i = 0; i < 8; ++i)
+    result = (result << 8) | bytes[offset + i];
+  return result;
+}
+
+/// Clears all bits of a 64-bit half beyond the first *n*.
+uint64_t mask64(uint64_t x, size_t n) {
+  if (n == 0)
+    return 0;
+  if (n >= 64)
+    return x;
+  return x & ~(~uint64_t{0} >> n);
+}
+
+void set(ewah_bitmap& bm, id row) {
+  VAST_ASSERT(row >= bm.size());
+  bm.append_bits(false, row - bm.size());
+  bm.append_bit(true);
+}
+
+} // namespace
+
+radix_index::radix_index(vast::type t, caf::settings opts)
+  : value_index{std::move(t), std::move(opts)}, nodes_(1) {
+  VAST_ASSERT(caf::holds_alternative<address_type>(type())
+              || caf::holds_alternative<subnet_type>(type()));
+}
+
+caf::error radix_index::serialize(caf::serializer& sink) const {
+  return caf::error::eval(
+    [&] {
+      return value_index::serialize(sink);
+    },
+    [&] {
+      return sink(nodes_);
+    });
+}
+
+caf::error radix_index::deserialize(caf::deserializer& source) {
+  auto err = caf::error::eval(
+    [&] {
+      return value_index::deserialize(source);
+    },
+    [&] {
+      return source(nodes_);
+    });
+  if (err)
+    return err;
+  if (!is_valid())
+    return caf::make_error(ec::format_error, "invalid radix index nodes");
+  return caf::none;
+}
+
+bool radix_index::deserialize(detail::legacy_deserializer& source) {
+  if (!value_index::deserialize(source))
+    return false;
+  return source(nodes_) && is_valid();
+}
+
+ids radix_index::longest_prefix_match(const address& x) const {
+  auto bytes = static_cast<address::byte_array>(x);
+  auto p = prefix{load_be64(bytes, 0), load_be64(bytes, 8), 128};
+  const auto* result = &nodes_[0].exact;
+  auto cur = uint32_t{0};
+  while (true) {
+    const auto& n = nodes_[cur];
+    if (n.terminal)
+      result = &exact_rows(n);
+    if (n.length == p.length)
+      break;
+    auto bit = n.length < 64 ? (p.hi >> (63 - n.length)) & 1
+                             : (p.lo >> (127 - n.length)) & 1;
+    auto child = n.children[bit];
+    if (child == 0)
+      break;
+    const auto& c = nodes_[child];
+    if (mask64(p.hi, c.length) != c.hi
+        || mask64(p.lo, c.length > 64 ? c.length - 64 : 0) != c.lo)
+      break;
+    cur = child;
+  }
+  return to_ids(*result);
+}
+
+bool radix_index::append_impl(data_view x, id pos) {
+  auto f = detail::overload{
+    [](auto) -> std::optional<prefix> {
+      return std::nullopt;
+    },
+    [](view<address> x) -> std::optional<prefix> {
+      auto bytes = static_cast<address::byte_array>(x);
+      return prefix{load_be64(bytes, 0), load_be64(bytes, 8), 128};
+    },
+    [](view<subnet> x) -> std::optional<prefix> {
+      auto bytes = static_cast<address::byte_array>(x.network());
+      auto length = x.network().is_v4() ? x.length() + 96 : x.length();
+      return prefix{load_be64(bytes, 0), load_be64(bytes, 8),
+                    static_cast<uint8_t>(length)};
+    },
+  };
+  auto p = caf::visit(f, x);
+  if (!p)
+    return false;
+  insert(*p, pos);
+  return true;
+}
+
+caf::expected<ids>
+radix_index::lookup_impl(relational_operator op, data_view d) const {
+  auto is_subnet_index = caf::holds_alternative<subnet_type>(type());
+  auto negate = [](ids result) {
+    result.flip();
+    return result;
+  };
+  auto to_prefix = [](const address& network, size_t length) {
+    auto bytes = static_cast<address::byte_array>(network);
+    auto length128 = network.is_v4() ? length + 96 : length;
+    return prefix{load_be64(bytes, 0), load_be64(bytes, 8),
+                  static_cast<uint8_t>(length128)};
+  };
+  return caf::visit(
+    detail::overload{
+      [&](auto x) -> caf::expected<ids> {
+        return caf::make_error(ec::type_clash, materialize(x));
+      },
+      [&](view<address> x) -> caf::expected<ids> {
+        auto p = to_prefix(x, x.is_v4() ? 32 : 128);
+        switch (op) {
+          default:
+            return caf::make_error(ec::unsupported_operator, op);
+          case relational_operator::equal:
+            if (is_subnet_index)
+              return caf::make_error(ec::unsupported_operator, op);
+            return lookup_equal(p);
+          case relational_operator::not_equal:
+            if (is_subnet_index)
+              return caf::make_error(ec::unsupported_operator, op);
+            return negate(lookup_equal(p));
+          case relational_operator::ni:
+            if (!is_subnet_index)
+              return caf::make_error(ec::unsupported_operator, op);
+            return lookup_covering(p);
+          case relational_operator::not_ni:
+            if (!is_subnet_index)
+              return caf::make_error(ec::unsupported_operator, op);
+            return negate(lookup_covering(p));
+        }
+      },
+      [&](view<subnet> x) -> caf::expected<ids> {
+        auto p = to_prefix(x.network(), x.length());
+        switch (op) {
+          default:
+            return caf::make_error(ec::unsupported_operator, op);
+          case relational_operator::in:
+            return lookup_within(p);
+          case relational_operator::not_in:
+            return negate(lookup_within(p));
+          case relational_operator::equal:
+            if (!is_subnet_index)
+              return caf::make_error(ec::unsupported_operator, op);
+            return lookup_equal(p);
+          case relational_operator::not_equal:
+            if (!is_subnet_index)
+              return caf::make_error(ec::unsupported_operator, op);
+            return negate(lookup_equal(p));
+          case relational_operator::ni:
+            if (!is_subnet_index)
+              return caf::make_error(ec::unsupported_operator, op);
+            return lookup_covering(p);
+          case relational_operator::not_ni:
+            if (!is_subnet_index)
+              return caf::make_error(ec::unsupported_operator, op);
+            return negate(lookup_covering(p));
+        }
+      },
+      [&](view<list> xs) {
+        return detail::container_lookup(*this, op, xs);
+      },
+    },
+    d);
+}
+
+size_t radix_index::memusage_impl() const {
+  auto acc = nodes_.capacity() * sizeof(node);
+  for (const auto& n : nodes_)
+    acc += n.subtree.memusage() + n.exact.memusage();
+  return acc;
+}
+
+flatbuffers::Offset<fbs::ValueIndex> radix_index::pack_impl(
+  flatbuffers::FlatBufferBuilder& builder,
+  flatbuffers::Offset<fbs::value_index::detail::ValueIndexBase> base_offset) {
+  auto nodes = std::vector<fbs::value_index::RadixIndexNode>{};
+  auto subtrees = std::vector<flatbuffers::Offset<fbs::bitmap::EWAHBitmap>>{};
+  auto exacts = std::vector<flatbuffers::Offset<fbs::bitmap::EWAHBitmap>>{};
+  nodes.reserve(nodes_.size());
+  subtrees.reserve(nodes_.size());
+  exacts.reserve(nodes_.size());
+  for (const auto& n : nodes_) {
+    nodes.emplace_back(n.hi, n.lo, n.length, n.terminal, n.children[0],
+                       n.children[1]);
+    subtrees.emplace_back(pack(builder, n.subtree));
+    exacts.emplace_back(pack(builder, n.exact));
+  }
+  const auto radix_index_offset = fbs::value_index::CreateRadixIndexDirect(
+    builder, base_offset, &nodes, &subtrees, &exacts);
+  return fbs::CreateValueIndex(builder, fbs::value_index::ValueIndex::radix,
+                               radix_index_offset.Union());
+}
+
+caf::error radix_index::unpack_impl(const fbs::ValueIndex& from) {
+  const auto* from_radix = from.value_index_as_radix();
+  VAST_ASSERT(from_radix);
+  const auto* nodes = from_radix->nodes();
+  const auto* subtrees = from_radix->subtrees();
+  const auto* exacts = from_radix->exacts();
+  if (nodes->size() == 0 || subtrees->size() != nodes->size()
+      || exacts->size() != nodes->size())
+    return caf::make_error(ec::format_error,
+                           fmt::format("radix index has {} nodes, {} subtree "
+                                       "bitmaps, and {} exact bitmaps",
+                                       nodes->size(), subtrees->size(),
+                                       exacts->size()));
+  nodes_.clear();
+  nodes_.resize(nodes->size());
+  for (flatbuffers::uoffset_t i = 0; i < nodes->size(); ++i) {
+    const auto* from_node = nodes->Get(i);
+    auto& to = nodes_[i];
+    to.hi = from_node->hi();
+    to.lo = from_node->lo();
+    to.length = from_node->length();
+    to.terminal = from_node->terminal();
+    to.children = {from_node->left(), from_node->right()};
+    if (auto err = unpack(*subtrees->Get(i), to.subtree))
+      return err;
+    if (auto err = unpack(*exacts->Get(i), to.exact))
+      return err;
+  }
+  if (!is_valid())
+    return caf::make_error(ec::format_error, "invalid radix index nodes");
+  return caf::none;
+}
+
+void radix_index::insert(const prefix& p, id row) {
+  auto bit = [](uint64_t hi, uint64_t lo, size_t i) -> size_t {
+    return i < 64 ? (hi >> (63 - i)) & 1 : (lo >> (127 - i)) & 1;
+  };
+  auto common_length = [&](const node& n) -> uint8_t {
+    auto result = size_t{128};
+    if (auto x = p.hi ^ n.hi)
+      result = std::countl_zero(x);
+    else if (auto y = p.lo ^ n.lo)
+      result = 64 + std::countl_zero(y);
+    return static_cast<uint8_t>(std::min({result, size_t{p.length},
+                                          size_t{n.length}}));
+  };
+  auto is_leaf = [](const node& n) {
+    return n.children[0] == 0 && n.children[1] == 0;
+  };
+  auto hi = mask64(p.hi, p.length);
+  auto lo = mask64(p.lo, p.length > 64 ? p.length - 64 : 0);
+  auto cur = uint32_t{0};
+  while (true) {
+    auto& n = nodes_[cur];
+    if (n.length == p.length) {
+      if (!is_leaf(n))
+        set(n.exact, row);
+      n.terminal = true;
+      set(n.subtree, row);
+      return;
+    }
+    // The exact rows of a leaf are implicit in its subtree, which is about to
+    // receive a row that belongs to a descendant.
+    if (n.terminal && is_leaf(n))
+      n.exact = n.subtree;
+    set(n.subtree, row);
+    auto b = bit(hi, lo, n.length);
+    auto child = n.children[b];
+    if (child == 0) {
+      auto leaf = node{};
+      leaf.hi = hi;
+      leaf.lo = lo;
+      leaf.length = p.length;
+      leaf.terminal = true;
+      set(leaf.subtree, row);
+      nodes_.push_back(std::move(leaf));
+      nodes_[cur].children[b] = static_cast<uint32_t>(nodes_.size() - 1);
+      return;
+    }
+    auto common = common_length(nodes_[child]);
+    if (common < nodes_[child].length) {
+      // Split the edge to the child with an inner node at the common prefix.
+      auto inner = node{};
+      inner.hi = mask64(hi, common);
+      inner.lo = mask64(lo, common > 64 ? common - 64 : 0);
+      inner.length = common;
+      inner.subtree = nodes_[child].subtree;
+      inner.children[bit(nodes_[child].hi, nodes_[child].lo, common)] = child;
+      nodes_.push_back(std::move(inner));
+      child = static_cast<uint32_t>(nodes_.size() - 1);
+      nodes_[cur].children[b] = child;
+    }
+    cur = child;
+  }
+}
+
+std::optional<uint32_t> radix_index::find(const prefix& p) const {
+  auto cur = uint32_t{0};
+  while (nodes_[cur].length < p.length) {
+    const auto& n = nodes_[cur];
+    auto bit = n.length < 64 ? (p.hi >> (63 - n.length)) & 1
+                             : (p.lo >> (127 - n.length)) & 1;
+    auto child = n.children[bit];
+    if (child == 0)
+      return std::nullopt;
+    // The prefix must match the child on the bits that both define.
+    const auto& c = nodes_[child];
+    auto length = std::min(p.length, c.length);
+    if (mask64(p.hi, length) != mask64(c.hi, length)
+        || mask64(p.lo, length > 64 ? length - 64 : 0)
+             != mask64(c.lo, length > 64 ? length - 64 : 0))
+      return std::nullopt;
+    cur = child;
+  }
+  return cur;
+}
+
+ids radix_index::lookup_equal(const prefix& p) const {
+  auto i = find(p);
+  if (!i || nodes_[*i].length != p.length)
+    return ids{offset(), false};
+  return to_ids(exact_rows(nodes_[*i]));
+}
+
+ids radix_index::lookup_within(const prefix& p) const {
+  auto i = find(p);
+  if (!i)
+    return ids{offset(), false};
+  return to_ids(nodes_[*i].subtree);
+}
+
+ids radix_index::lookup_covering(const prefix& p) const {
+  auto result = ids{offset(), false};
+  auto cur = uint32_t{0};
+  while (true) {
+    const auto& n = nodes_[cur];
+    if (n.terminal)
+      result |= to_ids(exact_rows(n));
+    if (n.length == p.length)
+      break;
+    auto bit = n.length < 64 ? (p.hi >> (63 - n.length)) & 1
+                             : (p.lo >> (127 - n.length)) & 1;
+    auto child = n.children[bit];
+    if (child == 0)
+      break;
+    // Only descend into children whose entire prefix is part of the query.
+    const auto& c = nodes_[child];
+    if (c.length > p.length || mask64(p.hi, c.length) != c.hi
+        || mask64(p.lo, c.length > 64 ? c.length - 64 : 0) != c.lo)
+      break;
+    cur = child;
+  }
+  return result;
+}
+
+ids radix_index::to_ids(const ewah_bitmap& rows) const {
+  auto result = ids{rows};
+  if (result.size() < offset())
+    result.append_bits(false, offset() - result.size());
+  return result;
+}
+
+const ewah_bitmap& radix_index::exact_rows(const node& n) const {
+  static const auto empty = ewah_bitmap{};
+  if (!n.terminal)
+    return empty;
+  if (n.children[0] == 0 && n.children[1] == 0)
+    return n.subtree;
+  return n.exact;
+}
+
+bool radix_index::is_valid() const {
+  if (nodes_.empty() || nodes_[0].length != 0)
+    return false;
+  // Splitting a node appends the new inner node to the back, so children may
+  // precede their parents. Strictly increasing prefix lengths along every
+  // edge rule out cycles regardless of the node order.
+  for (const auto& n : nodes_) {
+    if (n.length > 128)
+      return false;
+    for (auto child : n.children)
+      if (child != 0
+          && (child >= nodes_.size() || nodes_[child].length <= n.length))
+        return false;
+  }
+  return true;
+}
+
+} // namespace vast
@@ -0,0 +1,422 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/index/sorted_index.hpp"
+
+#include "vast/detail/assert.hpp"
+#include "vast/detail/legacy_deserialize.hpp"
+#include "vast/detail/overload.hpp"
+#include "vast/error.hpp"
+#include "vast/fbs/value_index.hpp"
+#include "vast/index/container_lookup.hpp"
+#include "vast/type.hpp"
+
+#include <caf/deserializer.hpp>
+#include <caf/serializer.hpp>
+#include <caf/settings.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+namespace vast {
+
+namespace {
+
+/// The number of 64-bit words that make up the flat representation of a
+/// block.
+constexpr size_t flat_block_size = 7;
+
+/// Maps a signed integer to an unsigned one with the same order.
+uint64_t signed_key(int64_t x) {
+  return static_cast<uint64_t>(x) ^ (uint64_t{1} << 63);
+}
+
+/// Maps a floating-point number to an unsigned integer with the same order.
+uint64_t real_key(double x) {
+  if (x == 0.0)
+    x = 0.0; // Treat -0.0 and 0.0 alike.
+  auto bits = std::bit_cast<uint64_t>(x);
+  return bits >> 63 ? ~bits : bits | (uint64_t{1} << 63);
+}
+
+/// Writes the lower *width* bits of *value* at bit position *bit*. The target
+/// bits must be zero.
+void put_bits(uint64_t* words, size_t bit, uint64_t value, uint8_t width) {
+  if (width == 0)
+    return;
+  auto word = bit / 64;
+  auto shift = bit % 64;
+  words[word] |= value << shift;
+  if (shift + width > 64)
+    words[word + 1] |= value >> (64 - shift);
+}
+
+/// Reads *width* bits at bit position *bit*.
+uint64_t get_bits(const uint64_t* words, size_t bit, uint8_t width) {
+  if (width == 0)
+    return 0;
+  auto word = bit / 64;
+  auto shift = bit % 64;
+  auto result = words[word] >> shift;
+  if (shift + width > 64)
+    result |= words[word + 1] << (64 - shift);
+  return width == 64 ? result : result & ((uint64_t{1} << width) - 1);
+}
+
+/// Finds the first index in [0, n) for which *pred* is false, assuming that
+/// *pred* is true for a prefix of the range.
+template <class Predicate>
+size_t partition_index(size_t n, Predicate pred) {
+  auto first = size_t{0};
+  while (n > 0) {
+    auto half = n / 2;
+    if (pred(first + half)) {
+      first += half + 1;
+      n -= half + 1;
+    } else {
+      n = half;
+    }
+  }
+  return first;
+}
+
+} // namespace
+
+bool sorted_index::supports(const vast::type& t) {
+  return caf::holds_alternative<integer_type>(t)
+         || caf::holds_alternative<count_type>(t)
+         || caf::holds_alternative<real_type>(t)
+         || caf::holds_alternative<duration_type>(t)
+         || caf::holds_alternative<time_type>(t);
+}
+
+sorted_index::sorted_index(vast::type t, caf::settings opts)
+  : value_index{std::move(t), std::move(opts)} {
+  VAST_ASSERT(supports(type()));
+}
+
+caf::error sorted_index::serialize(caf::serializer& sink) const {
+  auto blocks = blocks_;
+  auto words = words_;
+  if (!buffer_.empty()) {
+    blocks.clear();
+    words.clear();
+    encode(entries(), blocks, words);
+  }
+  auto flat_blocks = flatten(blocks);
+  return caf::error::eval(
+    [&] {
+      return value_index::serialize(sink);
+    },
+    [&] {
+      return sink(flat_blocks, words);
+    });
+}
+
+caf::error sorted_index::deserialize(caf::deserializer& source) {
+  auto flat_blocks = std::vector<uint64_t>{};
+  auto words = std::vector<uint64_t>{};
+  auto err = caf::error::eval(
+    [&] {
+      return value_index::deserialize(source);
+    },
+    [&] {
+      return source(flat_blocks, words);
+    });
+  if (err)
+    return err;
+  auto blocks = std::vector<block>{};
+  if (!unflatten(flat_blocks, blocks) || !is_valid(blocks, words.size()))
+    return caf::make_error(ec::format_error, "invalid sorted index blocks");
+  blocks_ = std::move(blocks);
+  words_ = std::move(words);
+  buffer_.clear();
+  return caf::none;
+}
+
+bool sorted_index::deserialize(detail::legacy_deserializer& source) {
+  if (!value_index::deserialize(source))
+    return false;
+  auto flat_blocks = std::vector<uint64_t>{};
+  auto words = std::vector<uint64_t>{};
+  if (!source(flat_blocks, words))
+    return false;
+  auto blocks = std::vector<block>{};
+  if (!unflatten(flat_blocks, blocks) || !is_valid(blocks, words.size()))
+    return false;
+  blocks_ = std::move(blocks);
+  words_ = std::move(words);
+  buffer_.clear();
+  return true;
+}
+
+bool sorted_index::append_impl(data_view x, id pos) {
+  auto k = key(x);
+  if (!k)
+    return false;
+  buffer_.emplace_back(*k, pos);
+  // Sealing re-encodes all entries, so we only seal once the buffer has
+  // grown as large as the sealed part. This keeps the linear scans over the
+  // buffer bounded and the total cost of sealing at O(n log n).
+  auto sealed = blocks_.size() * block_size;
+  if (buffer_.size() >= std::max(block_size * 64, sealed))
+    seal();
+  return true;
+}
+
+caf::expected<ids>
+sorted_index::lookup_impl(relational_operator op, data_view x) const {
+  if (const auto* xs = caf::get_if<view<list>>(&x))
+    return detail::container_lookup(*this, op, *xs);
+  auto k = key(x);
+  if (!k)
+    return caf::make_error(ec::type_clash, materialize(x));
+  constexpr auto max_key = std::numeric_limits<uint64_t>::max();
+  switch (op) {
+    default:
+      return caf::make_error(ec::unsupported_operator, op);
+    case relational_operator::equal:
+      return lookup_range(*k, *k);
+    case relational_operator::not_equal:
+      return ~lookup_range(*k, *k);
+    case relational_operator::less:
+      if (*k == 0)
+        return ids{offset(), false};
+      return lookup_range(0, *k - 1);
+    case relational_operator::less_equal:
+      return lookup_range(0, *k);
+    case relational_operator::greater:
+      if (*k == max_key)
+        return ids{offset(), false};
+      return lookup_range(*k + 1, max_key);
+    case relational_operator::greater_equal:
+      return lookup_range(*k, max_key);
+  }
+}
+
+size_t sorted_index::memusage_impl() const {
+  return blocks_.capacity() * sizeof(block)
+         + words_.capacity() * sizeof(uint64_t)
+         + buffer_.capacity() * sizeof(entry);
+}
+
+flatbuffers::Offset<fbs::ValueIndex> sorted_index::pack_impl(
+  flatbuffers::FlatBufferBuilder& builder,
+  flatbuffers::Offset<fbs::value_index::detail::ValueIndexBase> base_offset) {
+  seal();
+  auto blocks = std::vector<fbs::value_index::SortedIndexBlock>{};
+  blocks.reserve(blocks_.size());
+  for (const auto& b : blocks_)
+    blocks.emplace_back(b.min_key, b.max_key, b.min_row, b.offset, b.size,
+                        b.key_width, b.row_width);
+  const auto sorted_index_offset = fbs::value_index::CreateSortedIndexDirect(
+    builder, base_offset, &blocks, &words_);
+  return fbs::CreateValueIndex(builder, fbs::value_index::ValueIndex::sorted,
+                               sorted_index_offset.Union());
+}
+
+caf::error sorted_index::unpack_impl(const fbs::ValueIndex& from) {
+  const auto* from_sorted = from.value_index_as_sorted();
+  VAST_ASSERT(from_sorted);
+  auto blocks = std::vector<block>{};
+  blocks.reserve(from_sorted->blocks()->size());
+  for (const auto* b : *from_sorted->blocks())
+    blocks.push_back({b->min_key(), b->max_key(), b->min_row(), b->offset(),
+                      b->size(), b->key_width(), b->row_width()});
+  if (!is_valid(blocks, from_sorted->words()->size()))
+    return caf::make_error(ec::format_error, "invalid sorted index blocks");
+  blocks_ = std::move(blocks);
+  words_.assign(from_sorted->words()->begin(), from_sorted->words()->end());
+  buffer_.clear();
+  return caf::none;
+}
+
+std::optional<uint64_t> sorted_index::key(data_view x) const {
+  constexpr auto max_integer = std::numeric_limits<int64_t>::max();
+  auto f = detail::overload{
+    [](const auto&, const auto&) -> std::optional<uint64_t> {
+      return std::nullopt;
+    },
+    [](const integer_type&, view<integer> x) -> std::optional<uint64_t> {
+      return signed_key(x.value);
+    },
+    [](const integer_type&, view<count> x) -> std::optional<uint64_t> {
+      if (x > static_cast<count>(max_integer))
+        return std::nullopt;
+      return signed_key(static_cast<int64_t>(x));
+    },
+    [](const count_type&, view<count> x) -> std::optional<uint64_t> {
+      return x;
+    },
+    [](const count_type&, view<integer> x) -> std::optional<uint64_t> {
+      if (x.value < 0)
+        return std::nullopt;
+      return static_cast<uint64_t>(x.value);
+    },
+    [](const real_type&, view<real> x) -> std::optional<uint64_t> {
+      return real_key(x);
+    },
+    [](const duration_type&, view<duration> x) -> std::optional<uint64_t> {
+      return signed_key(x.count());
+    },
+    [](const time_type&, view<time> x) -> std::optional<uint64_t> {
+      return signed_key(x.time_since_epoch().count());
+    },
+  };
+  return caf::visit(f, type(), x);
+}
+
+ids sorted_index::lookup_range(uint64_t lo, uint64_t hi) const {
+  auto rows = std::vector<id>{};
+  auto first = std::partition_point(blocks_.begin(), blocks_.end(),
+                                    [&](const block& b) {
+                                      return b.max_key < lo;
+                                    });
+  for (auto it = first; it != blocks_.end() && it->min_key <= hi; ++it) {
+    const auto* words = words_.data() + it->offset;
+    auto key_at = [&](size_t i) {
+      return it->min_key + get_bits(words, i * it->key_width, it->key_width);
+    };
+    // Only the blocks at the boundaries of the range need a search; all
+    // others match entirely.
+    auto begin = size_t{0};
+    auto end = size_t{it->size};
+    if (it->min_key < lo)
+      begin = partition_index(it->size, [&](size_t i) {
+        return key_at(i) < lo;
+      });
+    if (it->max_key > hi)
+      end = partition_index(it->size, [&](size_t i) {
+        return key_at(i) <= hi;
+      });
+    auto row_bits = size_t{it->size} * it->key_width;
+    for (auto i = begin; i < end; ++i)
+      rows.push_back(it->min_row
+                     + get_bits(words, row_bits + i * it->row_width,
+                                it->row_width));
+  }
+  for (const auto& [k, row] : buffer_)
+    if (lo <= k && k <= hi)
+      rows.push_back(row);
+  std::sort(rows.begin(), rows.end());
+  auto result = ids{};
+  for (auto row : rows) {
+    result.append_bits(false, row - result.size());
+    result.append_bit(true);
+  }
+  if (result.size() < offset())
+    result.append_bits(false, offset() - result.size());
+  return result;
+}
+
+std::vector<sorted_index::entry> sorted_index::entries() const {
+  auto result = std::vector<entry>{};
+  result.reserve(blocks_.size() * block_size + buffer_.size());
+  for (const auto& b : blocks_) {
+    const auto* words = words_.data() + b.offset;
+    auto row_bits = size_t{b.size} * b.key_width;
+    for (size_t i = 0; i < b.size; ++i)
+      result.emplace_back(
+        b.min_key + get_bits(words, i * b.key_width, b.key_width),
+        b.min_row + get_bits(words, row_bits + i * b.row_width, b.row_width));
+  }
+  auto mid = static_cast<std::ptrdiff_t>(result.size());
+  result.insert(result.end(), buffer_.begin(), buffer_.end());
+  std::sort(result.begin() + mid, result.end());
+  std::inplace_merge(result.begin(), result.begin() + mid, result.end());
+  return result;
+}
+
+void sorted_index::seal() {
+  if (buffer_.empty())
+    return;
+  auto xs = entries();
+  blocks_.clear();
+  words_.clear();
+  encode(xs, blocks_, words_);
+  blocks_.shrink_to_fit();
+  words_.shrink_to_fit();
+  buffer_.clear();
+  buffer_.shrink_to_fit();
+}
+
+void sorted_index::encode(const std::vector<entry>& xs,
+                          std::vector<block>& blocks,
+                          std::vector<uint64_t>& words) {
+  for (size_t first = 0; first < xs.size(); first += block_size) {
+    auto last = std::min(first + block_size, xs.size());
+    auto by_row = [](const entry& x, const entry& y) {
+      return x.second < y.second;
+    };
+    auto [min_row, max_row]
+      = std::minmax_element(xs.begin() + first, xs.begin() + last, by_row);
+    auto b = block{};
+    b.min_key = xs[first].first;
+    b.max_key = xs[last - 1].first;
+    b.min_row = min_row->second;
+    b.offset = words.size();
+    b.size = static_cast<uint32_t>(last - first);
+    b.key_width = static_cast<uint8_t>(std::bit_width(b.max_key - b.min_key));
+    b.row_width
+      = static_cast<uint8_t>(std::bit_width(max_row->second - b.min_row));
+    auto bits = size_t{b.size} * (b.key_width + b.row_width);
+    words.resize(words.size() + (bits + 63) / 64);
+    auto* out = words.data() + b.offset;
+    auto row_bits = size_t{b.size} * b.key_width;
+    for (size_t i = 0; i < b.size; ++i) {
+      const auto& [k, row] = xs[first + i];
+      put_bits(out, i * b.key_width, k - b.min_key, b.key_width);
+      put_bits(out, row_bits + i * b.row_width, row - b.min_row, b.row_width);
+    }
+    blocks.push_back(b);
+  }
+}
+
+std::vector<uint64_t> sorted_index::flatten(const std::vector<block>& blocks) {
+  auto result = std::vector<uint64_t>{};
+  result.reserve(blocks.size() * flat_block_size);
+  for (const auto& b : blocks)
+    result.insert(result.end(), {b.min_key, b.max_key, b.min_row, b.offset,
+                                 b.size, b.key_width, b.row_width});
+  return result;
+}
+
+bool sorted_index::unflatten(const std::vector<uint64_t>& xs,
+                             std::vector<block>& blocks) {
+  if (xs.size() % flat_block_size != 0)
+    return false;
+  blocks.clear();
+  blocks.reserve(xs.size() / flat_block_size);
+  for (size_t i = 0; i < xs.size(); i += flat_block_size) {
+    if (xs[i + 4] > block_size || xs[i + 5] > 64 || xs[i + 6] > 64)
+      return false;
+    blocks.push_back({xs[i], xs[i + 1], xs[i + 2], xs[i + 3],
+                      static_cast<uint32_t>(xs[i + 4]),
+                      static_cast<uint8_t>(xs[i + 5]),
+                      static_cast<uint8_t>(xs[i + 6])});
+  }
+  return true;
+}
+
+bool sorted_index::is_valid(const std::vector<block>& blocks,
+                            size_t num_words) {
+  auto offset = uint64_t{0};
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    const auto& b = blocks[i];
+    if (b.size == 0 || b.size > block_size || b.key_width > 64
+        || b.row_width > 64 || b.min_key > b.max_key || b.offset != offset)
+      return false;
+    if (i > 0 && blocks[i - 1].max_key > b.min_key)
+      return false;
+    offset += (size_t{b.size} * (b.key_width + b.row_width) + 63) / 64;
+  }
+  return offset == num_words;
+}
+
+} // namespace vast
@@ -65,4 +65,22 @@ bool should_create_partition_index(
   return true;
 }
 
+bool should_create_sketches(const qualified_record_field& index_qf,
+                            const std::vector<index_config::rule>& rules) {
+  for (const auto& rule : rules) {
+    if (should_use_rule(rule.targets, index_qf))
+      return rule.create_sketches;
+  }
+  return false;
+}
+
+type make_index_type(const qualified_record_field& index_qf,
+                     const std::vector<index_config::rule>& rules) {
+  for (const auto& rule : rules) {
+    if (!rule.value_index.empty() && should_use_rule(rule.targets, index_qf))
+      return type{index_qf.type(), {{"index", rule.value_index}}};
+  }
+  return index_qf.type();
+}
+
 } // namespace vast
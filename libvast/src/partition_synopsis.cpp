@@ -8,12 +8,16 @@
 
 #include "vast/partition_synopsis.hpp"
 
+#include "vast/arrow_table_slice.hpp"
 #include "vast/detail/collect.hpp"
 #include "vast/error.hpp"
 #include "vast/fbs/utils.hpp"
 #include "vast/index_config.hpp"
 #include "vast/synopsis_factory.hpp"
 
+#include <arrow/record_batch.h>
+#include <arrow/type.h>
+
 namespace vast {
 
 partition_synopsis::partition_synopsis(partition_synopsis&& that) noexcept {
@@ -25,6 +29,8 @@ partition_synopsis::partition_synopsis(partition_synopsis&& that) noexcept {
   schema = std::exchange(that.schema, {});
   type_synopses_ = std::exchange(that.type_synopses_, {});
   field_synopses_ = std::exchange(that.field_synopses_, {});
+  field_sketches_ = std::exchange(that.field_sketches_, {});
+  digests_ = std::exchange(that.digests_, {});
   memusage_.store(that.memusage_.exchange(0));
 }
 
@@ -39,6 +45,8 @@ partition_synopsis::operator=(partition_synopsis&& that) noexcept {
     schema = std::exchange(that.schema, {});
     type_synopses_ = std::exchange(that.type_synopses_, {});
     field_synopses_ = std::exchange(that.field_synopses_, {});
+    field_sketches_ = std::exchange(that.field_sketches_, {});
+    digests_ = std::exchange(that.digests_, {});
     memusage_.store(that.memusage_.exchange(0));
   }
   return *this;
@@ -46,45 +54,52 @@ partition_synopsis::operator=(partition_synopsis&& that) noexcept {
 
 void partition_synopsis::shrink() {
   memusage_ = 0; // Invalidate cached size.
-  for (auto& [field, synopsis] : field_synopses_) {
-    if (!synopsis)
-      continue;
-    auto shrinked_synopsis = synopsis->shrink();
-    if (!shrinked_synopsis)
-      continue;
-    synopsis.swap(shrinked_synopsis);
-  }
-  // TODO: Make a utility function instead of copy/pasting
-  for (auto& [field, synopsis] : type_synopses_) {
+  auto digests = partition_digests{};
+  auto shrink = [&](auto& synopsis, uint64_t scope) {
     if (!synopsis)
-      continue;
+      return false;
     auto shrinked_synopsis = synopsis->shrink();
     if (!shrinked_synopsis)
-      continue;
+      return false;
+    // A shrinked synopsis is covered by the digests only if the original
+    // synopsis provided all of them.
+    auto size = digests.digests.size();
+    auto covered = synopsis->append_digests(scope, digests.digests);
+    if (!covered)
+      digests.digests.resize(size);
     synopsis.swap(shrinked_synopsis);
-  }
+    return covered;
+  };
+  for (auto& [field, synopsis] : field_synopses_)
+    if (shrink(synopsis, digest_scope(field)))
+      digests.fields.push_back(field);
+  for (auto& [type, synopsis] : type_synopses_)
+    if (shrink(synopsis, digest_scope(type)))
+      digests.types.push_back(type);
+  if (!digests.fields.empty() || !digests.types.empty())
+    digests_ = std::make_shared<const partition_digests>(std::move(digests));
 }
 
 // TODO: Use a more efficient data structure for rule lookup.
 std::optional<double> get_field_fprate(const index_config& config,
                                        const qualified_record_field& field) {
-  for (const auto& [targets, fprate, _] : config.rules)
-    for (const auto& name : targets)
+  for (const auto& rule : config.rules)
+    for (const auto& name : rule.targets)
       if (name.size()
             == field.field_name().size() + field.layout_name().size() + 1
           && name.starts_with(field.layout_name())
           && name.ends_with(field.field_name()))
-        return fprate;
+        return rule.fp_rate;
   return std::nullopt;
 }
 
 double get_type_fprate(const index_config& config, const type& type) {
-  for (const auto& [targets, fprate, _] : config.rules) {
-    for (const auto& name : targets) {
+  for (const auto& rule : config.rules) {
+    for (const auto& name : rule.targets) {
       if (name == ":string" && type == string_type{})
-        return fprate;
+        return rule.fp_rate;
       else if (name == ":addr" && type == address_type{})
-        return fprate;
+        return rule.fp_rate;
     }
   }
   return config.default_fp_rate;
@@ -115,11 +130,13 @@ void partition_synopsis::add(const table_slice& slice,
     = get_type_fprate(fp_rates, vast::type{string_type{}});
   synopsis_opts["address-synopsis-fp-rate"]
     = get_type_fprate(fp_rates, vast::type{address_type{}});
+  const auto batch = to_record_batch(slice);
   for (size_t col = 0; col < slice.columns(); ++col, ++leaf_it) {
     auto&& leaf = *leaf_it;
+    const auto array
+      = static_cast<arrow::FieldPath>(leaf.index).Get(*batch).ValueOrDie();
     auto add_column = [&](const synopsis_ptr& syn) {
-      for (size_t row = 0; row < slice.rows(); ++row) {
-        auto view = slice.at(row, col, leaf.field.type);
+      for (auto&& view : values(leaf.field.type, *array)) {
         // TODO: It would probably make sense to allow `nil` in the
         // synopsis API, so we can treat queries like `x == nil` just
         // like normal queries.
@@ -127,6 +144,17 @@ void partition_synopsis::add(const table_slice& slice,
           syn->add(std::move(view));
       }
     };
+    // Maintain the sketches of the field if they were configured.
+    if (auto key = qualified_record_field{layout, leaf.index};
+        should_create_sketches(key, fp_rates.rules)) {
+      auto it = field_sketches_.find(key);
+      if (it == field_sketches_.end()) {
+        auto sketch = sketch::column_sketch::make({});
+        VAST_ASSERT(sketch);
+        it = field_sketches_.emplace(std::move(key), std::move(*sketch)).first;
+      }
+      it->second.add(leaf.field.type, *array);
+    }
     // Make a field synopsis if it was configured.
     if (auto key = qualified_record_field{layout, leaf.index};
         auto fprate = get_field_fprate(fp_rates, key)) {
@@ -174,6 +202,8 @@ size_t partition_synopsis::memusage() const {
       result += synopsis ? synopsis->memusage() : 0ull;
     for (const auto& [type, synopsis] : type_synopses_)
       result += synopsis ? synopsis->memusage() : 0ull;
+    for (const auto& [field, sketch] : field_sketches_)
+      result += mem_usage(sketch);
     memusage_ = result;
   }
   return result;
@@ -187,6 +217,8 @@ partition_synopsis* partition_synopsis::copy() const {
   result->max_import_time = max_import_time;
   result->version = version;
   result->schema = schema;
+  result->field_sketches_ = field_sketches_;
+  result->digests_ = digests_;
   result->memusage_ = memusage_.load();
   result->type_synopses_.reserve(type_synopses_.size());
   result->field_synopses_.reserve(field_synopses_.size());
@@ -224,6 +256,17 @@ pack(flatbuffers::FlatBufferBuilder& builder, const partition_synopsis& x) {
     synopses.push_back(*maybe_synopsis);
   }
   auto synopses_vector = builder.CreateVector(synopses);
+  std::vector<flatbuffers::Offset<fbs::partition_synopsis::FieldSketch>>
+    sketches;
+  for (const auto& [fqf, sketch] : x.field_sketches_) {
+    auto column_name = fbs::serialize_bytes(builder, fqf);
+    if (!column_name)
+      return column_name.error();
+    auto sketch_offset = pack(builder, sketch);
+    sketches.push_back(fbs::partition_synopsis::CreateFieldSketch(
+      builder, *column_name, sketch_offset));
+  }
+  auto sketches_vector = builder.CreateVector(sketches);
   auto schema_bytes = as_bytes(x.schema);
   auto schema_vector = builder.CreateVector(
     reinterpret_cast<const uint8_t*>(schema_bytes.data()), schema_bytes.size());
@@ -237,6 +280,7 @@ pack(flatbuffers::FlatBufferBuilder& builder, const partition_synopsis& x) {
   ps_builder.add_import_time_range(&import_time_range);
   ps_builder.add_version(x.version);
   ps_builder.add_schema(schema_vector);
+  ps_builder.add_field_sketches(sketches_vector);
   return ps_builder.Finish();
 }
 
@@ -266,6 +310,24 @@ caf::error unpack_(
   return caf::none;
 }
 
+caf::error unpack_(const flatbuffers::Vector<flatbuffers::Offset<
+                     fbs::partition_synopsis::FieldSketch>>& sketches,
+                   partition_synopsis& ps) {
+  for (const auto* field_sketch : sketches) {
+    if (!field_sketch)
+      return caf::make_error(ec::format_error, "field sketch is null");
+    qualified_record_field qf;
+    if (auto error
+        = fbs::deserialize_bytes(field_sketch->qualified_record_field(), qf))
+      return error;
+    auto sketch = sketch::column_sketch{};
+    if (auto error = unpack(*field_sketch->sketch(), sketch))
+      return error;
+    ps.field_sketches_.emplace(std::move(qf), std::move(sketch));
+  }
+  return caf::none;
+}
+
 } // namespace
 
 caf::error unpack(const fbs::partition_synopsis::LegacyPartitionSynopsis& x,
@@ -286,6 +348,9 @@ caf::error unpack(const fbs::partition_synopsis::LegacyPartitionSynopsis& x,
     ps.schema = type{chunk::copy(as_bytes(*schema))};
   if (!x.synopses())
     return caf::make_error(ec::format_error, "missing synopses");
+  if (const auto* field_sketches = x.field_sketches())
+    if (auto error = unpack_(*field_sketches, ps))
+      return error;
   return unpack_(*x.synopses(), ps);
 }
 
@@ -310,6 +375,9 @@ caf::error unpack(const fbs::partition_synopsis::LegacyPartitionSynopsis& x,
     ps.schema = type{chunk::copy(as_bytes(*schema))};
   if (!x.synopses())
     return caf::make_error(ec::format_error, "missing synopses");
+  if (const auto* field_sketches = x.field_sketches())
+    if (auto error = unpack_(*field_sketches, ps))
+      return error;
   return unpack_(*x.synopses(), ps);
 }
 
@@ -10,29 +10,82 @@
 
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/data.hpp"
+#include "vast/detail/overload.hpp"
+#include "vast/detail/regex.hpp"
 #include "vast/pattern.hpp"
 
+#include <caf/expected.hpp>
+
 #include <regex>
+#include <variant>
 
 namespace vast {
 
+/// The compiled expression of a pattern. We fall back to `std::regex` for
+/// expressions that the linear-time engine does not support.
+struct pattern::compiled {
+  std::variant<detail::regex, std::regex> engine;
+};
+
 pattern pattern::glob(std::string_view str) {
   std::string rx;
-  std::regex_replace(std::back_inserter(rx), str.begin(), str.end(),
-                     std::regex("\\."), "\\.");
-  rx = std::regex_replace(rx, std::regex("\\*"), ".*");
-  return pattern{std::regex_replace(rx, std::regex("\\?"), ".")};
+  rx.reserve(str.size());
+  for (auto c : str) {
+    if (c == '.')
+      rx += "\\.";
+    else if (c == '*')
+      rx += ".*";
+    else if (c == '?')
+      rx += '.';
+    else
+      rx += c;
+  }
+  return pattern{std::move(rx)};
 }
 
 pattern::pattern(std::string str) : str_(std::move(str)) {
+  compile();
+}
+
+void pattern::compile() {
+  if (auto rx = detail::regex::make(str_)) {
+    compiled_ = std::make_shared<compiled>(compiled{std::move(*rx)});
+    return;
+  }
+  try {
+    compiled_ = std::make_shared<compiled>(compiled{std::regex{str_}});
+  } catch (const std::regex_error&) {
+    // Invalid expressions throw on every match, just like `std::regex`.
+    compiled_ = nullptr;
+  }
 }
 
 bool pattern::match(std::string_view str) const {
-  return std::regex_match(str.begin(), str.end(), std::regex{str_});
+  if (!compiled_)
+    return std::regex_match(str.begin(), str.end(), std::regex{str_});
+  auto f = detail::overload{
+    [&](const detail::regex& rx) {
+      return rx.match(str);
+    },
+    [&](const std::regex& rx) {
+      return std::regex_match(str.begin(), str.end(), rx);
+    },
+  };
+  return std::visit(f, compiled_->engine);
 }
 
 bool pattern::search(std::string_view str) const {
-  return std::regex_search(str.begin(), str.end(), std::regex{str_});
+  if (!compiled_)
+    return std::regex_search(str.begin(), str.end(), std::regex{str_});
+  auto f = detail::overload{
+    [&](const detail::regex& rx) {
+      return rx.search(str);
+    },
+    [&](const std::regex& rx) {
+      return std::regex_search(str.begin(), str.end(), rx);
+    },
+  };
+  return std::visit(f, compiled_->engine);
 }
 
 const std::string& pattern::string() const {
@@ -45,6 +98,7 @@ pattern& pattern::operator+=(const pattern& other) {
 
 pattern& pattern::operator+=(std::string_view other) {
   str_ += other;
+  compile();
   return *this;
 }
 
@@ -57,6 +111,7 @@ pattern& pattern::operator|=(std::string_view other) {
   str_ += ")|(";
   str_.append(other.begin(), other.end());
   str_ += ')';
+  compile();
   return *this;
 }
 
@@ -69,6 +124,7 @@ pattern& pattern::operator&=(std::string_view other) {
   str_ += ")(";
   str_.append(other.begin(), other.end());
   str_ += ')';
+  compile();
   return *this;
 }
 
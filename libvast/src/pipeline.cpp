@@ -9,6 +9,8 @@
 #include "vast/pipeline.hpp"
 
 #include "vast/logger.hpp"
+#include "vast/query_context.hpp"
+#include "vast/system/report.hpp"
 #include "vast/table_slice_builder.hpp"
 #include "vast/table_slice_builder_factory.hpp"
 #include "vast/table_slice_encoding.hpp"
@@ -19,6 +21,7 @@
 #include <caf/type_id.hpp>
 
 #include <algorithm>
+#include <utility>
 
 namespace vast {
 
@@ -28,6 +31,17 @@ pipeline::pipeline(std::string name, std::vector<std::string>&& schema_names)
 
 void pipeline::add_operator(std::unique_ptr<pipeline_operator> op) {
   operators_.emplace_back(std::move(op));
+  definitions_.emplace_back();
+}
+
+caf::error
+pipeline::add_operator(const std::string& name, const record& options) {
+  auto op = make_pipeline_operator(name, options);
+  if (!op)
+    return std::move(op.error());
+  operators_.emplace_back(std::move(*op));
+  definitions_.emplace_back(name, options);
+  return caf::none;
 }
 
 const std::string& pipeline::name() const {
@@ -38,12 +52,64 @@ const std::vector<std::string>& pipeline::schema_names() const {
   return schema_names_;
 }
 
+caf::expected<pipeline> pipeline::replicate() const {
+  auto result = pipeline{name_, std::vector<std::string>{schema_names_}};
+  for (const auto& [name, options] : definitions_) {
+    if (name.empty())
+      return caf::make_error(ec::invalid_argument,
+                             fmt::format("pipeline {} cannot replicate an "
+                                         "operator that was not created from "
+                                         "its configuration",
+                                         name_));
+    if (auto err = result.add_operator(name, options))
+      return err;
+  }
+  return result;
+}
+
 bool pipeline::is_aggregate() const {
   return std::any_of(operators_.begin(), operators_.end(), [](const auto& op) {
     return op->is_aggregate();
   });
 }
 
+bool pipeline::is_incremental() const {
+  return std::all_of(operators_.begin(), operators_.end(), [](const auto& op) {
+    return !op->is_aggregate() || op->is_incremental();
+  });
+}
+
+void pipeline::flush() {
+  for (const auto& op : operators_)
+    op->flush();
+}
+
+std::vector<system::data_point> pipeline::metrics() const {
+  auto result = std::vector<system::data_point>{};
+  for (const auto& op : operators_) {
+    auto op_metrics = op->metrics();
+    result.insert(result.end(), std::make_move_iterator(op_metrics.begin()),
+                  std::make_move_iterator(op_metrics.end()));
+  }
+  return result;
+}
+
+std::optional<partial_aggregation> pipeline::pushdown() const {
+  // Only the first operator may run next to the data, as all operators before
+  // it would otherwise see partial results.
+  if (operators_.empty() || !operators_.front()->is_aggregate())
+    return std::nullopt;
+  const auto& [name, options] = definitions_.front();
+  if (name.empty())
+    return std::nullopt;
+  if (auto partial = make_partial_pipeline_operator(name, options); !partial) {
+    VAST_DEBUG("pipeline {} cannot push down operator {}: {}", name_, name,
+               partial.error());
+    return std::nullopt;
+  }
+  return partial_aggregation{name, options, schema_names_};
+}
+
 bool pipeline::applies_to(std::string_view event_name) const {
   return schema_names_.empty()
          || std::find(schema_names_.begin(), schema_names_.end(), event_name)
@@ -135,12 +201,60 @@ caf::error pipeline::process_queue(const std::unique_ptr<pipeline_operator>& op,
   return caf::none;
 }
 
+caf::error pipeline::process_fused(
+  std::vector<std::unique_ptr<pipeline_operator>>::const_iterator first,
+  std::vector<std::unique_ptr<pipeline_operator>>::const_iterator last,
+  std::vector<pipeline_batch>& result, bool check_layout) {
+  const auto size = to_transform_.size();
+  for (size_t i = 0; i < size; ++i) {
+    auto [layout, batch] = std::move(to_transform_.front());
+    to_transform_.pop_front();
+    if (check_layout && !applies_to(layout.name())) {
+      // The transform does not change slices of unconfigured event types.
+      VAST_TRACE("{} transform skips a '{}' layout slice with {} event(s)",
+                 this->name(), std::string{layout.name()}, batch->num_rows());
+      result.emplace_back(std::move(layout), std::move(batch));
+      continue;
+    }
+    auto x = fused_batch{std::move(layout), std::move(batch)};
+    for (auto it = first; it != last && x.batch; ++it) {
+      if (auto err = (*it)->apply(x)) {
+        to_transform_.clear();
+        return caf::make_error(
+          static_cast<vast::ec>(err.code()),
+          fmt::format("transform aborts because of an error: {}", err));
+      }
+    }
+    auto selected = apply_selection(std::move(x));
+    if (!selected) {
+      to_transform_.clear();
+      return std::move(selected.error());
+    }
+    if (*selected)
+      to_transform_.push_back(std::move(**selected));
+  }
+  return caf::none;
+}
+
 caf::expected<std::vector<pipeline_batch>> pipeline::finish_batch() {
   VAST_DEBUG("applying {} pipeline {}", operators_.size(), name_);
   bool first_run = true;
   std::vector<pipeline_batch> result{};
-  for (const auto& op : operators_) {
-    auto failed = process_queue(op, result, first_run);
+  // Consecutive stateless operators run as a single fused pass over every
+  // batch; all other operators see the entire queue at once.
+  for (auto first = operators_.cbegin(); first != operators_.cend();) {
+    auto failed = caf::error{};
+    if ((*first)->is_stateless()) {
+      const auto last
+        = std::find_if(first, operators_.cend(), [](const auto& op) {
+            return !op->is_stateless();
+          });
+      failed = process_fused(first, last, result, first_run);
+      first = last;
+    } else {
+      failed = process_queue(*first, result, first_run);
+      ++first;
+    }
     first_run = false;
     if (failed) {
       to_transform_.clear();
@@ -170,7 +284,9 @@ pipeline_executor::pipeline_executor(std::vector<pipeline>&& pipelines)
 caf::error
 pipeline_executor::validate(enum allow_aggregate_pipelines allow_aggregates) {
   const auto first_aggregate = std::find_if(
-    pipelines_.begin(), pipelines_.end(), [](const auto& pipeline) {
+    pipelines_.begin(), pipelines_.end(), [&](const auto& pipeline) {
+      if (allow_aggregates == allow_aggregate_pipelines::incremental)
+        return !pipeline.is_incremental();
       return pipeline.is_aggregate();
     });
   bool is_aggregate = first_aggregate != pipelines_.end();
@@ -184,6 +300,58 @@ pipeline_executor::validate(enum allow_aggregate_pipelines allow_aggregates) {
   return caf::none;
 }
 
+bool pipeline_executor::is_aggregate() const {
+  return std::any_of(pipelines_.begin(), pipelines_.end(),
+                     [](const auto& pipeline) {
+                       return pipeline.is_aggregate();
+                     });
+}
+
+caf::error pipeline_executor::parallelize(size_t num_workers) {
+  for (const auto& pipeline : pipelines_)
+    if (auto replica = pipeline.replicate(); !replica)
+      return std::move(replica.error());
+  workers_ = num_workers > 1
+               ? std::make_unique<detail::worker_pool>(num_workers)
+               : nullptr;
+  return caf::none;
+}
+
+void pipeline_executor::flush() {
+  for (auto& pipeline : pipelines_)
+    pipeline.flush();
+  for (auto& [layout, instances] : replicas_)
+    for (auto& replicas : instances)
+      for (auto& replica : replicas)
+        replica.flush();
+  flush_ = true;
+}
+
+std::vector<system::data_point> pipeline_executor::metrics() const {
+  auto result = std::vector<system::data_point>{};
+  auto append = [&](const pipeline& pipeline) {
+    auto pipeline_metrics = pipeline.metrics();
+    result.insert(result.end(),
+                  std::make_move_iterator(pipeline_metrics.begin()),
+                  std::make_move_iterator(pipeline_metrics.end()));
+  };
+  for (const auto& pipeline : pipelines_)
+    append(pipeline);
+  for (const auto& [layout, instances] : replicas_)
+    for (const auto& replicas : instances)
+      for (const auto& replica : replicas)
+        append(replica);
+  return result;
+}
+
+std::optional<partial_aggregation> pipeline_executor::pushdown() const {
+  // With multiple pipelines, an earlier pipeline may need to see the events
+  // that a later aggregate pipeline consumes.
+  if (pipelines_.size() != 1)
+    return std::nullopt;
+  return pipelines_.front().pushdown();
+}
+
 /// Apply relevant pipelines to the table slice.
 caf::error pipeline_executor::add(table_slice&& x) {
   VAST_TRACE("pipeline engine adds a slice");
@@ -222,6 +390,7 @@ caf::expected<std::vector<table_slice>> pipeline_executor::finish() {
   VAST_TRACE("pipeline engine retrieves results");
   auto to_transform = std::exchange(to_transform_, {});
   std::unordered_map<vast::type, std::deque<pipeline_batch>> batches{};
+  std::vector<std::pair<vast::type, std::vector<size_t>>> work{};
   std::vector<table_slice> result{};
   for (auto& [layout, queue] : to_transform) {
     // TODO: Consider using a tsl robin map instead for transparent key lookup.
@@ -258,12 +427,42 @@ caf::expected<std::vector<table_slice>> pipeline_executor::finish() {
     VAST_DEBUG("pipeline engine applies {} pipelines on received table "
                "slices with layout {}",
                indices.size(), layout);
-    for (auto idx : indices) {
-      auto& t = pipelines_.at(idx);
-      auto failed = process_queue(t, bq);
-      if (failed)
+    work.emplace_back(layout, std::move(indices));
+  }
+  if (workers_ && !work.empty()) {
+    if (auto failed = process_parallel(work, batches))
+      return failed;
+  } else {
+    for (const auto& [layout, indices] : work) {
+      auto& bq = batches[layout];
+      for (auto idx : indices) {
+        auto& t = pipelines_.at(idx);
+        auto failed = process_queue(t, bq);
+        if (failed)
+          return failed;
+      }
+    }
+  }
+  // Aggregate pipelines may hold back results without receiving further
+  // input, so we finish them once more when flushing.
+  if (std::exchange(flush_, false)) {
+    auto& bq = batches[type{}];
+    for (auto& pipeline : pipelines_) {
+      if (!pipeline.is_aggregate())
+        continue;
+      if (auto failed = process_queue(pipeline, bq))
         return failed;
     }
+    for (auto& [layout, instances] : replicas_) {
+      auto queue = std::deque<pipeline_batch>{};
+      for (auto& replicas : instances) {
+        if (replicas.empty() || !replicas.front().is_aggregate())
+          continue;
+        if (auto failed = process_queue(replicas.front(), queue))
+          return failed;
+      }
+      std::move(queue.begin(), queue.end(), std::back_inserter(bq));
+    }
   }
   for (auto& [layout, queue] : batches) {
     for (auto& [layout, batch] : queue)
@@ -273,6 +472,96 @@ caf::expected<std::vector<table_slice>> pipeline_executor::finish() {
   return result;
 }
 
+caf::error
+pipeline_executor::process_layout(std::vector<std::vector<pipeline>>& instances,
+                                  const std::vector<size_t>& indices,
+                                  std::deque<pipeline_batch>& queue) {
+  auto is_aggregate = [&](size_t idx) {
+    return instances[idx].front().is_aggregate();
+  };
+  for (auto first = indices.begin(); first != indices.end();) {
+    if (is_aggregate(*first)) {
+      if (auto failed = process_queue(instances[*first].front(), queue))
+        return failed;
+      ++first;
+      continue;
+    }
+    // Apply consecutive pipelines without aggregate operators to contiguous
+    // chunks of the queue, so that concatenating the results of the chunks
+    // preserves the order of the batches.
+    const auto last = std::find_if(first, indices.end(), is_aggregate);
+    auto num_chunks = std::max(queue.size(), size_t{1});
+    for (auto it = first; it != last; ++it)
+      num_chunks = std::min(num_chunks, instances[*it].size());
+    auto chunks = std::vector<std::deque<pipeline_batch>>(num_chunks);
+    const auto size = queue.size();
+    for (size_t i = 0; i < size; ++i) {
+      chunks[i * num_chunks / size].push_back(std::move(queue.front()));
+      queue.pop_front();
+    }
+    auto errors = std::vector<caf::error>(num_chunks);
+    workers_->run(num_chunks, [&](size_t chunk) {
+      for (auto it = first; it != last; ++it) {
+        errors[chunk] = process_queue(instances[*it][chunk], chunks[chunk]);
+        if (errors[chunk])
+          return;
+      }
+    });
+    for (auto& error : errors)
+      if (error)
+        return std::move(error);
+    for (auto& chunk : chunks)
+      for (auto& batch : chunk)
+        queue.push_back(std::move(batch));
+    first = last;
+  }
+  return caf::none;
+}
+
+caf::error pipeline_executor::process_parallel(
+  const std::vector<std::pair<vast::type, std::vector<size_t>>>& work,
+  std::unordered_map<vast::type, std::deque<pipeline_batch>>& batches) {
+  // Share the workers among the layouts, and create the instances that every
+  // layout needs up front so that no two threads use the same operator.
+  const auto workers_per_layout
+    = std::max(workers_->size() / work.size(), size_t{1});
+  struct task {
+    std::vector<std::vector<pipeline>>* instances;
+    std::deque<pipeline_batch>* queue;
+  };
+  auto tasks = std::vector<task>{};
+  for (const auto& [layout, indices] : work) {
+    auto& instances = replicas_[layout];
+    auto& queue = batches[layout];
+    instances.resize(pipelines_.size());
+    for (auto idx : indices) {
+      const auto& pipeline = pipelines_[idx];
+      const auto num_instances
+        = pipeline.is_aggregate()
+            ? size_t{1}
+            : std::clamp(queue.size(), size_t{1}, workers_per_layout);
+      while (instances[idx].size() < num_instances) {
+        auto replica = pipeline.replicate();
+        if (!replica)
+          return std::move(replica.error());
+        if (flush_)
+          replica->flush();
+        instances[idx].push_back(std::move(*replica));
+      }
+    }
+    tasks.push_back({&instances, &queue});
+  }
+  auto errors = std::vector<caf::error>(work.size());
+  workers_->run(work.size(), [&](size_t i) {
+    errors[i]
+      = process_layout(*tasks[i].instances, work[i].second, *tasks[i].queue);
+  });
+  for (auto& error : errors)
+    if (error)
+      return std::move(error);
+  return caf::none;
+}
+
 const std::vector<pipeline>& pipeline_executor::pipelines() {
   return pipelines_;
 }
@@ -8,13 +8,87 @@
 
 #include "vast/pipeline_operator.hpp"
 
+#include "vast/bitmap_algorithms.hpp"
+#include "vast/detail/narrow.hpp"
 #include "vast/error.hpp"
 #include "vast/plugin.hpp"
+#include "vast/system/report.hpp"
 
+#include <arrow/array/builder_primitive.h>
+#include <arrow/compute/api.h>
 #include <fmt/format.h>
 
+#include <utility>
+
 namespace vast {
 
+caf::expected<std::optional<pipeline_batch>> apply_selection(fused_batch x) {
+  if (!x.batch)
+    return std::nullopt;
+  if (x.selection.empty())
+    return pipeline_batch{std::move(x.layout), std::move(x.batch)};
+  const auto num_rows = x.batch->num_rows();
+  const auto num_selected = rank(x.selection);
+  if (num_selected == 0)
+    return std::nullopt;
+  if (num_selected == detail::narrow_cast<uint64_t>(num_rows))
+    return pipeline_batch{std::move(x.layout), std::move(x.batch)};
+  auto mask_builder = arrow::BooleanBuilder{};
+  auto status = mask_builder.Reserve(num_rows);
+  auto next = int64_t{0};
+  for (auto id : select(x.selection)) {
+    const auto row = detail::narrow_cast<int64_t>(id);
+    if (status.ok() && row > next)
+      status = mask_builder.AppendValues(row - next, false);
+    if (status.ok())
+      status = mask_builder.Append(true);
+    next = row + 1;
+  }
+  if (status.ok() && num_rows > next)
+    status = mask_builder.AppendValues(num_rows - next, false);
+  if (!status.ok())
+    return caf::make_error(ec::system_error, status.ToString());
+  auto mask = mask_builder.Finish();
+  if (!mask.ok())
+    return caf::make_error(ec::system_error, mask.status().ToString());
+  auto filtered = arrow::compute::Filter(x.batch, *mask);
+  if (!filtered.ok())
+    return caf::make_error(ec::system_error, filtered.status().ToString());
+  return pipeline_batch{std::move(x.layout), filtered->record_batch()};
+}
+
+std::vector<system::data_point> pipeline_operator::metrics() const {
+  return {};
+}
+
+caf::error pipeline_operator::apply(fused_batch&) {
+  return caf::make_error(ec::unimplemented, "pipeline operator is not "
+                                            "stateless");
+}
+
+caf::error
+stateless_pipeline_operator::add(type layout,
+                                 std::shared_ptr<arrow::RecordBatch> batch) {
+  auto x = fused_batch{std::move(layout), std::move(batch)};
+  if (auto err = apply(x)) {
+    transformed_.clear();
+    return err;
+  }
+  auto selected = apply_selection(std::move(x));
+  if (!selected) {
+    transformed_.clear();
+    return std::move(selected.error());
+  }
+  if (*selected)
+    transformed_.push_back(std::move(**selected));
+  return caf::none;
+}
+
+caf::expected<std::vector<pipeline_batch>>
+stateless_pipeline_operator::finish() {
+  return std::exchange(transformed_, {});
+}
+
 // TODO: It would be more consistent with the rest of the code base to have a
 // `pipeline_operator_factory` to create the steps. All pipeline operators from
 // plugins would be registered at startup. However, that will require some more
@@ -37,4 +111,14 @@ make_pipeline_operator(const std::string& name, const vast::record& options) {
                          fmt::format("unknown pipeline operator '{}'", name));
 }
 
+caf::expected<std::unique_ptr<pipeline_operator>>
+make_partial_pipeline_operator(const std::string& name,
+                               const vast::record& options) {
+  const auto* plugin = plugins::find<pipeline_operator_plugin>(name);
+  if (!plugin)
+    return caf::make_error(ec::invalid_configuration,
+                           fmt::format("unknown pipeline operator '{}'", name));
+  return plugin->make_partial_pipeline_operator(options);
+}
+
 } // namespace vast
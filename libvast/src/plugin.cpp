@@ -20,6 +20,7 @@
 #include "vast/error.hpp"
 #include "vast/ids.hpp"
 #include "vast/logger.hpp"
+#include "vast/pipeline_operator.hpp"
 #include "vast/plugin.hpp"
 #include "vast/query_context.hpp"
 #include "vast/store.hpp"
@@ -347,6 +348,16 @@ system::component_plugin_actor analyzer_plugin::make_component(
   return analyzer(node);
 }
 
+// -- pipeline operator plugin -------------------------------------------------
+
+caf::expected<std::unique_ptr<pipeline_operator>>
+pipeline_operator_plugin::make_partial_pipeline_operator(const record&) const {
+  return caf::make_error(ec::unimplemented,
+                         fmt::format("pipeline operator '{}' does not support "
+                                     "partial aggregation",
+                                     name()));
+}
+
 // -- store plugin -------------------------------------------------------------
 
 caf::expected<store_actor_plugin::builder_and_header>
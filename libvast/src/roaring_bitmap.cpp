@@ -0,0 +1,762 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/roaring_bitmap.hpp"
+
+#include "vast/error.hpp"
+#include "vast/fbs/bitmap.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <iterator>
+
+namespace vast {
+
+namespace {
+
+using container = roaring_bitmap::container;
+using kind = container::kind;
+using block_type = roaring_bitmap::block_type;
+using word_type = roaring_bitmap::word_type;
+using block_vector = std::vector<block_type>;
+
+/// The end of the offsets within a container.
+constexpr auto chunk_end
+  = static_cast<uint32_t>(roaring_bitmap::container_bits);
+
+bool is_empty(const container& c) {
+  return c.values.empty() && c.blocks.empty();
+}
+
+size_t num_runs(const container& c) {
+  VAST_ASSERT(c.type == kind::run);
+  return c.values.size() / 2;
+}
+
+/// Locates the first run whose last position is not less than *x*.
+size_t find_run(const container& c, uint32_t x) {
+  auto lo = size_t{0};
+  auto hi = num_runs(c);
+  while (lo < hi) {
+    auto mid = lo + (hi - lo) / 2;
+    if (c.values[2 * mid + 1] < x)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+/// Computes a block with the bits in *[first,last]* set.
+block_type range_mask(uint32_t first, uint32_t last) {
+  VAST_ASSERT(first <= last && last < word_type::width);
+  return (word_type::all >> (word_type::width - 1 - last))
+         & (word_type::all << first);
+}
+
+void set_range(block_vector& blocks, uint32_t first, uint32_t last) {
+  auto first_block = first / word_type::width;
+  auto last_block = last / word_type::width;
+  if (first_block == last_block) {
+    blocks[first_block] |= range_mask(first % word_type::width,
+                                      last % word_type::width);
+    return;
+  }
+  blocks[first_block] |= word_type::all << (first % word_type::width);
+  for (auto i = first_block + 1; i < last_block; ++i)
+    blocks[i] = word_type::all;
+  blocks[last_block]
+    |= word_type::all >> (word_type::width - 1 - last % word_type::width);
+}
+
+/// Locates the first position not less than *x* whose value is *bit*.
+uint32_t find_next(const block_vector& blocks, uint32_t x, bool bit) {
+  auto i = x / word_type::width;
+  auto block = bit ? blocks[i] : ~blocks[i];
+  block &= word_type::all << (x % word_type::width);
+  while (block == 0) {
+    if (++i == blocks.size())
+      return chunk_end;
+    block = bit ? blocks[i] : ~blocks[i];
+  }
+  return i * word_type::width + word_type::count_trailing_zeros(block);
+}
+
+size_t cardinality(const container& c) {
+  switch (c.type) {
+    case kind::array:
+      return c.values.size();
+    case kind::bitset: {
+      auto result = size_t{0};
+      for (auto block : c.blocks)
+        result += word_type::popcount(block);
+      return result;
+    }
+    case kind::run: {
+      auto result = size_t{0};
+      for (size_t i = 0; i < c.values.size(); i += 2)
+        result += c.values[i + 1] - c.values[i] + 1;
+      return result;
+    }
+  }
+  __builtin_unreachable();
+}
+
+bool contains(const container& c, uint16_t x) {
+  switch (c.type) {
+    case kind::array:
+      return std::binary_search(c.values.begin(), c.values.end(), x);
+    case kind::bitset:
+      return word_type::test(c.blocks[x / word_type::width],
+                             x % word_type::width);
+    case kind::run: {
+      auto i = find_run(c, x);
+      return i < num_runs(c) && c.values[2 * i] <= x;
+    }
+  }
+  __builtin_unreachable();
+}
+
+block_vector to_blocks(const container& c) {
+  if (c.type == kind::bitset)
+    return c.blocks;
+  auto result = block_vector(roaring_bitmap::bitset_blocks);
+  if (c.type == kind::array) {
+    for (auto x : c.values)
+      result[x / word_type::width] |= word_type::mask(x % word_type::width);
+  } else {
+    for (size_t i = 0; i < c.values.size(); i += 2)
+      set_range(result, c.values[i], c.values[i + 1]);
+  }
+  return result;
+}
+
+/// Creates the smallest container for the given blocks.
+container make_container(uint64_t key, block_vector blocks) {
+  auto result = container{.key = key};
+  auto card = size_t{0};
+  auto runs = size_t{0};
+  auto carry = block_type{0};
+  for (auto block : blocks) {
+    card += word_type::popcount(block);
+    runs += word_type::popcount(block & ~((block << 1) | carry));
+    carry = block >> (word_type::width - 1);
+  }
+  if (card == 0)
+    return result;
+  const auto array_bytes = card * sizeof(uint16_t);
+  const auto bitset_bytes = blocks.size() * sizeof(block_type);
+  const auto run_bytes = runs * 2 * sizeof(uint16_t);
+  if (run_bytes < std::min(array_bytes, bitset_bytes)) {
+    result.type = kind::run;
+    result.values.reserve(runs * 2);
+    for (auto x = find_next(blocks, 0, true); x < chunk_end;) {
+      auto end = find_next(blocks, x, false);
+      result.values.push_back(static_cast<uint16_t>(x));
+      result.values.push_back(static_cast<uint16_t>(end - 1));
+      if (end == chunk_end)
+        break;
+      x = find_next(blocks, end, true);
+    }
+  } else if (card <= roaring_bitmap::max_array_size) {
+    result.type = kind::array;
+    result.values.reserve(card);
+    for (size_t i = 0; i < blocks.size(); ++i)
+      for (auto block = blocks[i]; block != 0; block &= block - 1)
+        result.values.push_back(static_cast<uint16_t>(
+          i * word_type::width + word_type::count_trailing_zeros(block)));
+  } else {
+    result.type = kind::bitset;
+    result.blocks = std::move(blocks);
+  }
+  return result;
+}
+
+void optimize(container& c) {
+  c = make_container(c.key, to_blocks(c));
+}
+
+/// Appends the range *[first,last]* after the last 1-bit of a container.
+void append_range(container& c, uint16_t first, uint16_t last) {
+  if (c.type == kind::array) {
+    if (first == last && c.values.size() < roaring_bitmap::max_array_size) {
+      c.values.push_back(first);
+      return;
+    }
+    if (first == last) {
+      c.blocks = to_blocks(c);
+      c.values.clear();
+      c.type = kind::bitset;
+    } else {
+      // Ranges are cheaper as runs.
+      auto runs = std::vector<uint16_t>{};
+      for (auto x : c.values) {
+        if (!runs.empty() && runs.back() + 1 == x)
+          runs.back() = x;
+        else
+          runs.insert(runs.end(), {x, x});
+      }
+      c.values = std::move(runs);
+      c.type = kind::run;
+    }
+  }
+  if (c.type == kind::run) {
+    if (!c.values.empty() && c.values.back() + 1 == first) {
+      c.values.back() = last;
+    } else {
+      c.values.push_back(first);
+      c.values.push_back(last);
+    }
+    // Beyond this many runs, a bitset takes less space.
+    if (c.values.size() > roaring_bitmap::max_array_size) {
+      c.blocks = to_blocks(c);
+      c.values.clear();
+      c.type = kind::bitset;
+    }
+    return;
+  }
+  set_range(c.blocks, first, last);
+}
+
+/// Locates the first position not less than *x* whose value is not *bit*.
+uint32_t run_end(const container& c, uint32_t x, bool bit) {
+  switch (c.type) {
+    case kind::array: {
+      auto it = std::lower_bound(c.values.begin(), c.values.end(), x);
+      if (!bit)
+        return it == c.values.end() ? chunk_end : *it;
+      if (it == c.values.end() || *it != x)
+        return x;
+      auto last = x;
+      while (++it != c.values.end() && *it == last + 1)
+        ++last;
+      return last + 1;
+    }
+    case kind::bitset:
+      return find_next(c.blocks, x, !bit);
+    case kind::run: {
+      auto i = find_run(c, x);
+      if (i == num_runs(c))
+        return bit ? x : chunk_end;
+      uint32_t first = c.values[2 * i];
+      uint32_t last = c.values[2 * i + 1];
+      if (bit)
+        return first <= x ? last + 1 : x;
+      return first <= x ? x : first;
+    }
+  }
+  __builtin_unreachable();
+}
+
+// -- container operations -----------------------------------------------------
+
+template <class Operation>
+container combine_blocks(const container& x, const container& y,
+                         Operation op) {
+  auto lhs = to_blocks(x);
+  const auto rhs = to_blocks(y);
+  for (size_t i = 0; i < lhs.size(); ++i)
+    lhs[i] = op(lhs[i], rhs[i]);
+  return make_container(x.key, std::move(lhs));
+}
+
+container filter(const container& array, const container& other,
+                 bool contained) {
+  VAST_ASSERT(array.type == kind::array);
+  auto result = container{.key = array.key};
+  for (auto x : array.values)
+    if (contains(other, x) == contained)
+      result.values.push_back(x);
+  return result;
+}
+
+template <class SetOperation>
+container combine_arrays(const container& x, const container& y,
+                         SetOperation op) {
+  auto result = container{.key = x.key};
+  op(x.values.begin(), x.values.end(), y.values.begin(), y.values.end(),
+     std::back_inserter(result.values));
+  if (result.values.size() > roaring_bitmap::max_array_size)
+    optimize(result);
+  return result;
+}
+
+container intersect(const container& x, const container& y) {
+  if (x.type == kind::array)
+    return filter(x, y, true);
+  if (y.type == kind::array)
+    return filter(y, x, true);
+  return combine_blocks(x, y, [](auto lhs, auto rhs) {
+    return lhs & rhs;
+  });
+}
+
+container unite(const container& x, const container& y) {
+  if (x.type == kind::array && y.type == kind::array)
+    return combine_arrays(x, y, [](auto... xs) {
+      return std::set_union(xs...);
+    });
+  return combine_blocks(x, y, [](auto lhs, auto rhs) {
+    return lhs | rhs;
+  });
+}
+
+container symmetric_difference(const container& x, const container& y) {
+  if (x.type == kind::array && y.type == kind::array)
+    return combine_arrays(x, y, [](auto... xs) {
+      return std::set_symmetric_difference(xs...);
+    });
+  return combine_blocks(x, y, [](auto lhs, auto rhs) {
+    return lhs ^ rhs;
+  });
+}
+
+container difference(const container& x, const container& y) {
+  if (x.type == kind::array)
+    return filter(x, y, false);
+  return combine_blocks(x, y, [](auto lhs, auto rhs) {
+    return lhs & ~rhs;
+  });
+}
+
+} // namespace
+
+roaring_bitmap::roaring_bitmap(size_type n, bool bit) {
+  append_bits(bit, n);
+}
+
+bool roaring_bitmap::empty() const {
+  return num_bits_ == 0;
+}
+
+roaring_bitmap::size_type roaring_bitmap::size() const {
+  return num_bits_;
+}
+
+size_t roaring_bitmap::memusage() const {
+  auto result = containers_.capacity() * sizeof(container);
+  for (const auto& c : containers_)
+    result += c.values.capacity() * sizeof(uint16_t)
+              + c.blocks.capacity() * sizeof(block_type);
+  return result;
+}
+
+const std::vector<roaring_bitmap::container>&
+roaring_bitmap::containers() const {
+  return containers_;
+}
+
+void roaring_bitmap::append_bit(bool bit) {
+  if (bit) {
+    auto offset = static_cast<uint16_t>(num_bits_ % container_bits);
+    append_range(container_for_append(num_bits_), offset, offset);
+  }
+  ++num_bits_;
+}
+
+void roaring_bitmap::append_bits(bool bit, size_type n) {
+  VAST_ASSERT(num_bits_ + n <= max_size);
+  if (!bit) {
+    num_bits_ += n;
+    return;
+  }
+  while (n > 0) {
+    auto offset = num_bits_ % container_bits;
+    auto length = std::min(n, container_bits - offset);
+    append_range(container_for_append(num_bits_),
+                 static_cast<uint16_t>(offset),
+                 static_cast<uint16_t>(offset + length - 1));
+    num_bits_ += length;
+    n -= length;
+  }
+}
+
+void roaring_bitmap::append_block(block_type bits, size_type n) {
+  VAST_ASSERT(n <= word_type::width);
+  if (n < word_type::width)
+    bits &= word_type::lsb_mask(n);
+  const auto start = num_bits_;
+  // Append the runs of 1-bits in the block.
+  while (bits != 0) {
+    auto first = word_type::count_trailing_zeros(bits);
+    auto rest = bits >> first;
+    auto length = rest == word_type::all
+                    ? word_type::width - first
+                    : word_type::count_trailing_zeros(~rest);
+    num_bits_ = start + first;
+    append_bits(true, length);
+    bits = first + length == word_type::width
+             ? 0
+             : bits & (word_type::all << (first + length));
+  }
+  num_bits_ = start + n;
+}
+
+void roaring_bitmap::flip() {
+  auto result = std::vector<container>{};
+  auto num_chunks = (num_bits_ + container_bits - 1) / container_bits;
+  result.reserve(num_chunks);
+  auto i = size_t{0};
+  for (size_type key = 0; key < num_chunks; ++key) {
+    auto limit = std::min(container_bits, num_bits_ - key * container_bits);
+    if (i < containers_.size() && containers_[i].key == key) {
+      auto blocks = to_blocks(containers_[i++]);
+      for (auto& block : blocks)
+        block = ~block;
+      // Clear the bits beyond the end of the bitmap.
+      auto last = limit / word_type::width;
+      if (limit % word_type::width != 0)
+        blocks[last++] &= word_type::lsb_mask(limit % word_type::width);
+      std::fill(blocks.begin() + last, blocks.end(), 0);
+      auto c = make_container(key, std::move(blocks));
+      if (!is_empty(c))
+        result.push_back(std::move(c));
+    } else {
+      result.push_back({
+        .key = key,
+        .type = kind::run,
+        .values = {0, static_cast<uint16_t>(limit - 1)},
+      });
+    }
+  }
+  containers_ = std::move(result);
+}
+
+template <class Operation>
+roaring_bitmap
+roaring_bitmap::merge(const roaring_bitmap& x, const roaring_bitmap& y,
+                      bool keep_x, bool keep_y, Operation op) {
+  auto result = roaring_bitmap{};
+  result.num_bits_ = std::max(x.num_bits_, y.num_bits_);
+  auto i = x.containers_.begin();
+  auto j = y.containers_.begin();
+  while (i != x.containers_.end() && j != y.containers_.end()) {
+    if (i->key < j->key) {
+      if (keep_x)
+        result.containers_.push_back(*i);
+      ++i;
+    } else if (j->key < i->key) {
+      if (keep_y)
+        result.containers_.push_back(*j);
+      ++j;
+    } else {
+      auto c = op(*i++, *j++);
+      if (!is_empty(c))
+        result.containers_.push_back(std::move(c));
+    }
+  }
+  if (keep_x)
+    result.containers_.insert(result.containers_.end(), i,
+                              x.containers_.end());
+  if (keep_y)
+    result.containers_.insert(result.containers_.end(), j,
+                              y.containers_.end());
+  return result;
+}
+
+roaring_bitmap operator&(const roaring_bitmap& x, const roaring_bitmap& y) {
+  return roaring_bitmap::merge(x, y, false, false, intersect);
+}
+
+roaring_bitmap operator|(const roaring_bitmap& x, const roaring_bitmap& y) {
+  return roaring_bitmap::merge(x, y, true, true, unite);
+}
+
+roaring_bitmap operator^(const roaring_bitmap& x, const roaring_bitmap& y) {
+  return roaring_bitmap::merge(x, y, true, true, symmetric_difference);
+}
+
+roaring_bitmap operator-(const roaring_bitmap& x, const roaring_bitmap& y) {
+  return roaring_bitmap::merge(x, y, true, false, difference);
+}
+
+roaring_bitmap& roaring_bitmap::operator&=(const roaring_bitmap& other) {
+  return *this = *this & other;
+}
+
+roaring_bitmap& roaring_bitmap::operator|=(const roaring_bitmap& other) {
+  return *this = *this | other;
+}
+
+roaring_bitmap& roaring_bitmap::operator^=(const roaring_bitmap& other) {
+  return *this = *this ^ other;
+}
+
+roaring_bitmap& roaring_bitmap::operator-=(const roaring_bitmap& other) {
+  return *this = *this - other;
+}
+
+bool operator==(const roaring_bitmap& x, const roaring_bitmap& y) {
+  if (x.num_bits_ != y.num_bits_ || x.containers_.size() != y.containers_.size())
+    return false;
+  for (size_t i = 0; i < x.containers_.size(); ++i) {
+    const auto& lhs = x.containers_[i];
+    const auto& rhs = y.containers_[i];
+    if (lhs.key != rhs.key)
+      return false;
+    // The same bits may have different representations.
+    if (lhs.type == rhs.type) {
+      if (lhs.values != rhs.values || lhs.blocks != rhs.blocks)
+        return false;
+    } else if (to_blocks(lhs) != to_blocks(rhs)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto pack(flatbuffers::FlatBufferBuilder& builder, const roaring_bitmap& from)
+  -> flatbuffers::Offset<fbs::bitmap::RoaringBitmap> {
+  auto container_offsets = std::vector<
+    flatbuffers::Offset<fbs::bitmap::detail::RoaringContainer>>{};
+  container_offsets.reserve(from.containers_.size());
+  for (const auto& c : from.containers_)
+    container_offsets.emplace_back(
+      fbs::bitmap::detail::CreateRoaringContainerDirect(
+        builder, c.key, static_cast<uint8_t>(c.type), &c.values, &c.blocks));
+  return fbs::bitmap::CreateRoaringBitmapDirect(builder, &container_offsets,
+                                                from.num_bits_);
+}
+
+auto unpack(const fbs::bitmap::RoaringBitmap& from, roaring_bitmap& to)
+  -> caf::error {
+  to.containers_.clear();
+  to.containers_.reserve(from.containers()->size());
+  to.num_bits_ = from.num_bits();
+  for (const auto* from_container : *from.containers()) {
+    auto& c = to.containers_.emplace_back();
+    c.key = from_container->key();
+    if (from_container->kind() > static_cast<uint8_t>(kind::run))
+      return caf::make_error(ec::format_error,
+                             fmt::format("invalid roaring container kind {}",
+                                         from_container->kind()));
+    c.type = static_cast<kind>(from_container->kind());
+    if (const auto* values = from_container->values())
+      c.values.assign(values->begin(), values->end());
+    if (const auto* blocks = from_container->blocks())
+      c.blocks.assign(blocks->begin(), blocks->end());
+    if ((c.type == kind::bitset) != (c.blocks.size() == bitset_blocks)
+        || (c.type == kind::run && c.values.size() % 2 != 0)
+        || is_empty(c))
+      return caf::make_error(ec::format_error, "invalid roaring container");
+    if (to.containers_.size() > 1
+        && (to.containers_.end() - 2)->key >= c.key)
+      return caf::make_error(ec::format_error,
+                             "roaring containers are not sorted");
+  }
+  return caf::none;
+}
+
+roaring_bitmap::size_type roaring_bitmap::rank1(size_type i) const {
+  VAST_ASSERT(i < num_bits_);
+  const auto key = i / container_bits;
+  const auto offset = static_cast<uint32_t>(i % container_bits);
+  auto result = size_type{0};
+  for (const auto& c : containers_) {
+    if (c.key < key) {
+      result += cardinality(c);
+      continue;
+    }
+    if (c.key > key)
+      break;
+    switch (c.type) {
+      case container::kind::array:
+        result += std::upper_bound(c.values.begin(), c.values.end(), offset)
+                  - c.values.begin();
+        break;
+      case container::kind::bitset: {
+        const auto last = offset / word_type::width;
+        for (size_t j = 0; j < last; ++j)
+          result += word_type::popcount(c.blocks[j]);
+        result += word_type::popcount(
+          c.blocks[last] & range_mask(0, offset % word_type::width));
+        break;
+      }
+      case container::kind::run:
+        for (size_t j = 0; j < c.values.size() && c.values[j] <= offset;
+             j += 2)
+          result += std::min<uint32_t>(c.values[j + 1], offset) - c.values[j]
+                    + 1;
+        break;
+    }
+    break;
+  }
+  return result;
+}
+
+roaring_bitmap::size_type roaring_bitmap::select1(size_type i) const {
+  VAST_ASSERT(i > 0);
+  if (i == word_type::npos) {
+    if (containers_.empty())
+      return word_type::npos;
+    const auto& c = containers_.back();
+    auto last = size_type{0};
+    switch (c.type) {
+      case container::kind::array:
+      case container::kind::run:
+        last = c.values.back();
+        break;
+      case container::kind::bitset: {
+        auto j = c.blocks.size() - 1;
+        while (c.blocks[j] == 0)
+          --j;
+        last = j * word_type::width + word_type::width - 1
+               - word_type::count_leading_zeros(c.blocks[j]);
+        break;
+      }
+    }
+    return c.key * container_bits + last;
+  }
+  for (const auto& c : containers_) {
+    auto card = cardinality(c);
+    if (i > card) {
+      i -= card;
+      continue;
+    }
+    const auto base = c.key * container_bits;
+    switch (c.type) {
+      case container::kind::array:
+        return base + c.values[i - 1];
+      case container::kind::run:
+        for (size_t j = 0;; j += 2) {
+          size_type length = c.values[j + 1] - c.values[j] + 1;
+          if (i <= length)
+            return base + c.values[j] + i - 1;
+          i -= length;
+        }
+      case container::kind::bitset:
+        for (size_t j = 0;; ++j) {
+          auto block = c.blocks[j];
+          auto count = word_type::popcount(block);
+          if (i > count) {
+            i -= count;
+            continue;
+          }
+          while (--i > 0)
+            block &= block - 1;
+          return base + j * word_type::width
+                 + word_type::count_trailing_zeros(block);
+        }
+    }
+  }
+  return word_type::npos;
+}
+
+roaring_bitmap::container& roaring_bitmap::container_for_append(size_type i) {
+  const auto key = i / container_bits;
+  if (containers_.empty() || containers_.back().key != key) {
+    // The previous container is complete, so we can settle its
+    // representation.
+    if (!containers_.empty())
+      optimize(containers_.back());
+    containers_.push_back({.key = key});
+  }
+  return containers_.back();
+}
+
+roaring_bitmap::block_type
+roaring_bitmap::block_at(size_type i, size_t& hint) const {
+  VAST_ASSERT(i % word_type::width == 0);
+  const auto key = i / container_bits;
+  while (hint < containers_.size() && containers_[hint].key < key)
+    ++hint;
+  if (hint == containers_.size() || containers_[hint].key != key)
+    return 0;
+  const auto& c = containers_[hint];
+  const auto offset = static_cast<uint32_t>(i % container_bits);
+  auto result = block_type{0};
+  switch (c.type) {
+    case container::kind::array: {
+      auto it = std::lower_bound(c.values.begin(), c.values.end(), offset);
+      for (; it != c.values.end() && *it < offset + word_type::width; ++it)
+        result |= word_type::mask(*it - offset);
+      break;
+    }
+    case container::kind::bitset:
+      result = c.blocks[offset / word_type::width];
+      break;
+    case container::kind::run:
+      for (auto j = find_run(c, offset);
+           j < num_runs(c) && c.values[2 * j] < offset + word_type::width;
+           ++j) {
+        auto first = std::max<uint32_t>(c.values[2 * j], offset);
+        auto last = std::min<uint32_t>(c.values[2 * j + 1],
+                                       offset + word_type::width - 1);
+        result |= range_mask(first - offset, last - offset);
+      }
+      break;
+  }
+  return result;
+}
+
+roaring_bitmap::size_type
+roaring_bitmap::homogeneous_end(size_type i, bool bit, size_t hint) const {
+  auto pos = i;
+  while (pos < num_bits_) {
+    const auto key = pos / container_bits;
+    while (hint < containers_.size() && containers_[hint].key < key)
+      ++hint;
+    if (hint == containers_.size() || containers_[hint].key != key) {
+      // Chunks without a container consist of 0-bits only.
+      if (bit)
+        return pos;
+      pos = hint == containers_.size() ? num_bits_
+                                       : containers_[hint].key * container_bits;
+      continue;
+    }
+    const auto offset = static_cast<uint32_t>(pos % container_bits);
+    const auto end = run_end(containers_[hint], offset, bit);
+    pos = key * container_bits + end;
+    if (end < container_bits)
+      break;
+  }
+  return std::min(pos, num_bits_);
+}
+
+roaring_bitmap_range::roaring_bitmap_range(const roaring_bitmap& bm)
+  : bm_{&bm} {
+  if (!bm.empty())
+    scan();
+}
+
+void roaring_bitmap_range::next() {
+  pos_ += bits_.size();
+  if (!done())
+    scan();
+}
+
+bool roaring_bitmap_range::done() const {
+  return bm_ == nullptr || pos_ >= bm_->num_bits_;
+}
+
+void roaring_bitmap_range::scan() {
+  const auto remaining = bm_->num_bits_ - pos_;
+  const auto block = bm_->block_at(pos_, hint_);
+  if (remaining < word_type::width) {
+    bits_ = {block, remaining};
+    return;
+  }
+  if (!word_type::all_or_none(block)) {
+    bits_ = {block, word_type::width};
+    return;
+  }
+  // Merge homogeneous blocks into a single run.
+  const auto end = bm_->homogeneous_end(pos_, block != 0, hint_);
+  auto length = end - pos_;
+  if (end < bm_->num_bits_)
+    length -= length % word_type::width;
+  VAST_ASSERT(length >= word_type::width);
+  bits_ = {block, length};
+}
+
+roaring_bitmap_range bit_range(const roaring_bitmap& bm) {
+  return roaring_bitmap_range{bm};
+}
+
+} // namespace vast
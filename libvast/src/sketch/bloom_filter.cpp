@@ -27,6 +27,11 @@ bool frozen_bloom_filter::lookup(uint64_t digest) const noexcept {
   return view_.lookup(digest);
 }
 
+bool frozen_bloom_filter::lookup_any(
+  std::span<const uint64_t> digests) const noexcept {
+  return view_.lookup_any(digests);
+}
+
 const bloom_filter_params& frozen_bloom_filter::parameters() const noexcept {
   return view_.parameters();
 }
@@ -54,6 +59,11 @@ bool bloom_filter::lookup(uint64_t digest) const noexcept {
   return view_.lookup(digest);
 }
 
+bool bloom_filter::lookup_any(
+  std::span<const uint64_t> digests) const noexcept {
+  return view_.lookup_any(digests);
+}
+
 const bloom_filter_params& bloom_filter::parameters() const noexcept {
   return view_.parameters();
 }
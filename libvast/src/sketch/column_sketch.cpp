@@ -0,0 +1,166 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/sketch/column_sketch.hpp"
+
+#include "vast/arrow_table_slice.hpp"
+#include "vast/error.hpp"
+#include "vast/fbs/sketch.hpp"
+#include "vast/hash/hash.hpp"
+
+#include <arrow/array.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace vast::sketch {
+
+caf::expected<column_sketch>
+column_sketch::make(const column_sketch_config& cfg) {
+  auto distinct = hyperloglog::make(cfg.precision);
+  if (!distinct)
+    return std::move(distinct.error());
+  auto frequencies = count_min::make(cfg.width, cfg.depth);
+  if (!frequencies)
+    return std::move(frequencies.error());
+  auto result = column_sketch{};
+  result.distinct_ = std::move(*distinct);
+  result.frequencies_ = std::move(*frequencies);
+  result.max_heavy_hitters_ = cfg.heavy_hitters;
+  result.heavy_hitters_.reserve(cfg.heavy_hitters);
+  return result;
+}
+
+void column_sketch::add(data_view x) {
+  auto digest = hash(x);
+  distinct_.add(digest);
+  frequencies_.add(digest);
+  update_heavy_hitters(x, frequencies_.estimate(digest));
+}
+
+void column_sketch::add(const type& t, const arrow::Array& array) {
+  for (auto&& x : values(t, array))
+    if (!caf::holds_alternative<caf::none_t>(x))
+      add(x);
+}
+
+uint64_t column_sketch::distinct() const noexcept {
+  return static_cast<uint64_t>(std::llround(distinct_.estimate()));
+}
+
+uint64_t column_sketch::frequency(data_view x) const noexcept {
+  return frequencies_.estimate(hash(x));
+}
+
+std::vector<column_sketch::heavy_hitter> column_sketch::top(size_t k) const {
+  auto result = heavy_hitters_;
+  std::sort(result.begin(), result.end(),
+            [](const heavy_hitter& lhs, const heavy_hitter& rhs) {
+              if (lhs.second != rhs.second)
+                return lhs.second > rhs.second;
+              return lhs.first < rhs.first;
+            });
+  if (result.size() > k)
+    result.resize(k);
+  return result;
+}
+
+caf::error column_sketch::merge(const column_sketch& other) {
+  if (auto err = distinct_.merge(other.distinct_))
+    return err;
+  if (auto err = frequencies_.merge(other.frequencies_))
+    return err;
+  // The merged frequencies supersede the estimates of both sides.
+  for (auto& [value, count] : heavy_hitters_)
+    count = frequencies_.estimate(hash(make_view(value)));
+  for (const auto& [value, _] : other.heavy_hitters_) {
+    auto x = make_view(value);
+    update_heavy_hitters(x, frequencies_.estimate(hash(x)));
+  }
+  return caf::none;
+}
+
+void column_sketch::update_heavy_hitters(data_view x, uint64_t count) {
+  if (max_heavy_hitters_ == 0)
+    return;
+  auto it = std::find_if(heavy_hitters_.begin(), heavy_hitters_.end(),
+                         [&](const heavy_hitter& hh) {
+                           return is_equal(hh.first, x);
+                         });
+  if (it != heavy_hitters_.end()) {
+    it->second = count;
+    return;
+  }
+  if (heavy_hitters_.size() < max_heavy_hitters_) {
+    heavy_hitters_.emplace_back(materialize(x), count);
+    return;
+  }
+  auto min = std::min_element(heavy_hitters_.begin(), heavy_hitters_.end(),
+                              [](const heavy_hitter& lhs,
+                                 const heavy_hitter& rhs) {
+                                return lhs.second < rhs.second;
+                              });
+  if (min->second < count)
+    *min = {materialize(x), count};
+}
+
+bool operator==(const column_sketch& x, const column_sketch& y) noexcept {
+  return x.distinct_ == y.distinct_ && x.frequencies_ == y.frequencies_
+         && x.max_heavy_hitters_ == y.max_heavy_hitters_
+         && x.heavy_hitters_ == y.heavy_hitters_;
+}
+
+size_t mem_usage(const column_sketch& x) noexcept {
+  return mem_usage(x.distinct_) + mem_usage(x.frequencies_)
+         + x.heavy_hitters_.capacity() * sizeof(column_sketch::heavy_hitter);
+}
+
+flatbuffers::Offset<fbs::sketch::ColumnSketch>
+pack(flatbuffers::FlatBufferBuilder& builder, const column_sketch& x) {
+  auto distinct_offset = pack(builder, x.distinct_);
+  auto frequencies_offset = pack(builder, x.frequencies_);
+  auto heavy_hitter_offsets
+    = std::vector<flatbuffers::Offset<fbs::sketch::HeavyHitter>>{};
+  heavy_hitter_offsets.reserve(x.heavy_hitters_.size());
+  for (const auto& [value, count] : x.heavy_hitters_) {
+    auto value_offset = pack(builder, value);
+    heavy_hitter_offsets.push_back(
+      fbs::sketch::CreateHeavyHitter(builder, value_offset, count));
+  }
+  auto heavy_hitters_offset = builder.CreateVector(heavy_hitter_offsets);
+  return fbs::sketch::CreateColumnSketch(builder, distinct_offset,
+                                         frequencies_offset,
+                                         heavy_hitters_offset,
+                                         x.max_heavy_hitters_);
+}
+
+caf::error unpack(const fbs::sketch::ColumnSketch& table, column_sketch& x) {
+  auto result = column_sketch{};
+  if (auto err = unpack(*table.distinct(), result.distinct_))
+    return err;
+  if (auto err = unpack(*table.frequencies(), result.frequencies_))
+    return err;
+  result.max_heavy_hitters_ = table.max_heavy_hitters();
+  if (const auto* heavy_hitters = table.heavy_hitters()) {
+    if (heavy_hitters->size() > result.max_heavy_hitters_)
+      return caf::make_error(ec::format_error, "column sketch has more heavy "
+                                               "hitters than it may track");
+    result.heavy_hitters_.reserve(heavy_hitters->size());
+    for (const auto* heavy_hitter : *heavy_hitters) {
+      auto value = data{};
+      if (auto err = unpack(*heavy_hitter->value(), value))
+        return err;
+      result.heavy_hitters_.emplace_back(std::move(value),
+                                         heavy_hitter->count());
+    }
+  }
+  x = std::move(result);
+  return caf::none;
+}
+
+} // namespace vast::sketch
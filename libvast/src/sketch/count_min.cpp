@@ -0,0 +1,122 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/sketch/count_min.hpp"
+
+#include "vast/detail/worm.hpp"
+#include "vast/error.hpp"
+#include "vast/fbs/sketch.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace vast::sketch {
+
+namespace {
+
+/// Adds to a counter without overflowing.
+uint32_t saturating_add(uint32_t x, uint32_t y) {
+  auto result = x + y;
+  return result < x ? std::numeric_limits<uint32_t>::max() : result;
+}
+
+} // namespace
+
+caf::expected<count_min> count_min::make(uint64_t width, uint64_t depth) {
+  if (width > 1 && (width & 1) == 0)
+    --width;
+  if (width == 0 || depth == 0)
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("invalid Count-Min dimensions {}x{}",
+                                       width, depth));
+  auto result = count_min{};
+  result.width_ = width;
+  result.depth_ = depth;
+  result.counters_.resize(width * depth);
+  return result;
+}
+
+void count_min::add(uint64_t digest, uint32_t n) noexcept {
+  for (uint64_t row = 0; row < depth_; ++row) {
+    auto column = detail::worm64(width_, digest);
+    auto& counter = counters_[row * width_ + column];
+    counter = saturating_add(counter, n);
+  }
+}
+
+uint64_t count_min::estimate(uint64_t digest) const noexcept {
+  auto result = std::numeric_limits<uint64_t>::max();
+  for (uint64_t row = 0; row < depth_; ++row) {
+    auto column = detail::worm64(width_, digest);
+    result = std::min(result, uint64_t{counters_[row * width_ + column]});
+  }
+  return depth_ > 0 ? result : 0;
+}
+
+caf::error count_min::merge(const count_min& other) {
+  if (width_ != other.width_ || depth_ != other.depth_)
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("cannot merge Count-Min sketches with "
+                                       "dimensions {}x{} and {}x{}",
+                                       width_, depth_, other.width_,
+                                       other.depth_));
+  for (size_t i = 0; i < counters_.size(); ++i)
+    counters_[i] = saturating_add(counters_[i], other.counters_[i]);
+  return caf::none;
+}
+
+uint64_t count_min::width() const noexcept {
+  return width_;
+}
+
+uint64_t count_min::depth() const noexcept {
+  return depth_;
+}
+
+bool operator==(const count_min& x, const count_min& y) noexcept {
+  return x.width_ == y.width_ && x.depth_ == y.depth_
+         && x.counters_ == y.counters_;
+}
+
+size_t mem_usage(const count_min& x) noexcept {
+  return sizeof(x) + x.counters_.capacity() * sizeof(uint32_t);
+}
+
+flatbuffers::Offset<fbs::sketch::CountMin>
+pack(flatbuffers::FlatBufferBuilder& builder, const count_min& x) {
+  auto counters_offset = builder.CreateVector(x.counters_);
+  return fbs::sketch::CreateCountMin(builder, x.width_, x.depth_,
+                                     counters_offset);
+}
+
+caf::error unpack(const fbs::sketch::CountMin& table, count_min& x) {
+  const auto* counters = table.counters();
+  // Check the size first so that invalid input cannot trigger a huge
+  // allocation.
+  if (table.depth() == 0 || counters->size() / table.depth() != table.width()
+      || counters->size() % table.depth() != 0)
+    return caf::make_error(ec::format_error,
+                           fmt::format("Count-Min sketch with dimensions {}x{} "
+                                       "has {} counters",
+                                       table.width(), table.depth(),
+                                       counters->size()));
+  auto result = count_min::make(table.width(), table.depth());
+  if (!result)
+    return std::move(result.error());
+  if (result->width_ != table.width())
+    return caf::make_error(ec::format_error,
+                           fmt::format("Count-Min sketch with even width {}",
+                                       table.width()));
+  std::copy(counters->begin(), counters->end(), result->counters_.begin());
+  x = std::move(*result);
+  return caf::none;
+}
+
+} // namespace vast::sketch
@@ -0,0 +1,139 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/sketch/hyperloglog.hpp"
+
+#include "vast/error.hpp"
+#include "vast/fbs/sketch.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace vast::sketch {
+
+caf::expected<hyperloglog> hyperloglog::make(uint8_t precision) {
+  if (precision < min_precision || precision > max_precision)
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("HyperLogLog precision must be in "
+                                       "[{}, {}], got {}",
+                                       min_precision, max_precision,
+                                       precision));
+  auto result = hyperloglog{};
+  result.precision_ = precision;
+  result.registers_.resize(size_t{1} << precision);
+  return result;
+}
+
+caf::expected<hyperloglog>
+hyperloglog::make(std::span<const uint8_t> registers) {
+  if (!std::has_single_bit(registers.size()))
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("HyperLogLog must have a power of two "
+                                       "registers, got {}",
+                                       registers.size()));
+  auto result
+    = make(static_cast<uint8_t>(std::countr_zero(registers.size())));
+  if (!result)
+    return result;
+  std::copy(registers.begin(), registers.end(), result->registers_.begin());
+  return result;
+}
+
+void hyperloglog::add(uint64_t digest) noexcept {
+  auto index = digest >> (64 - precision_);
+  // The sentinel bit bounds the rank if all remaining bits are zero.
+  auto rest = (digest << precision_) | (uint64_t{1} << (precision_ - 1));
+  auto rank = static_cast<uint8_t>(std::countl_zero(rest) + 1);
+  auto& reg = registers_[index];
+  reg = std::max(reg, rank);
+}
+
+double hyperloglog::estimate() const noexcept {
+  const auto m = static_cast<double>(registers_.size());
+  auto alpha = [&] {
+    switch (precision_) {
+      case 4:
+        return 0.673;
+      case 5:
+        return 0.697;
+      case 6:
+        return 0.709;
+      default:
+        return 0.7213 / (1.0 + 1.079 / m);
+    }
+  }();
+  auto sum = 0.0;
+  auto zeros = size_t{0};
+  for (auto reg : registers_) {
+    sum += std::ldexp(1.0, -reg);
+    zeros += reg == 0;
+  }
+  auto raw = alpha * m * m / sum;
+  // Fall back to linear counting for small cardinalities, where the raw
+  // estimate is heavily biased. With 64-bit digests, there is no need for a
+  // large-range correction.
+  if (raw <= 2.5 * m && zeros > 0)
+    return m * std::log(m / static_cast<double>(zeros));
+  return raw;
+}
+
+caf::error hyperloglog::merge(const hyperloglog& other) {
+  if (precision_ != other.precision_)
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("cannot merge HyperLogLog sketches with "
+                                       "precisions {} and {}",
+                                       precision_, other.precision_));
+  for (size_t i = 0; i < registers_.size(); ++i)
+    registers_[i] = std::max(registers_[i], other.registers_[i]);
+  return caf::none;
+}
+
+uint8_t hyperloglog::precision() const noexcept {
+  return precision_;
+}
+
+std::span<const uint8_t> hyperloglog::registers() const noexcept {
+  return registers_;
+}
+
+bool operator==(const hyperloglog& x, const hyperloglog& y) noexcept {
+  return x.precision_ == y.precision_ && x.registers_ == y.registers_;
+}
+
+size_t mem_usage(const hyperloglog& x) noexcept {
+  return sizeof(x) + x.registers_.capacity();
+}
+
+flatbuffers::Offset<fbs::sketch::HyperLogLog>
+pack(flatbuffers::FlatBufferBuilder& builder, const hyperloglog& x) {
+  auto registers_offset = builder.CreateVector(x.registers_);
+  return fbs::sketch::CreateHyperLogLog(builder, x.precision_,
+                                        registers_offset);
+}
+
+caf::error unpack(const fbs::sketch::HyperLogLog& table, hyperloglog& x) {
+  auto result = hyperloglog::make(table.precision());
+  if (!result)
+    return std::move(result.error());
+  const auto* registers = table.registers();
+  if (registers->size() != result->registers_.size())
+    return caf::make_error(ec::format_error,
+                           fmt::format("HyperLogLog with precision {} must "
+                                       "have {} registers, got {}",
+                                       table.precision(),
+                                       result->registers_.size(),
+                                       registers->size()));
+  std::copy(registers->begin(), registers->end(), result->registers_.begin());
+  x = std::move(*result);
+  return caf::none;
+}
+
+} // namespace vast::sketch
@@ -0,0 +1,193 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/sketch/space_saving.hpp"
+
+#include "vast/error.hpp"
+#include "vast/hash/hash.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+
+namespace vast::sketch {
+
+caf::expected<space_saving> space_saving::make(size_t capacity) {
+  if (capacity == 0)
+    return caf::make_error(ec::invalid_argument,
+                           "SpaceSaving capacity must be positive");
+  auto result = space_saving{};
+  result.capacity_ = capacity;
+  result.heap_.reserve(capacity);
+  return result;
+}
+
+caf::expected<space_saving>
+space_saving::make(size_t capacity, std::vector<counter> counters) {
+  auto result = make(capacity);
+  if (!result)
+    return result;
+  if (counters.size() > capacity)
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("SpaceSaving with capacity {} cannot "
+                                       "hold {} counters",
+                                       capacity, counters.size()));
+  for (auto& x : counters) {
+    if (x.error > x.count)
+      return caf::make_error(ec::invalid_argument,
+                             fmt::format("SpaceSaving counter error {} exceeds "
+                                         "its count {}",
+                                         x.error, x.count));
+    const auto digest = hash(make_view(x.value));
+    if (!result->positions_.emplace(digest, result->heap_.size()).second)
+      return caf::make_error(ec::invalid_argument,
+                             "SpaceSaving counters must be distinct");
+    result->heap_.push_back({digest, std::move(x)});
+  }
+  result->rebuild();
+  return result;
+}
+
+void space_saving::add(data_view x, uint64_t weight) {
+  const auto digest = hash(x);
+  if (auto it = positions_.find(digest); it != positions_.end()) {
+    const auto i = it->second;
+    heap_[i].counter.count += weight;
+    sift_down(i);
+    return;
+  }
+  if (heap_.size() < capacity_) {
+    heap_.push_back({digest, {materialize(x), weight, 0}});
+    positions_[digest] = heap_.size() - 1;
+    sift_up(heap_.size() - 1);
+    return;
+  }
+  // Take over the counter with the smallest count.
+  const auto error = heap_.front().counter.count;
+  positions_.erase(heap_.front().digest);
+  place(0, {digest, {materialize(x), error + weight, error}});
+  sift_down(0);
+}
+
+std::vector<space_saving::counter> space_saving::top(size_t k) const {
+  auto result = std::vector<counter>{};
+  result.reserve(heap_.size());
+  for (const auto& x : heap_)
+    result.push_back(x.counter);
+  std::sort(result.begin(), result.end(),
+            [](const counter& lhs, const counter& rhs) {
+              if (lhs.count != rhs.count)
+                return lhs.count > rhs.count;
+              return lhs.value < rhs.value;
+            });
+  if (result.size() > k)
+    result.resize(k);
+  return result;
+}
+
+caf::error space_saving::merge(const space_saving& other) {
+  if (capacity_ != other.capacity_)
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("cannot merge SpaceSaving sketches with "
+                                       "capacities {} and {}",
+                                       capacity_, other.capacity_));
+  // A value that lacks a counter in one of the sketches occurred at most as
+  // often as the smallest counter of that sketch.
+  const auto own_threshold = threshold();
+  const auto other_threshold = other.threshold();
+  auto merged = std::vector<entry>{};
+  merged.reserve(heap_.size() + other.heap_.size());
+  for (auto& x : heap_) {
+    if (auto it = other.positions_.find(x.digest);
+        it != other.positions_.end()) {
+      const auto& y = other.heap_[it->second].counter;
+      x.counter.count += y.count;
+      x.counter.error += y.error;
+    } else {
+      x.counter.count += other_threshold;
+      x.counter.error += other_threshold;
+    }
+    merged.push_back(std::move(x));
+  }
+  for (const auto& y : other.heap_) {
+    if (positions_.contains(y.digest))
+      continue;
+    auto& x = merged.emplace_back(y);
+    x.counter.count += own_threshold;
+    x.counter.error += own_threshold;
+  }
+  if (merged.size() > capacity_) {
+    std::nth_element(merged.begin(), merged.begin() + capacity_, merged.end(),
+                     [](const entry& lhs, const entry& rhs) {
+                       return lhs.counter.count > rhs.counter.count;
+                     });
+    merged.resize(capacity_);
+  }
+  heap_ = std::move(merged);
+  rebuild();
+  return caf::none;
+}
+
+size_t space_saving::capacity() const noexcept {
+  return capacity_;
+}
+
+uint64_t space_saving::threshold() const noexcept {
+  if (heap_.size() < capacity_)
+    return 0;
+  return heap_.front().counter.count;
+}
+
+void space_saving::sift_down(size_t i) {
+  auto x = std::move(heap_[i]);
+  while (true) {
+    auto child = 2 * i + 1;
+    if (child >= heap_.size())
+      break;
+    if (child + 1 < heap_.size()
+        && heap_[child + 1].counter.count < heap_[child].counter.count)
+      ++child;
+    if (heap_[child].counter.count >= x.counter.count)
+      break;
+    place(i, std::move(heap_[child]));
+    i = child;
+  }
+  place(i, std::move(x));
+}
+
+void space_saving::sift_up(size_t i) {
+  auto x = std::move(heap_[i]);
+  while (i > 0) {
+    const auto parent = (i - 1) / 2;
+    if (heap_[parent].counter.count <= x.counter.count)
+      break;
+    place(i, std::move(heap_[parent]));
+    i = parent;
+  }
+  place(i, std::move(x));
+}
+
+void space_saving::place(size_t i, entry x) {
+  positions_[x.digest] = i;
+  heap_[i] = std::move(x);
+}
+
+void space_saving::rebuild() {
+  positions_.clear();
+  for (size_t i = 0; i < heap_.size(); ++i)
+    positions_[heap_[i].digest] = i;
+  for (auto i = heap_.size() / 2; i > 0; --i)
+    sift_down(i - 1);
+}
+
+size_t mem_usage(const space_saving& x) noexcept {
+  return sizeof(x) + x.heap_.capacity() * sizeof(space_saving::entry)
+         + x.positions_.bucket_count() * sizeof(std::pair<uint64_t, size_t>);
+}
+
+} // namespace vast::sketch
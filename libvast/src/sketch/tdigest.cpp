@@ -0,0 +1,187 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/sketch/tdigest.hpp"
+
+#include "vast/detail/assert.hpp"
+#include "vast/error.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace vast::sketch {
+
+namespace {
+
+/// The number of buffered values per unit of compression that triggers a
+/// compression.
+constexpr auto buffer_factor = size_t{4};
+
+} // namespace
+
+tdigest::tdigest(double compression) noexcept : compression_{compression} {
+  VAST_ASSERT(compression > 0.0);
+}
+
+caf::expected<tdigest>
+tdigest::make(double compression, std::vector<centroid> centroids, double min,
+              double max) {
+  if (!(compression > 0.0))
+    return caf::make_error(ec::invalid_argument,
+                           fmt::format("t-digest compression must be positive, "
+                                       "got {}",
+                                       compression));
+  auto result = tdigest{compression};
+  if (centroids.empty())
+    return result;
+  const auto is_valid = [&](const centroid& x) {
+    return x.weight > 0.0 && x.mean >= min && x.mean <= max;
+  };
+  const auto by_mean = [](const centroid& lhs, const centroid& rhs) {
+    return lhs.mean < rhs.mean;
+  };
+  if (!std::all_of(centroids.begin(), centroids.end(), is_valid)
+      || !std::is_sorted(centroids.begin(), centroids.end(), by_mean))
+    return caf::make_error(ec::invalid_argument,
+                           "t-digest centroids must be sorted, have positive "
+                           "weights, and lie within the minimum and maximum");
+  for (const auto& x : centroids)
+    result.weight_ += x.weight;
+  result.min_ = min;
+  result.max_ = max;
+  result.centroids_ = std::move(centroids);
+  return result;
+}
+
+void tdigest::add(double x, double weight) {
+  VAST_ASSERT(!std::isnan(x));
+  VAST_ASSERT(weight > 0.0);
+  if (weight_ == 0.0) {
+    min_ = x;
+    max_ = x;
+  } else {
+    min_ = std::min(min_, x);
+    max_ = std::max(max_, x);
+  }
+  weight_ += weight;
+  buffer_.push_back({x, weight});
+  if (buffer_.size()
+      >= buffer_factor * static_cast<size_t>(std::ceil(compression_)))
+    compress();
+}
+
+void tdigest::merge(const tdigest& other) {
+  if (other.weight_ == 0.0)
+    return;
+  if (weight_ == 0.0) {
+    min_ = other.min_;
+    max_ = other.max_;
+  } else {
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+  }
+  weight_ += other.weight_;
+  buffer_.insert(buffer_.end(), other.centroids_.begin(),
+                 other.centroids_.end());
+  buffer_.insert(buffer_.end(), other.buffer_.begin(), other.buffer_.end());
+  compress();
+}
+
+void tdigest::compress() {
+  if (buffer_.empty())
+    return;
+  auto input = std::move(buffer_);
+  buffer_.clear();
+  input.insert(input.end(), centroids_.begin(), centroids_.end());
+  std::sort(input.begin(), input.end(),
+            [](const centroid& lhs, const centroid& rhs) {
+              return lhs.mean < rhs.mean;
+            });
+  // The scale function k1 maps quantiles to an index, such that a centroid
+  // may span at most a unit of the index. Its slope grows towards the tails,
+  // which keeps centroids near the tails small.
+  const auto scale = [&](double q) {
+    q = std::clamp(q, 0.0, 1.0);
+    return compression_ / (2.0 * std::numbers::pi) * std::asin(2.0 * q - 1.0);
+  };
+  centroids_.clear();
+  auto current = input.front();
+  auto weight_before = 0.0;
+  auto lower_bound = scale(0.0);
+  for (auto it = input.begin() + 1; it != input.end(); ++it) {
+    const auto q = (weight_before + current.weight + it->weight) / weight_;
+    if (scale(q) - lower_bound <= 1.0) {
+      current.weight += it->weight;
+      current.mean += (it->mean - current.mean) * it->weight / current.weight;
+      continue;
+    }
+    weight_before += current.weight;
+    centroids_.push_back(current);
+    lower_bound = scale(weight_before / weight_);
+    current = *it;
+  }
+  centroids_.push_back(current);
+}
+
+std::optional<double> tdigest::quantile(double q) {
+  VAST_ASSERT(q >= 0.0 && q <= 1.0);
+  compress();
+  if (centroids_.empty())
+    return std::nullopt;
+  if (centroids_.size() == 1)
+    return centroids_.front().mean;
+  const auto target = q * weight_;
+  const auto interpolate = [&](double x0, double y0, double x1, double y1) {
+    if (x1 <= x0)
+      return y1;
+    return y0 + (y1 - y0) * (target - x0) / (x1 - x0);
+  };
+  // Assume that the values of a centroid spread evenly around its mean, and
+  // interpolate linearly between the centers of neighboring centroids. The
+  // minimum and maximum anchor both ends.
+  auto previous_center = 0.0;
+  auto previous_mean = min_;
+  auto weight_before = 0.0;
+  for (const auto& x : centroids_) {
+    const auto center = weight_before + x.weight / 2.0;
+    if (target < center)
+      return interpolate(previous_center, previous_mean, center, x.mean);
+    previous_center = center;
+    previous_mean = x.mean;
+    weight_before += x.weight;
+  }
+  return interpolate(previous_center, previous_mean, weight_, max_);
+}
+
+const std::vector<tdigest::centroid>& tdigest::centroids() const noexcept {
+  VAST_ASSERT(buffer_.empty());
+  return centroids_;
+}
+
+double tdigest::weight() const noexcept {
+  return weight_;
+}
+
+double tdigest::min() const noexcept {
+  return min_;
+}
+
+double tdigest::max() const noexcept {
+  return max_;
+}
+
+size_t mem_usage(const tdigest& x) noexcept {
+  return sizeof(x)
+         + (x.centroids_.capacity() + x.buffer_.capacity())
+             * sizeof(tdigest::centroid);
+}
+
+} // namespace vast::sketch
@@ -129,6 +129,17 @@ handle_query(const auto& self, const query_context& query_context) {
                                        *self, query_context.id)));
         return;
       }
+      if (extract.aggregation
+          && extract.aggregation->applies_to(schema.name())) {
+        auto aggregation = make_partial_pipeline_operator(
+          extract.aggregation->name, extract.aggregation->options);
+        if (aggregation)
+          state->second.aggregation = std::move(*aggregation);
+        else
+          VAST_WARN("{} ships events for query {} without partial "
+                    "aggregation: {}",
+                    *self, query_context.id, aggregation.error());
+      }
       state->second.generator
         = self->state.store->extract(*tailored_expr, query_context.ids);
       state->second.result_iterator = state->second.generator.begin();
@@ -167,6 +178,20 @@ handle_query(const auto& self, const query_context& query_context) {
                          {"issuer", issuer},
                          {"store-type", self->state.store_type},
                        });
+            // The partial aggregation may have moved its state to disk.
+            if (it->second.aggregation) {
+              auto metrics = it->second.aggregation->metrics();
+              if (!metrics.empty())
+                self->send(self->state.accountant, atom::metrics_v,
+                           system::report{
+                             .data = std::move(metrics),
+                             .metadata = {
+                               {"query", id_str},
+                               {"issuer", issuer},
+                               {"store-type", self->state.store_type},
+                             },
+                           });
+            }
             self->state.running_extractions.erase(it);
           },
           [self, expr = query_context.expr, query_id = query_context.id,
@@ -184,6 +209,34 @@ handle_query(const auto& self, const query_context& query_context) {
   return rp;
 }
 
+/// Ships the result of an extract query for a single table slice, or feeds it
+/// into the partial aggregation of the query. The hits of the query are the
+/// rows that the store ships, i.e., the partial results for aggregations.
+caf::error ship_extract_result(auto* self, extract_query_state& state,
+                               table_slice slice) {
+  if (!state.aggregation) {
+    state.num_hits += slice.rows();
+    self->send(state.sink, std::move(slice));
+    return {};
+  }
+  return state.aggregation->add(slice.layout(), to_record_batch(slice));
+}
+
+/// Ships the partial results of an extract query after all table slices were
+/// processed.
+caf::error finish_extract(auto* self, extract_query_state& state) {
+  if (!state.aggregation)
+    return {};
+  auto batches = state.aggregation->finish();
+  if (!batches)
+    return std::move(batches.error());
+  for (auto& [layout, batch] : *batches) {
+    state.num_hits += batch->num_rows();
+    self->send(state.sink, table_slice{batch, std::move(layout)});
+  }
+  return {};
+}
+
 auto remove_down_source(auto* self, const caf::down_msg& down_msg) {
   for (const auto& [query_id, state] : self->state.running_extractions) {
     if (state.sink->address() == down_msg.source) {
@@ -307,9 +360,11 @@ default_passive_store(system::default_passive_store_actor::stateful_pointer<
         return {};
       }
       auto slice = *state.result_iterator;
-      state.num_hits += slice.rows();
-      self->send(state.sink, std::move(slice));
+      if (auto err = ship_extract_result(self, state, std::move(slice)))
+        return err;
       if (++state.result_iterator == state.generator.end()) {
+        if (auto err = finish_extract(self, state))
+          return err;
         return {};
       }
       return self->delegate(
@@ -451,9 +506,11 @@ system::default_active_store_actor::behavior_type default_active_store(
         return {};
       }
       auto slice = *state.result_iterator;
-      state.num_hits += slice.rows();
-      self->send(state.sink, std::move(slice));
+      if (auto err = ship_extract_result(self, state, std::move(slice)))
+        return err;
       if (++state.result_iterator == state.generator.end()) {
+        if (auto err = finish_extract(self, state))
+          return err;
         return {};
       }
       return self->delegate(
@@ -44,6 +44,10 @@ synopsis_ptr synopsis::shrink() const {
   return nullptr;
 }
 
+bool synopsis::append_digests(uint64_t, std::vector<uint64_t>&) const {
+  return false;
+}
+
 caf::error inspect(caf::serializer& sink, synopsis_ptr& ptr) {
   if (!ptr) {
     static legacy_type dummy;
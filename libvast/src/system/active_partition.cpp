@@ -401,8 +401,9 @@ active_partition_actor::behavior_type active_partition(
           continue;
         }
         if (!idx) {
-          auto value_index
-            = factory<vast::value_index>::make(field.type, index_opts);
+          auto value_index = factory<vast::value_index>::make(
+            make_index_type(qf, self->state.synopsis_index_config.rules),
+            index_opts);
           if (!value_index) {
             VAST_WARN("{} failed to spawn active indexer with options {} for "
                       "field {}: value index missing",
@@ -37,6 +37,9 @@ command::opts_builder add_index_opts(command::opts_builder ob) {
     .add<duration>("active-partition-timeout",
                    "timespan after which an active partition is "
                    "forcibly flushed")
+    .add<size_t>("active-partitions-per-schema",
+                 "number of active partitions per schema that are built in "
+                 "parallel")
     .add<size_t>("max-resident-partitions", "maximum number of in-memory "
                                             "partitions")
     .add<size_t>("max-taste-partitions", "maximum number of immediately "
@@ -184,6 +187,8 @@ auto make_spawn_source_command() {
       .add<size_t>("batch-size", "upper bound for the size of a table slice")
       .add<std::string>("batch-timeout", "timeout after which batched "
                                          "table slices are forwarded")
+      .add<std::string>("batch-latency-target", "end-to-end latency target "
+                                                "for adaptive batching")
       .add<std::string>("listen,l", "the endpoint to listen on "
                                     "([host]:port/type)")
       .add<size_t>("max-events,n", "the maximum number of events to import")
@@ -192,6 +197,12 @@ auto make_spawn_source_command() {
       .add<std::string>("schema,S", "alternate schema as string")
       .add<std::string>("schema-file,s", "path to alternate schema")
       .add<std::string>("type,t", "filter event type based on prefix matching")
+      .add<size_t>("udp-receivers", "number of batched UDP receiver threads "
+                                    "for -l (0 disables batching)")
+      .add<size_t>("udp-batch-size", "maximum number of datagrams per "
+                                     "receive call")
+      .add<size_t>("udp-receive-buffer", "requested socket receive buffer "
+                                         "size in bytes")
       .add<bool>("uds,d", "treat -r as listening UNIX domain socket"));
   spawn_source->add_subcommand(
     "csv", "creates a new CSV source inside the node",
@@ -438,6 +449,9 @@ auto make_root_command(std::string_view path) {
         .add<std::string>("aging-query", "query for aging out obsolete data")
         .add<std::string>("store-backend", "store plugin to use for imported "
                                            "data")
+        .add<size_t>("pipeline-workers", "maximum number of threads that "
+                                         "apply import pipelines on the "
+                                         "server")
         .add<std::string>("connection-timeout", "the timeout for connecting to "
                                                 "a VAST server (default: 10s)");
   ob = add_index_opts(std::move(ob));
@@ -468,9 +482,15 @@ std::unique_ptr<command> make_import_command() {
     "import", "imports data from STDIN or file",
     opts("?vast.import")
       .add<std::string>("batch-encoding", "encoding type of table slices")
+      .add<std::string>("batch-compression", "compression of table slices "
+                                             "(none, lz4, or zstd)")
+      .add<int64_t>("batch-compression-level", "compression level of table "
+                                               "slices")
       .add<size_t>("batch-size", "upper bound for the size of a table slice")
       .add<std::string>("batch-timeout", "timeout after which batched "
                                          "table slices are forwarded")
+      .add<std::string>("batch-latency-target", "end-to-end latency target "
+                                                "for adaptive batching")
       .add<bool>("blocking,b", "block until the IMPORTER forwarded all data")
       .add<std::string>("listen,l", "the endpoint to listen on "
                                     "([host]:port/type)")
@@ -479,7 +499,15 @@ std::unique_ptr<command> make_import_command() {
       .add<std::string>("read-timeout", "timeout for waiting for incoming data")
       .add<std::string>("schema,S", "alternate schema as string")
       .add<std::string>("schema-file,s", "path to alternate schema")
+      .add<std::string>("shm-socket", "UNIX domain socket for passing table "
+                                      "slices to a node on the same host")
       .add<std::string>("type,t", "filter event type based on prefix matching")
+      .add<size_t>("udp-receivers", "number of batched UDP receiver threads "
+                                    "for -l (0 disables batching)")
+      .add<size_t>("udp-batch-size", "maximum number of datagrams per "
+                                     "receive call")
+      .add<size_t>("udp-receive-buffer", "requested socket receive buffer "
+                                         "size in bytes")
       .add<bool>("uds,d", "treat -r as listening UNIX domain socket"));
   import_->add_subcommand("zeek", "imports Zeek TSV logs from STDIN or file",
                           opts("?vast.import.zeek"));
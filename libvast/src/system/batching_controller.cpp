@@ -0,0 +1,114 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/batching_controller.hpp"
+
+#include "vast/detail/assert.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace vast::system {
+
+batching_controller::batching_controller(options opts)
+  : options_{opts}, table_slice_size_{opts.max_table_slice_size} {
+  options_.min_table_slice_size = std::clamp(
+    options_.min_table_slice_size, size_t{1}, options_.max_table_slice_size);
+  VAST_ASSERT(options_.max_table_slice_size > 0);
+}
+
+bool batching_controller::enabled() const noexcept {
+  return options_.latency_target > duration::zero();
+}
+
+size_t batching_controller::table_slice_size() const noexcept {
+  return table_slice_size_;
+}
+
+duration batching_controller::batch_timeout() const noexcept {
+  return options_.latency_target;
+}
+
+double batching_controller::rate() const noexcept {
+  return rate_;
+}
+
+void batching_controller::observe_slice(size_t rows, time now) {
+  if (last_slice_ != time{}) {
+    auto interval = std::chrono::duration_cast<
+      std::chrono::duration<double, std::milli>>(now - last_slice_);
+    intervals_.add(interval.count(), interval_buckets);
+  }
+  last_slice_ = now;
+  window_events_ += rows;
+}
+
+void batching_controller::adapt(size_t buffered, time now) {
+  if (!enabled())
+    return;
+  if (window_start_ == time{}) {
+    window_start_ = now;
+    return;
+  }
+  // Update the input rate estimate once per window. Windows without any
+  // events count as well, so that the estimate decays while the input idles.
+  const auto elapsed = now - window_start_;
+  if (elapsed >= rate_window) {
+    const auto seconds
+      = std::chrono::duration_cast<std::chrono::duration<double>>(elapsed);
+    const auto sample = static_cast<double>(window_events_) / seconds.count();
+    rate_ = rate_ == 0.0 ? sample
+                         : rate_weight * sample + (1.0 - rate_weight) * rate_;
+    rates_.add(sample, rate_buckets);
+    window_events_ = 0;
+    window_start_ = now;
+  }
+  // Size table slices such that they fill up within the latency target, and
+  // round up to the next power of two to avoid jitter.
+  const auto target_seconds
+    = std::chrono::duration_cast<std::chrono::duration<double>>(
+      options_.latency_target);
+  const auto target_rows = rate_ * target_seconds.count();
+  auto result = options_.max_table_slice_size;
+  if (target_rows < static_cast<double>(options_.max_table_slice_size))
+    result = std::bit_ceil(static_cast<size_t>(std::max(target_rows, 1.0)));
+  // The outbound stream buffers table slices if the IMPORTER cannot keep up.
+  // Fewer, larger table slices are cheaper to process downstream.
+  if (buffered > 0)
+    result = std::max(result, table_slice_size_ * 2);
+  table_slice_size_ = std::clamp(result, options_.min_table_slice_size,
+                                 options_.max_table_slice_size);
+}
+
+report batching_controller::make_report(std::string_view name) {
+  auto result = report{.data = {
+                         {fmt::format("{}.batching.table-slice-size", name),
+                          uint64_t{table_slice_size_}},
+                         {fmt::format("{}.batching.rate", name), rate_},
+                       }};
+  auto add_histogram = [&](std::string_view metric, std::string_view unit,
+                           auto& hist, const auto& bounds) {
+    for (size_t i = 0; i < hist.counts.size(); ++i) {
+      auto key
+        = i < bounds.size()
+            ? fmt::format("{}.batching.{}.le-{}{}", name, metric, bounds[i],
+                          unit)
+            : fmt::format("{}.batching.{}.le-inf", name, metric);
+      result.data.push_back({std::move(key), hist.counts[i]});
+    }
+    hist = {};
+  };
+  add_histogram("slice-interval", "ms", intervals_, interval_buckets);
+  add_histogram("rate", "", rates_, rate_buckets);
+  return result;
+}
+
+} // namespace vast::system
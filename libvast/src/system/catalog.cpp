@@ -15,6 +15,7 @@
 #include "vast/detail/stable_set.hpp"
 #include "vast/detail/string.hpp"
 #include "vast/detail/tracepoint.hpp"
+#include "vast/error.hpp"
 #include "vast/expression.hpp"
 #include "vast/fbs/utils.hpp"
 #include "vast/logger.hpp"
@@ -32,7 +33,11 @@
 #include <caf/binary_serializer.hpp>
 #include <caf/detail/set_thread_name.hpp>
 
+#include <algorithm>
+#include <optional>
+#include <set>
 #include <type_traits>
+#include <unordered_map>
 
 namespace vast::system {
 
@@ -53,19 +58,46 @@ void catalog_state::update_unprunable_fields(const partition_synopsis& ps) {
   // }
 }
 
+caf::expected<sketch::column_sketch>
+catalog_state::merge_sketches(std::string_view field) const {
+  auto result = std::optional<sketch::column_sketch>{};
+  for (const auto& [_, synopsis] : synopses) {
+    for (const auto& [qf, sketch] : synopsis->field_sketches_) {
+      if (qf.field_name() != field && qf.name() != field)
+        continue;
+      if (!result)
+        result = sketch;
+      else if (auto err = result->merge(sketch))
+        return err;
+    }
+  }
+  if (!result)
+    return caf::make_error(ec::lookup_error,
+                           fmt::format("no sketches for field {}", field));
+  return std::move(*result);
+}
+
 size_t catalog_state::memusage() const {
   size_t result = 0;
   for (const auto& [id, partition_synopsis] : synopses)
     result += partition_synopsis->memusage();
+  result += digests.memusage();
   return result;
 }
 
 void catalog_state::erase(const uuid& partition) {
   synopses.erase(partition);
+  digests.erase(partition);
 }
 
 void catalog_state::merge(const uuid& partition, partition_synopsis_ptr ps) {
   update_unprunable_fields(*ps);
+  if (ps->digests_) {
+    digests.add(partition, *ps->digests_);
+    // The digests are only needed once, so we drop them from the synopsis that
+    // we keep. This copies the synopsis if another actor still shares it.
+    ps.unshared().digests_ = nullptr;
+  }
   synopses.emplace(partition, std::move(ps));
 }
 
@@ -184,6 +216,26 @@ catalog_state::lookup_impl(const expression& expr) const {
       auto search = [&](auto match) {
         VAST_ASSERT(caf::holds_alternative<data>(x.rhs));
         const auto& rhs = caf::get<data>(x.rhs);
+        // Resolve the predicate against the digest index once per field or
+        // type, so that we don't have to probe the synopses that the index
+        // covers.
+        auto digest_hits
+          = std::unordered_map<uint64_t, std::optional<std::vector<uuid>>>{};
+        auto probe = [&](const uuid& part_id, const synopsis& syn,
+                         const auto& scope) -> std::optional<bool> {
+          if (digests.size() > 0 && digests.covers(part_id, scope)) {
+            const auto key = digest_scope(scope);
+            auto it = digest_hits.find(key);
+            if (it == digest_hits.end())
+              it = digest_hits
+                     .emplace(key, digests.lookup(x.op, make_view(rhs), key))
+                     .first;
+            if (it->second)
+              return std::binary_search(it->second->begin(),
+                                        it->second->end(), part_id);
+          }
+          return syn.lookup(x.op, make_view(rhs));
+        };
         result_type result;
         for (const auto& [part_id, part_syn] : synopses) {
           for (const auto& [field, syn] : part_syn->field_synopses_) {
@@ -198,7 +250,7 @@ catalog_state::lookup_impl(const expression& expr) const {
               // We rely on having a field -> nullptr mapping here for the
               // fields that don't have their own synopsis.
               if (syn) {
-                auto opt = syn->lookup(x.op, make_view(rhs));
+                auto opt = probe(part_id, *syn, field);
                 if (!opt || *opt) {
                   VAST_TRACE("{} selects {} at predicate {}",
                              detail::pretty_type_name(this), part_id, x);
@@ -211,7 +263,7 @@ catalog_state::lookup_impl(const expression& expr) const {
                 // for the type in general.
               } else if (auto it = part_syn->type_synopses_.find(cleaned_type);
                          it != part_syn->type_synopses_.end() && it->second) {
-                auto opt = it->second->lookup(x.op, make_view(rhs));
+                auto opt = probe(part_id, *it->second, cleaned_type);
                 if (!opt || *opt) {
                   VAST_TRACE("{} selects {} at predicate {}",
                              detail::pretty_type_name(this), part_id, x);
@@ -498,6 +550,33 @@ catalog(catalog_actor::stateful_pointer<catalog_state> self,
           partitions.emplace_back(std::move(partition));
         }
         result["partitions"] = std::move(partitions);
+        // Report the merged sketches of every field that has them.
+        auto sketched_fields = std::set<std::string>{};
+        for (const auto& [id, synopsis] : self->state.synopses)
+          for (const auto& [field, sketch] : synopsis->field_sketches_)
+            sketched_fields.insert(field.name());
+        auto sketches = record{};
+        for (const auto& field : sketched_fields) {
+          auto sketch = self->state.merge_sketches(field);
+          if (!sketch) {
+            VAST_WARN("{} failed to merge sketches for field {}: {}", *self,
+                      field, sketch.error());
+            continue;
+          }
+          auto top = list{};
+          for (auto& [value, frequency] :
+               sketch->top(defaults::system::catalog_status_top_k))
+            top.emplace_back(record{
+              {"value", std::move(value)},
+              {"count", count{frequency}},
+            });
+          sketches.emplace(field, record{
+                                    {"distinct", count{sketch->distinct()}},
+                                    {"top", std::move(top)},
+                                  });
+        }
+        if (!sketches.empty())
+          result["sketches"] = std::move(sketches);
       }
       if (v >= status_verbosity::debug)
         detail::fill_status_map(result, self);
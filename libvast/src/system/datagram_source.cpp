@@ -202,6 +202,10 @@ caf::behavior datagram_source(
     [self](atom::telemetry) {
       VAST_DEBUG("{} got a telemetry atom", *self);
       self->state.send_report();
+      if (self->state.accountant)
+        self->send(self->state.accountant, atom::metrics_v,
+                   fmt::format("{}.udp.dropped", self->state.reader->name()),
+                   count{self->state.dropped_packets}, metrics_metadata{});
       if (self->state.dropped_packets > 0) {
         VAST_WARN("{} has no capacity left in stream and dropped {} packets",
                   *self, self->state.dropped_packets);
@@ -37,6 +37,28 @@ namespace vast::system {
 
 namespace {
 
+/// Ships the output of the pipelines to the SINK. The output of aggregate
+/// pipelines is limited to the number of events the client requested.
+void ship_transformed(exporter_actor::stateful_pointer<exporter_state> self,
+                      std::vector<table_slice> transformed) {
+  auto& st = self->state;
+  for (auto& slice : transformed) {
+    if (!st.pipeline.is_aggregate()) {
+      self->anon_send(st.sink, std::move(slice));
+      continue;
+    }
+    if (st.requested_aggregates == 0) {
+      VAST_DEBUG("{} drops aggregated events beyond the requested number",
+                 *self);
+      return;
+    }
+    if (slice.rows() > st.requested_aggregates)
+      slice = truncate(std::move(slice), st.requested_aggregates);
+    st.requested_aggregates -= slice.rows();
+    self->anon_send(st.sink, std::move(slice));
+  }
+}
+
 void ship_results(exporter_actor::stateful_pointer<exporter_state> self) {
   VAST_TRACE_SCOPE("");
   auto& st = self->state;
@@ -68,17 +90,36 @@ void ship_results(exporter_actor::stateful_pointer<exporter_state> self) {
       VAST_ERROR("exporter failed to apply the transformation: {}", err);
       return;
     }
+    // Aggregate pipelines only produce results after all partitions were
+    // processed, unless they are incremental.
+    if (st.pipeline.is_aggregate() && !has_continuous_option(st.options))
+      continue;
     auto transformed = self->state.pipeline.finish();
     if (!transformed) {
       VAST_ERROR("exporter failed to finish the transformation: {}",
                  transformed.error());
       return;
     }
-    for (auto& t : *transformed)
-      self->anon_send(st.sink, std::move(t));
+    ship_transformed(self, std::move(*transformed));
   }
 }
 
+/// Ships the results of aggregate pipelines after all partitions were
+/// processed, including the results that incremental aggregations held back.
+void finish_aggregation(exporter_actor::stateful_pointer<exporter_state> self) {
+  auto& st = self->state;
+  if (!st.pipeline.is_aggregate())
+    return;
+  st.pipeline.flush();
+  auto transformed = st.pipeline.finish();
+  if (!transformed) {
+    VAST_ERROR("exporter failed to finish the transformation: {}",
+               transformed.error());
+    return;
+  }
+  ship_transformed(self, std::move(*transformed));
+}
+
 void report_statistics(exporter_actor::stateful_pointer<exporter_state> self) {
   auto& st = self->state;
   if (st.statistics_subscriber)
@@ -103,6 +144,8 @@ void report_statistics(exporter_actor::stateful_pointer<exporter_state> self) {
         {"query", fmt::to_string(self->state.query_context.id)},
       },
     };
+    for (auto& data_point : st.pipeline.metrics())
+      msg.data.push_back(std::move(data_point));
     self->send(st.accountant, atom::metrics_v, std::move(msg));
   }
 }
@@ -203,19 +246,38 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
         ? query_context::priority::low
         : query_context::priority::normal;
   self->state.pipeline = pipeline_executor{std::move(pipelines)};
+  // Continuous queries never finish, so only incremental aggregations can
+  // produce their results.
   if (auto err = self->state.pipeline.validate(
-        pipeline_executor::allow_aggregate_pipelines::no)) {
+        has_continuous_option(options)
+          ? pipeline_executor::allow_aggregate_pipelines::incremental
+          : pipeline_executor::allow_aggregate_pipelines::yes)) {
     VAST_ERROR("transformer is not allowed to use aggregate transform {}", err);
     self->quit();
     return exporter_actor::behavior_type::make_empty_behavior();
   }
+  // Let the stores aggregate partially next to the data, so that they ship
+  // partial results instead of events. Continuous queries aggregate
+  // incrementally in the exporter instead.
+  auto aggregation = has_continuous_option(options)
+                       ? std::optional<partial_aggregation>{}
+                       : self->state.pipeline.pushdown();
+  if (aggregation) {
+    VAST_DEBUG("{} pushes down the partial aggregation of {}", *self,
+               aggregation->name);
+    caf::get<extract_query_context>(self->state.query_context.cmd).aggregation
+      = std::move(*aggregation);
+  }
   if (has_continuous_option(options))
     VAST_DEBUG("{} has continuous query option", *self);
   self->set_exit_handler([=](const caf::exit_msg& msg) {
     VAST_DEBUG("{} received exit from {} with reason: {}", *self, msg.source,
                msg.reason);
-    if (msg.reason != caf::exit_reason::kill)
+    if (msg.reason != caf::exit_reason::kill) {
+      if (has_continuous_option(self->state.options))
+        finish_aggregation(self);
       report_statistics(self);
+    }
     self->quit(msg.reason);
   });
   self->set_down_handler([=](const caf::down_msg& msg) {
@@ -230,6 +292,7 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
     [self](atom::extract) -> caf::result<void> {
       // Sanity check.
       VAST_DEBUG("{} got request to extract all events", *self);
+      self->state.requested_aggregates = max_events;
       if (self->state.query_status.requested == max_events) {
         VAST_WARN("{} ignores extract request, already getting all", *self);
         return {};
@@ -246,6 +309,19 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
         VAST_WARN("{} ignores extract request for 0 results", *self);
         return {};
       }
+      // Aggregate pipelines need all results, so the requested number of
+      // results applies to the aggregated events instead.
+      if (self->state.pipeline.is_aggregate()) {
+        auto& requested_aggregates = self->state.requested_aggregates;
+        requested_aggregates += std::min(max_events - requested_aggregates,
+                                         requested_results);
+        if (self->state.query_status.requested == max_events)
+          return {};
+        self->state.query_status.requested = max_events;
+        ship_results(self);
+        request_more_hits(self);
+        return {};
+      }
       if (self->state.query_status.requested == max_events) {
         VAST_WARN("{} ignores extract request, already getting all", *self);
         return {};
@@ -372,6 +448,7 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
         VAST_DEBUG("{} received all hits from {} partition(s) in {}", *self,
                    self->state.query_status.expected, vast::to_string(runtime));
         VAST_TRACEPOINT(query_done, self->state.id.as_u64().first);
+        finish_aggregation(self);
         if (self->state.accountant)
           self->send(
             self->state.accountant, atom::metrics_v, "exporter.hits.runtime",
@@ -18,12 +18,14 @@
 #include "vast/system/make_pipelines.hpp"
 #include "vast/system/make_source.hpp"
 #include "vast/system/node_control.hpp"
+#include "vast/system/shm_sink.hpp"
 #include "vast/system/signal_monitor.hpp"
 #include "vast/system/spawn_or_connect_to_node.hpp"
 #include "vast/system/transformer.hpp"
 
 #include <caf/make_message.hpp>
 #include <caf/settings.hpp>
+#include <caf/spawn_options.hpp>
 
 #include <csignal>
 #include <string>
@@ -64,11 +66,33 @@ caf::message import_command(const invocation& inv, caf::actor_system& sys) {
   auto guard = system::signal_monitor::run_guarded(
     sig_mon_thread, sys, defaults::system::signal_monitoring_interval, self);
   const auto format = std::string{inv.name()};
+  // Bypass the node connection for table slices if the node runs on the same
+  // host and accepts them through shared memory.
+  auto sink = stream_sink_actor<table_slice, std::string>{importer};
+  auto shm = shm_sink_actor{};
+  if (const auto* path
+      = caf::get_if<std::string>(&inv.options, "vast.import.shm-socket");
+      path && !path->empty()) {
+    if (auto fd = connect_shm_ingest(*path)) {
+      VAST_DEBUG("{} passes table slices through shared memory via {}",
+                 inv.full_name, *path);
+      // The sink blocks while the node applies backpressure and until the
+      // node acknowledged the end of the stream, so it needs its own thread.
+      shm = self->spawn<caf::detached>(shm_sink, *fd);
+      sink = shm;
+    } else {
+      VAST_WARN("{} falls back to the regular node connection: {}",
+                inv.full_name, fd.error());
+    }
+  }
   // Start the source.
   auto src_result = make_source(sys, format, inv, accountant, type_registry,
-                                importer, std::move(*pipelines));
-  if (!src_result)
+                                sink, std::move(*pipelines));
+  if (!src_result) {
+    if (shm)
+      self->send_exit(shm, caf::exit_reason::user_shutdown);
     return caf::make_message(std::move(src_result.error()));
+  }
   auto src = std::move(*src_result);
   bool stop = false;
   caf::error err;
@@ -82,10 +106,22 @@ caf::message import_command(const invocation& inv, caf::actor_system& sys) {
       });
   if (err) {
     self->send_exit(src, caf::exit_reason::user_shutdown);
+    if (shm)
+      self->send_exit(shm, caf::exit_reason::user_shutdown);
     return caf::make_message(std::move(err));
   }
   self->monitor(src);
   self->monitor(importer);
+  if (shm)
+    self->monitor(shm);
+  // Called once all table slices are on their way to the importer.
+  auto finish = [&] {
+    if (caf::get_or(inv.options, "vast.import.blocking", false))
+      self->send(importer, atom::subscribe_v, atom::flush_v,
+                 caf::actor_cast<flush_listener_actor>(self));
+    else
+      stop = true;
+  };
   self
     ->do_receive(
       // C++20: remove explicit 'importer' parameter passing.
@@ -94,15 +130,25 @@ caf::message import_command(const invocation& inv, caf::actor_system& sys) {
           VAST_DEBUG("{} received DOWN from node importer",
                      __PRETTY_FUNCTION__);
           self->send_exit(src, caf::exit_reason::user_shutdown);
+          if (shm)
+            self->send_exit(shm, caf::exit_reason::user_shutdown);
           err = ec::remote_node_down;
           stop = true;
         } else if (msg.source == src) {
           VAST_DEBUG("{} received DOWN from source", __PRETTY_FUNCTION__);
-          if (caf::get_or(inv.options, "vast.import.blocking", false))
-            self->send(importer, atom::subscribe_v, atom::flush_v,
-                       caf::actor_cast<flush_listener_actor>(self));
-          else
+          // The shared-memory sink terminates after the node acknowledged
+          // all table slices.
+          if (!shm)
+            finish();
+        } else if (shm && msg.source == shm) {
+          VAST_DEBUG("{} received DOWN from shared-memory sink",
+                     __PRETTY_FUNCTION__);
+          if (msg.reason && msg.reason != caf::exit_reason::user_shutdown) {
+            err = msg.reason;
             stop = true;
+          } else {
+            finish();
+          }
         } else {
           VAST_DEBUG("{} received unexpected DOWN from {}", __PRETTY_FUNCTION__,
                      msg.source);
@@ -766,17 +766,27 @@ void index_state::notify_flush_listeners() {
 
 // -- partition handling -----------------------------------------------------
 
-bool i_partition_selector::operator()(const type& filter,
+size_t active_partition_shard(const table_slice& slice, size_t num_shards) {
+  VAST_ASSERT(num_shards > 0);
+  if (num_shards == 1)
+    return 0;
+  const auto import_time = slice.import_time().time_since_epoch().count();
+  return vast::hash(import_time) % num_shards;
+}
+
+bool i_partition_selector::operator()(const active_partition_key& filter,
                                       const table_slice& slice) const {
-  return filter == slice.layout();
+  return filter.schema == slice.layout()
+         && filter.shard == active_partition_shard(slice, filter.num_shards);
 }
 
-caf::expected<std::unordered_map<type, active_partition_info>::iterator>
-index_state::create_active_partition(const type& schema) {
-  VAST_ASSERT(schema);
+caf::expected<
+  std::unordered_map<active_partition_key, active_partition_info>::iterator>
+index_state::create_active_partition(const active_partition_key& key) {
+  VAST_ASSERT(key.schema);
   auto id = uuid::random();
   const auto [active_partition, inserted]
-    = active_partitions.emplace(schema, active_partition_info{});
+    = active_partitions.emplace(key, active_partition_info{});
   VAST_ASSERT(inserted);
   VAST_ASSERT(active_partition != active_partitions.end());
   // If we're using the global store, the importer already sends the table
@@ -795,7 +805,7 @@ index_state::create_active_partition(const type& schema) {
   active_partition->second.store = builder;
   active_partition->second.store_slot
     = stage->add_outbound_path(active_partition->second.store);
-  stage->out().set_filter(active_partition->second.store_slot, schema);
+  stage->out().set_filter(active_partition->second.store_slot, key);
   active_partition->second.spawn_time = std::chrono::steady_clock::now();
   active_partition->second.actor
     = self->spawn(::vast::system::active_partition, id, accountant, filesystem,
@@ -804,7 +814,7 @@ index_state::create_active_partition(const type& schema) {
                   store_name, store_header);
   active_partition->second.stream_slot
     = stage->add_outbound_path(active_partition->second.actor);
-  stage->out().set_filter(active_partition->second.stream_slot, schema);
+  stage->out().set_filter(active_partition->second.stream_slot, key);
   active_partition->second.capacity = partition_capacity;
   active_partition->second.id = id;
   VAST_DEBUG("{} created new partition {}", *self, id);
@@ -812,9 +822,11 @@ index_state::create_active_partition(const type& schema) {
 }
 
 void index_state::decommission_active_partition(
-  const type& schema, std::function<void(const caf::error&)> completion) {
-  const auto active_partition = active_partitions.find(schema);
+  const active_partition_key& key,
+  std::function<void(const caf::error&)> completion) {
+  const auto active_partition = active_partitions.find(key);
   VAST_ASSERT(active_partition != active_partitions.end());
+  const auto schema = key.schema;
   const auto id = active_partition->second.id;
   const auto actor = std::exchange(active_partition->second.actor, {});
   // Send buffered batches and remove active partition from the stream.
@@ -1061,8 +1073,8 @@ std::size_t index_state::memusage() const {
     return collection.size() * sizeof(typename T::value_type);
   };
   auto usage = std::size_t{sizeof(*this)};
-  for (const auto& [type, partition_info] : active_partitions) {
-    usage += as_bytes(type).size() + sizeof(partition_info);
+  for (const auto& [key, partition_info] : active_partitions) {
+    usage += as_bytes(key.schema).size() + sizeof(partition_info);
   }
   usage += persisted_partitions.size()
            * sizeof(decltype(persisted_partitions)::value_type);
@@ -1191,13 +1203,15 @@ index(index_actor::stateful_pointer<index_state> self,
       archive_actor archive, catalog_actor catalog,
       type_registry_actor type_registry, const std::filesystem::path& dir,
       std::string store_backend, size_t partition_capacity,
-      duration active_partition_timeout, size_t max_inmem_partitions,
-      size_t taste_partitions, size_t max_concurrent_partition_lookups,
+      duration active_partition_timeout, size_t active_partition_shards,
+      size_t max_inmem_partitions, size_t taste_partitions,
+      size_t max_concurrent_partition_lookups,
       const std::filesystem::path& catalog_dir, index_config index_config) {
-  VAST_TRACE_SCOPE("index {} {} {} {} {} {} {} {} {} {}", VAST_ARG(self->id()),
-                   VAST_ARG(filesystem), VAST_ARG(dir),
+  VAST_TRACE_SCOPE("index {} {} {} {} {} {} {} {} {} {} {}",
+                   VAST_ARG(self->id()), VAST_ARG(filesystem), VAST_ARG(dir),
                    VAST_ARG(partition_capacity),
                    VAST_ARG(active_partition_timeout),
+                   VAST_ARG(active_partition_shards),
                    VAST_ARG(max_inmem_partitions), VAST_ARG(taste_partitions),
                    VAST_ARG(max_concurrent_partition_lookups),
                    VAST_ARG(catalog_dir), VAST_ARG(index_config));
@@ -1236,6 +1250,8 @@ index(index_actor::stateful_pointer<index_state> self,
   self->state.markersdir = dir / "markers";
   self->state.partition_capacity = partition_capacity;
   self->state.active_partition_timeout = active_partition_timeout;
+  self->state.active_partition_shards
+    = std::max(active_partition_shards, size_t{1});
   self->state.taste_partitions = taste_partitions;
   self->state.inmem_partitions.factory().filesystem() = self->state.filesystem;
   self->state.inmem_partitions.resize(max_inmem_partitions);
@@ -1255,9 +1271,17 @@ index(index_actor::stateful_pointer<index_state> self,
       // transparent key lookup with string views, avoding the copy of the name
       // here.
       self->state.stats.layouts[std::string{layout.name()}].count += x.rows();
-      auto active_partition = self->state.active_partitions.find(layout);
+      // The stream stage selects the same shard for the table slice when
+      // fanning it out to the active partitions.
+      const auto num_shards = self->state.active_partition_shards;
+      const auto key = active_partition_key{
+        .schema = layout,
+        .shard = active_partition_shard(x, num_shards),
+        .num_shards = num_shards,
+      };
+      auto active_partition = self->state.active_partitions.find(key);
       if (active_partition == self->state.active_partitions.end()) {
-        auto part = self->state.create_active_partition(layout);
+        auto part = self->state.create_active_partition(key);
         if (!part) {
           self->quit(caf::make_error(ec::logic_error,
                                      fmt::format("{} failed to create active "
@@ -1273,9 +1297,9 @@ index(index_actor::stateful_pointer<index_state> self,
           "{} flushes active partition {} with {}/{} events", *self, layout,
           self->state.partition_capacity - active_partition->second.capacity,
           self->state.partition_capacity);
-        self->state.decommission_active_partition(layout, {});
+        self->state.decommission_active_partition(key, {});
         self->state.flush_to_disk();
-        auto part = self->state.create_active_partition(layout);
+        auto part = self->state.create_active_partition(key);
         if (!part) {
           self->quit(caf::make_error(ec::logic_error,
                                      fmt::format("{} failed to create active "
@@ -1320,7 +1344,7 @@ index(index_actor::stateful_pointer<index_state> self,
       }
     },
     caf::policy::arg<caf::broadcast_downstream_manager<
-      table_slice, vast::type, i_partition_selector>>{});
+      table_slice, active_partition_key, i_partition_selector>>{});
   // Read persistent state.
   if (auto err = self->state.load_from_disk()) {
     VAST_ERROR("{} failed to load index state from disk: {}", *self,
@@ -1337,12 +1361,12 @@ index(index_actor::stateful_pointer<index_state> self,
     detail::shutdown_stream_stage(self->state.stage);
     // We gather the schemas first before we call decomission active partition
     // on every active partition to avoid iterator invalidation.
-    auto schemas = std::vector<type>{};
-    schemas.reserve(self->state.active_partitions.size());
-    for (const auto& [schema, _] : self->state.active_partitions)
-      schemas.push_back(schema);
-    for (const auto& schema : schemas)
-      self->state.decommission_active_partition(schema, {});
+    auto keys = std::vector<active_partition_key>{};
+    keys.reserve(self->state.active_partitions.size());
+    for (const auto& [key, _] : self->state.active_partitions)
+      keys.push_back(key);
+    for (const auto& key : keys)
+      self->state.decommission_active_partition(key, {});
     // Collect partitions for termination.
     // TODO: We must actor_cast to caf::actor here because 'shutdown' operates
     // on 'std::vector<caf::actor>' only. That should probably be generalized
@@ -1409,27 +1433,27 @@ index(index_actor::stateful_pointer<index_state> self,
       if (self->state.accountant)
         self->state.send_report();
       if (self->state.active_partition_timeout.count() > 0) {
-        auto decommissioned = std::vector<type>{};
-        for (const auto& [schema, active_partition] :
+        auto decommissioned = std::vector<active_partition_key>{};
+        for (const auto& [key, active_partition] :
              self->state.active_partitions) {
           if (active_partition.spawn_time + self->state.active_partition_timeout
               < std::chrono::steady_clock::now()) {
-            decommissioned.push_back(schema);
+            decommissioned.push_back(key);
           }
         }
         if (!decommissioned.empty()) {
-          for (const auto& schema : decommissioned) {
-            auto active_partition = self->state.active_partitions.find(schema);
+          for (const auto& key : decommissioned) {
+            auto active_partition = self->state.active_partitions.find(key);
             VAST_ASSERT(active_partition
                         != self->state.active_partitions.end());
             VAST_VERBOSE("{} flushes active partition {} with {}/{} events "
                          "after {} timeout",
-                         *self, schema,
+                         *self, key.schema,
                          self->state.partition_capacity
                            - active_partition->second.capacity,
                          self->state.partition_capacity,
                          data{self->state.active_partition_timeout});
-            self->state.decommission_active_partition(schema, {});
+            self->state.decommission_active_partition(key, {});
           }
           self->state.flush_to_disk();
         }
@@ -1992,13 +2016,13 @@ index(index_actor::stateful_pointer<index_state> self,
         });
       // We gather the schemas first before we call decomission active partition
       // on every active partition to avoid iterator invalidation.
-      auto schemas = std::vector<type>{};
-      schemas.reserve(self->state.active_partitions.size());
-      for (const auto& [schema, _] : self->state.active_partitions)
-        schemas.push_back(schema);
-      for (const auto& schema : schemas) {
+      auto keys = std::vector<active_partition_key>{};
+      keys.reserve(self->state.active_partitions.size());
+      for (const auto& [key, _] : self->state.active_partitions)
+        keys.push_back(key);
+      for (const auto& key : keys) {
         self->state.decommission_active_partition(
-          schema, [counter](const caf::error& err) mutable {
+          key, [counter](const caf::error& err) mutable {
             if (err)
               counter->receive_error(err);
             else
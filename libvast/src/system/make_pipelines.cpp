@@ -61,10 +61,8 @@ caf::error parse_pipeline_operators(pipeline& pipeline,
     auto rec = to<record>(*opts);
     if (!rec)
       return rec.error();
-    auto pipeline_operator = make_pipeline_operator(name, *rec);
-    if (!pipeline_operator)
-      return pipeline_operator.error();
-    pipeline.add_operator(std::move(*pipeline_operator));
+    if (auto err = pipeline.add_operator(name, *rec))
+      return err;
   }
   return caf::none;
 }
@@ -18,6 +18,7 @@
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/port.hpp"
 #include "vast/defaults.hpp"
+#include "vast/detail/udp_receiver.hpp"
 #include "vast/endpoint.hpp"
 #include "vast/error.hpp"
 #include "vast/expression.hpp"
@@ -25,6 +26,7 @@
 #include "vast/logger.hpp"
 #include "vast/module.hpp"
 #include "vast/optional.hpp"
+#include "vast/system/configuration.hpp"
 #include "vast/system/datagram_source.hpp"
 #include "vast/system/signal_monitor.hpp"
 #include "vast/system/source.hpp"
@@ -66,6 +68,7 @@ make_source(caf::actor_system& sys, const std::string& format,
   if (!importer)
     return caf::make_error(ec::missing_component, "importer");
   // Placeholder thingies.
+  auto udp_host = std::string{};
   auto udp_port = std::optional<uint16_t>{};
   // Parse options.
   const auto& options = inv.options;
@@ -84,6 +87,11 @@ make_source(caf::actor_system& sys, const std::string& format,
                                 defaults::import::table_slice_size);
   if (slice_size == 0)
     slice_size = std::numeric_limits<decltype(slice_size)>::max();
+  auto latency_target
+    = get_or_duration(options, "vast.import.batch-latency-target",
+                      defaults::import::batch_latency_target);
+  if (!latency_target)
+    return latency_target.error();
   // Parse module local to the import command.
   auto module = get_module(options);
   if (!module)
@@ -111,6 +119,7 @@ make_source(caf::actor_system& sys, const std::string& format,
         return caf::make_error(vast::ec::unimplemented,
                                "port type not supported:", ep.port->type());
       case port_type::udp:
+        udp_host = ep.host;
         udp_port = ep.port->number();
         break;
     }
@@ -128,6 +137,55 @@ make_source(caf::actor_system& sys, const std::string& format,
   else
     VAST_VERBOSE("{} produces {} table slices of at most {} events",
                  (*reader)->name(), encoding, slice_size);
+  // Set up the batched UDP receiver if requested. It feeds the reader
+  // through a regular source instead of the datagram source broker.
+  auto input_status = std::function<report()>{};
+  auto udp_receivers = caf::get_or(options, "vast.import.udp-receivers",
+                                   defaults::import::udp::receivers);
+  if (udp_port && udp_receivers > 0) {
+    auto receiver = detail::udp_receiver::make({
+      .host = udp_host,
+      .port = *udp_port,
+      .receivers = udp_receivers,
+      .batch_size = caf::get_or(options, "vast.import.udp-batch-size",
+                                defaults::import::udp::batch_size),
+      .receive_buffer_size
+      = caf::get_or(options, "vast.import.udp-receive-buffer",
+                    defaults::import::udp::receive_buffer_size),
+      .max_buffered_bytes = defaults::import::udp::max_buffered_bytes,
+    });
+    if (!receiver)
+      return receiver.error();
+    (*reader)->reset(detail::make_udp_input_stream(*receiver));
+    // The receiver counters are cumulative, but the accountant expects the
+    // values since the last report.
+    input_status = [receiver = *receiver, name = std::string{(*reader)->name()},
+                    last = detail::udp_receiver::statistics{}]() mutable {
+      auto current = receiver->stats();
+      auto delta = [&](uint64_t detail::udp_receiver::statistics::*member) {
+        return current.*member - last.*member;
+      };
+      using stats = detail::udp_receiver::statistics;
+      auto result = report{.data = {
+                             {name + ".udp.datagrams", delta(&stats::datagrams)},
+                             {name + ".udp.bytes", delta(&stats::bytes)},
+                             {name + ".udp.batches", delta(&stats::batches)},
+                             {name + ".udp.dropped", delta(&stats::dropped)},
+                             {name + ".udp.kernel-dropped",
+                              delta(&stats::kernel_dropped)},
+                           }};
+      if (auto dropped = delta(&stats::dropped)
+                         + delta(&stats::kernel_dropped);
+          dropped > 0)
+        VAST_WARN("{} UDP receiver dropped {} datagrams", name, dropped);
+      last = current;
+      return result;
+    };
+    VAST_VERBOSE("{} receives datagrams with {} batched UDP receiver(s)",
+                 (*reader)->name(), udp_receivers);
+    udp_port = std::nullopt;
+    detached = true;
+  }
   // Spawn the source, falling back to the default spawn function.
   auto local_module = module ? std::move(*module) : vast::module{};
   auto type_filter = type ? std::move(*type) : std::string{};
@@ -142,8 +200,11 @@ make_source(caf::actor_system& sys, const std::string& format,
       }
       if (detached)
         return sys.spawn<caf::detached>(source,
-                                        std::forward<decltype(args)>(args)...);
-      return sys.spawn(source, std::forward<decltype(args)>(args)...);
+                                        std::forward<decltype(args)>(args)...,
+                                        *latency_target,
+                                        std::move(input_status));
+      return sys.spawn(source, std::forward<decltype(args)>(args)...,
+                       *latency_target, std::move(input_status));
     }(std::move(*reader), slice_size, max_events, std::move(type_registry),
       std::move(local_module), std::move(type_filter), std::move(accountant),
       std::move(pipelines));
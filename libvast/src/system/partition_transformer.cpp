@@ -158,8 +158,9 @@ void partition_transformer_state::update_type_ids_and_indexers(
     if (it == typed_indexers.end()) {
       const auto skip
         = should_skip_index_creation(field.type, qf, synopsis_opts.rules);
-      auto idx
-        = skip ? nullptr : factory<value_index>::make(field.type, index_opts);
+      auto idx = skip ? nullptr
+                      : factory<value_index>::make(
+                        make_index_type(qf, synopsis_opts.rules), index_opts);
       it = typed_indexers.emplace(qf, std::move(idx)).first;
     }
     auto& idx = it->second;
@@ -0,0 +1,200 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/shm_ingest.hpp"
+
+#include "vast/atoms.hpp"
+#include "vast/chunk.hpp"
+#include "vast/data.hpp"
+#include "vast/detail/memfd.hpp"
+#include "vast/detail/posix.hpp"
+#include "vast/logger.hpp"
+#include "vast/system/status.hpp"
+#include "vast/table_slice.hpp"
+
+#include <caf/attach_continuous_stream_source.hpp>
+
+#include <algorithm>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace vast::system {
+
+namespace {
+
+/// The reasons for closing a client connection.
+enum class close_reason {
+  none,  ///< The connection stays open.
+  eof,   ///< The client finished its stream.
+  error, ///< The connection failed, or the client sent invalid data.
+};
+
+/// Checks whether the client closed its end of a connection after a failed
+/// attempt to receive a file descriptor.
+bool at_eof(int fd) {
+  auto byte = char{};
+  return ::recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT) == 0;
+}
+
+} // namespace
+
+shm_ingest_state::~shm_ingest_state() noexcept {
+  for (auto fd : connections)
+    ::close(fd);
+  if (listen_fd != -1) {
+    ::close(listen_fd);
+    ::unlink(path.c_str());
+  }
+}
+
+size_t shm_ingest_state::accept() {
+  auto result = size_t{0};
+  while (true) {
+    auto fd = detail::uds_accept(listen_fd);
+    if (fd < 0)
+      break;
+    VAST_DEBUG("{} accepted a new client", *self);
+    connections.push_back(fd);
+    ++result;
+  }
+  return result;
+}
+
+size_t shm_ingest_state::read() {
+  auto result = size_t{0};
+  for (auto it = connections.begin(); it != connections.end();) {
+    auto closed = close_reason::none;
+    while (mgr->out().capacity() > 0) {
+      if (detail::poll(*it, 0))
+        break;
+      auto fd = detail::uds_recv_fd(*it);
+      if (fd < 0) {
+        closed = at_eof(*it) ? close_reason::eof : close_reason::error;
+        if (closed == close_reason::error)
+          VAST_WARN("{} drops a connection after failing to receive a table "
+                    "slice",
+                    *self);
+        break;
+      }
+      auto chunk = detail::map_sealed_memfd(fd);
+      if (!chunk) {
+        VAST_WARN("{} drops a connection after failing to adopt a table "
+                  "slice: {}",
+                  *self, chunk.error());
+        closed = close_reason::error;
+        break;
+      }
+      auto slice = table_slice{std::move(*chunk), table_slice::verify::yes};
+      if (slice.encoding() == table_slice_encoding::none) {
+        VAST_WARN("{} drops a connection after receiving an invalid table "
+                  "slice",
+                  *self);
+        closed = close_reason::error;
+        break;
+      }
+      mgr->out().push(std::move(slice));
+      ++slices;
+      ++result;
+    }
+    if (closed != close_reason::none) {
+      // All table slices of the client are in the stream now, so we can
+      // acknowledge the end of its input. On errors, we close the connection
+      // without acknowledgement so that the client fails.
+      if (closed == close_reason::eof) {
+        const auto ack = char{'*'};
+        if (::write(*it, &ack, 1) != 1)
+          VAST_DEBUG("{} failed to acknowledge the end of a stream", *self);
+      }
+      ::close(*it);
+      it = connections.erase(it);
+      VAST_DEBUG("{} closed a connection", *self);
+    } else {
+      ++it;
+    }
+  }
+  if (result > 0)
+    mgr->push();
+  return result;
+}
+
+shm_ingest_actor::behavior_type
+shm_ingest(shm_ingest_actor::stateful_pointer<shm_ingest_state> self,
+           stream_sink_actor<table_slice> importer, std::string path) {
+  self->state.self = self;
+  self->state.path = std::move(path);
+  auto status = [self](atom::status, status_verbosity v) {
+    auto result = record{};
+    if (v >= status_verbosity::detailed) {
+      result["socket"] = self->state.path;
+      result["clients"] = count{self->state.connections.size()};
+      result["slices"] = count{self->state.slices};
+    }
+    return result;
+  };
+  // The component stays idle unless shared-memory ingest is configured.
+  if (self->state.path.empty() || !importer)
+    return {
+      [](atom::internal, atom::read) {
+        // nop
+      },
+      std::move(status),
+    };
+  self->state.listen_fd = detail::uds_listen(self->state.path);
+  if (self->state.listen_fd < 0) {
+    VAST_WARN("{} failed to listen on {}; shared-memory ingest is disabled",
+              *self, self->state.path);
+  } else if (auto err = detail::make_nonblocking(self->state.listen_fd)) {
+    VAST_WARN("{} failed to make {} non-blocking: {}", *self, self->state.path,
+              err);
+    ::close(self->state.listen_fd);
+    self->state.listen_fd = -1;
+  } else {
+    VAST_VERBOSE("{} accepts table slices from co-located import clients at "
+                 "{}",
+                 *self, self->state.path);
+    self->state.mgr = caf::attach_continuous_stream_source(
+      self,
+      [](caf::unit_t&) {
+        // nop
+      },
+      [](caf::unit_t&, caf::downstream<table_slice>&, size_t) {
+        // nop, new slices are generated in the read handler
+      },
+      [](const caf::unit_t&) {
+        return false;
+      });
+    self->state.mgr->add_outbound_path(importer);
+    self->send(self, atom::internal_v, atom::read_v);
+  }
+  return {
+    [self](atom::internal, atom::read) {
+      auto& st = self->state;
+      if (st.listen_fd == -1)
+        return;
+      const auto num_accepted = st.accept();
+      // Keep going without delay as long as there is input. Otherwise, back
+      // off exponentially while idle so that an unused socket costs next to
+      // nothing, but check again soon while the stream applies backpressure.
+      if (st.read() > 0) {
+        st.poll_interval = shm_ingest_state::min_poll_interval;
+        self->send(self, atom::internal_v, atom::read_v);
+        return;
+      }
+      if (num_accepted > 0 || st.mgr->out().capacity() == 0)
+        st.poll_interval = shm_ingest_state::min_poll_interval;
+      else
+        st.poll_interval = std::min(st.poll_interval * 2,
+                                    shm_ingest_state::max_poll_interval);
+      self->delayed_send(self, st.poll_interval, atom::internal_v,
+                         atom::read_v);
+    },
+    std::move(status),
+  };
+}
+
+} // namespace vast::system
@@ -0,0 +1,124 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/shm_sink.hpp"
+
+#include "vast/detail/memfd.hpp"
+#include "vast/detail/posix.hpp"
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+#include "vast/table_slice.hpp"
+
+#include <caf/attach_stream_sink.hpp>
+#include <fmt/format.h>
+#include <sys/socket.h>
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+namespace vast::system {
+
+namespace {
+
+/// Passes a single table slice to the node.
+caf::error forward(shm_sink_state& state, table_slice slice) {
+  // Only serialized table slices have a contiguous representation that the
+  // node can adopt as-is.
+  if (!slice.is_serialized()) {
+    auto serialized = table_slice{to_record_batch(slice), slice.layout(),
+                                  table_slice::serialize::yes};
+    serialized.import_time(slice.import_time());
+    slice = std::move(serialized);
+  }
+  const auto bytes = as_bytes(slice);
+  auto memfd = detail::make_sealed_memfd("vast-table-slice", bytes);
+  if (!memfd)
+    return std::move(memfd.error());
+  const auto sent = detail::uds_send_fd(state.fd, *memfd);
+  // The receiving end holds its own reference to the file once the message
+  // is in flight.
+  ::close(*memfd);
+  if (!sent)
+    return caf::make_error(ec::system_error,
+                           fmt::format("failed to pass table slice to node: "
+                                       "{}",
+                                       std::strerror(errno)));
+  ++state.slices;
+  state.bytes += bytes.size();
+  return caf::none;
+}
+
+/// Signals the end of the stream to the node and waits until the node has
+/// forwarded all table slices to its IMPORTER.
+caf::error finish(shm_sink_state& state) {
+  if (::shutdown(state.fd, SHUT_WR) < 0)
+    return caf::make_error(ec::system_error,
+                           fmt::format("failed to shut down shared-memory "
+                                       "ingest connection: {}",
+                                       std::strerror(errno)));
+  auto ack = char{};
+  if (::read(state.fd, &ack, 1) != 1)
+    return caf::make_error(ec::remote_node_down,
+                           "node closed the shared-memory ingest connection "
+                           "without acknowledging the stream");
+  return caf::none;
+}
+
+} // namespace
+
+shm_sink_state::~shm_sink_state() noexcept {
+  if (fd != -1)
+    ::close(fd);
+}
+
+caf::expected<int> connect_shm_ingest(const std::string& path) {
+  auto fd = detail::uds_connect(path, detail::socket_type::fd);
+  if (fd < 0)
+    return caf::make_error(ec::system_error,
+                           fmt::format("failed to connect to shared-memory "
+                                       "ingest socket {}",
+                                       path));
+  return fd;
+}
+
+shm_sink_actor::behavior_type
+shm_sink(shm_sink_actor::stateful_pointer<shm_sink_state> self, int fd) {
+  self->state.fd = fd;
+  return {
+    [self](caf::stream<table_slice> in, const std::string& description)
+      -> caf::inbound_stream_slot<table_slice> {
+      VAST_DEBUG("{} forwards stream from {} to the node", *self, description);
+      return caf::attach_stream_sink(
+               self, in,
+               [](caf::unit_t&) {
+                 // nop
+               },
+               [self](caf::unit_t&, std::vector<table_slice>& slices) {
+                 for (auto& slice : slices) {
+                   if (auto err = forward(self->state, std::move(slice))) {
+                     self->quit(std::move(err));
+                     return;
+                   }
+                 }
+               },
+               [self](caf::unit_t&, const caf::error& err) {
+                 if (err) {
+                   self->quit(err);
+                   return;
+                 }
+                 VAST_DEBUG("{} forwarded {} table slices with {} bytes",
+                            *self, self->state.slices, self->state.bytes);
+                 self->quit(finish(self->state));
+               })
+        .inbound_slot();
+    },
+  };
+}
+
+} // namespace vast::system
@@ -106,6 +106,12 @@ void source_state::send_report() {
   // Send the reader-specific status report to the accountant.
   if (auto status = reader->status(); !status.data.empty())
     send_to_accountant(self, accountant, atom::metrics_v, std::move(status));
+  if (input_status)
+    if (auto status = input_status(); !status.data.empty())
+      send_to_accountant(self, accountant, atom::metrics_v, std::move(status));
+  if (batching.enabled())
+    send_to_accountant(self, accountant, atom::metrics_v,
+                       batching.make_report(reader->name()));
   // Send the source-specific performance metrics to the accountant.
   auto r = performance_report{{{std::string{name}, metrics}}};
   for (const auto& [key, m, _] : r.data) {
@@ -157,7 +163,8 @@ source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
        size_t table_slice_size, std::optional<size_t> max_events,
        const type_registry_actor& type_registry, vast::module local_module,
        std::string type_filter, accountant_actor accountant,
-       std::vector<pipeline>&& pipelines) {
+       std::vector<pipeline>&& pipelines, duration latency_target,
+       std::function<report()> input_status) {
   VAST_TRACE_SCOPE("{}", VAST_ARG(*self));
   // Initialize state.
   self->state.self = self;
@@ -167,6 +174,17 @@ source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
   self->state.local_module = std::move(local_module);
   self->state.accountant = std::move(accountant);
   self->state.table_slice_size = table_slice_size;
+  self->state.batching = batching_controller{{
+    .max_table_slice_size = table_slice_size,
+    .latency_target = latency_target,
+  }};
+  if (self->state.batching.enabled()) {
+    VAST_VERBOSE("{} adapts table slices of at most {} events to a latency "
+                 "target of {}",
+                 *self, table_slice_size, to_string(latency_target));
+    self->state.reader->batch_timeout_ = self->state.batching.batch_timeout();
+  }
+  self->state.input_status = std::move(input_status);
   self->state.has_sink = false;
   self->state.done = false;
   self->state.transformer
@@ -249,16 +267,25 @@ source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
           const auto& layout = slice.layout();
           self->state.event_counters[std::string{layout.name()}]
             += slice.rows();
+          self->state.batching.observe_slice(slice.rows(),
+                                             std::chrono::system_clock::now());
           self->state.mgr->out().push(std::move(slice));
         });
       };
+      // Let the batching controller pick the table slice size for this run
+      // based on the input rate and the slices still waiting for credit.
+      self->state.batching.adapt(self->state.mgr->out().buffered(),
+                                 std::chrono::system_clock::now());
+      const auto table_slice_size = self->state.batching.enabled()
+                                      ? self->state.batching.table_slice_size()
+                                      : self->state.table_slice_size;
       // We can produce up to num * table_slice_size events per run.
-      auto events = static_cast<size_t>(num) * self->state.table_slice_size;
+      auto events = static_cast<size_t>(num) * table_slice_size;
       if (self->state.requested)
         events = std::min(events, *self->state.requested - self->state.count);
       auto t = timer::start(self->state.metrics);
-      auto [err, produced] = self->state.reader->read(
-        events, self->state.table_slice_size, push_slice);
+      auto [err, produced]
+        = self->state.reader->read(events, table_slice_size, push_slice);
       VAST_DEBUG("{} read {} events", *self, produced);
       // TODO: We use the produced number in metrics and INFO logs, but it is
       // the number _before_ filtering which may be a bit unexpected to the
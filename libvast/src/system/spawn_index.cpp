@@ -62,6 +62,7 @@ spawn_index(node_actor::stateful_pointer<node_state> self,
     opt("vast.store-backend", std::string{sd::store_backend}),
     opt("vast.max-partition-size", sd::max_partition_size),
     opt("vast.active-partition-timeout", sd::active_partition_timeout),
+    opt("vast.active-partitions-per-schema", sd::active_partitions_per_schema),
     opt("vast.max-resident-partitions", sd::max_in_mem_partitions),
     opt("vast.max-taste-partitions", sd::taste_partitions),
     opt("vast.max-queries", sd::num_query_supervisors),
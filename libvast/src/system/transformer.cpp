@@ -8,22 +8,86 @@
 
 #include "vast/system/transformer.hpp"
 
+#include "vast/defaults.hpp"
 #include "vast/detail/fill_status_map.hpp"
 #include "vast/detail/framed.hpp"
 #include "vast/detail/overload.hpp"
+#include "vast/detail/shutdown_stream_stage.hpp"
 #include "vast/error.hpp"
 #include "vast/logger.hpp"
 #include "vast/plugin.hpp"
 #include "vast/system/status.hpp"
 #include "vast/table_slice.hpp"
 
+#include <caf/actor_system_config.hpp>
 #include <caf/attach_continuous_stream_stage.hpp>
 #include <caf/attach_stream_sink.hpp>
 #include <caf/attach_stream_stage.hpp>
+#include <caf/downstream.hpp>
 #include <caf/settings.hpp>
 
+#include <utility>
+
 namespace vast::system {
 
+namespace {
+
+/// Assigns consecutive offsets to transformed table slices. The INDEX assigns
+/// the final partition-local offsets, so the results of aggregations, which do
+/// not correspond to any input events, continue after the previous results.
+/// @param slices The transformed table slices.
+/// @param offset The offset of the input table slice, or `invalid_id` to
+/// continue after the previous results.
+void assign_offsets(
+  transformer_actor::stateful_pointer<transformer_state> self,
+  std::vector<table_slice>& slices, id offset) {
+  auto& next_offset = self->state.next_offset;
+  if (offset != invalid_id
+      && (!self->state.executor.is_aggregate() || offset > next_offset))
+    next_offset = offset;
+  for (auto& slice : slices) {
+    slice.offset(next_offset);
+    next_offset += slice.rows();
+  }
+}
+
+/// Applies the pipelines to the collected table slices.
+/// @param out The buffer of the stream stage.
+void finish_buffered(
+  transformer_actor::stateful_pointer<transformer_state> self,
+  caf::downstream<table_slice>& out) {
+  auto& state = self->state;
+  const auto num_slices = std::exchange(state.num_buffered_slices, 0);
+  const auto rows = std::exchange(state.num_buffered_rows, 0);
+  const auto offset = std::exchange(state.buffered_offset, invalid_id);
+  if (num_slices == 0)
+    return;
+  auto transformed = state.executor.finish();
+  if (!transformed) {
+    VAST_WARN("{} skips {} slice(s) because of an error in pipeline: {}",
+              state.transformer_name, num_slices, transformed.error());
+    return;
+  }
+  if (state.reassign_offset_ranges) {
+    // Only aggregations may return more events than they receive.
+    auto transformed_rows = uint64_t{0};
+    for (const auto& t1 : *transformed)
+      transformed_rows += t1.rows();
+    if (!state.executor.is_aggregate() && transformed_rows > rows) {
+      VAST_WARN(caf::make_error(ec::invalid_result,
+                                "pipeline returned a slice "
+                                "with an offset outside the "
+                                "range of its input"));
+      return;
+    }
+    assign_offsets(self, *transformed, offset);
+  }
+  for (auto& t2 : *transformed)
+    out.push(std::move(t2));
+}
+
+} // namespace
+
 transformer_stream_stage_ptr attach_pipeline_stage(
   transformer_actor::stateful_pointer<transformer_state> self) {
   return caf::attach_continuous_stream_stage(
@@ -34,42 +98,53 @@ transformer_stream_stage_ptr attach_pipeline_stage(
     [self](caf::unit_t&, caf::downstream<table_slice>& out,
            detail::framed<table_slice> x) {
       if (x.header == detail::stream_control_header::eof) {
-        VAST_DEBUG("{} quits after receiving EOF control message in stream",
+        finish_buffered(self, out);
+        // Incremental aggregations hold back the results of open windows until
+        // the end of the input.
+        if (self->state.executor.is_aggregate()) {
+          self->state.executor.flush();
+          if (auto transformed = self->state.executor.finish()) {
+            if (self->state.reassign_offset_ranges)
+              assign_offsets(self, *transformed, invalid_id);
+            for (auto& t : *transformed)
+              out.push(std::move(t));
+          } else {
+            VAST_ERROR("{} drops the results of open windows because of an "
+                       "error in pipeline: {}",
+                       self->state.transformer_name, transformed.error());
+          }
+        }
+        // We quit once the stream stage shipped all buffered slices, which
+        // includes the results of open windows.
+        VAST_DEBUG("{} shuts down after receiving EOF control message in "
+                   "stream",
                    self->state.transformer_name);
-        self->send_exit(self, caf::make_error(ec::end_of_input));
+        self->state.received_eof = true;
+        detail::shutdown_stream_stage(self->state.stage);
         return;
       }
-      auto offset = x.body.offset();
+      if (self->state.num_buffered_slices == 0)
+        self->state.buffered_offset = x.body.offset();
       auto rows = x.body.rows();
       if (auto err = self->state.executor.add(std::move(x.body))) {
         VAST_WARN("{} skips slice because add failed: {}",
                   self->state.transformer_name, err);
         return;
       }
-      auto transformed = self->state.executor.finish();
-      if (!transformed) {
-        VAST_WARN("{} skips slice because of an error in pipeline: {}",
-                  self->state.transformer_name, transformed.error());
+      ++self->state.num_buffered_slices;
+      self->state.num_buffered_rows += rows;
+      // Collect the slices that arrive together, so that the executor can
+      // apply the pipelines to them in parallel.
+      if (self->state.num_buffered_slices >= self->state.max_buffered_slices) {
+        finish_buffered(self, out);
         return;
       }
-      if (self->state.reassign_offset_ranges) {
-        auto next_offset = offset;
-        for (auto& t1 : *transformed) {
-          t1.offset(next_offset);
-          next_offset += t1.rows();
-        }
-        if (next_offset > offset + rows) {
-          VAST_WARN(caf::make_error(ec::invalid_result,
-                                    "pipeline returned a slice "
-                                    "with an offset outside the "));
-          return;
-        }
-      }
-      for (auto& t2 : *transformed)
-        out.push(std::move(t2));
+      if (!std::exchange(self->state.flush_pending, true))
+        self->send(self, atom::internal_v, atom::flush_v);
     },
-    [=](caf::unit_t&, const caf::error&) {
-      // nop
+    [self](caf::unit_t&, const caf::error&) {
+      if (self->state.received_eof)
+        self->send_exit(self, caf::make_error(ec::end_of_input));
     });
 }
 
@@ -85,8 +160,10 @@ transformer(transformer_actor::stateful_pointer<transformer_state> self,
   self->state.status["pipelines"] = std::move(pipeline_names);
   self->state.executor = pipeline_executor{std::move(pipelines)};
   if (auto err = self->state.executor.validate(
-        pipeline_executor::allow_aggregate_pipelines::no)) {
-    VAST_ERROR("transformer is not allowed to use aggregate pipeline {}", err);
+        pipeline_executor::allow_aggregate_pipelines::incremental)) {
+    VAST_ERROR("transformer is not allowed to use non-incremental aggregate "
+               "pipeline {}",
+               err);
     self->quit();
     return transformer_actor::behavior_type::make_empty_behavior();
   }
@@ -145,6 +222,15 @@ transformer(transformer_actor::stateful_pointer<transformer_state> self,
       }
       return slot;
     },
+    [self](atom::internal, atom::flush) {
+      self->state.flush_pending = false;
+      if (self->state.num_buffered_slices == 0)
+        return;
+      auto out = caf::downstream<table_slice>{
+        self->state.stage->out().buf()};
+      finish_buffered(self, out);
+      self->state.stage->push();
+    },
     [self](atom::status, status_verbosity v) {
       auto result = self->state.status;
       // General state such as open streams.
@@ -160,6 +246,16 @@ importer_transformer(transformer_actor::stateful_pointer<transformer_state> self
   auto handle = transformer(self, std::move(name), std::move(pipelines));
   self->state.source_requires_shutdown = true;
   self->state.reassign_offset_ranges = true;
+  const auto pipeline_workers
+    = caf::get_or(content(self->system().config()), "vast.pipeline-workers",
+                  defaults::system::pipeline_workers);
+  if (pipeline_workers > 1) {
+    if (auto err = self->state.executor.parallelize(pipeline_workers))
+      VAST_WARN("{} applies pipelines on a single thread: {}",
+                self->state.transformer_name, err);
+    else
+      self->state.max_buffered_slices = pipeline_workers;
+  }
   return handle;
 }
 
@@ -24,6 +24,7 @@
 #include "vast/ids.hpp"
 #include "vast/logger.hpp"
 #include "vast/msgpack_table_slice.hpp"
+#include "vast/pattern.hpp"
 #include "vast/table_slice_builder.hpp"
 #include "vast/table_slice_builder_factory.hpp"
 #include "vast/type.hpp"
@@ -32,6 +33,7 @@
 #include <arrow/record_batch.h>
 
 #include <cstddef>
+#include <optional>
 #include <span>
 
 namespace vast {
@@ -624,6 +626,51 @@ bool evaluate_meta_extractor(const table_slice& slice,
   __builtin_unreachable();
 }
 
+/// Evaluates a predicate that compares a string column with a pattern on the
+/// underlying Arrow array, without materializing every element.
+/// @returns `std::nullopt` if the operator has no string and pattern semantics.
+std::optional<ids>
+evaluate_pattern(const type_to_arrow_array_t<string_type>& array,
+                 relational_operator op, const pattern& rhs, id offset,
+                 size_t num_rows, const ids& selection) {
+  auto negated = false;
+  auto search = false;
+  switch (op) {
+    case relational_operator::match:
+    case relational_operator::equal:
+      break;
+    case relational_operator::not_match:
+    case relational_operator::not_equal:
+      negated = true;
+      break;
+    case relational_operator::in:
+      search = true;
+      break;
+    case relational_operator::not_in:
+      search = true;
+      negated = true;
+      break;
+    default:
+      return std::nullopt;
+  }
+  auto result = ids{};
+  for (auto id : select(selection)) {
+    VAST_ASSERT(id >= offset);
+    const auto row = detail::narrow_cast<int64_t>(id - offset);
+    result.append(false, id - result.size());
+    // Null values never match, so only the negated operators select them.
+    auto matches = negated;
+    if (!array.IsNull(row)) {
+      const auto value = array.GetView(row);
+      const auto str = std::string_view{value.data(), value.size()};
+      matches = negated != (search ? rhs.search(str) : rhs.match(str));
+    }
+    result.append(matches, 1);
+  }
+  result.append(false, offset + num_rows - result.size());
+  return result;
+}
+
 } // namespace
 
 ids evaluate(const expression& expr, const table_slice& slice,
@@ -654,6 +701,12 @@ ids evaluate(const expression& expr, const table_slice& slice,
       const auto array = static_cast<arrow::FieldPath>(index)
                            .Get(*to_record_batch(slice))
                            .ValueOrDie();
+      if (const auto* rhs_pattern = caf::get_if<pattern>(&rhs);
+          rhs_pattern && caf::holds_alternative<string_type>(type))
+        if (auto result = evaluate_pattern(
+              caf::get<type_to_arrow_array_t<string_type>>(*array), op,
+              *rhs_pattern, offset, num_rows, selection))
+          return std::move(*result);
       auto result = ids{};
       const auto rhs_internal
         = materialize(to_internal(type, make_data_view(rhs)));
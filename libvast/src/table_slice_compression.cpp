@@ -0,0 +1,111 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/table_slice_compression.hpp"
+
+#include "vast/defaults.hpp"
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+
+#include <arrow/util/compression.h>
+#include <caf/error.hpp>
+#include <caf/settings.hpp>
+
+namespace vast {
+
+namespace {
+
+caf::expected<std::shared_ptr<arrow::util::Codec>>
+make_codec(table_slice_compression compression, std::optional<int> level) {
+  auto type = arrow::Compression::UNCOMPRESSED;
+  switch (compression) {
+    case table_slice_compression::none:
+      return std::shared_ptr<arrow::util::Codec>{};
+    case table_slice_compression::lz4:
+      type = arrow::Compression::LZ4_FRAME;
+      break;
+    case table_slice_compression::zstd:
+      type = arrow::Compression::ZSTD;
+      break;
+  }
+  if (!level) {
+    auto default_level = arrow::util::Codec::DefaultCompressionLevel(type);
+    if (!default_level.ok())
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("failed to configure {} codec for "
+                                         "Apache Arrow: {}",
+                                         compression,
+                                         default_level.status().ToString()));
+    level = default_level.MoveValueUnsafe();
+  }
+  auto codec = arrow::util::Codec::Create(type, *level);
+  if (!codec.ok())
+    return caf::make_error(ec::invalid_configuration,
+                           fmt::format("failed to create {} codec with level "
+                                       "{} for Apache Arrow: {}",
+                                       compression, *level,
+                                       codec.status().ToString()));
+  return std::shared_ptr<arrow::util::Codec>{codec.MoveValueUnsafe()};
+}
+
+std::shared_ptr<arrow::util::Codec>& codec_impl() noexcept {
+  static auto codec = [] {
+    auto result = make_codec(defaults::import::table_slice_compression, {});
+    return result ? std::move(*result) : std::shared_ptr<arrow::util::Codec>{};
+  }();
+  return codec;
+}
+
+} // namespace
+
+std::optional<table_slice_compression>
+to_table_slice_compression(std::string_view name) noexcept {
+  if (name == "none")
+    return table_slice_compression::none;
+  if (name == "lz4")
+    return table_slice_compression::lz4;
+  if (name == "zstd")
+    return table_slice_compression::zstd;
+  return std::nullopt;
+}
+
+caf::error set_table_slice_compression(table_slice_compression compression,
+                                       std::optional<int> level) {
+  auto codec = make_codec(compression, level);
+  if (!codec)
+    return std::move(codec.error());
+  codec_impl() = std::move(*codec);
+  VAST_DEBUG("table slices use {} compression", compression);
+  return caf::none;
+}
+
+caf::error set_table_slice_compression(const caf::settings& options) {
+  auto compression = defaults::import::table_slice_compression;
+  if (auto name
+      = caf::get_if<std::string>(&options, "vast.import.batch-compression")) {
+    auto parsed = to_table_slice_compression(*name);
+    if (!parsed)
+      return caf::make_error(ec::invalid_configuration,
+                             fmt::format("invalid value '{}' for "
+                                         "vast.import.batch-compression; "
+                                         "expected none, lz4, or zstd",
+                                         *name));
+    compression = *parsed;
+  }
+  auto level = std::optional<int>{};
+  if (auto x = caf::get_if<caf::config_value::integer>(
+        &options, "vast.import.batch-compression-level"))
+    level = static_cast<int>(*x);
+  return set_table_slice_compression(compression, level);
+}
+
+const std::shared_ptr<arrow::util::Codec>& table_slice_codec() noexcept {
+  return codec_impl();
+}
+
+} // namespace vast
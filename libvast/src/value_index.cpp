@@ -8,13 +8,16 @@
 
 #include "vast/value_index.hpp"
 
+#include "vast/arrow_table_slice.hpp"
 #include "vast/chunk.hpp"
 #include "vast/data.hpp"
 #include "vast/detail/legacy_deserialize.hpp"
+#include "vast/detail/narrow.hpp"
 #include "vast/fbs/value_index.hpp"
 #include "vast/legacy_type.hpp"
 #include "vast/value_index_factory.hpp"
 
+#include <arrow/array.h>
 #include <caf/binary_serializer.hpp>
 #include <caf/deserializer.hpp>
 #include <caf/sec.hpp>
@@ -52,6 +55,32 @@ caf::expected<void> value_index::append(data_view x, id pos) {
   return caf::no_error;
 }
 
+caf::expected<void> value_index::append(const arrow::Array& array, id pos) {
+  auto off = offset();
+  if (pos < off)
+    // Can only append at the end
+    return caf::make_error(ec::unspecified, pos, '<', off);
+  if (!append_array_impl(array, pos))
+    return caf::make_error(ec::unspecified, "append_array_impl");
+  for (int64_t row = 0; row < array.length(); ++row) {
+    if (array.IsNull(row))
+      continue;
+    mask_.append_bits(false, pos + detail::narrow_cast<id>(row) - mask_.size());
+    mask_.append_bit(true);
+  }
+  return caf::no_error;
+}
+
+bool value_index::append_array_impl(const arrow::Array& array, id pos) {
+  for (auto&& x : values(type(), array)) {
+    if (!caf::holds_alternative<view<caf::none_t>>(x))
+      if (!append_impl(x, pos))
+        return false;
+    ++pos;
+  }
+  return true;
+}
+
 caf::expected<ids>
 value_index::lookup(relational_operator op, data_view x) const {
   // When x is nil, we can answer the query right here.
@@ -173,6 +202,12 @@ caf::error unpack(const fbs::ValueIndex& from, value_index_ptr& to) {
       return do_unpack(*from.value_index_as_subnet()->base());
     case fbs::value_index::ValueIndex::string:
       return do_unpack(*from.value_index_as_string()->base());
+    case fbs::value_index::ValueIndex::ngram:
+      return do_unpack(*from.value_index_as_ngram()->base());
+    case fbs::value_index::ValueIndex::sorted:
+      return do_unpack(*from.value_index_as_sorted()->base());
+    case fbs::value_index::ValueIndex::radix:
+      return do_unpack(*from.value_index_as_radix()->base());
   }
   return caf::make_error(ec::format_error, "unexpected value index type");
 }
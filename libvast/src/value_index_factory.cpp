@@ -18,6 +18,9 @@
 #include "vast/index/enumeration_index.hpp"
 #include "vast/index/hash_index.hpp"
 #include "vast/index/list_index.hpp"
+#include "vast/index/ngram_index.hpp"
+#include "vast/index/radix_index.hpp"
+#include "vast/index/sorted_index.hpp"
 #include "vast/index/string_index.hpp"
 #include "vast/index/subnet_index.hpp"
 #include "vast/logger.hpp"
@@ -57,6 +60,23 @@ value_index_ptr make(type x, caf::settings opts) {
     }
   }
   if (auto index = x.attribute("index")) {
+    if (*index == "ngram"sv) {
+      if (caf::holds_alternative<string_type>(x))
+        return std::make_unique<ngram_index>(std::move(x), std::move(opts));
+      VAST_WARN("{} ignores n-gram index for non-string type {}", __func__, x);
+    }
+    if (*index == "sorted"sv) {
+      if (sorted_index::supports(x))
+        return std::make_unique<sorted_index>(std::move(x), std::move(opts));
+      VAST_WARN("{} ignores sorted index for non-arithmetic type {}", __func__,
+                x);
+    }
+    if (*index == "radix"sv) {
+      if (caf::holds_alternative<address_type>(x)
+          || caf::holds_alternative<subnet_type>(x))
+        return std::make_unique<radix_index>(std::move(x), std::move(opts));
+      VAST_WARN("{} ignores radix index for non-address type {}", __func__, x);
+    }
     if (*index == "hash"sv) {
       auto i = opts.find("cardinality");
       if (i == opts.end())
@@ -14,8 +14,10 @@
 #include "vast/concept/parseable/to.hpp"
 #include "vast/concept/parseable/vast/subnet.hpp"
 #include "vast/config.hpp"
+#include "vast/defaults.hpp"
 #include "vast/detail/narrow.hpp"
 #include "vast/io/read.hpp"
+#include "vast/table_slice_compression.hpp"
 #include "vast/test/fixtures/table_slices.hpp"
 #include "vast/test/test.hpp"
 #include "vast/type.hpp"
@@ -617,6 +619,26 @@ TEST(single column - serialization) {
   CHECK_VARIANT_EQUAL(slice1, slice2);
 }
 
+TEST(single column - serialization with compression) {
+  auto t = string_type{};
+  for (auto compression : {table_slice_compression::none,
+                           table_slice_compression::lz4,
+                           table_slice_compression::zstd}) {
+    MESSAGE("serialize with " << fmt::to_string(compression));
+    REQUIRE_EQUAL(set_table_slice_compression(compression), caf::none);
+    auto slice1 = make_single_column_slice(t, "foo", "bar", "baz");
+    REQUIRE(slice1.is_serialized());
+    auto slice2 = roundtrip(slice1);
+    CHECK_VARIANT_EQUAL(slice2.at(0, 0, t), "foo"sv);
+    CHECK_VARIANT_EQUAL(slice2.at(1, 0, t), "bar"sv);
+    CHECK_VARIANT_EQUAL(slice2.at(2, 0, t), "baz"sv);
+    CHECK_VARIANT_EQUAL(slice1, slice2);
+  }
+  REQUIRE_EQUAL(set_table_slice_compression(
+                  defaults::import::table_slice_compression),
+                caf::none);
+}
+
 TEST(record batch roundtrip) {
   auto t = count_type{};
   auto slice1 = make_single_column_slice(t, 0_c, 1_c, 2_c, 3_c);
@@ -10,6 +10,9 @@
 
 #include "vast/bitmap.hpp"
 
+#include "vast/address.hpp"
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/address.hpp"
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/bitmap.hpp"
 #include "vast/ewah_bitmap.hpp"
@@ -17,10 +20,15 @@
 #include "vast/flatbuffer.hpp"
 #include "vast/ids.hpp"
 #include "vast/null_bitmap.hpp"
+#include "vast/roaring_bitmap.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/test/fixtures/events.hpp"
 #include "vast/test/test.hpp"
 
 #include <caf/test/dsl.hpp>
 
+#include <array>
+
 using namespace vast;
 using namespace std::string_literals;
 
@@ -488,6 +496,14 @@ TEST(wah_bitmap) {
 
 FIXTURE_SCOPE_END()
 
+FIXTURE_SCOPE(roaring_bitmap_tests, bitmap_test_harness<roaring_bitmap>)
+
+TEST(roaring_bitmap) {
+  execute();
+}
+
+FIXTURE_SCOPE_END()
+
 FIXTURE_SCOPE(bitmap_tests, bitmap_test_harness<bitmap>)
 
 TEST(bitmap) {
@@ -865,6 +881,37 @@ TEST(EWAH bitwise NAND) {
   CHECK(to_block_string(bm2 - bm3), str);
 }
 
+TEST(EWAH word-wise operations) {
+  auto bitmaps = std::vector{make_ewah1(), make_ewah2(), make_ewah3()};
+  bitmaps.push_back(~bitmaps[1]);
+  bitmaps.push_back(~bitmaps[2]);
+  for (const auto& x : bitmaps) {
+    for (const auto& y : bitmaps) {
+      CHECK_EQUAL(x & y, binary_and(x, y));
+      CHECK_EQUAL(x | y, binary_or(x, y));
+      CHECK_EQUAL(x ^ y, binary_xor(x, y));
+      CHECK_EQUAL(x - y, binary_nand(x, y));
+    }
+  }
+}
+
+TEST(EWAH rank and select) {
+  auto bm = make_ewah1();
+  CHECK_EQUAL(rank(bm, 9), 10u);
+  CHECK_EQUAL(rank(bm, 29), 10u);
+  CHECK_EQUAL(rank(bm, 30), 11u);
+  CHECK_EQUAL(rank<0>(bm, 29), 20u);
+  CHECK_EQUAL(select(bm, 11), 30u);
+  CHECK_EQUAL(select(bm, -1), bm.size() - 1);
+  auto n = rank(bm);
+  CHECK_EQUAL(select(bm, n), bm.size() - 1);
+  CHECK_EQUAL(select(bm, n + 1), ewah_bitmap::word_type::npos);
+  auto bm3 = make_ewah3();
+  for (auto i = 0u; i < bm3.size(); ++i)
+    if (bm3[i])
+      CHECK_EQUAL(select(bm3, rank(bm3, i)), i);
+}
+
 TEST(EWAH block append) {
   ewah_bitmap bm;
   bm.append_bits(true, 10);
@@ -915,3 +962,124 @@ TEST(EWAH RLE print 2) {
   // CHECK_EQUAL(str, "1F1T421F2T");
   CHECK_EQUAL(str, "1F1T62F320F39F2T");
 }
+
+namespace {
+
+/// Checks that a roaring bitmap and an EWAH bitmap hold the same bits.
+void check_same_bits(const roaring_bitmap& x, const ewah_bitmap& y) {
+  REQUIRE_EQUAL(x.size(), y.size());
+  CHECK_EQUAL(to_string(x), to_string(y));
+  if (!y.empty()) {
+    CHECK_EQUAL(rank(x), rank(y));
+    CHECK_EQUAL(rank<0>(x), rank<0>(y));
+    CHECK_EQUAL(select(x, -1), select(y, -1));
+  }
+}
+
+} // namespace
+
+TEST(roaring containers) {
+  using container = roaring_bitmap::container;
+  roaring_bitmap bm;
+  MESSAGE("sparse chunk");
+  for (auto i = 0u; i < 100; ++i) {
+    bm.append_bit(true);
+    bm.append_bits(false, 99);
+  }
+  MESSAGE("dense chunk");
+  bm.append_bits(false, roaring_bitmap::container_bits - bm.size());
+  for (auto i = 0u; i < roaring_bitmap::container_bits / 64; ++i)
+    bm.append_block(0xaaaaaaaaaaaaaaaa);
+  MESSAGE("full chunk");
+  bm.append_bits(true, roaring_bitmap::container_bits);
+  MESSAGE("empty chunk");
+  bm.append_bits(false, roaring_bitmap::container_bits);
+  bm.append_bit(true);
+  REQUIRE_EQUAL(bm.containers().size(), 4u);
+  CHECK(bm.containers()[0].type == container::kind::array);
+  CHECK(bm.containers()[1].type == container::kind::bitset);
+  CHECK(bm.containers()[2].type == container::kind::run);
+  CHECK_EQUAL(bm.containers()[3].key, 4u);
+  CHECK_EQUAL(rank(bm), 100u + roaring_bitmap::container_bits / 2
+                          + roaring_bitmap::container_bits + 1);
+  CHECK_EQUAL(select(bm, 101), roaring_bitmap::container_bits + 1);
+  CHECK_EQUAL(select(bm, -1), bm.size() - 1);
+  MESSAGE("runs span containers in bit ranges");
+  auto ones = roaring_bitmap{3 * roaring_bitmap::container_bits + 10, true};
+  auto ranges = size_t{0};
+  for ([[maybe_unused]] auto bits : bit_range(ones))
+    ++ranges;
+  CHECK_EQUAL(ranges, 1u);
+  CHECK_EQUAL(rank(ones), ones.size());
+  MESSAGE("complement");
+  auto flipped = ~bm;
+  CHECK_EQUAL(rank(flipped), bm.size() - rank(bm));
+  CHECK((flipped & bm).containers().empty());
+  CHECK_EQUAL(rank(flipped | bm), bm.size());
+}
+
+FIXTURE_SCOPE(roaring_bitmap_comparison_tests, fixtures::events)
+
+// Builds a bit-sliced address index over the originator addresses of a Zeek
+// conn.log with both encodings. The log is repeated to span several
+// containers.
+TEST(roaring and EWAH bitmaps on conn.log addresses) {
+  std::array<ewah_bitmap, 32> ewah_slices;
+  std::array<roaring_bitmap, 32> roaring_slices;
+  for (auto pass = 0; pass < 10; ++pass) {
+    for (auto& slice : zeek_conn_log_full) {
+      for (size_t row = 0; row < slice.rows(); ++row) {
+        // Column 2 is orig_h.
+        auto x = caf::get<view<address>>(slice.at(row, 2));
+        auto bytes = static_cast<address::byte_array>(x);
+        for (auto i = 0u; i < 4; ++i) {
+          for (auto j = 0u; j < 8; ++j) {
+            auto bit = ((bytes[i + 12] >> j) & 1) != 0;
+            ewah_slices[i * 8 + j].append_bit(bit);
+            roaring_slices[i * 8 + j].append_bit(bit);
+          }
+        }
+      }
+    }
+  }
+  REQUIRE_GREATER(roaring_slices[0].size(), roaring_bitmap::container_bits);
+  for (auto i = 0u; i < 32; ++i) {
+    check_same_bits(roaring_slices[i], ewah_slices[i]);
+    check_same_bits(~roaring_slices[i], ~ewah_slices[i]);
+    auto j = (i + 7) % 32;
+    check_same_bits(roaring_slices[i] & roaring_slices[j],
+                    ewah_slices[i] & ewah_slices[j]);
+    check_same_bits(roaring_slices[i] | roaring_slices[j],
+                    ewah_slices[i] | ewah_slices[j]);
+    check_same_bits(roaring_slices[i] ^ roaring_slices[j],
+                    ewah_slices[i] ^ ewah_slices[j]);
+    check_same_bits(roaring_slices[i] - roaring_slices[j],
+                    ewah_slices[i] - ewah_slices[j]);
+  }
+  MESSAGE("point query for 169.254.225.22");
+  auto addr = unbox(to<address>("169.254.225.22"));
+  auto bytes = static_cast<address::byte_array>(addr);
+  auto ewah_result = ewah_bitmap{ewah_slices[0].size(), true};
+  auto roaring_result = roaring_bitmap{roaring_slices[0].size(), true};
+  for (auto i = 0u; i < 4; ++i) {
+    for (auto j = 0u; j < 8; ++j) {
+      auto k = i * 8 + j;
+      if ((bytes[i + 12] >> j) & 1) {
+        ewah_result &= ewah_slices[k];
+        roaring_result &= roaring_slices[k];
+      } else {
+        ewah_result -= ewah_slices[k];
+        roaring_result -= roaring_slices[k];
+      }
+    }
+  }
+  check_same_bits(roaring_result, ewah_result);
+  CHECK_EQUAL(rank(roaring_result), rank(ewah_result));
+  MESSAGE("type-erased roaring bitmaps stay roaring");
+  auto erased = bitmap{roaring_slices[0]} & bitmap{roaring_slices[1]};
+  CHECK(caf::holds_alternative<roaring_bitmap>(erased));
+  check_same_bits(caf::get<roaring_bitmap>(erased),
+                  ewah_slices[0] & ewah_slices[1]);
+}
+
+FIXTURE_SCOPE_END()
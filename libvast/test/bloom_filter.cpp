@@ -24,6 +24,7 @@
 
 #include <cmath>
 #include <string>
+#include <vector>
 
 using namespace vast;
 using namespace si_literals;
@@ -221,3 +222,60 @@ TEST(bloom filter - duplicate tracking) {
   CHECK(x.lookup(42));
   CHECK(!x.add(42));
 }
+
+TEST(bloom filter - batched lookup) {
+  bloom_filter_parameters xs;
+  xs.n = 1_k;
+  xs.p = 0.001;
+  auto x = vast::test::unbox(make_bloom_filter<xxh64>(xs));
+  for (auto i = 0; i < 1'000; ++i)
+    x.add(i);
+  auto misses = std::vector<int>{};
+  for (auto i = 10'000; i < 10'100; ++i)
+    if (!x.lookup(i))
+      misses.push_back(i);
+  REQUIRE_GREATER(misses.size(), bloom_filter<xxh64>::batch_size);
+  CHECK(!x.lookup_any(misses.begin(), misses.end()));
+  CHECK(!x.lookup_any(misses.begin(), misses.begin()));
+  for (auto i : {0, 500, 999}) {
+    auto ys = misses;
+    ys.push_back(i);
+    CHECK(x.lookup_any(ys.begin(), ys.end()));
+    ys.insert(ys.begin(), i);
+    CHECK(x.lookup_any(ys.begin(), ys.begin() + 1));
+  }
+}
+
+TEST(bloom filter - blocked partitioning) {
+  using filter_type
+    = bloom_filter<xxh64, double_hasher, policy::partitioning::blocked>;
+  bloom_filter_parameters xs;
+  xs.n = 10_k;
+  xs.p = 0.01;
+  auto x = vast::test::unbox(
+    make_bloom_filter<xxh64, double_hasher, policy::partitioning::blocked>(xs));
+  CHECK_EQUAL(x.size() % filter_type::block_size, 0u);
+  for (auto i = 0; i < 10'000; ++i)
+    x.add(i);
+  auto num_fns = 0;
+  for (auto i = 0; i < 10'000; ++i)
+    if (!x.lookup(i))
+      ++num_fns;
+  CHECK_EQUAL(num_fns, 0);
+  MESSAGE("the false-positive rate stays close to the configured rate");
+  auto num_fps = 0;
+  for (auto i = 10'000; i < 110'000; ++i)
+    if (x.lookup(i))
+      ++num_fps;
+  CHECK_LESS(num_fps, 2'000);
+  MESSAGE("all cells of an element fall into the same block");
+  filter_type y{4 * filter_type::block_size, double_hasher<xxh64>{7}};
+  y.add(42);
+  auto blocks = std::vector<size_t>{};
+  for (size_t i = 0; i < y.size(); ++i)
+    if (y.data()[i])
+      blocks.push_back(i / filter_type::block_size);
+  REQUIRE(!blocks.empty());
+  CHECK_EQUAL(blocks.front(), blocks.back());
+  CHECK(y.lookup(42));
+}
@@ -61,3 +61,32 @@ TEST(bloom filter synopsis - wrong lookup type) {
     = synopsis.lookup(relational_operator::equal, make_data_view(integer{17}));
   CHECK_EQUAL(r2, false);
 }
+
+TEST(bloom filter synopsis - membership in list) {
+  bloom_filter_parameters xs;
+  xs.n = 1_k;
+  xs.p = 0.001;
+  auto bf = unbox(make_bloom_filter<xxh64>(std::move(xs)));
+  bloom_filter_synopsis<integer, xxh64> x{type{integer_type{}}, std::move(bf)};
+  for (auto i = 0; i < 100; ++i)
+    x.add(make_data_view(integer{i}));
+  auto lookup = [&](const list& xs) {
+    return x.lookup(relational_operator::in, make_data_view(xs));
+  };
+  MESSAGE("lists that span multiple batches");
+  auto misses = list{};
+  for (auto i = 1'000; i < 1'040; ++i)
+    misses.emplace_back(integer{i});
+  CHECK_EQUAL(lookup(misses), false);
+  auto hits = misses;
+  hits.emplace_back(integer{42});
+  CHECK_EQUAL(lookup(hits), true);
+  MESSAGE("elements of other types never match");
+  CHECK_EQUAL(lookup(list{"foo", count{42}}), false);
+  CHECK_EQUAL(lookup(list{"foo", integer{42}}), true);
+  CHECK_EQUAL(lookup(list{}), false);
+  MESSAGE("nil makes the result unknown unless another element hits");
+  CHECK_EQUAL(lookup(list{integer{42}, caf::none}), true);
+  CHECK_EQUAL(lookup(list{caf::none, integer{42}}), true);
+  CHECK_EQUAL(lookup(list{integer{1'000}, caf::none}), std::nullopt);
+}
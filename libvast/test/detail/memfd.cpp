@@ -0,0 +1,65 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE memfd
+
+#include "vast/detail/memfd.hpp"
+
+#include "vast/chunk.hpp"
+#include "vast/config.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/test/fixtures/events.hpp"
+#include "vast/test/test.hpp"
+
+#include <sys/mman.h>
+
+#include <cstring>
+#include <string_view>
+#include <unistd.h>
+
+using namespace vast;
+using namespace vast::detail;
+
+#if VAST_LINUX
+
+FIXTURE_SCOPE(memfd_tests, fixtures::events)
+
+TEST(roundtrip bytes) {
+  const auto str = std::string_view{"foobarbaz"};
+  const auto bytes = std::as_bytes(std::span{str.data(), str.size()});
+  auto fd = unbox(make_sealed_memfd("test", bytes));
+  auto chunk = unbox(map_sealed_memfd(fd));
+  REQUIRE_EQUAL(chunk->size(), str.size());
+  CHECK(std::memcmp(chunk->data(), str.data(), str.size()) == 0);
+  MESSAGE("the file is no longer writable");
+  fd = unbox(make_sealed_memfd("test", bytes));
+  CHECK_EQUAL(::write(fd, "x", 1), -1);
+  ::close(fd);
+}
+
+TEST(reject unsealed files) {
+  auto fd = ::memfd_create("test", MFD_CLOEXEC);
+  REQUIRE(fd >= 0);
+  REQUIRE_EQUAL(::write(fd, "x", 1), 1);
+  CHECK(!map_sealed_memfd(fd));
+}
+
+TEST(roundtrip table slice) {
+  const auto& slice = zeek_conn_log[0];
+  REQUIRE(slice.is_serialized());
+  auto fd = unbox(make_sealed_memfd("test", as_bytes(slice)));
+  auto chunk = unbox(map_sealed_memfd(fd));
+  auto copy = table_slice{std::move(chunk), table_slice::verify::yes};
+  REQUIRE_NOT_EQUAL(copy.encoding(), table_slice_encoding::none);
+  copy.offset(slice.offset());
+  CHECK_EQUAL(copy, slice);
+}
+
+FIXTURE_SCOPE_END()
+
+#endif // VAST_LINUX
@@ -0,0 +1,130 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE regex
+
+#include "vast/detail/regex.hpp"
+
+#include "vast/error.hpp"
+#include "vast/test/test.hpp"
+
+#include <chrono>
+#include <regex>
+#include <string>
+#include <vector>
+
+using namespace vast;
+using namespace std::string_literals;
+
+TEST(literals and wildcards take the glob fast path) {
+  auto rx = unbox(detail::regex::make("foo.*b?ar.*"));
+  CHECK(!rx.is_glob());
+  rx = unbox(detail::regex::make(".*\\.example\\.com"));
+  CHECK(rx.is_glob());
+  CHECK(rx.match("www.example.com"));
+  CHECK(!rx.match("www.example.org"));
+  CHECK(rx.search("https://www.example.com/"));
+  rx = unbox(detail::regex::make("a.c.*d"));
+  CHECK(rx.is_glob());
+  CHECK(rx.match("abcd"));
+  CHECK(rx.match("abcxxd"));
+  CHECK(!rx.match("a\ncd"));
+  CHECK(!rx.match("abc"));
+  CHECK(rx.search("xxabcdxx"));
+  CHECK(!rx.search("ab\ncd"));
+}
+
+TEST(other expressions run as DFA) {
+  auto rx = unbox(detail::regex::make("^(GET|POST) /[a-z]+\\?id=\\d{1,4}$"));
+  CHECK(rx.is_dfa());
+  CHECK(rx.match("GET /index?id=42"));
+  CHECK(!rx.match("PUT /index?id=42"));
+  CHECK(!rx.match("GET /index?id=12345"));
+  CHECK(rx.search("POST /x?id=1"));
+  CHECK(!rx.search(" POST /x?id=1"));
+}
+
+TEST(large automata fall back to NFA simulation) {
+  // The search DFA of a bounded repetition of wildcards tracks the positions
+  // of all preceding 'a's, so its states grow too large.
+  const auto start = std::chrono::steady_clock::now();
+  auto rx = unbox(detail::regex::make("a.{0,999}b"));
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  CHECK(!rx.is_dfa());
+  CHECK_LESS(
+    std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(),
+    1'000);
+  const auto expected = std::regex{"a.{0,999}b"};
+  auto inputs = std::vector<std::string>{
+    "ab",
+    "axb",
+    "xxaxxxb",
+    "a" + std::string(999, 'x') + "b",
+    "a" + std::string(1'000, 'x') + "b",
+    "b" + std::string(200, 'a'),
+    "",
+  };
+  for (const auto& input : inputs) {
+    CHECK_EQUAL(rx.match(input), std::regex_match(input, expected));
+    CHECK_EQUAL(rx.search(input), std::regex_search(input, expected));
+  }
+}
+
+TEST(literal prefix) {
+  CHECK_EQUAL(unbox(detail::regex::make("Mozilla/5\\.0 .*")).prefix(),
+              "Mozilla/5.0 ");
+  CHECK_EQUAL(unbox(detail::regex::make("^ab{2}c?d")).prefix(), "abb");
+  CHECK_EQUAL(unbox(detail::regex::make("(foo)+bar")).prefix(), "foo");
+  CHECK_EQUAL(unbox(detail::regex::make("foo|bar")).prefix(), "");
+}
+
+TEST(required literals) {
+  using strings = std::vector<std::string>;
+  CHECK_EQUAL(unbox(detail::regex::make(".*foo.ba.*baz")).literals(),
+              (strings{"foo", "ba", "baz"}));
+  CHECK_EQUAL(unbox(detail::regex::make("^ab{2}c?d")).literals(),
+              strings{"abb"});
+  CHECK_EQUAL(unbox(detail::regex::make("foo|bar")).literals(), strings{});
+}
+
+TEST(unsupported features) {
+  auto unsupported = [](std::string_view str) {
+    auto rx = detail::regex::make(str);
+    return !rx && rx.error() == ec::unimplemented;
+  };
+  CHECK(unsupported("(a)\\1"));
+  CHECK(unsupported("\\bfoo"));
+  CHECK(unsupported("foo(?=bar)"));
+  CHECK(unsupported("[[:alpha:]]"));
+  auto invalid = detail::regex::make("(foo");
+  REQUIRE(!invalid);
+  CHECK_EQUAL(invalid.error(), ec::parse_error);
+}
+
+TEST(equivalence with std::regex) {
+  auto patterns = std::vector<std::string>{
+    "",         "a",          "a*",        "a+b?",     "(a|b)*abb",
+    "^a|b$",    "[^a-c]x",    "\\d+\\.\\d+", ".",      "a.c",
+    "(ab){2,}", "x{0,2}y",    "\\s\\S\\w", "$^",       "(a|)+$",
+    "[-.]a",    "(?:ab|a)bc", "a\\n",      "[\\d\\-]", "\\x41|\\.",
+  };
+  auto inputs = std::vector<std::string>{
+    "",      "a",      "b",    "ab",      "abb",      "aabb", "babb",
+    "1.5",   "x1.25y", "abc",  "ababab",  "xy",       "xxy",  "xxxy",
+    " a_",   "\n",     "a\n",  "-a",      ".a",       "abbc", "dx",
+    "A",     ".",      "9-",   "abababb", "a\nb\nc",
+  };
+  for (const auto& pattern : patterns) {
+    auto rx = unbox(detail::regex::make(pattern));
+    auto expected = std::regex{pattern};
+    for (const auto& input : inputs) {
+      CHECK_EQUAL(rx.match(input), std::regex_match(input, expected));
+      CHECK_EQUAL(rx.search(input), std::regex_search(input, expected));
+    }
+  }
+}
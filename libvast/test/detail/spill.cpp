@@ -0,0 +1,38 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE spill
+
+#include "vast/detail/spill.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <filesystem>
+
+using namespace vast;
+using namespace std::string_literals;
+
+TEST(memory budget) {
+  CHECK_EQUAL(unbox(detail::parse_memory_budget(data{count{42}})), 42u);
+  CHECK_EQUAL(unbox(detail::parse_memory_budget(data{integer{42}})), 42u);
+  CHECK_EQUAL(unbox(detail::parse_memory_budget(data{"1 KiB"s})), 1'024u);
+  CHECK(!detail::parse_memory_budget(data{integer{-1}}));
+  CHECK(!detail::parse_memory_budget(data{"lots"s}));
+  CHECK(!detail::parse_memory_budget(data{true}));
+}
+
+TEST(spill directory) {
+  CHECK(unbox(detail::parse_spill_directory(data{"/tmp/vast"s}))
+        == std::filesystem::path{"/tmp/vast"});
+  CHECK(!detail::parse_spill_directory(data{count{42}}));
+  const auto parent = std::filesystem::temp_directory_path();
+  const auto directory = unbox(detail::make_spill_directory(parent, "test"));
+  CHECK(directory.filename().string().starts_with("vast-test-"));
+  CHECK(std::filesystem::is_directory(directory));
+  std::filesystem::remove_all(directory);
+}
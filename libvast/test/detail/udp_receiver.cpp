@@ -0,0 +1,97 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE udp_receiver
+
+#include "vast/detail/udp_receiver.hpp"
+
+#include "vast/detail/line_range.hpp"
+#include "vast/test/test.hpp"
+
+#include <arpa/inet.h>
+#include <fmt/format.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+using namespace vast;
+using namespace vast::detail;
+
+namespace {
+
+void send_datagrams(uint16_t port, const std::vector<std::string>& xs) {
+  auto fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+  REQUIRE(fd >= 0);
+  auto addr = ::sockaddr_in{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  REQUIRE_EQUAL(::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr), 1);
+  for (const auto& x : xs)
+    REQUIRE(::sendto(fd, x.data(), x.size(), 0,
+                     reinterpret_cast<::sockaddr*>(&addr), sizeof(addr))
+            >= 0);
+  ::close(fd);
+}
+
+} // namespace
+
+TEST(receive lines from multiple sockets) {
+  auto receiver = unbox(udp_receiver::make({
+    .host = "127.0.0.1",
+    .port = 0,
+    .receivers = 2,
+    .batch_size = 8,
+  }));
+  REQUIRE_NOT_EQUAL(receiver->port(), 0u);
+  auto xs = std::vector<std::string>{};
+  for (auto i = 0; i < 100; ++i)
+    xs.push_back(fmt::format("<13>message {}{}", i, i % 2 == 0 ? "\n" : ""));
+  send_datagrams(receiver->port(), xs);
+  auto in = make_udp_input_stream(receiver);
+  auto lines = line_range{*in};
+  auto num_lines = size_t{0};
+  while (num_lines < xs.size()) {
+    if (lines.next_timeout(1s))
+      break;
+    if (!lines.get().empty())
+      ++num_lines;
+  }
+  CHECK_EQUAL(num_lines, xs.size());
+  auto stats = receiver->stats();
+  CHECK_EQUAL(stats.datagrams, xs.size());
+  CHECK_EQUAL(stats.dropped, 0u);
+  MESSAGE("reads time out without input");
+  CHECK(lines.next_timeout(10ms));
+  MESSAGE("stopping the receiver ends the input");
+  receiver->stop();
+  CHECK(!lines.next_timeout(10ms));
+  CHECK(lines.done());
+}
+
+TEST(drop datagrams exceeding the buffer) {
+  auto receiver = unbox(udp_receiver::make({
+    .host = "127.0.0.1",
+    .max_buffered_bytes = 16,
+  }));
+  send_datagrams(receiver->port(), {"0123456789", "0123456789", "0123456789"});
+  auto arrived = [&] {
+    auto stats = receiver->stats();
+    return stats.datagrams + stats.dropped == 3;
+  };
+  for (auto i = 0; i < 100 && !arrived(); ++i)
+    std::this_thread::sleep_for(10ms);
+  CHECK_EQUAL(receiver->stats().datagrams, 1u);
+  CHECK_EQUAL(receiver->stats().dropped, 2u);
+  auto buffer = std::string{};
+  REQUIRE(receiver->receive(buffer, 1s));
+  CHECK_EQUAL(buffer, "0123456789\n");
+}
@@ -0,0 +1,40 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE worker_pool
+
+#include "vast/detail/worker_pool.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <atomic>
+#include <vector>
+
+using namespace vast;
+
+TEST(worker pool) {
+  auto pool = detail::worker_pool{4};
+  CHECK_EQUAL(pool.size(), 4u);
+  MESSAGE("every loop runs every iteration once");
+  for (size_t n : {0u, 1u, 3u, 100u}) {
+    auto counts = std::vector<std::atomic<size_t>>(n);
+    pool.run(n, [&](size_t i) {
+      ++counts[i];
+    });
+    for (const auto& count : counts)
+      CHECK_EQUAL(count.load(), 1u);
+  }
+  MESSAGE("nested loops run on the calling thread");
+  auto sum = std::atomic<size_t>{0};
+  pool.run(8, [&](size_t i) {
+    pool.run(i, [&](size_t j) {
+      sum += j;
+    });
+  });
+  CHECK_EQUAL(sum.load(), 56u);
+}
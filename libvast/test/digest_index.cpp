@@ -0,0 +1,172 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE digest_index
+
+#include "vast/digest_index.hpp"
+
+#include "vast/address.hpp"
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/address.hpp"
+#include "vast/data.hpp"
+#include "vast/test/test.hpp"
+
+#include <algorithm>
+#include <array>
+
+using namespace vast;
+
+namespace {
+
+struct fixture {
+  fixture() {
+    for (auto& id : ids)
+      id = uuid::random();
+    std::sort(ids.begin(), ids.end());
+  }
+
+  static uint64_t digest_of(std::string_view x) {
+    return unbox(digest(make_data_view(x), scope()));
+  }
+
+  static uint64_t scope() {
+    return digest_scope(qualified_record_field{"test", "x",
+                                               type{string_type{}}});
+  }
+
+  static partition_digests make(std::vector<std::string_view> xs) {
+    auto result = partition_digests{};
+    for (auto x : xs)
+      result.digests.push_back(digest_of(x));
+    result.fields.emplace_back("test", "x", type{string_type{}});
+    result.types.emplace_back(string_type{});
+    return result;
+  }
+
+  std::array<uuid, 4> ids;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(digest_index_tests, fixture)
+
+TEST(digest) {
+  auto foo = make_data_view("foo");
+  CHECK(digest(foo, scope()));
+  CHECK_EQUAL(digest(foo, scope()), digest(foo, scope()));
+  CHECK_NOT_EQUAL(digest(foo, scope()), digest(make_data_view("bar"), scope()));
+  auto addr = unbox(to<address>("10.0.0.1"));
+  CHECK(digest(make_data_view(addr), scope()));
+  CHECK_EQUAL(digest(make_data_view(integer{42}), scope()), std::nullopt);
+  MESSAGE("the same value has different digests in different scopes");
+  auto other = qualified_record_field{"test", "y", type{string_type{}}};
+  CHECK_NOT_EQUAL(digest(foo, scope()), digest(foo, digest_scope(other)));
+  CHECK_NOT_EQUAL(digest(foo, scope()),
+                  digest(foo, digest_scope(type{string_type{}})));
+}
+
+TEST(lookup) {
+  auto idx = digest_index{};
+  idx.add(ids[0], make({"foo", "bar"}));
+  idx.add(ids[1], make({"bar", "baz", "bar"}));
+  idx.add(ids[2], make({}));
+  CHECK_EQUAL(idx.size(), 3u);
+  using uuids = std::vector<uuid>;
+  CHECK_EQUAL(idx.lookup({digest_of("foo")}), (uuids{ids[0]}));
+  CHECK_EQUAL(idx.lookup({digest_of("bar")}), (uuids{ids[0], ids[1]}));
+  CHECK_EQUAL(idx.lookup({digest_of("baz"), digest_of("foo")}),
+              (uuids{ids[0], ids[1]}));
+  CHECK_EQUAL(idx.lookup({digest_of("qux")}), uuids{});
+  CHECK_EQUAL(idx.lookup({}), uuids{});
+  MESSAGE("coverage");
+  auto field = qualified_record_field{"test", "x", type{string_type{}}};
+  auto other = qualified_record_field{"test", "y", type{string_type{}}};
+  CHECK(idx.covers(ids[2], field));
+  CHECK(!idx.covers(ids[2], other));
+  CHECK(idx.covers(ids[2], type{string_type{}}));
+  CHECK(!idx.covers(ids[2], type{address_type{}}));
+  CHECK(!idx.covers(uuid::nil(), field));
+}
+
+TEST(lookup predicates) {
+  auto idx = digest_index{};
+  idx.add(ids[0], make({"foo"}));
+  idx.add(ids[1], make({"bar"}));
+  using uuids = std::vector<uuid>;
+  auto lookup = [&](relational_operator op, const data& rhs) {
+    return idx.lookup(op, make_view(rhs), scope());
+  };
+  CHECK_EQUAL(lookup(relational_operator::equal, "foo"), uuids{ids[0]});
+  CHECK_EQUAL(lookup(relational_operator::equal, integer{42}), uuids{});
+  CHECK_EQUAL(lookup(relational_operator::in, list{"foo", "bar"}),
+              (uuids{ids[0], ids[1]}));
+  CHECK_EQUAL(lookup(relational_operator::in, list{integer{42}, "bar"}),
+              uuids{ids[1]});
+  MESSAGE("nil and unsupported predicates yield no answer");
+  CHECK_EQUAL(lookup(relational_operator::equal, caf::none), std::nullopt);
+  CHECK_EQUAL(lookup(relational_operator::in, list{"foo", caf::none}),
+              std::nullopt);
+  CHECK_EQUAL(lookup(relational_operator::in, "foo"), std::nullopt);
+  CHECK_EQUAL(lookup(relational_operator::ni, "foo"), std::nullopt);
+  CHECK_EQUAL(lookup(relational_operator::not_equal, "foo"), std::nullopt);
+  MESSAGE("values only match in the scope they occur in");
+  auto other = qualified_record_field{"test", "y", type{string_type{}}};
+  CHECK_EQUAL(idx.lookup(relational_operator::equal, make_data_view("foo"),
+                         digest_scope(other)),
+              uuids{});
+}
+
+TEST(erase and reuse) {
+  auto idx = digest_index{};
+  idx.add(ids[0], make({"foo"}));
+  idx.add(ids[1], make({"foo", "bar"}));
+  using uuids = std::vector<uuid>;
+  idx.erase(ids[0]);
+  CHECK_EQUAL(idx.size(), 1u);
+  CHECK_EQUAL(idx.lookup({digest_of("foo")}), uuids{ids[1]});
+  CHECK(!idx.covers(ids[0], type{string_type{}}));
+  MESSAGE("new partitions reuse the slots of erased ones");
+  idx.add(ids[2], make({"bar"}));
+  CHECK_EQUAL(idx.lookup({digest_of("bar")}), (uuids{ids[1], ids[2]}));
+  CHECK_EQUAL(idx.lookup({digest_of("foo")}), uuids{ids[1]});
+  MESSAGE("adding a partition again replaces its digests");
+  idx.add(ids[1], make({"baz"}));
+  CHECK_EQUAL(idx.lookup({digest_of("foo")}), uuids{});
+  CHECK_EQUAL(idx.lookup({digest_of("baz")}), uuids{ids[1]});
+  MESSAGE("partitions without covered synopses are not indexed");
+  auto digests = make({"qux"});
+  digests.fields.clear();
+  digests.types.clear();
+  idx.add(ids[0], std::move(digests));
+  CHECK_EQUAL(idx.size(), 2u);
+  CHECK_EQUAL(idx.lookup({digest_of("qux")}), uuids{});
+  CHECK_GREATER(idx.memusage(), 0u);
+}
+
+TEST(capacity) {
+  auto idx = digest_index{3};
+  idx.add(ids[0], make({"foo", "bar"}));
+  idx.add(ids[1], make({"baz"}));
+  CHECK_EQUAL(idx.num_digests(), 3u);
+  MESSAGE("new partitions evict the ones that the index received first");
+  idx.add(ids[2], make({"foo", "qux"}));
+  using uuids = std::vector<uuid>;
+  CHECK_EQUAL(idx.size(), 2u);
+  CHECK_EQUAL(idx.num_digests(), 3u);
+  CHECK(!idx.covers(ids[0], type{string_type{}}));
+  CHECK_EQUAL(idx.lookup({digest_of("foo")}), uuids{ids[2]});
+  CHECK_EQUAL(idx.lookup({digest_of("bar")}), uuids{});
+  CHECK_EQUAL(idx.lookup({digest_of("baz")}), uuids{ids[1]});
+  MESSAGE("partitions that exceed the capacity are not added");
+  idx.add(ids[3], make({"a", "b", "c", "d"}));
+  CHECK_EQUAL(idx.size(), 2u);
+  CHECK(!idx.covers(ids[3], type{string_type{}}));
+  CHECK(idx.covers(ids[1], type{string_type{}}));
+}
+
+FIXTURE_SCOPE_END()
@@ -95,6 +95,20 @@ TEST(evaluation - field extractor - service + orig_h) {
   REQUIRE_EQUAL(rank(ids), 2u);
 }
 
+TEST(evaluation - field extractor - service + pattern) {
+  // head -n 108 conn.log | awk '$8 == "dns"' | wc -l
+  auto ids = evaluate(make_conn_expr("service == /d.s/"), zeek_conn_log_slice,
+                      {});
+  CHECK_EQUAL(rank(ids), 35u);
+  // Null values only qualify for negated operators.
+  ids = evaluate(make_conn_expr("service != /d.s/"), zeek_conn_log_slice, {});
+  CHECK_EQUAL(rank(ids), 65u);
+  ids = evaluate(make_conn_expr("service in /t+p/"), zeek_conn_log_slice, {});
+  CHECK_EQUAL(rank(ids), 13u);
+  ids = evaluate(make_conn_expr("service !in /t+p/"), zeek_conn_log_slice, {});
+  CHECK_EQUAL(rank(ids), 87u);
+}
+
 TEST(evaluation - field extractor - nonexistent field) {
   auto expr = make_conn_expr("devnull != nil");
   auto ids = evaluate(expr, zeek_conn_log_slice, {});
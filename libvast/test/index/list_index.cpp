@@ -14,9 +14,12 @@
 #include "vast/concept/printable/vast/bitmap.hpp"
 #include "vast/detail/legacy_deserialize.hpp"
 #include "vast/detail/serialize.hpp"
+#include "vast/fbs/value_index.hpp"
+#include "vast/flatbuffer.hpp"
 #include "vast/test/test.hpp"
 #include "vast/value_index_factory.hpp"
 
+#include <arrow/api.h>
 #include <caf/test/dsl.hpp>
 
 using namespace vast;
@@ -71,6 +74,71 @@ TEST(list) {
   CHECK_EQUAL(
     to_string(*idx2.lookup(relational_operator::ni, make_data_view(x))), "11000"
                                                                          "000");
+  MESSAGE("flatbuffers roundtrip");
+  auto idx3 = factory<value_index>::make(container_type, caf::settings{});
+  REQUIRE(idx3);
+  REQUIRE(idx3->append(make_data_view(list{"foo", "bar"})));
+  REQUIRE(idx3->append(make_data_view(list{"baz"}), 3));
+  auto builder = flatbuffers::FlatBufferBuilder{};
+  builder.Finish(pack(builder, idx3));
+  auto maybe_fb = flatbuffer<fbs::ValueIndex>::make(builder.Release());
+  REQUIRE_NOERROR(maybe_fb);
+  auto fb = *maybe_fb;
+  REQUIRE(fb);
+  auto idx4 = value_index_ptr{};
+  REQUIRE_EQUAL(unpack(*fb, idx4), caf::none);
+  REQUIRE(dynamic_cast<list_index*>(idx4.get()) != nullptr);
+  x = "baz";
+  CHECK_EQUAL(
+    to_string(*idx4->lookup(relational_operator::ni, make_data_view(x))),
+    "0001");
+  CHECK_EQUAL(
+    to_string(*idx4->lookup(relational_operator::not_ni, make_data_view(x))),
+    "1000");
+}
+
+TEST(list - arrow) {
+  auto container_type = type{list_type{string_type{}}};
+  auto value_builder = std::make_shared<arrow::StringBuilder>();
+  auto builder
+    = arrow::ListBuilder{arrow::default_memory_pool(), value_builder};
+  auto append = [&](const std::vector<std::string>& xs) {
+    REQUIRE(builder.Append().ok());
+    for (const auto& x : xs)
+      REQUIRE(value_builder->Append(x).ok());
+  };
+  append({"foo", "bar"});
+  append({});
+  REQUIRE(builder.AppendNull().ok());
+  append({"bar", "baz", "foo"});
+  append({"qux"});
+  auto array = std::shared_ptr<arrow::Array>{};
+  REQUIRE(builder.Finish(&array).ok());
+  MESSAGE("bulk append");
+  list_index idx{container_type};
+  REQUIRE(idx.append(*array, 0));
+  auto lookup = [](const list_index& idx, relational_operator op,
+                   std::string x) {
+    return to_string(unbox(idx.lookup(op, make_data_view(x))));
+  };
+  CHECK_EQUAL(lookup(idx, relational_operator::ni, "foo"), "10010");
+  CHECK_EQUAL(lookup(idx, relational_operator::ni, "baz"), "00010");
+  CHECK_EQUAL(lookup(idx, relational_operator::ni, "qux"), "00001");
+  CHECK_EQUAL(lookup(idx, relational_operator::not_ni, "foo"), "01001");
+  MESSAGE("bulk append equals appending row by row");
+  list_index idx2{container_type};
+  REQUIRE(idx2.append(make_data_view(list{"foo", "bar"}), 0));
+  REQUIRE(idx2.append(make_data_view(list{}), 1));
+  REQUIRE(idx2.append(make_data_view(list{"bar", "baz", "foo"}), 3));
+  REQUIRE(idx2.append(make_data_view(list{"qux"}), 4));
+  for (auto x : {"foo", "bar", "baz", "qux", "corge"})
+    CHECK_EQUAL(lookup(idx, relational_operator::ni, x),
+                lookup(idx2, relational_operator::ni, x));
+  MESSAGE("sliced arrays");
+  list_index idx3{container_type};
+  REQUIRE(idx3.append(*array->Slice(3, 2), 10));
+  CHECK_EQUAL(lookup(idx3, relational_operator::ni, "foo"), "000000000010");
+  CHECK_EQUAL(lookup(idx3, relational_operator::ni, "qux"), "000000000001");
 }
 
 FIXTURE_SCOPE_END()
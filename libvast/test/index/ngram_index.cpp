@@ -0,0 +1,133 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE value_index
+
+#include "vast/index/ngram_index.hpp"
+
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/bitmap.hpp"
+#include "vast/detail/legacy_deserialize.hpp"
+#include "vast/detail/serialize.hpp"
+#include "vast/fbs/value_index.hpp"
+#include "vast/flatbuffer.hpp"
+#include "vast/pattern.hpp"
+#include "vast/test/test.hpp"
+#include "vast/value_index_factory.hpp"
+
+using namespace vast;
+using namespace std::string_literals;
+
+namespace {
+
+struct fixture {
+  fixture() {
+    factory<value_index>::initialize();
+    auto t = type{string_type{}, {{"index", "ngram"}}};
+    idx = factory<value_index>::make(t, caf::settings{});
+    REQUIRE(idx != nullptr);
+    REQUIRE(dynamic_cast<ngram_index*>(idx.get()) != nullptr);
+    for (auto str : {
+           "http://example.com/index.html",
+           "https://vast.io/docs",
+           "foo",
+           "",
+           "example",
+           "xx",
+           "/usr/bin/curl -o /tmp/x http://evil.example.org",
+         })
+      REQUIRE(idx->append(make_data_view(str)));
+  }
+
+  std::string lookup(relational_operator op, data_view x) {
+    return to_string(unbox(idx->lookup(op, x)));
+  }
+
+  value_index_ptr idx;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(ngram_index_tests, fixture)
+
+TEST(ngram index - substring) {
+  CHECK_EQUAL(lookup(relational_operator::ni, make_data_view("example")),
+              "1000101");
+  CHECK_EQUAL(lookup(relational_operator::ni, make_data_view("docs")),
+              "0100000");
+  CHECK_EQUAL(lookup(relational_operator::ni, make_data_view("zzz")),
+              "0000000");
+  MESSAGE("needles shorter than a trigram only constrain the length");
+  CHECK_EQUAL(lookup(relational_operator::ni, make_data_view("xx")),
+              "1110111");
+  CHECK_EQUAL(lookup(relational_operator::ni, make_data_view("")), "1111111");
+  MESSAGE("negations leave all candidates to the store");
+  CHECK_EQUAL(lookup(relational_operator::not_ni, make_data_view("example")),
+              "1111111");
+}
+
+TEST(ngram index - equality) {
+  CHECK_EQUAL(lookup(relational_operator::equal, make_data_view("foo")),
+              "0010000");
+  CHECK_EQUAL(lookup(relational_operator::equal, make_data_view("example")),
+              "0000100");
+  CHECK_EQUAL(lookup(relational_operator::equal, make_data_view("xx")),
+              "0000010");
+  CHECK_EQUAL(lookup(relational_operator::equal, make_data_view("")),
+              "0001000");
+  CHECK_EQUAL(lookup(relational_operator::not_equal, make_data_view("foo")),
+              "1111111");
+  auto xs = list{"foo", "xx"};
+  CHECK_EQUAL(lookup(relational_operator::in, make_data_view(xs)), "0010010");
+  auto result = idx->lookup(relational_operator::match, make_data_view("foo"));
+  REQUIRE(!result);
+  CHECK(result.error() == ec::unsupported_operator);
+}
+
+TEST(ngram index - pattern) {
+  auto glob = pattern{".*example\\..*"};
+  CHECK_EQUAL(lookup(relational_operator::match, make_data_view(glob)),
+              "1000001");
+  MESSAGE("the literal prefix yields candidates that need verification");
+  auto url = pattern{"^https?://.*"};
+  CHECK_EQUAL(lookup(relational_operator::match, make_data_view(url)),
+              "1100001");
+  CHECK_EQUAL(lookup(relational_operator::in, make_data_view(url)), "1100001");
+  CHECK_EQUAL(lookup(relational_operator::not_match, make_data_view(url)),
+              "1111111");
+  MESSAGE("patterns without literals match everything");
+  auto backref = pattern{"(a)\\1"};
+  CHECK_EQUAL(lookup(relational_operator::match, make_data_view(backref)),
+              "1111111");
+}
+
+TEST(ngram index - serialization) {
+  auto builder = flatbuffers::FlatBufferBuilder{};
+  const auto idx_offset = pack(builder, idx);
+  builder.Finish(idx_offset);
+  auto maybe_fb = flatbuffer<fbs::ValueIndex>::make(builder.Release());
+  REQUIRE_NOERROR(maybe_fb);
+  auto fb = *maybe_fb;
+  REQUIRE(fb);
+  auto idx2 = value_index_ptr{};
+  REQUIRE_EQUAL(unpack(*fb, idx2), caf::none);
+  CHECK_EQUAL(idx->type(), idx2->type());
+  CHECK(dynamic_cast<ngram_index*>(idx2.get()) != nullptr);
+  auto result
+    = idx2->lookup(relational_operator::ni, make_data_view("example"));
+  CHECK_EQUAL(to_string(unbox(result)), "1000101");
+  MESSAGE("legacy serialization");
+  std::vector<char> buf;
+  CHECK_EQUAL(detail::serialize(buf, *idx), caf::none);
+  auto idx3 = ngram_index{type{string_type{}}};
+  CHECK_EQUAL(detail::legacy_deserialize(buf, idx3), true);
+  result = idx3.lookup(relational_operator::equal, make_data_view("foo"));
+  CHECK_EQUAL(to_string(unbox(result)), "0010000");
+}
+
+FIXTURE_SCOPE_END()
@@ -0,0 +1,169 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE value_index
+
+#include "vast/index/radix_index.hpp"
+
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/address.hpp"
+#include "vast/concept/parseable/vast/subnet.hpp"
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/bitmap.hpp"
+#include "vast/detail/legacy_deserialize.hpp"
+#include "vast/detail/serialize.hpp"
+#include "vast/fbs/value_index.hpp"
+#include "vast/flatbuffer.hpp"
+#include "vast/test/test.hpp"
+#include "vast/value_index_factory.hpp"
+
+#include <random>
+
+using namespace vast;
+using namespace std::string_literals;
+
+namespace {
+
+struct fixture {
+  fixture() {
+    factory<value_index>::initialize();
+  }
+
+  static value_index_ptr make(type t) {
+    auto result = factory<value_index>::make(
+      type{std::move(t), {{"index", "radix"}}}, caf::settings{});
+    REQUIRE(result != nullptr);
+    REQUIRE(dynamic_cast<radix_index*>(result.get()) != nullptr);
+    return result;
+  }
+
+  template <class T>
+  static std::string
+  lookup(const value_index& idx, relational_operator op, std::string_view x) {
+    return to_string(unbox(idx.lookup(op, make_data_view(unbox(to<T>(x))))));
+  }
+};
+
+} // namespace
+
+FIXTURE_SCOPE(radix_index_tests, fixture)
+
+TEST(radix index - address) {
+  auto idx = make(type{address_type{}});
+  for (auto x : {"10.0.0.1", "10.0.0.2", "192.168.1.1", "::1", "10.0.0.1",
+                 "10.1.2.3"})
+    REQUIRE(idx->append(make_data_view(unbox(to<address>(x)))));
+  using op = relational_operator;
+  MESSAGE("subnet containment");
+  CHECK_EQUAL(lookup<subnet>(*idx, op::in, "10.0.0.0/8"), "110011");
+  CHECK_EQUAL(lookup<subnet>(*idx, op::in, "10.0.0.0/30"), "110010");
+  CHECK_EQUAL(lookup<subnet>(*idx, op::in, "10.0.0.1/32"), "100010");
+  CHECK_EQUAL(lookup<subnet>(*idx, op::in, "172.16.0.0/12"), "000000");
+  CHECK_EQUAL(lookup<subnet>(*idx, op::in, "0.0.0.0/0"), "111011");
+  CHECK_EQUAL(lookup<subnet>(*idx, op::in, "::/112"), "000100");
+  CHECK_EQUAL(lookup<subnet>(*idx, op::in, "::/0"), "111111");
+  CHECK_EQUAL(lookup<subnet>(*idx, op::not_in, "10.0.0.0/8"), "001100");
+  MESSAGE("equality");
+  CHECK_EQUAL(lookup<address>(*idx, op::equal, "10.0.0.1"), "100010");
+  CHECK_EQUAL(lookup<address>(*idx, op::equal, "10.0.0.3"), "000000");
+  CHECK_EQUAL(lookup<address>(*idx, op::not_equal, "10.0.0.1"), "011101");
+  MESSAGE("membership uses the container lookup");
+  auto xs = list{unbox(to<address>("::1")), unbox(to<address>("10.1.2.3"))};
+  CHECK_EQUAL(to_string(unbox(idx->lookup(op::in, make_view(xs)))), "000101");
+  MESSAGE("unsupported operators");
+  CHECK(!idx->lookup(op::ni, make_data_view(unbox(to<address>("10.0.0.1")))));
+  CHECK(!idx->lookup(op::equal, make_data_view(unbox(to<subnet>("::/0")))));
+  CHECK(!idx->lookup(op::equal, make_data_view("foo")));
+}
+
+TEST(radix index - subnet) {
+  auto idx = radix_index{type{subnet_type{}}};
+  for (auto x : {"10.0.0.0/8", "10.1.0.0/16", "192.168.0.0/24", "10.1.0.0/16",
+                 "fe80::/10", "0.0.0.0/0"})
+    REQUIRE(idx.append(make_data_view(unbox(to<subnet>(x)))));
+  using op = relational_operator;
+  MESSAGE("subnets that contain an address");
+  CHECK_EQUAL(lookup<address>(idx, op::ni, "10.1.2.3"), "110101");
+  CHECK_EQUAL(lookup<address>(idx, op::ni, "10.2.0.0"), "100001");
+  CHECK_EQUAL(lookup<address>(idx, op::ni, "192.168.0.7"), "001001");
+  CHECK_EQUAL(lookup<address>(idx, op::ni, "8.8.8.8"), "000001");
+  CHECK_EQUAL(lookup<address>(idx, op::ni, "fe80::1"), "000010");
+  CHECK_EQUAL(lookup<address>(idx, op::ni, "2001:db8::1"), "000000");
+  CHECK_EQUAL(lookup<address>(idx, op::not_ni, "10.1.2.3"), "001010");
+  MESSAGE("subnets that contain a subnet");
+  CHECK_EQUAL(lookup<subnet>(idx, op::ni, "10.1.2.0/24"), "110101");
+  CHECK_EQUAL(lookup<subnet>(idx, op::ni, "10.0.0.0/8"), "100001");
+  MESSAGE("subnets within a subnet");
+  CHECK_EQUAL(lookup<subnet>(idx, op::in, "10.0.0.0/8"), "110100");
+  CHECK_EQUAL(lookup<subnet>(idx, op::in, "10.1.0.0/24"), "000000");
+  CHECK_EQUAL(lookup<subnet>(idx, op::in, "::/0"), "111111");
+  MESSAGE("equality");
+  CHECK_EQUAL(lookup<subnet>(idx, op::equal, "10.1.0.0/16"), "010100");
+  CHECK_EQUAL(lookup<subnet>(idx, op::equal, "10.0.0.0/8"), "100000");
+  CHECK_EQUAL(lookup<subnet>(idx, op::equal, "10.0.0.0/12"), "000000");
+  CHECK_EQUAL(lookup<subnet>(idx, op::not_equal, "0.0.0.0/0"), "111110");
+  MESSAGE("longest prefix match");
+  auto lpm = [&](std::string_view x) {
+    return to_string(idx.longest_prefix_match(unbox(to<address>(x))));
+  };
+  CHECK_EQUAL(lpm("10.1.2.3"), "010100");
+  CHECK_EQUAL(lpm("10.2.0.0"), "100000");
+  CHECK_EQUAL(lpm("8.8.8.8"), "000001");
+  CHECK_EQUAL(lpm("2001:db8::1"), "000000");
+}
+
+TEST(radix index - random addresses) {
+  auto idx = make(type{address_type{}});
+  auto values = std::vector<address>{};
+  auto rng = std::mt19937{42};
+  // Cluster addresses in a few /16 networks so that paths share prefixes.
+  for (size_t i = 0; i < 5'000; ++i) {
+    auto x = static_cast<uint32_t>(0x0a000000 | ((rng() % 4) << 16)
+                                   | (rng() % 0x3000));
+    values.push_back(address::v4(x));
+    REQUIRE(idx->append(make_data_view(values.back())));
+  }
+  auto queries = std::vector<subnet>{};
+  for (size_t i = 0; i < 50; ++i) {
+    auto x = static_cast<uint32_t>(0x0a000000 | ((rng() % 4) << 16)
+                                   | (rng() % 0x3000));
+    auto length = static_cast<uint8_t>(8 + rng() % 25);
+    queries.emplace_back(address::v4(x), length);
+  }
+  auto check = [&](const value_index& idx) {
+    for (const auto& q : queries) {
+      auto expected = ids{};
+      for (const auto& x : values)
+        expected.append_bit(q.contains(x));
+      auto result
+        = unbox(idx.lookup(relational_operator::in, make_data_view(q)));
+      CHECK_EQUAL(to_string(result), to_string(expected));
+    }
+  };
+  check(*idx);
+  MESSAGE("flatbuffers roundtrip");
+  auto builder = flatbuffers::FlatBufferBuilder{};
+  const auto idx_offset = pack(builder, idx);
+  builder.Finish(idx_offset);
+  auto maybe_fb = flatbuffer<fbs::ValueIndex>::make(builder.Release());
+  REQUIRE_NOERROR(maybe_fb);
+  auto fb = *maybe_fb;
+  REQUIRE(fb);
+  auto idx2 = value_index_ptr{};
+  REQUIRE_EQUAL(unpack(*fb, idx2), caf::none);
+  REQUIRE(dynamic_cast<radix_index*>(idx2.get()) != nullptr);
+  check(*idx2);
+  MESSAGE("legacy serialization");
+  std::vector<char> buf;
+  CHECK_EQUAL(detail::serialize(buf, *idx), caf::none);
+  auto idx3 = radix_index{type{address_type{}}};
+  CHECK_EQUAL(detail::legacy_deserialize(buf, idx3), true);
+  check(idx3);
+}
+
+FIXTURE_SCOPE_END()
@@ -0,0 +1,171 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE value_index
+
+#include "vast/index/sorted_index.hpp"
+
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/bitmap.hpp"
+#include "vast/detail/legacy_deserialize.hpp"
+#include "vast/detail/serialize.hpp"
+#include "vast/fbs/value_index.hpp"
+#include "vast/flatbuffer.hpp"
+#include "vast/index/arithmetic_index.hpp"
+#include "vast/test/test.hpp"
+#include "vast/value_index_factory.hpp"
+
+#include <random>
+
+using namespace vast;
+using namespace std::string_literals;
+
+namespace {
+
+struct fixture {
+  fixture() {
+    factory<value_index>::initialize();
+  }
+
+  static value_index_ptr make(type t) {
+    auto result = factory<value_index>::make(
+      type{std::move(t), {{"index", "sorted"}}}, caf::settings{});
+    REQUIRE(result != nullptr);
+    REQUIRE(dynamic_cast<sorted_index*>(result.get()) != nullptr);
+    return result;
+  }
+
+  static std::string
+  lookup(const value_index_ptr& idx, relational_operator op, data_view x) {
+    return to_string(unbox(idx->lookup(op, x)));
+  }
+};
+
+} // namespace
+
+FIXTURE_SCOPE(sorted_index_tests, fixture)
+
+TEST(sorted index - integer) {
+  auto idx = make(type{integer_type{}});
+  for (auto x : {3, -7, 42, 3, 0, -7})
+    REQUIRE(idx->append(make_data_view(integer{x})));
+  REQUIRE(idx->append(make_data_view(caf::none)));
+  using op = relational_operator;
+  CHECK_EQUAL(lookup(idx, op::equal, make_data_view(integer{3})), "1001000");
+  CHECK_EQUAL(lookup(idx, op::not_equal, make_data_view(integer{3})),
+              "0110111");
+  CHECK_EQUAL(lookup(idx, op::less, make_data_view(integer{0})), "0100010");
+  CHECK_EQUAL(lookup(idx, op::less_equal, make_data_view(integer{0})),
+              "0100110");
+  CHECK_EQUAL(lookup(idx, op::greater, make_data_view(integer{3})), "0010000");
+  CHECK_EQUAL(lookup(idx, op::greater_equal, make_data_view(integer{-7})),
+              "1111110");
+  MESSAGE("counts compare with integers");
+  CHECK_EQUAL(lookup(idx, op::equal, make_data_view(count{42})), "0010000");
+  MESSAGE("membership uses the container lookup");
+  auto xs = list{integer{42}, integer{-7}};
+  CHECK_EQUAL(lookup(idx, op::in, make_view(xs)), "0110010");
+  MESSAGE("nil");
+  CHECK_EQUAL(lookup(idx, op::equal, make_data_view(caf::none)), "0000001");
+  MESSAGE("type clash");
+  CHECK(!idx->lookup(op::equal, make_data_view("foo")));
+}
+
+TEST(sorted index - real) {
+  auto idx = make(type{real_type{}});
+  for (auto x : {-1.5, 0.0, 2.25, -0.0, -100.0, 1e9})
+    REQUIRE(idx->append(make_data_view(real{x})));
+  using op = relational_operator;
+  CHECK_EQUAL(lookup(idx, op::less, make_data_view(real{0.0})), "100010");
+  CHECK_EQUAL(lookup(idx, op::equal, make_data_view(real{0.0})), "010100");
+  CHECK_EQUAL(lookup(idx, op::greater, make_data_view(real{2.0})), "001001");
+}
+
+TEST(sorted index - many blocks) {
+  auto idx = make(type{count_type{}});
+  auto values = std::vector<count>{};
+  auto rng = std::mt19937_64{42};
+  // Enough values to seal several times and keep a buffered remainder.
+  for (size_t i = 0; i < 20'000; ++i) {
+    auto x = count{rng() % 5'000};
+    values.push_back(x);
+    REQUIRE(idx->append(make_data_view(x)));
+  }
+  auto expected = [&](auto pred) {
+    auto result = ids{};
+    for (auto x : values)
+      result.append_bit(pred(x));
+    return to_string(result);
+  };
+  auto check = [&](const value_index& idx) {
+    using op = relational_operator;
+    auto lookup = [&](relational_operator rel, count y) {
+      return to_string(unbox(idx.lookup(rel, make_data_view(y))));
+    };
+    for (auto y : {count{0}, count{17}, count{2'500}, count{4'999}}) {
+      CHECK_EQUAL(lookup(op::equal, y), expected([=](count x) {
+                    return x == y;
+                  }));
+      CHECK_EQUAL(lookup(op::less, y), expected([=](count x) {
+                    return x < y;
+                  }));
+      CHECK_EQUAL(lookup(op::greater_equal, y), expected([=](count x) {
+                    return x >= y;
+                  }));
+    }
+  };
+  check(*idx);
+  MESSAGE("flatbuffers roundtrip");
+  auto builder = flatbuffers::FlatBufferBuilder{};
+  const auto idx_offset = pack(builder, idx);
+  builder.Finish(idx_offset);
+  auto maybe_fb = flatbuffer<fbs::ValueIndex>::make(builder.Release());
+  REQUIRE_NOERROR(maybe_fb);
+  auto fb = *maybe_fb;
+  REQUIRE(fb);
+  auto idx2 = value_index_ptr{};
+  REQUIRE_EQUAL(unpack(*fb, idx2), caf::none);
+  REQUIRE(dynamic_cast<sorted_index*>(idx2.get()) != nullptr);
+  check(*idx2);
+  MESSAGE("legacy serialization");
+  std::vector<char> buf;
+  CHECK_EQUAL(detail::serialize(buf, *idx), caf::none);
+  auto idx3 = sorted_index{type{count_type{}}};
+  CHECK_EQUAL(detail::legacy_deserialize(buf, idx3), true);
+  check(idx3);
+}
+
+TEST(sorted index - memory usage of timestamps) {
+  // Timestamps have one distinct value per event, which is the worst case
+  // for the range-coded bitmaps of the arithmetic index.
+  auto t = type{time_type{}};
+  auto sorted = make(t);
+  auto arithmetic = arithmetic_index<vast::time>{t};
+  auto ts = vast::time{} + std::chrono::hours{24 * 365 * 50};
+  auto rng = std::mt19937_64{0};
+  for (size_t i = 0; i < 10'000; ++i) {
+    ts += std::chrono::microseconds{rng() % 1'000'000};
+    REQUIRE(sorted->append(make_data_view(ts)));
+    REQUIRE(arithmetic.append(make_data_view(ts)));
+  }
+  // Packing seals the buffered values into compressed blocks.
+  auto builder = flatbuffers::FlatBufferBuilder{};
+  builder.Finish(pack(builder, sorted));
+  MESSAGE("sorted index: " << sorted->memusage() << " bytes");
+  MESSAGE("arithmetic index: " << arithmetic.memusage() << " bytes");
+  CHECK_LESS(sorted->memusage(), arithmetic.memusage());
+  using op = relational_operator;
+  auto cutoff = make_data_view(ts - std::chrono::minutes{10});
+  auto x = unbox(sorted->lookup(op::greater_equal, cutoff));
+  auto y = unbox(arithmetic.lookup(op::greater_equal, cutoff));
+  // The arithmetic index bins timestamps to seconds, so it may only report
+  // more hits.
+  CHECK_EQUAL(to_string(x & y), to_string(x));
+}
+
+FIXTURE_SCOPE_END()
@@ -30,6 +30,10 @@ rules:
   - targets:
       - zeek.conn.id.orig_h
     partition-index: false
+  - targets:
+      - zeek.http.uri
+    value-index: ngram
+    sketches: true
 )__";
 
 const vast::type schema{
@@ -46,7 +50,7 @@ TEST(example configuration) {
   const auto yaml = unbox(from_yaml(example_index_config));
   index_config config;
   REQUIRE_EQUAL(convert(yaml, config), caf::none);
-  REQUIRE_EQUAL(config.rules.size(), 2u);
+  REQUIRE_EQUAL(config.rules.size(), 3u);
   const auto& rule0 = config.rules[0];
   REQUIRE_EQUAL(rule0.targets.size(), 2u);
   CHECK_EQUAL(rule0.targets[0], "suricata.dns.dns.rrname");
@@ -57,6 +61,22 @@ TEST(example configuration) {
   CHECK_EQUAL(rule1.fp_rate, 0.01); // default
   CHECK_EQUAL(rule0.create_partition_index, true); // default
   CHECK_EQUAL(rule1.create_partition_index, false);
+  CHECK_EQUAL(rule1.value_index, ""); // default
+  const auto& rule2 = config.rules[2];
+  CHECK_EQUAL(rule2.value_index, "ngram");
+  CHECK_EQUAL(rule1.create_sketches, false); // default
+  CHECK_EQUAL(rule2.create_sketches, true);
+}
+
+TEST(should_create_sketches) {
+  qualified_record_field in{schema, {0u}};
+  CHECK_EQUAL(should_create_sketches(in, {}), false);
+  auto rules = std::vector<index_config::rule>{{.targets = {"y.x"}}};
+  CHECK_EQUAL(should_create_sketches(in, rules), false);
+  rules[0].create_sketches = true;
+  CHECK_EQUAL(should_create_sketches(in, rules), true);
+  rules[0].targets = {"y.y"};
+  CHECK_EQUAL(should_create_sketches(in, rules), false);
 }
 
 TEST(should_create_partition_index will return true for empty rules)
@@ -104,3 +124,18 @@ TEST(should_create_partition_index will will use create_partition_index from
   CHECK_EQUAL(should_create_partition_index(in_y, rules_x), true);
   CHECK_EQUAL(should_create_partition_index(in_y, rules_y), true);
 }
+
+TEST(make_index_type attaches the value index of the first matching rule) {
+  qualified_record_field in_x{schema, {0u}};
+  qualified_record_field in_y{schema, {1u}};
+  auto rules = std::vector{
+    index_config::rule{.targets = {"y.x"}, .create_partition_index = false},
+    index_config::rule{.targets = {"y.x", ":foo"}, .value_index = "hash"},
+  };
+  const auto x = make_index_type(in_x, rules);
+  const auto y = make_index_type(in_y, rules);
+  const auto z = make_index_type(in_x, {});
+  CHECK(x.attribute("index") == "hash");
+  CHECK(y.attribute("index") == "hash");
+  CHECK(!z.attribute("index"));
+}
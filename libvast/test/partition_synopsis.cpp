@@ -16,6 +16,8 @@
 #include "vast/test/fixtures/events.hpp"
 #include "vast/test/test.hpp"
 
+#include <algorithm>
+
 namespace {
 
 struct fixture : fixtures::events {};
@@ -73,6 +75,54 @@ TEST(custom index_config) {
   REQUIRE(url_parameters);
   CHECK_EQUAL(string_parameters->p, vast::defaults::system::fp_rate);
   CHECK_EQUAL(address_parameters->p, 0.05);
+  // Verify that shrinking recorded the digests of the buffered synopses.
+  REQUIRE(ps.digests_);
+  CHECK(!ps.digests_->digests.empty());
+  auto covers = [](const auto& xs, const auto& x) {
+    return std::find(xs.begin(), xs.end(), x) != xs.end();
+  };
+  CHECK(covers(ps.digests_->fields, uri_field));
+  CHECK(!covers(ps.digests_->fields, host_field));
+  CHECK(covers(ps.digests_->types, vast::type{vast::string_type{}}));
+  CHECK(covers(ps.digests_->types, vast::type{vast::address_type{}}));
+}
+
+TEST(field sketches) {
+  using namespace std::string_literals;
+  auto ps = vast::partition_synopsis{};
+  auto capacity = vast::defaults::system::max_partition_size;
+  auto synopsis_opts = vast::index_config{
+    .rules = {
+      {
+        .targets = {"zeek.http.method"s},
+        .create_sketches = true,
+      },
+    },
+  };
+  for (const auto& slice : zeek_http_log)
+    ps.add(slice, capacity, synopsis_opts);
+  auto&& layout = zeek_http_log.at(0).layout();
+  auto const& layout_rt = caf::get<vast::record_type>(layout);
+  auto method_key = layout_rt.resolve_key("method");
+  REQUIRE(method_key);
+  auto method_field = vast::qualified_record_field(layout, *method_key);
+  REQUIRE_EQUAL(ps.field_sketches_.size(), 1u);
+  const auto& sketch = ps.field_sketches_.at(method_field);
+  CHECK_EQUAL(sketch.distinct(), 3u);
+  auto top = sketch.top(1);
+  REQUIRE_EQUAL(top.size(), 1u);
+  CHECK_EQUAL(top[0].first, vast::data{"GET"});
+  MESSAGE("the sketches survive a flatbuffers roundtrip");
+  flatbuffers::FlatBufferBuilder builder;
+  auto offset = unbox(pack(builder, ps));
+  builder.Finish(offset);
+  const auto* table
+    = flatbuffers::GetRoot<vast::fbs::partition_synopsis::LegacyPartitionSynopsis>(
+      builder.GetBufferPointer());
+  auto copy = vast::partition_synopsis{};
+  REQUIRE_EQUAL(unpack(*table, copy), caf::none);
+  REQUIRE_EQUAL(copy.field_sketches_.size(), 1u);
+  CHECK(copy.field_sketches_.at(method_field) == sketch);
 }
 
 FIXTURE_SCOPE_END()
@@ -39,6 +39,26 @@ TEST(functionality) {
   CHECK(p.search(str));
 }
 
+TEST(fallback to std::regex) {
+  // Back references are beyond the capabilities of a finite automaton.
+  auto p = pattern{"(a+)b\\1"};
+  CHECK(p.match("aabaa"));
+  CHECK(!p.match("aaba"));
+  CHECK(p.search("xabax"));
+}
+
+TEST(glob) {
+  auto p = pattern::glob("*.example.com");
+  CHECK_EQUAL(p.string(), ".*\\.example\\.com");
+  CHECK(p.match("www.example.com"));
+  CHECK(!p.match("www.example.co"));
+  CHECK(!p.match("wwwexample.com"));
+  CHECK(p.search("http://www.example.com/index.html"));
+  // Wildcards do not match line terminators, just like `.` in a regex.
+  CHECK(!p.match("www\n.example.com"));
+  CHECK(p.search("www\n.example.com"));
+}
+
 TEST(comparison with string) {
   auto rx = pattern{"foo.*baz"};
   CHECK("foobarbaz"sv == rx);
@@ -10,6 +10,8 @@
 
 #include "vast/pipeline.hpp"
 
+#include "vast/address.hpp"
+#include "vast/hash/hash.hpp"
 #include "vast/plugin.hpp"
 #include "vast/table_slice_builder_factory.hpp"
 #include "vast/test/test.hpp"
@@ -22,6 +24,9 @@
 #include <caf/settings.hpp>
 #include <caf/test/dsl.hpp>
 
+#include <array>
+#include <filesystem>
+#include <span>
 #include <string_view>
 
 using namespace std::literals;
@@ -186,6 +191,18 @@ TEST(select operator) {
   REQUIRE(!invalid_add_failed);
   auto not_projected = unbox(invalid_project_operator->finish());
   CHECK(not_projected.empty());
+  MESSAGE("the operator binds to every schema separately");
+  auto other_slice = make_pipelines_testdata();
+  for (const auto* input : {&slice, &other_slice, &slice}) {
+    REQUIRE_SUCCESS(
+      project_operator->add(input->layout(), to_record_batch(*input)));
+    auto result = unbox(project_operator->finish());
+    REQUIRE_EQUAL(result.size(), 1ull);
+    CHECK_EQUAL(caf::get<vast::record_type>(result[0].layout).field(0).name,
+                "uid");
+    CHECK_EQUAL(caf::get<vast::record_type>(result[0].layout).field(1).name,
+                "index");
+  }
 }
 
 TEST(replace operator) {
@@ -294,7 +311,205 @@ TEST(anonymize operator) {
                 4ull);
   REQUIRE_EQUAL(caf::get<vast::record_type>(layout(anonymized)).field(1).name,
                 "hashed_uid");
-  // TODO: not sure how we can check that the data was correctly hashed.
+  // The digests are compatible with hashing the data view of the value.
+  auto hashed = as_table_slice(anonymized);
+  for (size_t row = 0; row < slice.rows(); ++row) {
+    const auto expected = fmt::format("{:x}", vast::hash(slice.at(row, 0)));
+    CHECK_EQUAL(hashed.at(row, 1), vast::data_view{std::string_view{expected}});
+  }
+  MESSAGE("salted integer digests");
+  auto count_operator = unbox(vast::make_pipeline_operator(
+    "hash", {{"field", "uid"},
+             {"out", "hashed_uid"},
+             {"salt", "pepper"},
+             {"format", "count"}}));
+  REQUIRE_SUCCESS(count_operator->add(slice.layout(), to_record_batch(slice)));
+  auto counted = unbox(count_operator->finish());
+  REQUIRE_EQUAL(counted.size(), 1ull);
+  auto counted_slice = as_table_slice(counted);
+  REQUIRE_EQUAL(
+    caf::get<vast::record_type>(counted_slice.layout()).field(1).type,
+    vast::type{vast::count_type{}});
+  const auto salt = "pepper"s;
+  for (size_t row = 0; row < slice.rows(); ++row) {
+    const auto expected = vast::count{vast::hash(slice.at(row, 0), salt)};
+    CHECK_EQUAL(counted_slice.at(row, 1), vast::data_view{expected});
+  }
+  MESSAGE("invalid format");
+  CHECK(!vast::make_pipeline_operator(
+    "hash", {{"field", "uid"}, {"out", "hashed_uid"}, {"format", "base64"}}));
+}
+
+TEST(hash operator digests match hashing data views) {
+  const auto layout = vast::type{
+    "digestdata",
+    vast::record_type{
+      {"integer", vast::integer_type{}},
+      {"count", vast::count_type{}},
+      {"real", vast::real_type{}},
+      {"duration", vast::duration_type{}},
+      {"time", vast::time_type{}},
+      {"address", vast::address_type{}},
+      {"string", vast::string_type{}},
+    },
+  };
+  auto builder = vast::factory<vast::table_slice_builder>::make(
+    vast::defaults::import::table_slice_type, layout);
+  REQUIRE(builder);
+  const auto v6_bytes = std::array<uint8_t, 16>{
+    0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01,
+  };
+  REQUIRE(builder->add(vast::integer{-42}, vast::count{42}, vast::real{-0.0},
+                       vast::duration{42s}, vast::time{} + 42s,
+                       vast::address::v4(0x0a000001u), "foo"sv));
+  REQUIRE(builder->add(caf::none, caf::none, caf::none, caf::none, caf::none,
+                       caf::none, caf::none));
+  const auto v6 = vast::address::v6(std::span<const uint8_t, 16>{v6_bytes});
+  REQUIRE(builder->add(vast::integer{0}, vast::count{0}, vast::real{0.0},
+                       vast::duration{0s}, vast::time{}, v6, ""sv));
+  REQUIRE(builder->add(vast::integer{1}, vast::count{1}, vast::real{1.5},
+                       vast::duration{-1ns}, vast::time{} - 1ns,
+                       vast::address{}, "a longer string value"sv));
+  const auto slice = builder->finish();
+  const auto salt = "pepper"s;
+  const auto& fields = caf::get<vast::record_type>(layout);
+  for (size_t column = 0; column < fields.num_fields(); ++column) {
+    const auto name = fields.field(column).name;
+    MESSAGE("digests of " << name << " values");
+    for (const auto salted : {false, true}) {
+      auto options = vast::record{
+        {"field", std::string{name}},
+        {"out", "digest"},
+        {"format", "count"},
+      };
+      if (salted)
+        options["salt"] = salt;
+      auto hash_operator
+        = unbox(vast::make_pipeline_operator("hash", options));
+      REQUIRE_SUCCESS(
+        hash_operator->add(slice.layout(), to_record_batch(slice)));
+      auto hashed = unbox(hash_operator->finish());
+      REQUIRE_EQUAL(hashed.size(), 1ull);
+      const auto hashed_slice = as_table_slice(hashed);
+      for (size_t row = 0; row < slice.rows(); ++row) {
+        const auto value = slice.at(row, column);
+        const auto expected = vast::count{
+          salted ? vast::hash(value, salt) : vast::hash(value)};
+        CHECK_EQUAL(hashed_slice.at(row, column + 1),
+                    vast::data_view{expected});
+      }
+    }
+  }
+  MESSAGE("negative and positive zero hash the same");
+  CHECK_EQUAL(vast::hash(slice.at(0, 2)), vast::hash(slice.at(2, 2)));
+}
+
+TEST(sort operator) {
+  const auto first = make_pipelines_testdata();
+  const auto second = make_pipelines_testdata();
+  // Sorts the two slices by their index, and returns the index and uid of
+  // every row along with the metrics of the operator.
+  auto sort = [&](const vast::record& opts) {
+    auto sort_operator = unbox(vast::make_pipeline_operator("sort", opts));
+    for (const auto& slice : {first, second})
+      REQUIRE_SUCCESS(
+        sort_operator->add(slice.layout(), to_record_batch(slice)));
+    auto rows = std::vector<std::pair<int64_t, std::string>>{};
+    for (const auto& result : unbox(sort_operator->finish())) {
+      const auto slice = vast::table_slice{result.batch};
+      for (size_t row = 0; row < slice.rows(); ++row)
+        rows.emplace_back(caf::get<vast::integer>(slice.at(row, 2)).value,
+                          caf::get<std::string_view>(slice.at(row, 0)));
+    }
+    return std::pair{std::move(rows), sort_operator->metrics()};
+  };
+  auto opts = vast::record{
+    {"fields", vast::list{"index"}},
+    {"order", "descending"},
+  };
+  const auto [sorted, no_metrics] = sort(opts);
+  CHECK(no_metrics.empty());
+  REQUIRE_EQUAL(sorted.size(), 20u);
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    // Events with equal keys keep their order.
+    const auto index = 9 - static_cast<int64_t>(i / 2);
+    const auto& expected = i % 2 == 0 ? first : second;
+    CHECK_EQUAL(sorted[i].first, index);
+    CHECK_EQUAL(vast::data_view{std::string_view{sorted[i].second}},
+                expected.at(index, 0));
+  }
+  MESSAGE("sorting with a memory budget moves runs to disk");
+  const auto spill_directory
+    = std::filesystem::temp_directory_path() / "vast-sort-test";
+  opts["memory-budget"] = vast::count{1};
+  opts["spill-directory"] = spill_directory.string();
+  const auto [spilled, metrics] = sort(opts);
+  CHECK(spilled == sorted);
+  REQUIRE_EQUAL(metrics.size(), 3u);
+  CHECK_EQUAL(metrics[0].key, "sort.spills");
+  CHECK_EQUAL(caf::get<uint64_t>(metrics[0].value), 2u);
+  CHECK(std::filesystem::is_empty(spill_directory));
+  std::filesystem::remove_all(spill_directory);
+  MESSAGE("invalid configuration");
+  CHECK(!vast::make_pipeline_operator("sort", {}));
+  CHECK(!vast::make_pipeline_operator(
+    "sort", {{"fields", "index"}, {"order", "random"}}));
+}
+
+TEST(head operator) {
+  const auto first = make_pipelines_testdata();
+  const auto second = make_pipelines_testdata();
+  auto head = [&](const vast::record& opts) {
+    auto head_operator = unbox(vast::make_pipeline_operator("head", opts));
+    for (const auto& slice : {first, second})
+      REQUIRE_SUCCESS(
+        head_operator->add(slice.layout(), to_record_batch(slice)));
+    auto rows = std::vector<std::pair<int64_t, std::string>>{};
+    for (const auto& result : unbox(head_operator->finish())) {
+      const auto slice = vast::table_slice{result.batch};
+      for (size_t row = 0; row < slice.rows(); ++row)
+        rows.emplace_back(caf::get<vast::integer>(slice.at(row, 2)).value,
+                          caf::get<std::string_view>(slice.at(row, 0)));
+    }
+    return rows;
+  };
+  const auto uid = [](const vast::table_slice& slice, size_t row) {
+    return std::string{caf::get<std::string_view>(slice.at(row, 0))};
+  };
+  const auto first_rows = head({{"limit", vast::count{3}}});
+  const auto expected_first_rows
+    = std::vector<std::pair<int64_t, std::string>>{
+      {0, uid(first, 0)},
+      {1, uid(first, 1)},
+      {2, uid(first, 2)},
+    };
+  CHECK(first_rows == expected_first_rows);
+  const auto top_rows = head({
+    {"limit", vast::count{3}},
+    {"fields", "index"},
+    {"order", "descending"},
+  });
+  const auto expected_top_rows
+    = std::vector<std::pair<int64_t, std::string>>{
+      {9, uid(first, 9)},
+      {9, uid(second, 9)},
+      {8, uid(first, 8)},
+    };
+  CHECK(top_rows == expected_top_rows);
+  MESSAGE("the heap compacts its rows");
+  auto head_operator = unbox(vast::make_pipeline_operator(
+    "head", {{"limit", vast::count{2}}, {"fields", "index"}}));
+  for (int i = 0; i < 5; ++i) {
+    const auto slice = make_pipelines_testdata();
+    REQUIRE_SUCCESS(
+      head_operator->add(slice.layout(), to_record_batch(slice)));
+  }
+  const auto compacted = unbox(head_operator->finish());
+  REQUIRE_EQUAL(compacted.size(), 1u);
+  const auto compacted_slice = vast::table_slice{compacted[0].batch};
+  REQUIRE_EQUAL(compacted_slice.rows(), 2u);
+  CHECK_EQUAL(compacted_slice.at(0, 2), vast::data_view{vast::integer{0}});
+  CHECK_EQUAL(compacted_slice.at(1, 2), vast::data_view{vast::integer{0}});
 }
 
 TEST(pipeline with multiple steps) {
@@ -364,6 +579,35 @@ TEST(pipeline rename layout) {
     caf::get<vast::record_type>((*transformed)[0].layout()).num_fields(), 2ull);
 }
 
+TEST(pipeline fuses stateless operators) {
+  vast::pipeline pipeline("test_pipeline", {{"testdata"}});
+  pipeline.add_operator(unbox(
+    vast::make_pipeline_operator("where", {{"expression", "index > +5"}})));
+  pipeline.add_operator(unbox(vast::make_pipeline_operator(
+    "select", {{"fields", vast::list{"desc", "index"}}})));
+  pipeline.add_operator(unbox(
+    vast::make_pipeline_operator("where", {{"expression", "index < +8"}})));
+  auto [slice, single_row_slice, multi_row_slice] = make_where_testdata();
+  REQUIRE_SUCCESS(pipeline.add(std::move(slice)));
+  auto transformed = pipeline.finish();
+  REQUIRE_NOERROR(transformed);
+  REQUIRE_EQUAL(transformed->size(), 1ull);
+  const auto& result = (*transformed)[0];
+  REQUIRE_EQUAL(result.rows(), 2ull);
+  REQUIRE_EQUAL(caf::get<vast::record_type>(result.layout()).num_fields(),
+                2ull);
+  CHECK_EQUAL(result.at(0, 0), vast::data_view{"test-datum 6"sv});
+  CHECK_EQUAL(result.at(0, 1), vast::data{vast::integer{6}});
+  CHECK_EQUAL(result.at(1, 1), vast::data{vast::integer{7}});
+  // A filter that matches no rows drops the batch before the projection.
+  pipeline.add_operator(unbox(
+    vast::make_pipeline_operator("where", {{"expression", "index > +9"}})));
+  REQUIRE_SUCCESS(pipeline.add(std::move(multi_row_slice)));
+  auto dropped = pipeline.finish();
+  REQUIRE_NOERROR(dropped);
+  CHECK_EQUAL(dropped->size(), 0ull);
+}
+
 TEST(Pipeline executor - single matching pipeline) {
   std::vector<vast::pipeline> pipelines;
   pipelines.emplace_back("t1", std::vector<std::string>{"foo", "testdata"});
@@ -430,4 +674,40 @@ TEST(pipeline executor - aggregate validation pipelines) {
   CHECK_FAILURE(validation2);
 }
 
+TEST(pipeline executor - parallel execution) {
+  std::vector<vast::pipeline> pipelines;
+  pipelines.emplace_back("t1", std::vector<std::string>{"testdata"});
+  pipelines.emplace_back("t2", std::vector<std::string>{});
+  REQUIRE_SUCCESS(pipelines.at(0).add_operator(
+    "replace", vast::record{{"fields", vast::record{{"desc", "xxx"}}}}));
+  REQUIRE_SUCCESS(pipelines.at(1).add_operator(
+    "drop", vast::record{{"fields", vast::list{"index"}}}));
+  vast::pipeline_executor executor(std::move(pipelines));
+  REQUIRE_SUCCESS(executor.parallelize(4));
+  auto expected = std::vector<vast::table_slice>{};
+  for (int i = 0; i < 10; ++i) {
+    auto slice = make_pipelines_testdata();
+    expected.push_back(slice);
+    REQUIRE_SUCCESS(executor.add(std::move(slice)));
+  }
+  auto transformed = executor.finish();
+  REQUIRE_NOERROR(transformed);
+  REQUIRE_EQUAL(transformed->size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    const auto& slice = (*transformed)[i];
+    REQUIRE_EQUAL(caf::get<vast::record_type>(slice.layout()).num_fields(),
+                  2ull);
+    CHECK_EQUAL(slice.at(0, 1), vast::data_view{"xxx"sv});
+    // The random uids tell whether the slices kept their order.
+    CHECK_EQUAL(slice.at(3, 0), expected[i].at(3, 0));
+  }
+  MESSAGE("operators that were added directly cannot run in parallel");
+  std::vector<vast::pipeline> direct;
+  direct.emplace_back("t3", std::vector<std::string>{"testdata"});
+  direct.at(0).add_operator(unbox(
+    vast::make_pipeline_operator("drop", {{"fields", vast::list{"uid"}}})));
+  vast::pipeline_executor direct_executor(std::move(direct));
+  CHECK_FAILURE(direct_executor.parallelize(4));
+}
+
 FIXTURE_SCOPE_END()
@@ -77,3 +77,28 @@ TEST(frozen bloom filter) {
   CHECK(frozen.lookup(hash("foo")));
   CHECK_EQUAL(filter.parameters(), frozen.parameters());
 }
+
+TEST(bloom filter batched lookup) {
+  bloom_filter_config cfg;
+  cfg.n = 1_k;
+  cfg.p = 0.001;
+  auto filter = unbox(bloom_filter::make(cfg));
+  std::mt19937_64 r{0};
+  for (size_t i = 0; i < 1_k; ++i)
+    filter.add(hash(r()));
+  auto digests = std::vector<uint64_t>{};
+  while (digests.size() < 100) {
+    auto digest = hash(r());
+    if (!filter.lookup(digest))
+      digests.push_back(digest);
+  }
+  CHECK(!filter.lookup_any(digests));
+  CHECK(!filter.lookup_any({}));
+  filter.add(hash("foo"));
+  digests.push_back(hash("foo"));
+  CHECK(filter.lookup_any(digests));
+  auto frozen = unbox(freeze(filter));
+  CHECK(frozen.lookup_any(digests));
+  digests.pop_back();
+  CHECK(!frozen.lookup_any(digests));
+}
@@ -0,0 +1,193 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE column_sketch
+
+#include "vast/sketch/column_sketch.hpp"
+
+#include "vast/fbs/sketch.hpp"
+#include "vast/hash/hash.hpp"
+#include "vast/sketch/count_min.hpp"
+#include "vast/sketch/hyperloglog.hpp"
+#include "vast/sketch/space_saving.hpp"
+#include "vast/sketch/tdigest.hpp"
+#include "vast/test/test.hpp"
+
+#include <caf/test/dsl.hpp>
+
+#include <cmath>
+#include <random>
+
+using namespace vast;
+using namespace vast::sketch;
+
+TEST(hyperloglog estimate) {
+  CHECK(!hyperloglog::make(3));
+  CHECK(!hyperloglog::make(17));
+  auto hll = unbox(hyperloglog::make(12));
+  CHECK_EQUAL(hll.estimate(), 0.0);
+  std::mt19937_64 r{0};
+  for (size_t i = 0; i < 100'000; ++i)
+    hll.add(hash(r()));
+  // Adding duplicates must not change the estimate.
+  auto estimate = hll.estimate();
+  r.seed(0);
+  for (size_t i = 0; i < 1'000; ++i)
+    hll.add(hash(r()));
+  CHECK_EQUAL(hll.estimate(), estimate);
+  // The standard error at precision 12 is about 1.6%.
+  CHECK_LESS(std::abs(estimate - 100'000.0), 5'000.0);
+}
+
+TEST(hyperloglog merge) {
+  auto x = unbox(hyperloglog::make(10));
+  auto y = unbox(hyperloglog::make(10));
+  for (uint64_t i = 0; i < 1'000; ++i) {
+    x.add(hash(i));
+    y.add(hash(i + 500));
+  }
+  REQUIRE_EQUAL(x.merge(y), caf::none);
+  CHECK_LESS(std::abs(x.estimate() - 1'500.0), 150.0);
+  auto z = unbox(hyperloglog::make(11));
+  CHECK_NOT_EQUAL(x.merge(z), caf::none);
+}
+
+TEST(hyperloglog registers) {
+  auto x = unbox(hyperloglog::make(8));
+  for (uint64_t i = 0; i < 1'000; ++i)
+    x.add(hash(i));
+  auto y = unbox(hyperloglog::make(x.registers()));
+  CHECK_EQUAL(x, y);
+  auto registers = std::vector<uint8_t>(100);
+  CHECK(!hyperloglog::make(registers));
+}
+
+TEST(tdigest quantiles) {
+  auto digest = tdigest{};
+  CHECK(!digest.quantile(0.5));
+  std::mt19937_64 r{0};
+  auto values = std::vector<double>{};
+  for (size_t i = 0; i < 100'000; ++i) {
+    values.push_back(std::uniform_real_distribution<double>{0.0, 1.0}(r));
+    digest.add(values.back());
+  }
+  std::sort(values.begin(), values.end());
+  for (auto q : {0.01, 0.5, 0.9, 0.99, 0.999}) {
+    auto expected = values[static_cast<size_t>(q * values.size())];
+    CHECK_LESS(std::abs(unbox(digest.quantile(q)) - expected), 0.01);
+  }
+  CHECK_EQUAL(unbox(digest.quantile(0.0)), values.front());
+  CHECK_EQUAL(unbox(digest.quantile(1.0)), values.back());
+  CHECK_LESS(digest.centroids().size(), 2 * tdigest::default_compression);
+}
+
+TEST(tdigest merge) {
+  auto x = tdigest{};
+  auto y = tdigest{};
+  for (auto i = 0; i < 1'000; ++i) {
+    x.add(i);
+    y.add(i + 1'000);
+  }
+  y.compress();
+  auto z = unbox(tdigest::make(tdigest::default_compression, y.centroids(),
+                               y.min(), y.max()));
+  x.merge(z);
+  CHECK_EQUAL(x.weight(), 2'000.0);
+  CHECK_LESS(std::abs(unbox(x.quantile(0.5)) - 1'000.0), 20.0);
+  CHECK_EQUAL(x.max(), 1'999.0);
+  CHECK(!tdigest::make(tdigest::default_compression, {{2.0, 1.0}, {1.0, 1.0}},
+                       0.0, 3.0));
+}
+
+TEST(space saving) {
+  CHECK(!space_saving::make(0));
+  auto x = unbox(space_saving::make(8));
+  // Frequent values survive a long tail of rare values.
+  for (auto i = 0; i < 100; ++i) {
+    x.add(make_data_view("foo"));
+    if (i % 2 == 0)
+      x.add(make_data_view("bar"));
+    x.add(make_data_view(count{static_cast<count>(i)}));
+  }
+  auto top = x.top(2);
+  REQUIRE_EQUAL(top.size(), 2u);
+  CHECK_EQUAL(top[0].value, data{"foo"});
+  CHECK_GREATER_EQUAL(top[0].count, 100u);
+  CHECK_LESS_EQUAL(top[0].count - top[0].error, 100u);
+  CHECK_EQUAL(top[1].value, data{"bar"});
+  MESSAGE("merge");
+  auto y = unbox(space_saving::make(8));
+  for (auto i = 0; i < 200; ++i)
+    y.add(make_data_view("bar"));
+  REQUIRE_EQUAL(x.merge(y), caf::none);
+  top = x.top(1);
+  REQUIRE_EQUAL(top.size(), 1u);
+  CHECK_EQUAL(top[0].value, data{"bar"});
+  CHECK_GREATER_EQUAL(top[0].count, 250u);
+  CHECK_NOT_EQUAL(x.merge(unbox(space_saving::make(16))), caf::none);
+  MESSAGE("roundtrip");
+  auto z = unbox(space_saving::make(8, x.top(8)));
+  CHECK(z.top(8) == x.top(8));
+}
+
+TEST(count-min estimate) {
+  CHECK(!count_min::make(0, 4));
+  CHECK(!count_min::make(64, 0));
+  auto cm = unbox(count_min::make(64, 4));
+  CHECK(cm.width() & 1);
+  for (uint64_t i = 0; i < 100; ++i)
+    cm.add(hash(i), static_cast<uint32_t>(i));
+  // The estimates never undercount.
+  for (uint64_t i = 0; i < 100; ++i)
+    CHECK_GREATER_EQUAL(cm.estimate(hash(i)), i);
+  auto other = unbox(count_min::make(64, 4));
+  other.add(hash(uint64_t{42}), 8);
+  REQUIRE_EQUAL(cm.merge(other), caf::none);
+  CHECK_GREATER_EQUAL(cm.estimate(hash(uint64_t{42})), 50u);
+  CHECK_NOT_EQUAL(cm.merge(unbox(count_min::make(128, 4))), caf::none);
+}
+
+TEST(column sketch) {
+  auto sketch = unbox(column_sketch::make({.heavy_hitters = 2}));
+  for (auto i = 0; i < 10; ++i)
+    sketch.add(make_data_view("foo"));
+  for (auto i = 0; i < 5; ++i)
+    sketch.add(make_data_view("bar"));
+  sketch.add(make_data_view("baz"));
+  CHECK_EQUAL(sketch.distinct(), 3u);
+  CHECK_EQUAL(sketch.frequency(make_data_view("foo")), 10u);
+  CHECK_EQUAL(sketch.frequency(make_data_view("qux")), 0u);
+  auto top = sketch.top(3);
+  REQUIRE_EQUAL(top.size(), 2u);
+  CHECK_EQUAL(top[0], std::pair(data{"foo"}, uint64_t{10}));
+  CHECK_EQUAL(top[1], std::pair(data{"bar"}, uint64_t{5}));
+  MESSAGE("merging re-estimates the heavy hitters");
+  auto other = unbox(column_sketch::make({.heavy_hitters = 2}));
+  for (auto i = 0; i < 20; ++i)
+    other.add(make_data_view("baz"));
+  REQUIRE_EQUAL(sketch.merge(other), caf::none);
+  CHECK_EQUAL(sketch.distinct(), 3u);
+  top = sketch.top(1);
+  REQUIRE_EQUAL(top.size(), 1u);
+  CHECK_EQUAL(top[0], std::pair(data{"baz"}, uint64_t{21}));
+}
+
+TEST(column sketch roundtrip) {
+  auto sketch = unbox(column_sketch::make({}));
+  for (uint64_t i = 0; i < 100; ++i)
+    sketch.add(make_data_view(count{i % 7}));
+  flatbuffers::FlatBufferBuilder builder;
+  builder.Finish(pack(builder, sketch));
+  const auto* table = flatbuffers::GetRoot<fbs::sketch::ColumnSketch>(
+    builder.GetBufferPointer());
+  REQUIRE(table);
+  auto copy = column_sketch{};
+  REQUIRE_EQUAL(unpack(*table, copy), caf::none);
+  CHECK(copy == sketch);
+  CHECK_EQUAL(copy.top(1).size(), 1u);
+}
@@ -8,18 +8,24 @@
 
 #define SUITE summarize
 
+#include <vast/aggregation_function.hpp>
 #include <vast/concept/parseable/to.hpp>
 #include <vast/concept/parseable/vast.hpp>
 #include <vast/pipeline.hpp>
 #include <vast/pipeline_operator.hpp>
 #include <vast/plugin.hpp>
+#include <vast/query_context.hpp>
+#include <vast/system/report.hpp>
 #include <vast/table_slice_builder_factory.hpp>
 #include <vast/test/fixtures/events.hpp>
 #include <vast/test/test.hpp>
 
+#include <arrow/builder.h>
 #include <caf/settings.hpp>
 #include <caf/test/dsl.hpp>
 
+#include <filesystem>
+
 namespace vast {
 
 namespace {
@@ -80,6 +86,24 @@ table_slice make_testdata(table_slice_encoding encoding
   return slice;
 }
 
+const auto window_test_layout = vast::type{
+  "windowtestdata",
+  vast::record_type{
+    {"ts", vast::time_type{}},
+    {"port", vast::count_type{}},
+  },
+};
+
+// Creates a table slice with one event per given second since the epoch.
+table_slice make_window_testdata(std::initializer_list<int> seconds) {
+  auto builder = vast::factory<vast::table_slice_builder>::make(
+    defaults::import::table_slice_type, window_test_layout);
+  REQUIRE(builder);
+  for (auto second : seconds)
+    REQUIRE(builder->add(vast::time{std::chrono::seconds(second)}, count{443}));
+  return builder->finish();
+}
+
 struct fixture : fixtures::events {
   fixture() {
     summarize_plugin = plugins::find<pipeline_operator_plugin>("summarize");
@@ -139,9 +163,11 @@ TEST(summarize Zeek conn log) {
   //   cat libvast_test/artifacts/logs/zeek/conn.log
   //     | zeek-cut -D "%Y-%m-%d" ts duration
   //     | awk '{sums[$1] += $2;}END{for (s in sums){print s,sums[s];}}'
+  //
+  // Groups appear in the order of their first occurrence in the input.
   const auto expected_data = std::vector<std::vector<std::string_view>>{
-    {"2009-11-19", "33722481628959ns", "40", "498087", "286586076"},
     {"2009-11-18", "147082148590872ns", "0", "123661", "81051017"},
+    {"2009-11-19", "33722481628959ns", "40", "498087", "286586076"},
   };
   REQUIRE_EQUAL(summarized_slice.rows(), expected_data.size());
   REQUIRE_EQUAL(summarized_slice.columns(), expected_data[0].size());
@@ -151,6 +177,246 @@ TEST(summarize Zeek conn log) {
                   unbox(to<data>(expected_data[row][column])));
 }
 
+TEST(summarize Zeek conn log with partial aggregation) {
+  const auto opts = record{
+    {"group-by",
+     list{
+       "ts",
+     }},
+    {"time-resolution", duration{std::chrono::days(1)}},
+    {"aggregate",
+     record{
+       {"duration", "sum"},
+       {"orig_ip_bytes", "min"},
+       {"resp_pkts", "sum"},
+       {"resp_ip_bytes", "max"},
+       {"num_conns", record{{"count", "uid"}}},
+     }},
+  };
+  // Split the log into three parts: two get aggregated partially, as if by
+  // different stores, and the last one reaches the final operator unchanged.
+  auto partial_operators = std::vector<std::unique_ptr<pipeline_operator>>{};
+  partial_operators.push_back(
+    unbox(summarize_plugin->make_partial_pipeline_operator(opts)));
+  partial_operators.push_back(
+    unbox(summarize_plugin->make_partial_pipeline_operator(opts)));
+  auto summarize_operator
+    = unbox(summarize_plugin->make_pipeline_operator(opts));
+  const auto num_slices = zeek_conn_log_full.size();
+  for (size_t i = 0; i < num_slices; ++i) {
+    const auto& slice = zeek_conn_log_full[i];
+    auto& op = i < num_slices / 3       ? partial_operators[0]
+               : i < 2 * num_slices / 3 ? partial_operators[1]
+                                        : summarize_operator;
+    CHECK_EQUAL(op->add(slice.layout(), to_record_batch(slice)), caf::none);
+  }
+  for (auto& op : partial_operators) {
+    const auto partial_result = unbox(op->finish());
+    REQUIRE_EQUAL(partial_result.size(), 1u);
+    CHECK(partial_result[0].layout.attribute("partial").has_value());
+    CHECK_EQUAL(summarize_operator->add(partial_result[0].layout,
+                                        partial_result[0].batch),
+                caf::none);
+  }
+  const auto result = unbox(summarize_operator->finish());
+  REQUIRE_EQUAL(result.size(), 1u);
+  const auto summarized_slice = table_slice{result[0].batch};
+  CHECK(!summarized_slice.layout().attribute("partial").has_value());
+  const auto expected_data = std::vector<std::vector<std::string_view>>{
+    {"2009-11-18", "147082148590872ns", "0", "123661", "81051017"},
+    {"2009-11-19", "33722481628959ns", "40", "498087", "286586076"},
+  };
+  REQUIRE_EQUAL(summarized_slice.rows(), expected_data.size());
+  REQUIRE_EQUAL(summarized_slice.columns(), expected_data[0].size() + 1);
+  auto num_conns = count{0};
+  for (size_t row = 0; row < summarized_slice.rows(); ++row) {
+    for (size_t column = 0; column < expected_data[row].size(); ++column)
+      CHECK_EQUAL(materialize(summarized_slice.at(row, column)), //
+                  unbox(to<data>(expected_data[row][column])));
+    num_conns += caf::get<count>(summarized_slice.at(row, 5));
+  }
+  CHECK_EQUAL(num_conns, 8462u);
+}
+
+TEST(summarize Zeek conn log with memory budget) {
+  auto opts = record{
+    {"group-by", list{"id.orig_h", "id.resp_h"}},
+    {"aggregate",
+     record{
+       {"orig_bytes", "sum"},
+       {"ports", record{{"distinct", "id.resp_p"}}},
+       {"n", record{{"count", "uid"}}},
+     }},
+  };
+  auto summarize = [&](const record& opts) {
+    auto summarize_operator
+      = unbox(summarize_plugin->make_pipeline_operator(opts));
+    for (const auto& slice : zeek_conn_log_full)
+      REQUIRE_SUCCESS(
+        summarize_operator->add(slice.layout(), to_record_batch(slice)));
+    auto rows = std::vector<std::vector<data>>{};
+    for (const auto& result : unbox(summarize_operator->finish())) {
+      const auto slice = table_slice{result.batch};
+      for (size_t row = 0; row < slice.rows(); ++row) {
+        auto& values = rows.emplace_back();
+        for (size_t column = 0; column < slice.columns(); ++column)
+          values.push_back(materialize(slice.at(row, column)));
+      }
+    }
+    // Groups that were moved to disk do not retain their order.
+    std::sort(rows.begin(), rows.end());
+    return std::pair{std::move(rows), summarize_operator->metrics()};
+  };
+  const auto [expected, no_metrics] = summarize(opts);
+  CHECK(no_metrics.empty());
+  const auto spill_directory
+    = std::filesystem::temp_directory_path() / "vast-summarize-test";
+  opts["memory-budget"] = "64 KiB";
+  opts["spill-directory"] = spill_directory.string();
+  const auto [spilled, metrics] = summarize(opts);
+  CHECK_EQUAL(spilled, expected);
+  REQUIRE_EQUAL(metrics.size(), 3u);
+  CHECK_EQUAL(metrics[0].key, "summarize.spills");
+  CHECK_GREATER(caf::get<uint64_t>(metrics[0].value), 0u);
+  MESSAGE("the spilled partitions are removed after finishing");
+  CHECK(std::filesystem::is_empty(spill_directory));
+  MESSAGE("partitions that exceed the budget when merging get split further");
+  opts["memory-budget"] = "16 KiB";
+  const auto [split, split_metrics] = summarize(opts);
+  CHECK_EQUAL(split, expected);
+  REQUIRE_EQUAL(split_metrics.size(), 3u);
+  CHECK_GREATER(caf::get<uint64_t>(split_metrics[0].value),
+                caf::get<uint64_t>(metrics[0].value));
+  CHECK(std::filesystem::is_empty(spill_directory));
+  std::filesystem::remove_all(spill_directory);
+}
+
+TEST(summarize pushdown) {
+  const auto opts = record{
+    {"group-by", "ip"},
+    {"aggregate", record{{"ports", record{{"distinct", "port"}}}}},
+  };
+  auto aggregate = pipeline{"aggregate", {"aggtestdata"}};
+  REQUIRE_SUCCESS(aggregate.add_operator("summarize", opts));
+  const auto pushdown = aggregate.pushdown();
+  REQUIRE(pushdown);
+  CHECK_EQUAL(pushdown->name, "summarize");
+  CHECK_EQUAL(pushdown->options, opts);
+  CHECK(pushdown->applies_to("aggtestdata"));
+  CHECK(!pushdown->applies_to("zeek.conn"));
+  MESSAGE("operators before the aggregation prevent the pushdown");
+  auto renamed = pipeline{"renamed", {}};
+  REQUIRE_SUCCESS(renamed.add_operator(
+    "rename", record{{"schemas", list{record{
+                                   {"from", "aggtestdata"},
+                                   {"to", "renamed"},
+                                 }}}}));
+  REQUIRE_SUCCESS(renamed.add_operator("summarize", opts));
+  CHECK(!renamed.pushdown());
+  MESSAGE("the partial operator marks its results");
+  auto partial = unbox(summarize_plugin->make_partial_pipeline_operator(opts));
+  REQUIRE_SUCCESS(
+    partial->add(agg_test_layout, to_record_batch(make_testdata())));
+  const auto result = unbox(partial->finish());
+  REQUIRE_EQUAL(result.size(), 1u);
+  CHECK(result[0].layout.attribute("partial").has_value());
+  CHECK_EQUAL(result[0].batch->num_rows(), 1);
+}
+
+TEST(summarize windows) {
+  auto summarize = [&](const record& window, const auto& batches) {
+    const auto opts = record{
+      {"window", window},
+      {"aggregate", record{{"n", record{{"count", "port"}}}}},
+    };
+    auto summarize_operator
+      = unbox(summarize_plugin->make_pipeline_operator(opts));
+    CHECK(summarize_operator->is_incremental());
+    auto results = std::vector<std::vector<std::pair<int, count>>>{};
+    const auto collect = [&] {
+      auto& rows = results.emplace_back();
+      for (const auto& result : unbox(summarize_operator->finish())) {
+        const auto slice = table_slice{result.batch};
+        for (size_t row = 0; row < slice.rows(); ++row)
+          rows.emplace_back(
+            std::chrono::duration_cast<std::chrono::seconds>(
+              caf::get<vast::time>(materialize(slice.at(row, 0)))
+                .time_since_epoch())
+              .count(),
+            caf::get<count>(materialize(slice.at(row, 1))));
+      }
+    };
+    for (const auto& batch : batches) {
+      REQUIRE_SUCCESS(
+        summarize_operator->add(batch.layout(), to_record_batch(batch)));
+      collect();
+    }
+    summarize_operator->flush();
+    collect();
+    return results;
+  };
+  using rows = std::vector<std::pair<int, count>>;
+  MESSAGE("tumbling windows close once the watermark passes them");
+  auto tumbling = summarize(
+    record{{"field", "ts"}, {"size", duration{std::chrono::seconds(10)}}},
+    std::vector{make_window_testdata({101, 102, 111}),
+                make_window_testdata({112, 105, 125})});
+  REQUIRE_EQUAL(tumbling.size(), 3u);
+  CHECK_EQUAL(tumbling[0], (rows{{100, 2}}));
+  // The event at 105 arrives after its window was emitted.
+  CHECK_EQUAL(tumbling[1], (rows{{110, 2}}));
+  CHECK_EQUAL(tumbling[2], (rows{{120, 1}}));
+  MESSAGE("sliding windows with allowed lateness");
+  auto sliding = summarize(
+    record{
+      {"field", "ts"},
+      {"size", duration{std::chrono::seconds(10)}},
+      {"slide", duration{std::chrono::seconds(5)}},
+      {"allowed-lateness", duration{std::chrono::seconds(5)}},
+    },
+    std::vector{make_window_testdata({101, 107, 112})});
+  REQUIRE_EQUAL(sliding.size(), 2u);
+  CHECK_EQUAL(sliding[0], (rows{{95, 1}}));
+  CHECK_EQUAL(sliding[1], (rows{{100, 2}, {105, 2}, {110, 1}}));
+  MESSAGE("invalid windows");
+  for (const auto& window : {
+         record{{"size", duration{std::chrono::seconds(10)}}},
+         record{{"field", "ts"}},
+         record{
+           {"field", "ts"},
+           {"size", duration{std::chrono::seconds(10)}},
+           {"slide", duration{std::chrono::seconds(3)}},
+         },
+       })
+    CHECK(!summarize_plugin->make_pipeline_operator(record{
+      {"window", window},
+      {"aggregate", record{{"n", record{{"count", "port"}}}}},
+    }));
+  MESSAGE("only incremental aggregations apply to unbounded inputs");
+  auto windowed = pipeline{"windowed", {}};
+  REQUIRE_SUCCESS(windowed.add_operator(
+    "summarize",
+    record{
+      {"window",
+       record{{"field", "ts"}, {"size", duration{std::chrono::seconds(10)}}}},
+      {"aggregate", record{{"n", record{{"count", "port"}}}}},
+    }));
+  auto unbounded = pipeline{"unbounded", {}};
+  REQUIRE_SUCCESS(unbounded.add_operator(
+    "summarize", record{
+                   {"group-by", "port"},
+                   {"aggregate", record{{"n", record{{"count", "port"}}}}},
+                 }));
+  const auto validate = [](pipeline&& x) {
+    auto pipelines = std::vector<pipeline>{};
+    pipelines.push_back(std::move(x));
+    return pipeline_executor{std::move(pipelines)}.validate(
+      pipeline_executor::allow_aggregate_pipelines::incremental);
+  };
+  CHECK_EQUAL(validate(std::move(windowed)), caf::none);
+  CHECK_NOT_EQUAL(validate(std::move(unbounded)), caf::none);
+}
+
 TEST(summarize test) {
   const auto opts = record{
     {"group-by",
@@ -307,6 +573,80 @@ TEST(summarize test wrong config) {
               caf::get<record_type>(expected_data.layout()));
 }
 
+TEST(aggregation functions skip null values in bulk) {
+  auto aggregate = [](const char* name, const type& input_type,
+                      const arrow::Array& array) {
+    const auto* plugin = plugins::find<aggregation_function_plugin>(name);
+    REQUIRE(plugin);
+    auto function = unbox(plugin->make_aggregation_function(input_type));
+    function->add(array);
+    return unbox(std::move(*function).finish());
+  };
+  auto count_builder = arrow::UInt64Builder{};
+  REQUIRE(count_builder.AppendValues({1, 2, 3, 4, 5, 6},
+                                     {true, false, true, false, true, true})
+            .ok());
+  // Slice the array so that the validity bitmap has a non-zero offset.
+  const auto counts = count_builder.Finish().ValueOrDie()->Slice(1, 4);
+  CHECK_EQUAL(aggregate("sum", type{count_type{}}, *counts), data{count{8}});
+  CHECK_EQUAL(aggregate("min", type{count_type{}}, *counts), data{count{3}});
+  CHECK_EQUAL(aggregate("max", type{count_type{}}, *counts), data{count{5}});
+  auto bool_builder = arrow::BooleanBuilder{};
+  const auto bool_values = std::vector<bool>{true, false, true};
+  const auto bool_validity = std::vector<bool>{false, true, false};
+  REQUIRE(bool_builder.AppendValues(bool_values, bool_validity).ok());
+  const auto bools = bool_builder.Finish().ValueOrDie();
+  CHECK_EQUAL(aggregate("any", type{bool_type{}}, *bools), data{false});
+  CHECK_EQUAL(aggregate("all", type{bool_type{}}, *bools), data{false});
+  const auto nulls = bools->Slice(0, 1);
+  CHECK_EQUAL(aggregate("any", type{bool_type{}}, *nulls), data{});
+  CHECK_EQUAL(aggregate("all", type{bool_type{}}, *nulls), data{});
+}
+
+TEST(approximate aggregation functions) {
+  auto aggregate = [](const char* name, const type& input_type,
+                      const arrow::Array& array) {
+    const auto* plugin = plugins::find<aggregation_function_plugin>(name);
+    REQUIRE(plugin);
+    // Aggregate both halves of the array separately, and merge their partial
+    // states.
+    const auto half = array.length() / 2;
+    auto merged = std::unique_ptr<aggregation_function>{};
+    for (const auto& part : {array.Slice(0, half), array.Slice(half)}) {
+      auto function = unbox(plugin->make_aggregation_function(input_type));
+      function->add(*part);
+      if (!merged)
+        merged = unbox(
+          plugin->make_aggregation_function(function->partial_type()));
+      const auto partial = unbox(std::move(*function).save());
+      REQUIRE_EQUAL(merged->merge(make_view(partial)), caf::none);
+    }
+    return unbox(std::move(*merged).finish());
+  };
+  auto count_builder = arrow::UInt64Builder{};
+  for (uint64_t i = 0; i < 1'000; ++i)
+    REQUIRE(count_builder.Append(i % 10 == 0 ? 7 : i).ok());
+  const auto counts = count_builder.Finish().ValueOrDie();
+  CHECK_EQUAL(aggregate("count_distinct", type{count_type{}}, *counts),
+              data{count{900}});
+  const auto top = aggregate("top_k", type{count_type{}}, *counts);
+  const auto& top_values = caf::get<list>(top);
+  REQUIRE_EQUAL(top_values.size(), 10u);
+  const auto& most_frequent = caf::get<record>(top_values[0]);
+  CHECK_EQUAL(most_frequent.at("value"), data{count{7}});
+  CHECK_GREATER_EQUAL(caf::get<count>(most_frequent.at("count")), 100u);
+  auto duration_builder
+    = duration_type::make_arrow_builder(arrow::default_memory_pool());
+  for (auto i = 1; i <= 1'000; ++i)
+    REQUIRE(duration_builder->Append(i * 1'000'000).ok());
+  const auto durations = duration_builder->Finish().ValueOrDie();
+  const auto p99 = caf::get<duration>(
+    aggregate("p99", type{duration_type{}}, *durations));
+  CHECK_LESS(std::abs(p99.count() - 990'000'000), 5'000'000);
+  CHECK(!plugins::find<aggregation_function_plugin>("p99")
+           ->make_aggregation_function(type{string_type{}}));
+}
+
 FIXTURE_SCOPE_END()
 
 } // namespace vast
@@ -0,0 +1,101 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE batching_controller
+
+#include "vast/system/batching_controller.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <algorithm>
+
+using namespace vast;
+using namespace vast::system;
+using namespace std::chrono_literals;
+
+namespace {
+
+/// Feeds the controller with a constant input rate for the given number of
+/// rate windows of 100ms each.
+void feed(batching_controller& controller, vast::time& now,
+          size_t events_per_window, size_t windows, size_t buffered = 0) {
+  for (size_t i = 0; i < windows; ++i) {
+    controller.adapt(buffered, now);
+    controller.observe_slice(events_per_window, now);
+    now += 100ms;
+  }
+  controller.adapt(buffered, now);
+}
+
+} // namespace
+
+TEST(disabled controller keeps the static batch size) {
+  auto controller = batching_controller{{.max_table_slice_size = 65'536}};
+  CHECK(!controller.enabled());
+  auto now = vast::time{} + 1s;
+  feed(controller, now, 10, 10);
+  CHECK_EQUAL(controller.table_slice_size(), 65'536u);
+}
+
+TEST(table slices fill up within the latency target) {
+  auto controller = batching_controller{{
+    .max_table_slice_size = 65'536,
+    .latency_target = 1s,
+  }};
+  REQUIRE(controller.enabled());
+  CHECK_EQUAL(controller.batch_timeout(), duration{1s});
+  auto now = vast::time{} + 1s;
+  MESSAGE("10k events per second");
+  feed(controller, now, 1'000, 10);
+  CHECK_EQUAL(controller.rate(), 10'000.0);
+  CHECK_EQUAL(controller.table_slice_size(), 16'384u);
+  MESSAGE("the minimum applies for low rates");
+  feed(controller, now, 1, 20);
+  CHECK_EQUAL(controller.table_slice_size(), 1'024u);
+  MESSAGE("the maximum applies for high rates");
+  feed(controller, now, 100'000, 10);
+  CHECK_EQUAL(controller.table_slice_size(), 65'536u);
+}
+
+TEST(backpressure grows table slices) {
+  auto controller = batching_controller{{
+    .max_table_slice_size = 65'536,
+    .latency_target = 100ms,
+  }};
+  auto now = vast::time{} + 1s;
+  feed(controller, now, 1'000, 10);
+  CHECK_EQUAL(controller.table_slice_size(), 1'024u);
+  controller.adapt(1, now);
+  CHECK_EQUAL(controller.table_slice_size(), 2'048u);
+  controller.adapt(1, now);
+  CHECK_EQUAL(controller.table_slice_size(), 4'096u);
+}
+
+TEST(report contains histograms) {
+  auto controller = batching_controller{{
+    .max_table_slice_size = 65'536,
+    .latency_target = 1s,
+  }};
+  auto now = vast::time{} + 1s;
+  feed(controller, now, 1'000, 5);
+  auto report = controller.make_report("test");
+  auto value = [&](std::string_view key) -> uint64_t {
+    auto it = std::find_if(report.data.begin(), report.data.end(),
+                           [&](const auto& x) {
+                             return x.key == key;
+                           });
+    REQUIRE(it != report.data.end());
+    return caf::get<uint64_t>(it->value);
+  };
+  CHECK_EQUAL(value("test.batching.slice-interval.le-100ms"), 4u);
+  CHECK_EQUAL(value("test.batching.rate.le-10000"), 5u);
+  CHECK_EQUAL(value("test.batching.rate.le-inf"), 0u);
+  MESSAGE("reports reset the histograms");
+  report = controller.make_report("test");
+  CHECK_EQUAL(value("test.batching.slice-interval.le-100ms"), 0u);
+}
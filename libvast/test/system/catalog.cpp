@@ -20,6 +20,7 @@
 #include "vast/synopsis.hpp"
 #include "vast/synopsis_factory.hpp"
 #include "vast/system/actors.hpp"
+#include "vast/system/status.hpp"
 #include "vast/table_slice.hpp"
 #include "vast/table_slice_builder_factory.hpp"
 #include "vast/test/fixtures/actor_system.hpp"
@@ -394,6 +395,176 @@ TEST(catalog with bool synopsis) {
   CHECK_EQUAL(lookup_("y != T"), none);
 }
 
+TEST(catalog with digest index) {
+  auto meta_idx = self->spawn(catalog, accountant_actor{});
+  auto layout = type{
+    "test",
+    record_type{
+      {"src", address_type{}},
+      {"host", string_type{}},
+    },
+  };
+  auto builder = factory<table_slice_builder>::make(
+    defaults::import::table_slice_type, layout);
+  REQUIRE(builder);
+  auto add = [&](std::string_view addr, std::string_view host, bool shrink) {
+    CHECK(builder->add(make_data_view(unbox(to<data>(addr)))));
+    CHECK(builder->add(make_data_view(host)));
+    auto slice = builder->finish();
+    slice.offset(0);
+    auto ps = make_partition_synopsis(slice);
+    if (shrink) {
+      ps.shrink();
+      REQUIRE(ps.digests_);
+    }
+    auto id = uuid::random();
+    merge(meta_idx, id, caf::make_copy_on_write<partition_synopsis>(
+                          std::move(ps)));
+    return id;
+  };
+  auto id1 = add("10.0.0.1", "foo", true);
+  auto id2 = add("10.0.0.2", "bar", true);
+  auto id3 = add("10.0.0.3", "baz", true);
+  MESSAGE("partitions without digests fall back to their synopses");
+  auto id4 = add("10.0.0.1", "qux", false);
+  auto ids = [](std::vector<uuid> xs) {
+    std::sort(xs.begin(), xs.end());
+    return xs;
+  };
+  auto lookup_ = [&](std::string_view expr) {
+    return lookup(meta_idx, expr);
+  };
+  CHECK_EQUAL(lookup_("src == 10.0.0.1"), ids({id1, id4}));
+  CHECK_EQUAL(lookup_("src == 10.0.0.2"), ids({id2}));
+  CHECK_EQUAL(lookup_("src == 192.168.0.1"), ids({}));
+  CHECK_EQUAL(lookup_(":addr in [10.0.0.2, 10.0.0.3]"), ids({id2, id3}));
+  CHECK_EQUAL(lookup_(":addr in [192.168.0.1, 192.168.0.2]"), ids({}));
+  CHECK_EQUAL(lookup_("host == \"bar\""), ids({id2}));
+  CHECK_EQUAL(lookup_(":string in [\"foo\", \"qux\"]"), ids({id1, id4}));
+  MESSAGE("predicates that the index cannot answer use the synopses");
+  CHECK_EQUAL(lookup_("src in 10.0.0.0/8"), ids({id1, id2, id3, id4}));
+  MESSAGE("erased partitions disappear from the index");
+  auto rp = self->request(meta_idx, caf::infinite, atom::erase_v, id1);
+  run();
+  rp.receive([](atom::ok) {},
+             [](const caf::error& e) {
+               FAIL(render(e));
+             });
+  CHECK_EQUAL(lookup_("src == 10.0.0.1"), ids({id4}));
+}
+
+TEST(catalog scopes digests by field) {
+  auto meta_idx = self->spawn(catalog, accountant_actor{});
+  auto layout = type{
+    "test",
+    record_type{
+      {"a", string_type{}},
+      {"b", string_type{}},
+    },
+  };
+  auto builder = factory<table_slice_builder>::make(
+    defaults::import::table_slice_type, layout);
+  REQUIRE(builder);
+  CHECK(builder->add(make_data_view("foo"), make_data_view("bar")));
+  auto slice = builder->finish();
+  slice.offset(0);
+  auto ps = make_partition_synopsis(slice);
+  ps.shrink();
+  auto shared = caf::make_copy_on_write<partition_synopsis>(std::move(ps));
+  auto id = uuid::random();
+  merge(meta_idx, id, shared);
+  MESSAGE("merging leaves the shared synopsis intact");
+  CHECK(shared->digests_);
+  MESSAGE("values only match in the field they occur in");
+  CHECK_EQUAL(lookup(meta_idx, "a == \"foo\""), std::vector<uuid>{id});
+  CHECK_EQUAL(lookup(meta_idx, "b == \"foo\""), std::vector<uuid>{});
+  CHECK_EQUAL(lookup(meta_idx, "b == \"bar\""), std::vector<uuid>{id});
+}
+
+TEST(catalog merges sketches) {
+  auto state = catalog_state{};
+  auto layout = type{
+    "test",
+    record_type{
+      {"host", string_type{}},
+    },
+  };
+  auto synopsis_opts = vast::index_config{
+    .rules = {{.targets = {"test.host"}, .create_sketches = true}},
+  };
+  auto add = [&](std::vector<std::string_view> hosts) {
+    auto builder = factory<table_slice_builder>::make(
+      defaults::import::table_slice_type, layout);
+    REQUIRE(builder);
+    for (auto host : hosts)
+      CHECK(builder->add(make_data_view(host)));
+    auto slice = builder->finish();
+    slice.offset(0);
+    auto ps = partition_synopsis{};
+    ps.add(slice, defaults::system::max_partition_size, synopsis_opts);
+    state.merge(uuid::random(),
+                caf::make_copy_on_write<partition_synopsis>(std::move(ps)));
+  };
+  add({"foo", "foo", "bar"});
+  add({"foo", "baz"});
+  auto sketch = unbox(state.merge_sketches("host"));
+  CHECK_EQUAL(sketch.distinct(), 3u);
+  CHECK_EQUAL(sketch.frequency(make_data_view("foo")), 3u);
+  auto top = sketch.top(1);
+  REQUIRE_EQUAL(top.size(), 1u);
+  CHECK_EQUAL(top[0], std::pair(data{"foo"}, uint64_t{3}));
+  CHECK(state.merge_sketches("test.host"));
+  CHECK(!state.merge_sketches("src"));
+}
+
+TEST(catalog reports sketches in its status) {
+  auto meta_idx = self->spawn(catalog, accountant_actor{});
+  auto layout = type{
+    "test",
+    record_type{
+      {"host", string_type{}},
+    },
+  };
+  auto synopsis_opts = vast::index_config{
+    .rules = {{.targets = {"test.host"}, .create_sketches = true}},
+  };
+  for (auto hosts : {std::vector<std::string_view>{"foo", "foo", "bar"},
+                     std::vector<std::string_view>{"foo", "baz"}}) {
+    auto builder = factory<table_slice_builder>::make(
+      defaults::import::table_slice_type, layout);
+    REQUIRE(builder);
+    for (auto host : hosts)
+      CHECK(builder->add(make_data_view(host)));
+    auto slice = builder->finish();
+    slice.offset(0);
+    auto ps = partition_synopsis{};
+    ps.add(slice, defaults::system::max_partition_size, synopsis_opts);
+    merge(meta_idx, uuid::random(),
+          caf::make_copy_on_write<partition_synopsis>(std::move(ps)));
+  }
+  auto rp = self->request(meta_idx, caf::infinite, atom::status_v,
+                          status_verbosity::detailed);
+  run();
+  rp.receive(
+    [](record& status) {
+      const auto* sketches = caf::get_if<record>(&status["sketches"]);
+      REQUIRE(sketches);
+      const auto* host = caf::get_if<record>(&(*sketches)["test.host"]);
+      REQUIRE(host);
+      CHECK_EQUAL((*host)["distinct"], data{count{3}});
+      const auto* top = caf::get_if<list>(&(*host)["top"]);
+      REQUIRE(top);
+      REQUIRE(!top->empty());
+      CHECK_EQUAL(top->front(), (data{record{
+                                  {"value", "foo"},
+                                  {"count", count{3}},
+                                }}));
+    },
+    [](const caf::error& e) {
+      FAIL(render(e));
+    });
+}
+
 TEST(catalog messages) {
   // All of the pregenerated data has "foo" as content and its id as timestamp,
   // so this selects everything but the first partition.
@@ -101,8 +101,8 @@ TEST(count IP point query with partition - local stores) {
   auto index = self->spawn(system::index, system::accountant_actor{}, fs,
                            archive, catalog, type_registry, indexdir,
                            defaults::system::store_backend,
-                           defaults::import::table_slice_size, duration{}, 100,
-                           3, 1, indexdir, vast::index_config{});
+                           defaults::import::table_slice_size, duration{}, 1u,
+                           100, 3, 1, indexdir, vast::index_config{});
   // Fill the INDEX with 400 rows from the Zeek conn log.
   detail::spawn_container_source(sys, take(zeek_conn_log_full, 4), index);
   MESSAGE("spawn the COUNTER for query ':addr == 192.168.1.104'");
@@ -130,8 +130,8 @@ TEST(count meta extractor import time 1) {
   auto index = self->spawn(system::index, system::accountant_actor{}, fs,
                            archive, catalog, type_registry, indexdir,
                            defaults::system::store_backend,
-                           defaults::import::table_slice_size, duration{}, 100,
-                           3, 1, indexdir, vast::index_config{});
+                           defaults::import::table_slice_size, duration{}, 1u,
+                           100, 3, 1, indexdir, vast::index_config{});
   // Fill the INDEX with 400 rows from the Zeek conn log.
   auto slices = take(zeek_conn_log_full, 4);
   for (auto& slice : slices) {
@@ -167,8 +167,8 @@ TEST(count meta extractor import time 2) {
   auto index = self->spawn(system::index, system::accountant_actor{}, fs,
                            archive, catalog, type_registry, indexdir,
                            defaults::system::store_backend,
-                           defaults::import::table_slice_size, duration{}, 100,
-                           3, 1, indexdir, vast::index_config{});
+                           defaults::import::table_slice_size, duration{}, 1u,
+                           100, 3, 1, indexdir, vast::index_config{});
   // Fill the INDEX with 400 rows from the Zeek conn log.
   auto slices = take(zeek_conn_log_full, 4);
   for (auto& slice : slices) {
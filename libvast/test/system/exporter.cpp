@@ -62,7 +62,8 @@ struct fixture : fixture_base {
     index = self->spawn(system::index, system::accountant_actor{}, fs,
                         system::archive_actor{}, catalog, type_registry,
                         indexdir, defaults::system::store_backend, 10000,
-                        duration{}, 5, 5, 1, indexdir, vast::index_config{});
+                        duration{}, 1u, 5, 5, 1, indexdir,
+                        vast::index_config{});
   }
 
   void spawn_importer() {
@@ -71,9 +72,9 @@ struct fixture : fixture_base {
                            std::vector<vast::pipeline>{});
   }
 
-  void spawn_exporter(query_options opts) {
-    exporter = self->spawn(system::exporter, expr, opts,
-                           std::vector<vast::pipeline>{});
+  void spawn_exporter(query_options opts,
+                      std::vector<vast::pipeline> pipelines = {}) {
+    exporter = self->spawn(system::exporter, expr, opts, std::move(pipelines));
   }
 
   void importer_setup() {
@@ -171,6 +172,32 @@ TEST(historical query with importer) {
   verify(fetch_results());
 }
 
+TEST(historical query with aggregate pipeline and limit) {
+  MESSAGE("prepare importer");
+  importer_setup();
+  MESSAGE("ingest conn.log via importer");
+  vast::detail::spawn_container_source(sys, zeek_conn_log, importer);
+  run();
+  MESSAGE("spawn exporter with an aggregate pipeline");
+  auto schemas = std::vector<std::string>{"zeek.conn"};
+  auto pipelines = std::vector<vast::pipeline>{};
+  auto& aggregate = pipelines.emplace_back("aggregate", std::move(schemas));
+  REQUIRE_SUCCESS(aggregate.add_operator(
+    "summarize", record{
+                   {"group-by", "uid"},
+                   {"aggregate", record{{"n", record{{"count", "uid"}}}}},
+                 }));
+  spawn_exporter(historical, std::move(pipelines));
+  send(exporter, atom::set_v, index);
+  send(exporter, atom::sink_v, self);
+  send(exporter, atom::run_v);
+  // The limit applies to the aggregated events, i.e., one event for each of
+  // the five matching connections.
+  send(exporter, atom::extract_v, uint64_t{2});
+  run();
+  CHECK_EQUAL(rows(fetch_results()), 2u);
+}
+
 TEST(continuous query with exporter only) {
   MESSAGE("prepare exporter for continuous query");
   spawn_exporter(continuous);
@@ -27,6 +27,7 @@
 #include "vast/test/test.hpp"
 
 #include <filesystem>
+#include <set>
 #include <unistd.h>
 
 using caf::after;
@@ -111,7 +112,7 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
     index = self->spawn(system::index, system::accountant_actor{}, fs,
                         system::archive_actor{}, catalog, type_registry,
                         index_dir, defaults::system::store_backend, slice_size,
-                        vast::duration{}, in_mem_partitions, taste_count,
+                        vast::duration{}, 1u, in_mem_partitions, taste_count,
                         num_query_supervisors, index_dir, vast::index_config{});
   }
 
@@ -196,6 +197,29 @@ TEST(iterable integer query result) {
   CHECK_EQUAL(result, expected_result);
 }
 
+TEST(sharded active partitions) {
+  state().active_partition_shards = 4;
+  MESSAGE("assign distinct import times to spread slices across shards");
+  auto slices = std::vector<table_slice>{};
+  auto shards = std::set<size_t>{};
+  for (int64_t i = 0; i < 8; ++i) {
+    auto copy = alternating_integers[i].unshare();
+    copy.import_time(time{} + nanoseconds{i});
+    CHECK_EQUAL(system::active_partition_shard(copy, 1), 0u);
+    shards.insert(system::active_partition_shard(copy, 4));
+    slices.push_back(std::move(copy));
+  }
+  REQUIRE_GREATER(shards.size(), 1u);
+  auto src = detail::spawn_container_source(sys, slices, index);
+  run();
+  CHECK_EQUAL(state().active_partitions.size(), shards.size());
+  MESSAGE("query half of the values");
+  auto [query_id, hits, scheduled] = query(":int == +1");
+  CHECK_EQUAL(hits, slices.size());
+  auto result = receive_result(query_id, hits, scheduled);
+  CHECK_EQUAL(result, slice_size * slices.size() / 2);
+}
+
 TEST(iterable zeek conn log query result) {
   MESSAGE("ingest conn.log slices");
   detail::spawn_container_source(sys, zeek_conn_log, index);
@@ -265,7 +289,7 @@ TEST(oversized partition recovery) {
   auto index
     = self->spawn(system::index, system::accountant_actor{}, fs,
                   system::archive_actor{}, catalog, type_registry, index_dir,
-                  defaults::system::store_backend, 1000u, vast::duration{},
+                  defaults::system::store_backend, 1000u, vast::duration{}, 1u,
                   in_mem_partitions, taste_count, num_query_supervisors,
                   index_dir, vast::index_config{});
   run();
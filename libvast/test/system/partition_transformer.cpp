@@ -350,7 +350,7 @@ TEST(identity partition pipeline via the index) {
     = self->spawn(vast::system::index, accountant, filesystem, archive, catalog,
                   type_registry, index_dir,
                   vast::defaults::system::store_backend, partition_capacity,
-                  active_partition_timeout, in_mem_partitions, taste_count,
+                  active_partition_timeout, 1u, in_mem_partitions, taste_count,
                   num_query_supervisors, index_dir, index_config);
   vast::detail::spawn_container_source(sys, zeek_conn_log, index);
   run();
@@ -456,7 +456,7 @@ TEST(query after transform) {
     = self->spawn(vast::system::index, accountant, filesystem, archive, catalog,
                   type_registry, index_dir,
                   vast::defaults::system::store_backend, partition_capacity,
-                  active_partition_timeout, in_mem_partitions, taste_count,
+                  active_partition_timeout, 1u, in_mem_partitions, taste_count,
                   num_query_supervisors, index_dir, index_config);
   vast::detail::spawn_container_source(sys, zeek_conn_log, index);
   run();
@@ -562,7 +562,7 @@ TEST(select pipeline with an empty result set) {
     = self->spawn(vast::system::index, accountant, filesystem, archive, catalog,
                   type_registry, index_dir,
                   vast::defaults::system::store_backend, partition_capacity,
-                  active_partition_timeout, in_mem_partitions, taste_count,
+                  active_partition_timeout, 1u, in_mem_partitions, taste_count,
                   num_query_supervisors, index_dir, vast::index_config{});
   vast::detail::spawn_container_source(sys, zeek_conn_log, index);
   run();
@@ -0,0 +1,168 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE shm_ingest
+
+#include "vast/system/shm_ingest.hpp"
+
+#include "vast/config.hpp"
+#include "vast/detail/memfd.hpp"
+#include "vast/detail/posix.hpp"
+#include "vast/system/shm_sink.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/test/fixtures/actor_system_and_events.hpp"
+#include "vast/test/test.hpp"
+
+#include <caf/attach_stream_sink.hpp>
+#include <caf/attach_stream_source.hpp>
+#include <sys/socket.h>
+
+#include <unistd.h>
+
+using namespace vast;
+
+#if VAST_LINUX
+
+namespace {
+
+system::stream_sink_actor<table_slice>::behavior_type
+collecting_sink(system::stream_sink_actor<table_slice>::pointer self,
+                std::vector<table_slice>* results) {
+  return {
+    [=](caf::stream<table_slice> in) -> caf::inbound_stream_slot<table_slice> {
+      return caf::attach_stream_sink(
+               self, in,
+               [](caf::unit_t&) {
+                 // nop
+               },
+               [=](caf::unit_t&, table_slice slice) {
+                 results->push_back(std::move(slice));
+               })
+        .inbound_slot();
+    },
+  };
+}
+
+struct fixture : fixtures::deterministic_actor_system_and_events {
+  fixture()
+    : fixtures::deterministic_actor_system_and_events(
+      VAST_PP_STRINGIFY(SUITE)) {
+    path = (directory / "shm.sock").string();
+    importer = self->spawn(collecting_sink, &results);
+    ingest = self->spawn(system::shm_ingest, importer, path);
+    run();
+  }
+
+  ~fixture() override {
+    self->send_exit(ingest, caf::exit_reason::user_shutdown);
+    self->send_exit(importer, caf::exit_reason::user_shutdown);
+    run();
+  }
+
+  /// Lets the SHM INGEST actor check for input until *done* returns true.
+  template <class Predicate>
+  void poll_until(Predicate done) {
+    for (size_t i = 0; i < 100 && !done(); ++i) {
+      sched.trigger_timeouts();
+      run();
+    }
+    REQUIRE(done());
+  }
+
+  std::string path;
+  std::vector<table_slice> results;
+  system::stream_sink_actor<table_slice> importer;
+  system::shm_ingest_actor ingest;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(shm_ingest_tests, fixture)
+
+TEST(shm ingest forwards table slices to the importer) {
+  auto client = unbox(system::connect_shm_ingest(path));
+  for (const auto& slice : zeek_conn_log) {
+    auto fd = unbox(detail::make_sealed_memfd("test", as_bytes(slice)));
+    REQUIRE(detail::uds_send_fd(client, fd));
+    ::close(fd);
+  }
+  REQUIRE_EQUAL(::shutdown(client, SHUT_WR), 0);
+  poll_until([&] {
+    return results.size() == zeek_conn_log.size();
+  });
+  for (size_t i = 0; i < results.size(); ++i) {
+    results[i].offset(zeek_conn_log[i].offset());
+    CHECK_EQUAL(results[i], zeek_conn_log[i]);
+  }
+  MESSAGE("the node acknowledges the end of the stream");
+  poll_until([&] {
+    return !detail::poll(client, 0);
+  });
+  auto ack = char{};
+  CHECK_EQUAL(::read(client, &ack, 1), 1);
+  CHECK_EQUAL(ack, '*');
+  ::close(client);
+}
+
+TEST(shm ingest drops clients that send invalid table slices) {
+  auto client = unbox(system::connect_shm_ingest(path));
+  auto sink = self->spawn(system::shm_sink, client);
+  self->monitor(sink);
+  MESSAGE("pass a file that does not contain a table slice");
+  const auto str = std::string_view{"not a table slice"};
+  auto fd = unbox(detail::make_sealed_memfd(
+    "test", std::as_bytes(std::span{str.data(), str.size()})));
+  REQUIRE(detail::uds_send_fd(client, fd));
+  ::close(fd);
+  poll_until([&] {
+    return !detail::poll(client, 0);
+  });
+  CHECK(results.empty());
+  MESSAGE("the node closes the connection without acknowledgement");
+  auto ack = char{};
+  CHECK_EQUAL(::recv(client, &ack, 1, MSG_PEEK), 0);
+  MESSAGE("the client fails at the end of its stream");
+  sys.spawn([sink](caf::event_based_actor* src) {
+    auto mgr = caf::attach_stream_source(
+      src,
+      [](caf::unit_t&) {
+        // nop
+      },
+      [](caf::unit_t&, caf::downstream<table_slice>&, size_t) {
+        // nop
+      },
+      [](const caf::unit_t&) {
+        return true;
+      });
+    mgr->add_outbound_path(sink, std::make_tuple(std::string{"test"}));
+  });
+  run();
+  self->receive([](const caf::down_msg& msg) {
+    CHECK_EQUAL(msg.reason, ec::remote_node_down);
+  });
+}
+
+TEST(shm ingest backs off while idle) {
+  auto& state = deref<caf::stateful_actor<system::shm_ingest_state>>(ingest)
+                  .state;
+  for (size_t i = 0; i < 20; ++i) {
+    sched.trigger_timeouts();
+    run();
+  }
+  CHECK_EQUAL(state.poll_interval, system::shm_ingest_state::max_poll_interval);
+  MESSAGE("a new client resets the interval");
+  auto client = unbox(system::connect_shm_ingest(path));
+  sched.trigger_timeouts();
+  run();
+  CHECK_EQUAL(state.poll_interval, system::shm_ingest_state::min_poll_interval);
+  ::close(client);
+}
+
+FIXTURE_SCOPE_END()
+
+#endif // VAST_LINUX
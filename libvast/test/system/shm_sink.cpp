@@ -0,0 +1,123 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2022 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE shm_sink
+
+#include "vast/system/shm_sink.hpp"
+
+#include "vast/config.hpp"
+#include "vast/detail/memfd.hpp"
+#include "vast/detail/posix.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/test/fixtures/actor_system_and_events.hpp"
+#include "vast/test/test.hpp"
+
+#include <caf/attach_stream_source.hpp>
+#include <sys/socket.h>
+
+#include <unistd.h>
+
+using namespace vast;
+
+#if VAST_LINUX
+
+namespace {
+
+struct fixture : fixtures::deterministic_actor_system_and_events {
+  fixture()
+    : fixtures::deterministic_actor_system_and_events(
+      VAST_PP_STRINGIFY(SUITE)) {
+    int fds[2];
+    REQUIRE_EQUAL(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    sink = self->spawn(system::shm_sink, fds[0]);
+    node_fd = fds[1];
+    run();
+  }
+
+  ~fixture() override {
+    ::close(node_fd);
+  }
+
+  /// Streams table slices to the SHM SINK and closes the stream afterwards.
+  void stream(std::vector<table_slice> slices) {
+    sys.spawn([this, slices = std::move(slices)](caf::event_based_actor* src) {
+      auto mgr = caf::attach_stream_source(
+        src,
+        [&](std::vector<table_slice>& xs) {
+          xs = slices;
+        },
+        [](std::vector<table_slice>& xs, caf::downstream<table_slice>& out,
+           size_t hint) {
+          for (size_t i = 0; i < hint && !xs.empty(); ++i) {
+            out.push(std::move(xs.front()));
+            xs.erase(xs.begin());
+          }
+        },
+        [](const std::vector<table_slice>& xs) {
+          return xs.empty();
+        });
+      mgr->add_outbound_path(sink, std::make_tuple(std::string{"test"}));
+    });
+    run();
+  }
+
+  /// Receives the table slices that the SHM SINK passed to the node until
+  /// the SHM SINK signals the end of the stream.
+  std::vector<table_slice> receive() {
+    auto result = std::vector<table_slice>{};
+    while (true) {
+      auto fd = detail::uds_recv_fd(node_fd);
+      if (fd < 0)
+        break;
+      auto chunk = unbox(detail::map_sealed_memfd(fd));
+      auto slice = table_slice{std::move(chunk), table_slice::verify::yes};
+      REQUIRE_NOT_EQUAL(slice.encoding(), table_slice_encoding::none);
+      result.push_back(std::move(slice));
+    }
+    return result;
+  }
+
+  system::shm_sink_actor sink;
+  int node_fd = -1;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(shm_sink_tests, fixture)
+
+TEST(shm sink passes table slices to the node) {
+  MESSAGE("acknowledge the stream ahead of time");
+  const auto ack = char{'*'};
+  REQUIRE_EQUAL(::write(node_fd, &ack, 1), 1);
+  self->monitor(sink);
+  stream(zeek_conn_log);
+  auto received = receive();
+  REQUIRE_EQUAL(received.size(), zeek_conn_log.size());
+  for (size_t i = 0; i < received.size(); ++i) {
+    received[i].offset(zeek_conn_log[i].offset());
+    CHECK_EQUAL(received[i], zeek_conn_log[i]);
+  }
+  MESSAGE("the sink terminates normally after the acknowledgement");
+  self->receive([](const caf::down_msg& msg) {
+    CHECK_EQUAL(msg.reason, caf::error{});
+  });
+}
+
+TEST(shm sink fails without acknowledgement) {
+  self->monitor(sink);
+  REQUIRE_EQUAL(::shutdown(node_fd, SHUT_WR), 0);
+  stream(zeek_conn_log);
+  CHECK_EQUAL(receive().size(), zeek_conn_log.size());
+  self->receive([](const caf::down_msg& msg) {
+    CHECK_EQUAL(msg.reason, ec::remote_node_down);
+  });
+}
+
+FIXTURE_SCOPE_END()
+
+#endif // VAST_LINUX
@@ -81,7 +81,8 @@ TEST(zeek source) {
     = self->spawn(source, std::move(reader), events::slice_size, std::nullopt,
                   vast::system::type_registry_actor{}, vast::module{},
                   std::string{}, vast::system::accountant_actor{},
-                  std::vector<vast::pipeline>{});
+                  std::vector<vast::pipeline>{}, vast::duration{},
+                  std::function<vast::system::report()>{});
   run();
   MESSAGE("start sink and run exhaustively");
   auto snk = self->spawn(test_sink, src);
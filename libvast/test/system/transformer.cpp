@@ -73,6 +73,25 @@ dummy_sink(vast::system::stream_sink_actor<vast::table_slice>::pointer self,
   };
 }
 
+vast::system::stream_sink_actor<vast::table_slice>::behavior_type
+collecting_sink(
+  vast::system::stream_sink_actor<vast::table_slice>::pointer self,
+  std::vector<vast::table_slice>* results) {
+  return {
+    [=](caf::stream<vast::table_slice> in) {
+      auto sink = caf::attach_stream_sink(
+        self, in,
+        [=](caf::unit_t&) {
+          // nop
+        },
+        [=](caf::unit_t&, vast::table_slice&& x) {
+          results->push_back(std::move(x));
+        });
+      return caf::inbound_stream_slot<vast::table_slice>{sink.inbound_slot()};
+    },
+  };
+}
+
 struct transformer_fixture
   : public fixtures::deterministic_actor_system_and_events {
   transformer_fixture()
@@ -101,6 +120,26 @@ struct transformer_fixture
     }
     return {builder->finish()};
   }
+
+  // Creates a table slice with ten events one second apart.
+  static std::vector<vast::detail::framed<vast::table_slice>>
+  make_windowed_testdata() {
+    auto layout = vast::type{
+      "vast.test",
+      vast::record_type{
+        {"ts", vast::time_type{}},
+        {"uid", vast::string_type{}},
+      },
+    };
+    auto builder = vast::factory<vast::table_slice_builder>::make(
+      vast::defaults::import::table_slice_type, layout);
+    REQUIRE(builder);
+    const auto start = vast::time{} + std::chrono::hours{1};
+    for (int i = 0; i < 10; ++i)
+      REQUIRE(builder->add(start + std::chrono::seconds{i},
+                           fmt::format("uid-{}", i)));
+    return {builder->finish()};
+  }
 };
 
 std::vector<vast::pipeline>
@@ -166,4 +205,74 @@ TEST(transformer) {
   self->send_exit(transformer, caf::exit_reason::user_shutdown);
 }
 
+TEST(importer transformer ships open windows at the end of the input) {
+  auto results = std::vector<vast::table_slice>{};
+  auto snk = self->spawn(collecting_sink, &results);
+  // Every event falls into two sliding windows, so the aggregation returns
+  // more events than it receives.
+  auto windowed = vast::pipeline{"windowed", {"vast.test"}};
+  REQUIRE_SUCCESS(windowed.add_operator(
+    "summarize",
+    vast::record{
+      {"group-by", "uid"},
+      {"window",
+       vast::record{
+         {"field", "ts"},
+         {"size", vast::duration{std::chrono::minutes{2}}},
+         {"slide", vast::duration{std::chrono::minutes{1}}},
+       }},
+      {"aggregate", vast::record{{"n", vast::record{{"count", "uid"}}}}},
+    }));
+  auto pipelines = std::vector<vast::pipeline>{};
+  pipelines.push_back(std::move(windowed));
+  auto transformer = self->spawn(vast::system::importer_transformer,
+                                 "test_transformer", std::move(pipelines));
+  self->send(transformer, snk);
+  run();
+  auto slices = make_windowed_testdata();
+  slices.push_back(vast::detail::framed<vast::table_slice>::make_eof());
+  vast::detail::spawn_container_source(self->system(), slices, transformer);
+  run();
+  MESSAGE("all windows arrive at the sink with consecutive offsets");
+  auto rows = uint64_t{0};
+  for (const auto& slice : results) {
+    CHECK_EQUAL(slice.offset(), rows);
+    rows += slice.rows();
+  }
+  CHECK_EQUAL(rows, 20u);
+}
+
+TEST(importer transformer applies pipelines on multiple workers) {
+  caf::put(cfg.content, "vast.pipeline-workers", 4);
+  auto results = std::vector<vast::table_slice>{};
+  auto snk = self->spawn(collecting_sink, &results);
+  auto pipelines = pipelines_from_string(
+    vast::system::pipelines_location::server_import, pipeline_config);
+  auto transformer = self->spawn(vast::system::importer_transformer,
+                                 "test_transformer", std::move(pipelines));
+  self->send(transformer, snk);
+  run();
+  auto slices = std::vector<vast::detail::framed<vast::table_slice>>{};
+  for (int i = 0; i < 6; ++i) {
+    auto slice = std::move(make_pipelines_testdata()[0].body);
+    slice.offset(i * 10);
+    slices.emplace_back(std::move(slice));
+  }
+  slices.push_back(vast::detail::framed<vast::table_slice>::make_eof());
+  vast::detail::spawn_container_source(self->system(), slices, transformer);
+  run();
+  MESSAGE("all slices arrive at the sink in order");
+  auto rows = uint64_t{0};
+  for (const auto& slice : results) {
+    CHECK_EQUAL(slice.offset(), rows);
+    CHECK_EQUAL(caf::get<vast::record_type>(slice.layout()).num_fields(), 1u);
+    for (size_t row = 0; row < slice.rows(); ++row)
+      CHECK_EQUAL(slice.at(row, 0),
+                  vast::data_view{vast::integer{
+                    static_cast<int64_t>((rows + row) % 10)}});
+    rows += slice.rows();
+  }
+  CHECK_EQUAL(rows, 60u);
+}
+
 FIXTURE_SCOPE_END()
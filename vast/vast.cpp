@@ -26,8 +26,8 @@
 #include "vast/system/application.hpp"
 #include "vast/system/default_configuration.hpp"
 #include "vast/system/make_pipelines.hpp"
+#include "vast/table_slice_compression.hpp"
 
-#include <arrow/util/compression.h>
 #include <caf/actor_system.hpp>
 
 #include <csignal>
@@ -184,23 +184,12 @@ int main(int argc, char** argv) {
   // Issue deprecation warnings.
   if (auto exit_code = try_handle_deprecations(cfg))
     return *exit_code;
-  // Eagerly verify that the Arrow libraries we're using have Zstd support so
-  // we can assert this works when serializing record batches.
-  {
-    auto compression_level
-      = arrow::util::Codec::DefaultCompressionLevel(arrow::Compression::ZSTD);
-    if (!compression_level.ok()) {
-      VAST_ERROR("failed to configure Zstd codec for Apache Arrow: {}",
-                 compression_level.status().ToString());
-      return EXIT_FAILURE;
-    }
-    auto codec = arrow::util::Codec::Create(
-      arrow::Compression::ZSTD, compression_level.MoveValueUnsafe());
-    if (!codec.ok()) {
-      VAST_ERROR("failed to create Zstd codec for Apache Arrow: {}",
-                 compression_level.status().ToString());
-      return EXIT_FAILURE;
-    }
+  // Configure the compression of table slices. This eagerly verifies that the
+  // Arrow libraries we're using support the configured codec so we can assert
+  // this works when serializing record batches.
+  if (auto err = set_table_slice_compression(cfg.content)) {
+    VAST_ERROR("failed to configure table slice compression: {}", err);
+    return EXIT_FAILURE;
   }
   // Eagerly verify the export transform configuration, to avoid hidden
   // configuration errors that pop up the first time a user tries to run